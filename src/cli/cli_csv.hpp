@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Field helpers shared by the batch commands' CSV readers.
+
+namespace cli {
+
+inline std::string_view trim_field(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' ||
+                          s.back() == '\r')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+inline std::string upper_ticker(std::string_view ticker)
+{
+    std::string key(ticker);
+    for (char& c : key) {
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    }
+    return key;
+}
+
+} // namespace cli
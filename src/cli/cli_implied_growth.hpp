@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cli/cli_csv.hpp"
+#include "db/database.hpp"
+#include "metrics/metric_math.hpp"
+#include "metrics/reverse_dcf.hpp"
+#include "metrics/work_pool.hpp"
+
+// `intrinsic implied-growth <prices.csv>`: solves the implied growth of
+// every portfolio ticker against a file of TICKER,PRICE lines and prints
+// the results as CSV, without starting the terminal UI.
+
+namespace cli {
+
+// TICKER,PRICE per line with a positive price; blank lines and lines
+// starting with '#' are skipped, as is a first line whose price is not a
+// number (a header).
+// Tickers are matched case-insensitively; a repeated ticker keeps its last
+// price. Empty with `err` set on the first malformed line.
+inline std::optional<std::map<std::string, double>>
+parse_price_lines(std::istream& in, std::string* err = nullptr)
+{
+    std::map<std::string, double> out;
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        const auto text = trim_field(line);
+        if (text.empty() || text.front() == '#') continue;
+
+        const auto comma = text.find(',');
+        const auto ticker = trim_field(text.substr(0, comma));
+        const std::string price_text =
+            comma == std::string_view::npos
+                ? std::string()
+                : std::string(trim_field(text.substr(comma + 1)));
+
+        char* end = nullptr;
+        errno = 0;
+        const double price = std::strtod(price_text.c_str(), &end);
+        const bool numeric = !price_text.empty() && errno == 0 &&
+                             end == price_text.c_str() + price_text.size() &&
+                             std::isfinite(price);
+        if (!numeric || price <= 0.0 || ticker.empty()) {
+            if (line_no == 1 && !numeric) continue;
+            if (err) *err = "line " + std::to_string(line_no) +
+                            ": expected TICKER,PRICE";
+            return std::nullopt;
+        }
+
+        out[upper_ticker(ticker)] = price;
+    }
+    return out;
+}
+
+// Writes `ticker,period,price,implied_growth_pct` per priced portfolio
+// ticker (growth empty when unsolvable) and a summary line to `log`.
+// Returns the process exit code.
+inline int run_implied_growth(db::Database& database,
+                              const std::string& prices_path,
+                              metrics::WorkPool& pool,
+                              std::ostream& out,
+                              std::ostream& log)
+{
+    std::ifstream file(prices_path);
+    if (!file) {
+        log << "error: cannot open " << prices_path << "\n";
+        return 1;
+    }
+    std::string err;
+    const auto prices = parse_price_lines(file, &err);
+    if (!prices.has_value()) {
+        log << "error: " << prices_path << ": " << err << "\n";
+        return 1;
+    }
+
+    const auto tickers =
+        database.get_all_tickers(std::numeric_limits<int>::max(), &err);
+    if (!err.empty()) {
+        log << "error: " << err << "\n";
+        return 1;
+    }
+
+    struct Entry {
+        std::string ticker;
+        std::string period;
+        double price = 0.0;
+        std::optional<metrics::ReverseDcfInputs> inputs;
+    };
+    std::vector<Entry> entries;
+    for (const auto& t : tickers) {
+        if (!t.portfolio) continue;
+        const auto price = prices->find(t.ticker);
+        if (price == prices->end()) {
+            log << "no price for " << t.ticker << "\n";
+            continue;
+        }
+
+        // rows come back oldest first; solve from the latest period
+        const auto rows = database.get_finances(t.ticker, &err);
+        if (!err.empty()) {
+            log << "error: " << err << "\n";
+            return 1;
+        }
+        Entry e;
+        e.ticker = t.ticker;
+        e.price = price->second;
+        if (!rows.empty()) {
+            e.period = metrics::period_label(rows.back());
+            e.inputs = metrics::reverse_dcf_inputs(
+                rows, static_cast<int>(rows.size()) - 1);
+        }
+        entries.push_back(std::move(e));
+    }
+
+    std::vector<metrics::ImpliedGrowthJob> jobs;
+    std::vector<std::size_t> job_entry;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (!entries[i].inputs.has_value()) continue;
+        jobs.push_back({*entries[i].inputs, entries[i].price});
+        job_entry.push_back(i);
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    const auto solved = metrics::implied_growth_batch(jobs, pool);
+    const auto elapsed_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started)
+            .count();
+
+    std::vector<std::optional<double>> growth(entries.size());
+    std::size_t solved_count = 0;
+    for (std::size_t j = 0; j < jobs.size(); ++j) {
+        growth[job_entry[j]] = solved[j];
+        if (solved[j].has_value()) ++solved_count;
+    }
+
+    out << "ticker,period,price,implied_growth_pct\n";
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const auto& e = entries[i];
+        // shortest text that reads back as the solved price
+        char price[32];
+        const auto price_end =
+            std::to_chars(price, price + sizeof(price), e.price).ptr;
+        out << e.ticker << ',' << e.period << ',';
+        out.write(price, price_end - price);
+        out << ',';
+        if (growth[i].has_value()) {
+            out << std::fixed << std::setprecision(2) << *growth[i] * 100.0
+                << std::defaultfloat << std::setprecision(6);
+        }
+        out << '\n';
+    }
+
+    log << "solved " << solved_count << " of " << entries.size()
+        << " tickers in " << elapsed_us << " us on " << pool.size()
+        << " threads\n";
+    return 0;
+}
+
+} // namespace cli
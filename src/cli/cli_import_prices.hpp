@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cli/cli_csv.hpp"
+#include "db/database.hpp"
+#include "db/price_series.hpp"
+
+// `intrinsic import-prices <file.csv>...`: loads daily closes from
+// TICKER,YYYY-MM-DD,CLOSE lines into the prices table, without starting the
+// terminal UI.
+
+namespace cli {
+
+using PriceHistory =
+    std::map<std::string, std::vector<db::Database::PricePoint>>;
+
+// Appends the closes of `in` to `out`, by upper-cased ticker. Blank lines
+// and lines starting with '#' are skipped, as is a first line that does not
+// parse (a header). False with `err` set on the first malformed line.
+inline bool parse_close_lines(std::istream& in,
+                              PriceHistory& out,
+                              std::string* err = nullptr)
+{
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        const auto text = trim_field(line);
+        if (text.empty() || text.front() == '#') continue;
+
+        const auto first = text.find(',');
+        const auto second = first == std::string_view::npos
+                                ? std::string_view::npos
+                                : text.find(',', first + 1);
+        std::string_view ticker;
+        std::optional<std::int32_t> day;
+        std::string close_text;
+        if (second != std::string_view::npos) {
+            ticker = trim_field(text.substr(0, first));
+            day = db::parse_iso_day(
+                trim_field(text.substr(first + 1, second - first - 1)));
+            close_text = std::string(trim_field(text.substr(second + 1)));
+        }
+
+        char* end = nullptr;
+        errno = 0;
+        const double close = std::strtod(close_text.c_str(), &end);
+        const bool ok = !ticker.empty() && day.has_value() &&
+                        !close_text.empty() && errno == 0 &&
+                        end == close_text.c_str() + close_text.size() &&
+                        std::isfinite(close) && close > 0.0;
+        if (!ok) {
+            if (line_no == 1) continue;
+            if (err) *err = "line " + std::to_string(line_no) +
+                            ": expected TICKER,YYYY-MM-DD,CLOSE";
+            return false;
+        }
+
+        out[upper_ticker(ticker)].push_back({*day, close});
+    }
+    return true;
+}
+
+// Orders one ticker's closes by day; of repeated days the last read wins.
+inline void sort_closes(std::vector<db::Database::PricePoint>& points)
+{
+    std::stable_sort(
+        points.begin(), points.end(), [](const auto& a, const auto& b) {
+            return a.day < b.day;
+        });
+    std::vector<db::Database::PricePoint> unique;
+    unique.reserve(points.size());
+    for (const auto& p : points) {
+        if (!unique.empty() && unique.back().day == p.day) {
+            unique.back() = p;
+        }
+        else {
+            unique.push_back(p);
+        }
+    }
+    points = std::move(unique);
+}
+
+// Reads every file before writing anything, then upserts each ticker's
+// closes in one transaction. Returns the process exit code.
+inline int run_import_prices(db::Database& database,
+                             const std::vector<std::string>& paths,
+                             std::ostream& log)
+{
+    const auto started = std::chrono::steady_clock::now();
+
+    PriceHistory history;
+    for (const auto& path : paths) {
+        std::ifstream file(path);
+        if (!file) {
+            log << "error: cannot open " << path << "\n";
+            return 1;
+        }
+        std::string err;
+        if (!parse_close_lines(file, history, &err)) {
+            log << "error: " << path << ": " << err << "\n";
+            return 1;
+        }
+    }
+
+    std::size_t closes = 0;
+    for (auto& [ticker, points] : history) {
+        sort_closes(points);
+        std::string err;
+        if (!database.add_prices(ticker, points, &err)) {
+            log << "error: " << ticker << ": " << err << "\n";
+            return 1;
+        }
+        closes += points.size();
+    }
+
+    const auto elapsed_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started)
+            .count();
+    log << "imported " << closes << " closes for " << history.size()
+        << " tickers in " << elapsed_ms << " ms\n";
+    return 0;
+}
+
+} // namespace cli
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "db/database.hpp"
+#include "server/api.hpp"
+#include "server/http_server.hpp"
+#include "server/response_cache.hpp"
+
+// `intrinsic serve [--port N] [--workers N]`: answers the JSON API of
+// server/api.hpp on 127.0.0.1 until interrupted, reading the database the
+// terminal UI writes to.
+
+namespace cli {
+
+struct ServeOptions {
+    std::uint16_t port = 8080;
+    unsigned workers = 0; // 0: one per core, at most kMaxServeWorkers
+};
+
+inline constexpr unsigned kMaxServeWorkers = 8;
+
+// Parses the arguments after `serve`. False with `err` set on unknown or
+// malformed ones.
+inline bool parse_serve_args(const std::vector<std::string>& args,
+                             ServeOptions& out,
+                             std::string* err = nullptr)
+{
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const auto& flag = args[i];
+        if ((flag != "--port" && flag != "--workers") ||
+            i + 1 >= args.size()) {
+            if (err) *err = "unexpected argument: " + flag;
+            return false;
+        }
+        const auto& text = args[++i];
+        char* end = nullptr;
+        const long value = std::strtol(text.c_str(), &end, 10);
+        const bool is_number =
+            !text.empty() && end == text.c_str() + text.size();
+        if (flag == "--port") {
+            if (!is_number || value < 0 || value > 65535) {
+                if (err) *err = "bad port: " + text;
+                return false;
+            }
+            out.port = static_cast<std::uint16_t>(value);
+        }
+        else {
+            if (!is_number || value < 1 ||
+                value > static_cast<long>(kMaxServeWorkers)) {
+                if (err) *err = "workers must be 1-" +
+                                std::to_string(kMaxServeWorkers);
+                return false;
+            }
+            out.workers = static_cast<unsigned>(value);
+        }
+    }
+    return true;
+}
+
+namespace detail {
+
+inline std::atomic<server::HttpServer*> serving{nullptr};
+
+inline void stop_serving(int)
+{
+    if (auto* s = serving.load()) s->stop();
+}
+
+} // namespace detail
+
+// Serves until SIGINT or SIGTERM. Returns the process exit code.
+inline int run_serve(const db::Database& database,
+                     const ServeOptions& options,
+                     std::ostream& log)
+{
+    unsigned workers = options.workers;
+    if (workers == 0) {
+        workers = std::clamp(std::thread::hardware_concurrency(),
+                             1u,
+                             kMaxServeWorkers);
+    }
+
+    server::HttpServer http;
+    std::string err;
+    if (!http.listen(options.port, &err)) {
+        log << "error: " << err << "\n";
+        return 1;
+    }
+
+    detail::serving.store(&http);
+    std::signal(SIGINT, detail::stop_serving);
+    std::signal(SIGTERM, detail::stop_serving);
+    log << "serving http://127.0.0.1:" << http.port() << "/api/ (workers: "
+        << workers << ")\n";
+    log.flush();
+
+    server::ResponseCache cache;
+    const auto handler = [&cache](db::Database& reader,
+                                  const server::HttpRequest& request) {
+        return server::handle_api_request(reader, request, &cache);
+    };
+    const bool ok = http.run(database.path(), workers, handler, &err);
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    detail::serving.store(nullptr);
+    if (!ok) {
+        log << "error: " << err << "\n";
+        return 1;
+    }
+    log << "served " << http.requests_served() << " requests\n";
+    return 0;
+}
+
+} // namespace cli
@@ -1,4 +1,6 @@
 #include "db/database.hpp"
+#include "db/metrics_vtab.hpp"
+#include "db/sql_functions.hpp"
 #include "db/sql_helpers.hpp"
 #include "paths.hpp"
 
@@ -82,6 +84,8 @@ void Database::open_connection_(const std::filesystem::path& file_path)
     db::detail::exec_sql(tmp, "PRAGMA temp_store = MEMORY;");
     db::detail::exec_sql(tmp, "PRAGMA cache_size = -2000;"); // 2000 KB
     db::detail::exec_sql(tmp, "PRAGMA wal_autocheckpoint = 1000;");
+    register_sql_functions(tmp);
+    register_metrics_vtab(tmp);
 
     db_ = tmp;
     db_path_ = file_path;
@@ -97,8 +101,42 @@ void Database::open_or_create()
     open_connection_(file_path);
 
     apply_schema_(); // IF NOT EXISTS handles it
+    watch_changes_();
+    ++write_generation_; // possibly a different file than before
+    ++price_generation_;
 }
 
-} // namespace db
+void Database::open_read_only(const std::filesystem::path& file_path)
+{
+    if (db_) return;
 
+    sqlite3* tmp = nullptr;
+    const std::string utf8_path = sqlite_path_utf8(file_path);
+
+    const int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX;
+    const int rc = sqlite3_open_v2(utf8_path.c_str(), &tmp, flags, nullptr);
 
+    if (rc != SQLITE_OK) {
+        std::string msg = tmp ? sqlite3_errmsg(tmp) : "sqlite open error";
+        if (tmp) sqlite3_close(tmp);
+        throw std::runtime_error("failed to open sqlite db at: " +
+                                 file_path.string() + " (" + msg + ")");
+    }
+
+    sqlite3_busy_timeout(tmp, 5000);
+    db::detail::exec_sql(tmp, "PRAGMA query_only = ON;");
+    db::detail::exec_sql(tmp, "PRAGMA temp_store = MEMORY;");
+    register_sql_functions(tmp);
+    register_metrics_vtab(tmp);
+
+    db_ = tmp;
+    db_path_ = file_path;
+    watch_changes_();
+}
+
+void Database::interrupt()
+{
+    if (db_) sqlite3_interrupt(db_);
+}
+
+} // namespace db
@@ -25,6 +25,87 @@ public:
         int type = 1;
     };
 
+    // Narrow per-ticker digest of its finances, kept in ticker_summary by
+    // every finances write so lists never need whole histories.
+    struct TickerSummary {
+        std::string ticker;
+        int latest_year = 0;
+        std::string latest_period_type;
+        int period_count = 0;
+        int yearly_count = 0;
+        std::optional<std::int64_t> latest_revenue;
+        std::optional<double> latest_eps;
+
+        // TTM at the newest quarterly/semiannual period, when there is one
+        std::optional<int> ttm_year;
+        std::string ttm_period_type;
+        std::optional<double> ttm_eps;
+        std::optional<double> ttm_net_income;
+        std::optional<double> ttm_cash_flow_ops;
+    };
+
+    // One period matched by screen_finance_metric().
+    struct MetricScreenRow {
+        std::string ticker;
+        int year = 0;
+        std::string period_type;
+        double value = 0.0;
+    };
+
+    // One daily close; `day` counts days since 1970-01-01.
+    struct PricePoint {
+        std::int32_t day = 0;
+        double close = 0.0;
+    };
+
+    // A portfolio ticker with its holding and the price-independent metrics
+    // of its newest period (see finance_metrics).
+    struct PortfolioRow {
+        std::string ticker;
+        int type = 1;
+        double shares = 0.0;     // 0 without a holding
+        double cost_basis = 0.0; // paid for all `shares`
+        // TTM eps, or the newest period's own when that is a year
+        std::optional<double> eps;
+        std::optional<double> tbv_per_share;
+        std::optional<double> combined_ratio;
+    };
+
+    // One change_log row: a write to a ticker's row, one of its periods,
+    // its holding, or a batch of its closes.
+    struct Change {
+        std::int64_t seq = 0; // increasing in commit order
+        std::string op;       // insert, update, delete; upsert for prices
+        std::string source;   // tickers, finances, holdings or prices
+        std::string ticker;
+        std::optional<int> year; // finances only, with period_type
+        std::string period_type;
+    };
+
+    struct ChangeSet {
+        std::vector<Change> changes; // seq ASC
+        // entries after the watermark were compacted away before they were
+        // read: rescan instead of applying `changes`
+        bool truncated = false;
+        // newest seq when read; where to resume after a rescan
+        std::int64_t latest_seq = 0;
+    };
+
+    // Tickers other connections wrote since this one last looked, ticker
+    // ASC without duplicates; see poll_external_changes().
+    struct ExternalChanges {
+        std::vector<std::string> tickers; // ticker rows, finances, holdings
+        std::vector<std::string> prices;  // daily closes
+        // the log was compacted past what this connection had seen: treat
+        // every ticker as changed
+        bool truncated = false;
+
+        bool empty() const
+        {
+            return tickers.empty() && prices.empty() && !truncated;
+        }
+    };
+
     enum class TickerSortKey { Ticker, LastUpdate };
     enum class SortDir { Asc, Desc };
 
@@ -120,8 +201,42 @@ public:
     void close();
     void open_or_create();
 
+    // Second connection on an existing file for background readers: no
+    // schema work, writes rejected.
+    void open_read_only(const std::filesystem::path& file_path);
+
+    // Aborts the statement running on this connection; safe to call from
+    // another thread while the connection stays open.
+    void interrupt();
+
     const std::filesystem::path& path() const { return db_path_; }
 
+    // Bumped by every committed finances write and by reopening, so caches
+    // of decoded rows can tell whether they are still current.
+    std::uint64_t write_generation() const { return write_generation_; }
+
+    // Same for the prices table, which moves independently of finances.
+    std::uint64_t price_generation() const { return price_generation_; }
+
+    // Cheap enough for every idle tick: one PRAGMA data_version unless
+    // another connection (another session, an import) committed since the
+    // last call, then the change_log rows it added. Moves write_generation()
+    // and price_generation() when the changes touched them, so callers
+    // should first carry unchanged cache entries over. This connection's
+    // own writes are left out unless another commit raced them.
+    ExternalChanges poll_external_changes(std::string* err = nullptr);
+
+    // change_log keeps its newest `keep_rows` entries for polling sessions,
+    // drops older ones once every consumer acknowledged them, and never
+    // holds more than `max_rows` (a consumer that stopped acknowledging
+    // then reads a truncated set). Applied on open, on ack_changes() and
+    // every kChangeLogCompactEvery writes.
+    static constexpr std::int64_t kChangeLogKeepRows = 4096;
+    static constexpr std::int64_t kChangeLogMaxRows = 1 << 18;
+    static constexpr int kChangeLogCompactEvery = 1024;
+    void set_change_log_retention(std::int64_t keep_rows,
+                                  std::int64_t max_rows);
+
     // *
     // **
     // ***
@@ -140,6 +255,16 @@ public:
                                           std::string* err = nullptr,
                                           bool portfolio_only = false);
 
+    // ticker ASC, at most `limit` rows
+    std::vector<TickerRow> get_all_tickers(int limit,
+                                           std::string* err = nullptr);
+
+    std::optional<TickerRow> get_ticker(const std::string& ticker,
+                                        std::string* err = nullptr);
+
+    std::optional<std::int64_t> count_tickers(bool portfolio_only,
+                                              std::string* err = nullptr);
+
     bool toggle_ticker_portfolio(const std::string& ticker,
                                  std::string* err = nullptr);
 
@@ -159,6 +284,86 @@ public:
     std::optional<int> get_ticker_type(const std::string& ticker,
                                        std::string* err = nullptr);
 
+    // Moves on every add_finances(), delete_period() and
+    // toggle_ticker_portfolio() of `ticker`, and is stored with it, so other
+    // processes can tell whether what they derived from it is current.
+    // Drawn from one counter per file, so a value is never reused, not even
+    // by a re-created ticker; nullopt for unknown tickers.
+    std::optional<std::uint64_t>
+    get_ticker_generation(const std::string& ticker,
+                          std::string* err = nullptr);
+
+    std::optional<TickerSummary>
+    get_ticker_summary(const std::string& ticker, std::string* err = nullptr);
+
+    // Summaries for `tickers` in the same order; tickers without one are
+    // skipped.
+    std::vector<TickerSummary>
+    get_ticker_summaries(const std::vector<std::string>& tickers,
+                         std::string* err = nullptr);
+
+    // Periods whose finance_metrics `metric` lies in [min, max], ordered by
+    // it. Metrics marked indexed in metrics::kFinanceMetricColumns are
+    // served by an index range scan. Unknown metric names are an error.
+    std::vector<MetricScreenRow>
+    screen_finance_metric(const std::string& metric,
+                          std::optional<double> min,
+                          std::optional<double> max,
+                          SortDir dir,
+                          int limit,
+                          bool latest_only,
+                          std::string* err = nullptr);
+
+    // Upserts daily closes of `ticker` in one transaction. Prices are
+    // market data, not finances: tickers without finances may have them.
+    bool add_prices(const std::string& ticker,
+                    const std::vector<PricePoint>& points,
+                    std::string* err = nullptr);
+
+    // day ASC
+    std::vector<PricePoint> get_prices(const std::string& ticker,
+                                       std::string* err = nullptr);
+
+    // Newest close of `ticker`, without reading the rest.
+    std::optional<PricePoint> get_latest_price(const std::string& ticker,
+                                               std::string* err = nullptr);
+
+    // `shares` of `ticker` bought for `cost_basis` in total; zero shares
+    // drop the holding. The ticker must exist.
+    bool set_holding(const std::string& ticker,
+                     double shares,
+                     double cost_basis,
+                     std::string* err = nullptr);
+
+    // Portfolio-marked tickers, ticker ASC.
+    std::vector<PortfolioRow> get_portfolio_rows(std::string* err = nullptr);
+
+    // One of them; nullopt when `ticker` is not in the portfolio.
+    std::optional<PortfolioRow>
+    get_portfolio_row(const std::string& ticker, std::string* err = nullptr);
+
+    // At most `limit` change_log entries after `seq` (0: from the start),
+    // for consumers that keep derived data (exports, summaries, caches)
+    // current from the delta instead of rescanning.
+    ChangeSet changes_since(std::int64_t seq,
+                            int limit,
+                            std::string* err = nullptr);
+
+    // Records that `consumer` processed everything through `seq`, then
+    // compacts what all consumers have processed. Watermarks never move
+    // back. Consumers pin the log until dropped.
+    bool ack_changes(const std::string& consumer,
+                     std::int64_t seq,
+                     std::string* err = nullptr);
+
+    // nullopt for unknown consumers
+    std::optional<std::int64_t>
+    get_change_watermark(const std::string& consumer,
+                         std::string* err = nullptr);
+
+    bool drop_change_consumer(const std::string& consumer,
+                              std::string* err = nullptr);
+
 private:
     static std::filesystem::path default_db_path_();
     static void
@@ -167,9 +372,39 @@ private:
     void open_connection_(const std::filesystem::path& file_path);
     void apply_schema_();
 
+    // Rewrites the ticker_summary row and the finance_metrics rows from
+    // (year, period_type) onwards; earlier rows cannot depend on a change
+    // there. Removes the summary when no finances are left. Throws.
+    void refresh_derived_(const std::string& ticker,
+                          int year,
+                          const std::string& period_type);
+    // Tickers without a summary, or every ticker when `all`.
+    void backfill_derived_(bool all);
+    // Both throw; call inside the writing transaction.
+    std::int64_t next_ticker_generation_();
+    void bump_ticker_generation_(const std::string& ticker);
+
+    // Starts watching change_log from its current end. Throws.
+    void watch_changes_();
+    // After each committed write: skips its change_log rows when no other
+    // connection committed meanwhile (otherwise the next poll reads them
+    // along with the foreign ones), and compacts the log every
+    // kChangeLogCompactEvery calls. Never throws.
+    void note_own_write_();
+    // Drops change_log entries per the retention rules. Throws.
+    void compact_change_log_();
+
 private:
     sqlite3* db_{nullptr};
     std::filesystem::path db_path_{};
+    std::uint64_t write_generation_{1};
+    std::uint64_t price_generation_{1};
+    // PRAGMA data_version and change_log seq the last poll saw
+    std::int64_t data_version_{0};
+    std::int64_t change_seq_{0};
+    std::int64_t change_log_keep_rows_{kChangeLogKeepRows};
+    std::int64_t change_log_max_rows_{kChangeLogMaxRows};
+    int writes_since_compaction_{0};
 };
 
 } // namespace db
@@ -1,6 +1,9 @@
 #include "db/database.hpp"
+#include "db/database_sql.hpp"
 #include "db/sql_helpers.hpp"
+#include "metrics/metric_math.hpp"
 
+#include <algorithm>
 #include <ctime>
 #include <limits>
 #include <stdexcept>
@@ -127,6 +130,17 @@ static int normalize_ticker_type(int ticker_type)
     return ticker_type;
 }
 
+static db::Database::TickerRow read_ticker_row(sqlite3_stmt* st)
+{
+    db::Database::TickerRow r;
+    r.ticker = col_text(st, 0);
+    r.last_update = sqlite3_column_int64(st, 1);
+    r.portfolio = sqlite3_column_int(st, 2) != 0;
+    r.type = sqlite3_column_int(st, 3);
+    if (r.type <= 0) r.type = 1;
+    return r;
+}
+
 template <class Fn>
 static bool in_transaction(sqlite3* db, Fn&& fn, std::string* err = nullptr)
 {
@@ -172,34 +186,8 @@ db::Database::get_tickers(int page,
             throw std::runtime_error("page offset out of range");
         }
 
-        const char* order_by = nullptr;
-
-        if (key == TickerSortKey::LastUpdate) {
-            if (dir == SortDir::Desc) {
-                order_by = "last_update DESC, ticker ASC";
-            }
-            else {
-                order_by = "last_update ASC, ticker ASC";
-            }
-        }
-        else { // TickerSortKey::Ticker
-            if (dir == SortDir::Asc) {
-                order_by = "ticker ASC";
-            }
-            else {
-                order_by = "ticker DESC";
-            }
-        }
-
-        std::string sql = "SELECT ticker, last_update, portfolio, type "
-                          "FROM tickers ";
-        if (portfolio_only) {
-            sql += "WHERE portfolio = 1 ";
-        }
-
-        sql += "ORDER BY " + std::string(order_by) +
-               " "
-               "LIMIT ? OFFSET ?;";
+        const std::string sql =
+            db::sql::tickers_page(key, dir, portfolio_only);
 
         Stmt st{db_, sql.c_str()};
 
@@ -212,13 +200,7 @@ db::Database::get_tickers(int page,
         while (true) {
             const int rc = sqlite3_step(st.get());
             if (rc == SQLITE_ROW) {
-                TickerRow r;
-                r.ticker = col_text(st.get(), 0);
-                r.last_update = sqlite3_column_int64(st.get(), 1);
-                r.portfolio = sqlite3_column_int(st.get(), 2) != 0;
-                r.type = sqlite3_column_int(st.get(), 3);
-                if (r.type <= 0) r.type = 1;
-                out.push_back(std::move(r));
+                out.push_back(read_ticker_row(st.get()));
             }
             else if (rc == SQLITE_DONE) {
                 break;
@@ -245,18 +227,7 @@ db::Database::search_tickers(const std::string& contains,
         if (limit <= 0) limit = 1;
         if (contains.empty()) return {};
 
-        std::string sql = R"SQL(
-            SELECT ticker, last_update, portfolio, type
-            FROM tickers
-            WHERE UPPER(ticker) LIKE '%' || UPPER(?) || '%'
-        )SQL";
-        if (portfolio_only) {
-            sql += " AND portfolio = 1 ";
-        }
-        sql += R"SQL(
-            ORDER BY ticker ASC
-            LIMIT ?;
-        )SQL";
+        const std::string sql = db::sql::search_tickers(portfolio_only);
 
         Stmt st{db_, sql.c_str()};
         bind_text(db_, st.get(), 1, contains);
@@ -267,13 +238,7 @@ db::Database::search_tickers(const std::string& contains,
         while (true) {
             const int rc = sqlite3_step(st.get());
             if (rc == SQLITE_ROW) {
-                TickerRow r;
-                r.ticker = col_text(st.get(), 0);
-                r.last_update = sqlite3_column_int64(st.get(), 1);
-                r.portfolio = sqlite3_column_int(st.get(), 2) != 0;
-                r.type = sqlite3_column_int(st.get(), 3);
-                if (r.type <= 0) r.type = 1;
-                out.push_back(std::move(r));
+                out.push_back(read_ticker_row(st.get()));
             }
             else if (rc == SQLITE_DONE) {
                 break;
@@ -291,26 +256,98 @@ db::Database::search_tickers(const std::string& contains,
     }
 }
 
-bool Database::toggle_ticker_portfolio(const std::string& ticker,
-                                       std::string* err)
+std::vector<db::Database::TickerRow>
+db::Database::get_all_tickers(int limit, std::string* err)
 {
     try {
-        const char* sql = R"SQL(
-            UPDATE tickers
-            SET portfolio = CASE WHEN portfolio = 0 THEN 1 ELSE 0 END
-            WHERE ticker = ?;
-        )SQL";
+        if (limit <= 0) return {};
+
+        Stmt st{db_, db::sql::kSelectAllTickers};
+        if (sqlite3_bind_int(st.get(), 1, limit) != SQLITE_OK)
+            db::detail::throw_sqlite(db_, "bind limit failed");
 
-        Stmt st{db_, sql};
+        std::vector<TickerRow> out;
+        while (true) {
+            const int rc = sqlite3_step(st.get());
+            if (rc == SQLITE_ROW) {
+                out.push_back(read_ticker_row(st.get()));
+            }
+            else if (rc == SQLITE_DONE) {
+                break;
+            }
+            else {
+                db::detail::throw_sqlite(db_, "all tickers step failed");
+            }
+        }
+        return out;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return {};
+    }
+}
+
+std::optional<db::Database::TickerRow>
+db::Database::get_ticker(const std::string& ticker, std::string* err)
+{
+    try {
+        Stmt st{db_, db::sql::kSelectTicker};
         bind_text(db_, st.get(), 1, ticker);
 
         const int rc = sqlite3_step(st.get());
-        if (rc != SQLITE_DONE) {
-            db::detail::throw_sqlite(db_,
-                                     "toggle ticker portfolio step failed");
-        }
+        if (rc == SQLITE_ROW) return read_ticker_row(st.get());
+        if (rc == SQLITE_DONE) return std::nullopt;
+        db::detail::throw_sqlite(db_, "get ticker step failed");
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+    }
+    return std::nullopt;
+}
+
+std::optional<std::int64_t> Database::count_tickers(bool portfolio_only,
+                                                    std::string* err)
+{
+    try {
+        Stmt st{db_,
+                portfolio_only ? db::sql::kCountPortfolioTickers
+                               : db::sql::kCountTickers};
 
-        return sqlite3_changes(db_) > 0;
+        if (sqlite3_step(st.get()) != SQLITE_ROW)
+            db::detail::throw_sqlite(db_, "count tickers step failed");
+        return sqlite3_column_int64(st.get(), 0);
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+    }
+    return std::nullopt;
+}
+
+bool Database::toggle_ticker_portfolio(const std::string& ticker,
+                                       std::string* err)
+{
+    try {
+        bool changed = false;
+        const bool ok = in_transaction(
+            db_,
+            [&] {
+                const std::int64_t generation = next_ticker_generation_();
+                Stmt st{db_, db::sql::kToggleTickerPortfolio};
+                bind_text(db_, st.get(), 1, ticker);
+                if (sqlite3_bind_int64(st.get(), 2, generation) != SQLITE_OK)
+                    db::detail::throw_sqlite(db_, "bind generation failed");
+
+                const int rc = sqlite3_step(st.get());
+                if (rc != SQLITE_DONE) {
+                    db::detail::throw_sqlite(
+                        db_, "toggle ticker portfolio step failed");
+                }
+                changed = sqlite3_changes(db_) > 0;
+            },
+            err);
+
+        if (ok && changed) note_own_write_();
+        return ok && changed;
     }
     catch (const std::exception& e) {
         if (err) *err = e.what();
@@ -322,13 +359,7 @@ std::optional<int> Database::get_ticker_type(const std::string& ticker,
                                              std::string* err)
 {
     try {
-        const char* sql = R"SQL(
-            SELECT type
-            FROM tickers
-            WHERE ticker = ?;
-        )SQL";
-
-        Stmt st{db_, sql};
+        Stmt st{db_, db::sql::kSelectTickerType};
         bind_text(db_, st.get(), 1, ticker);
 
         const int rc = sqlite3_step(st.get());
@@ -348,6 +379,53 @@ std::optional<int> Database::get_ticker_type(const std::string& ticker,
     return std::nullopt;
 }
 
+std::optional<std::uint64_t>
+Database::get_ticker_generation(const std::string& ticker, std::string* err)
+{
+    try {
+        Stmt st{db_, db::sql::kSelectTickerGeneration};
+        bind_text(db_, st.get(), 1, ticker);
+
+        const int rc = sqlite3_step(st.get());
+        if (rc == SQLITE_ROW) {
+            return static_cast<std::uint64_t>(
+                sqlite3_column_int64(st.get(), 0));
+        }
+        if (rc != SQLITE_DONE) {
+            db::detail::throw_sqlite(db_, "ticker generation step failed");
+        }
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+    }
+    return std::nullopt;
+}
+
+std::int64_t Database::next_ticker_generation_()
+{
+    {
+        Stmt st{db_, db::sql::kNextTickerGeneration};
+        if (sqlite3_step(st.get()) != SQLITE_DONE)
+            db::detail::throw_sqlite(db_, "next generation step failed");
+    }
+
+    Stmt st{db_, db::sql::kSelectLastTickerGeneration};
+    if (sqlite3_step(st.get()) != SQLITE_ROW)
+        db::detail::throw_sqlite(db_, "select generation step failed");
+    return sqlite3_column_int64(st.get(), 0);
+}
+
+void Database::bump_ticker_generation_(const std::string& ticker)
+{
+    const std::int64_t generation = next_ticker_generation_();
+    Stmt st{db_, db::sql::kBumpTickerGeneration};
+    bind_text(db_, st.get(), 1, ticker);
+    if (sqlite3_bind_int64(st.get(), 2, generation) != SQLITE_OK)
+        db::detail::throw_sqlite(db_, "bind generation failed");
+    if (sqlite3_step(st.get()) != SQLITE_DONE)
+        db::detail::throw_sqlite(db_, "bump ticker generation step failed");
+}
+
 bool Database::delete_period(const std::string& ticker,
                              const std::string& period,
                              std::string* err)
@@ -355,18 +433,12 @@ bool Database::delete_period(const std::string& ticker,
     try {
         const auto [year, period_type] = parse_period(period);
 
-        return in_transaction(
+        const bool ok = in_transaction(
             db_,
             [&] {
                 int count = 0; // how many periods for this ticker?
                 {
-                    const char* sql = R"SQL(
-                        SELECT COUNT(*)
-                        FROM finances
-                        WHERE ticker = ?;
-                    )SQL";
-
-                    Stmt st{db_, sql};
+                    Stmt st{db_, db::sql::kCountFinancesForTicker};
                     bind_text(db_, st.get(), 1, ticker);
 
                     const int rc = sqlite3_step(st.get());
@@ -384,12 +456,7 @@ bool Database::delete_period(const std::string& ticker,
 
                 if (count == 1) {
                     // last period -> delete ticker -> cascade on finances
-                    const char* sql = R"SQL(
-                        DELETE FROM tickers
-                        WHERE ticker = ?;
-                    )SQL";
-
-                    Stmt st{db_, sql};
+                    Stmt st{db_, db::sql::kDeleteTicker};
                     bind_text(db_, st.get(), 1, ticker);
 
                     const int rc = sqlite3_step(st.get());
@@ -399,14 +466,7 @@ bool Database::delete_period(const std::string& ticker,
                 }
                 else {
                     // not last -> delete only on finances
-                    const char* sql = R"SQL(
-                        DELETE FROM finances
-                        WHERE ticker = ?
-                          AND year = ?
-                          AND period_type = ?;
-                    )SQL";
-
-                    Stmt st{db_, sql};
+                    Stmt st{db_, db::sql::kDeleteFinancePeriod};
                     bind_text(db_, st.get(), 1, ticker);
 
                     if (sqlite3_bind_int(st.get(), 2, year) != SQLITE_OK)
@@ -418,9 +478,17 @@ bool Database::delete_period(const std::string& ticker,
                     if (rc != SQLITE_DONE)
                         db::detail::throw_sqlite(db_,
                                                  "delete period step failed");
+
+                    refresh_derived_(ticker, year, period_type);
+                    bump_ticker_generation_(ticker);
                 }
             },
             err);
+        if (ok) {
+            ++write_generation_;
+            note_own_write_();
+        }
+        return ok;
     }
     catch (const std::exception& e) {
         if (err) *err = e.what();
@@ -445,19 +513,13 @@ bool Database::add_finances(const std::string& ticker,
         const std::int64_t now = static_cast<std::int64_t>(std::time(nullptr));
         ticker_type = normalize_ticker_type(ticker_type);
 
-        return in_transaction(
+        const bool ok = in_transaction(
             db_,
             [&] {
                 // Existing ticker type is immutable. New rows default to 1 and
                 // specialized models can set 2/3.
                 {
-                    const char* sql = R"SQL(
-                        SELECT type
-                        FROM tickers
-                        WHERE ticker = ?;
-                    )SQL";
-
-                    Stmt st{db_, sql};
+                    Stmt st{db_, db::sql::kSelectTickerType};
                     bind_text(db_, st.get(), 1, ticker);
 
                     const int rc = sqlite3_step(st.get());
@@ -477,20 +539,18 @@ bool Database::add_finances(const std::string& ticker,
 
                 // upsert ticker
                 {
-                    const char* sql = R"SQL(
-                INSERT INTO tickers (ticker, last_update, type)
-                VALUES (?, ?, ?)
-                ON CONFLICT(ticker) DO UPDATE SET
-                    last_update = excluded.last_update;
-            )SQL";
-
-                    Stmt st{db_, sql};
+                    const std::int64_t generation = next_ticker_generation_();
+                    Stmt st{db_, db::sql::kUpsertTicker};
                     bind_text(db_, st.get(), 1, ticker);
                     if (sqlite3_bind_int64(st.get(), 2, now) != SQLITE_OK)
                         db::detail::throw_sqlite(db_, "bind now failed");
                     if (sqlite3_bind_int(st.get(), 3, ticker_type) != SQLITE_OK)
                         db::detail::throw_sqlite(db_,
                                                  "bind ticker type failed");
+                    if (sqlite3_bind_int64(st.get(), 4, generation) !=
+                        SQLITE_OK)
+                        db::detail::throw_sqlite(db_,
+                                                 "bind generation failed");
 
                     const int rc = sqlite3_step(st.get());
                     if (rc != SQLITE_DONE)
@@ -500,87 +560,7 @@ bool Database::add_finances(const std::string& ticker,
 
                 // upsert finances
                 {
-                    const char* sql = R"SQL(
-                INSERT INTO finances (
-                    ticker, year, period_type,
-                    current_assets,
-                    non_current_assets,
-                    eps,
-                    cash_and_equivalents,
-                    cash_flow_from_financing,
-                    cash_flow_from_investing,
-                    cash_flow_from_operations,
-                    revenue,
-                    current_liabilities,
-                    non_current_liabilities,
-                    net_income,
-                    total_loans,
-                    goodwill,
-                    total_assets,
-                    total_deposits,
-                    total_liabilities,
-                    net_interest_income,
-                    non_interest_income,
-                    loan_loss_provisions,
-                    non_interest_expense,
-                    risk_weighted_assets,
-                    common_equity_tier1,
-                    net_charge_offs,
-                    non_performing_loans,
-                    insurance_reserves,
-                    earned_premiums,
-                    claims_incurred,
-                    interest_expenses,
-                    total_expenses,
-                    underwriting_expenses,
-                    total_debt
-                )
-                VALUES (
-                    ?, ?, ?,
-                    ?, ?, ?,
-                    ?, ?, ?, ?,
-                    ?, ?, ?, ?,
-                    ?, ?, ?, ?, ?,
-                    ?, ?, ?, ?,
-                    ?, ?, ?, ?,
-                    ?, ?, ?, ?, ?, ?, ?
-                )
-                ON CONFLICT(ticker, year, period_type)
-                DO UPDATE SET
-                    current_assets            = excluded.current_assets,
-                    non_current_assets        = excluded.non_current_assets,
-                    eps                       = excluded.eps,
-                    cash_and_equivalents      = excluded.cash_and_equivalents,
-                    cash_flow_from_financing  = excluded.cash_flow_from_financing,
-                    cash_flow_from_investing  = excluded.cash_flow_from_investing,
-                    cash_flow_from_operations = excluded.cash_flow_from_operations,
-                    revenue                   = excluded.revenue,
-                    current_liabilities       = excluded.current_liabilities,
-                    non_current_liabilities   = excluded.non_current_liabilities,
-                    net_income                = excluded.net_income,
-                    total_loans               = excluded.total_loans,
-                    goodwill                  = excluded.goodwill,
-                    total_assets              = excluded.total_assets,
-                    total_deposits            = excluded.total_deposits,
-                    total_liabilities         = excluded.total_liabilities,
-                    net_interest_income       = excluded.net_interest_income,
-                    non_interest_income       = excluded.non_interest_income,
-                    loan_loss_provisions      = excluded.loan_loss_provisions,
-                    non_interest_expense      = excluded.non_interest_expense,
-                    risk_weighted_assets      = excluded.risk_weighted_assets,
-                    common_equity_tier1       = excluded.common_equity_tier1,
-                    net_charge_offs           = excluded.net_charge_offs,
-                    non_performing_loans      = excluded.non_performing_loans,
-                    insurance_reserves        = excluded.insurance_reserves,
-                    earned_premiums           = excluded.earned_premiums,
-                    claims_incurred           = excluded.claims_incurred,
-                    interest_expenses         = excluded.interest_expenses,
-                    total_expenses            = excluded.total_expenses,
-                    underwriting_expenses     = excluded.underwriting_expenses,
-                    total_debt                = excluded.total_debt;
-            )SQL";
-
-                    Stmt st{db_, sql};
+                    Stmt st{db_, db::sql::kUpsertFinances};
 
                     bind_text(db_, st.get(), 1, ticker);
                     if (sqlite3_bind_int(st.get(), 2, year) != SQLITE_OK)
@@ -638,8 +618,15 @@ bool Database::add_finances(const std::string& ticker,
                         db::detail::throw_sqlite(db_,
                                                  "upsert finances step failed");
                 }
+
+                refresh_derived_(ticker, year, period_type);
             },
             err);
+        if (ok) {
+            ++write_generation_;
+            note_own_write_();
+        }
+        return ok;
     }
     catch (const std::exception& e) {
         if (err) *err = e.what();
@@ -647,103 +634,647 @@ bool Database::add_finances(const std::string& ticker,
     }
 }
 
+Database::FinanceRow detail::read_finance_row(sqlite3_stmt* st)
+{
+    Database::FinanceRow r;
+    r.ticker = col_text(st, 0);
+    r.year = sqlite3_column_int(st, 1);
+    r.period_type = col_text(st, 2);
+
+    r.current_assets = col_i64_opt(st, 3);
+    r.non_current_assets = col_i64_opt(st, 4);
+    r.eps = col_f64_opt(st, 5);
+    r.cash_and_equivalents = col_i64_opt(st, 6);
+    r.cash_flow_from_financing = col_i64_opt(st, 7);
+    r.cash_flow_from_investing = col_i64_opt(st, 8);
+    r.cash_flow_from_operations = col_i64_opt(st, 9);
+    r.revenue = col_i64_opt(st, 10);
+    r.current_liabilities = col_i64_opt(st, 11);
+    r.non_current_liabilities = col_i64_opt(st, 12);
+    r.net_income = col_i64_opt(st, 13);
+    r.total_loans = col_i64_opt(st, 14);
+    r.goodwill = col_i64_opt(st, 15);
+    r.total_assets = col_i64_opt(st, 16);
+    r.total_deposits = col_i64_opt(st, 17);
+    r.total_liabilities = col_i64_opt(st, 18);
+    r.net_interest_income = col_i64_opt(st, 19);
+    r.non_interest_income = col_i64_opt(st, 20);
+    r.loan_loss_provisions = col_i64_opt(st, 21);
+    r.non_interest_expense = col_i64_opt(st, 22);
+    r.risk_weighted_assets = col_i64_opt(st, 23);
+    r.common_equity_tier1 = col_i64_opt(st, 24);
+    r.net_charge_offs = col_i64_opt(st, 25);
+    r.non_performing_loans = col_i64_opt(st, 26);
+    r.insurance_reserves = col_i64_opt(st, 27);
+    r.earned_premiums = col_i64_opt(st, 28);
+    r.claims_incurred = col_i64_opt(st, 29);
+    r.interest_expenses = col_i64_opt(st, 30);
+    r.total_expenses = col_i64_opt(st, 31);
+    r.underwriting_expenses = col_i64_opt(st, 32);
+    r.total_debt = col_i64_opt(st, 33);
+    return r;
+}
+
 std::vector<Database::FinanceRow>
 Database::get_finances(const std::string& ticker, std::string* err)
 {
     try {
-        const char* sql = R"SQL(
-            SELECT
-                ticker, year, period_type,
-                current_assets,
-                non_current_assets,
-                eps,
-                cash_and_equivalents,
-                cash_flow_from_financing,
-                cash_flow_from_investing,
-                cash_flow_from_operations,
-                revenue,
-                current_liabilities,
-                non_current_liabilities,
-                net_income,
-                total_loans,
-                goodwill,
-                total_assets,
-                total_deposits,
-                total_liabilities,
-                net_interest_income,
-                non_interest_income,
-                loan_loss_provisions,
-                non_interest_expense,
-                risk_weighted_assets,
-                common_equity_tier1,
-                net_charge_offs,
-                non_performing_loans,
-                insurance_reserves,
-                earned_premiums,
-                claims_incurred,
-                interest_expenses,
-                total_expenses,
-                underwriting_expenses,
-                total_debt
-            FROM finances
-            WHERE ticker = ?
-            ORDER BY year ASC, period_type ASC;
-        )SQL";
-
-        Stmt st{db_, sql};
+        Stmt st{db_, db::sql::kSelectFinances};
         bind_text(db_, st.get(), 1, ticker);
 
         std::vector<FinanceRow> out;
         while (true) {
             const int rc = sqlite3_step(st.get());
             if (rc == SQLITE_ROW) {
-                FinanceRow r;
+                out.push_back(db::detail::read_finance_row(st.get()));
+            }
+            else if (rc == SQLITE_DONE) {
+                break;
+            }
+            else {
+                db::detail::throw_sqlite(db_, "step failed");
+            }
+        }
+
+        return out;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return {};
+    }
+}
+
+// *
+// **
+// ***
+// ****
+// ***** PRICES
+
+bool Database::add_prices(const std::string& ticker,
+                          const std::vector<PricePoint>& points,
+                          std::string* err)
+{
+    try {
+        const bool ok = in_transaction(
+            db_,
+            [&] {
+                // one statement, rebound per point
+                Stmt st{db_, db::sql::kUpsertPrice};
+                bind_text(db_, st.get(), 1, ticker);
+                for (const auto& p : points) {
+                    if (sqlite3_bind_int(st.get(), 2, p.day) != SQLITE_OK)
+                        db::detail::throw_sqlite(db_, "bind day failed");
+                    bind_f64_opt(db_, st.get(), 3, p.close);
+
+                    if (sqlite3_step(st.get()) != SQLITE_DONE)
+                        db::detail::throw_sqlite(db_,
+                                                 "upsert prices step failed");
+                    sqlite3_reset(st.get());
+                }
+
+                // one change_log row for the batch
+                Stmt log{db_, db::sql::kLogPrices};
+                bind_text(db_, log.get(), 1, ticker);
+                if (sqlite3_step(log.get()) != SQLITE_DONE)
+                    db::detail::throw_sqlite(db_, "log prices step failed");
+            },
+            err);
+        if (ok) {
+            ++price_generation_;
+            note_own_write_();
+        }
+        return ok;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return false;
+    }
+}
+
+std::vector<Database::PricePoint>
+Database::get_prices(const std::string& ticker, std::string* err)
+{
+    try {
+        Stmt st{db_, db::sql::kSelectPrices};
+        bind_text(db_, st.get(), 1, ticker);
+
+        std::vector<PricePoint> out;
+        while (true) {
+            const int rc = sqlite3_step(st.get());
+            if (rc == SQLITE_ROW) {
+                out.push_back({sqlite3_column_int(st.get(), 0),
+                               sqlite3_column_double(st.get(), 1)});
+            }
+            else if (rc == SQLITE_DONE) {
+                break;
+            }
+            else {
+                db::detail::throw_sqlite(db_, "step failed");
+            }
+        }
+
+        return out;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return {};
+    }
+}
+
+std::optional<Database::PricePoint>
+Database::get_latest_price(const std::string& ticker, std::string* err)
+{
+    try {
+        Stmt st{db_, db::sql::kSelectLatestPrice};
+        bind_text(db_, st.get(), 1, ticker);
+
+        const int rc = sqlite3_step(st.get());
+        if (rc == SQLITE_DONE) return std::nullopt;
+        if (rc != SQLITE_ROW) db::detail::throw_sqlite(db_, "step failed");
+        return PricePoint{sqlite3_column_int(st.get(), 0),
+                          sqlite3_column_double(st.get(), 1)};
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return std::nullopt;
+    }
+}
+
+// *
+// **
+// ***
+// ****
+// ***** HOLDINGS
+
+bool Database::set_holding(const std::string& ticker,
+                           double shares,
+                           double cost_basis,
+                           std::string* err)
+{
+    try {
+        if (shares <= 0.0) {
+            Stmt st{db_, db::sql::kDeleteHolding};
+            bind_text(db_, st.get(), 1, ticker);
+            if (sqlite3_step(st.get()) != SQLITE_DONE)
+                db::detail::throw_sqlite(db_, "delete holding step failed");
+            note_own_write_();
+            return true;
+        }
+
+        Stmt st{db_, db::sql::kUpsertHolding};
+        bind_text(db_, st.get(), 1, ticker);
+        bind_f64_opt(db_, st.get(), 2, shares);
+        bind_f64_opt(db_, st.get(), 3, cost_basis);
+        if (sqlite3_step(st.get()) != SQLITE_DONE)
+            db::detail::throw_sqlite(db_, "upsert holding step failed");
+        note_own_write_();
+        return true;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return false;
+    }
+}
+
+static std::vector<Database::PortfolioRow>
+select_portfolio_rows(sqlite3* db, const std::string& ticker)
+{
+    Stmt st{db, db::sql::kSelectPortfolioRows};
+    bind_text(db, st.get(), 1, ticker);
+
+    std::vector<Database::PortfolioRow> out;
+    while (true) {
+        const int rc = sqlite3_step(st.get());
+        if (rc == SQLITE_DONE) break;
+        if (rc != SQLITE_ROW) db::detail::throw_sqlite(db, "step failed");
+
+        Database::PortfolioRow r;
+        r.ticker = col_text(st.get(), 0);
+        r.type = sqlite3_column_int(st.get(), 1);
+        if (r.type <= 0) r.type = 1;
+        r.shares = col_f64_opt(st.get(), 2).value_or(0.0);
+        r.cost_basis = col_f64_opt(st.get(), 3).value_or(0.0);
+        r.eps = col_f64_opt(st.get(), 6);
+        if (!r.eps.has_value() && col_text(st.get(), 4) == "Y") {
+            r.eps = col_f64_opt(st.get(), 5);
+        }
+        r.tbv_per_share = col_f64_opt(st.get(), 7);
+        r.combined_ratio = col_f64_opt(st.get(), 8);
+        out.push_back(std::move(r));
+    }
+    return out;
+}
+
+std::vector<Database::PortfolioRow>
+Database::get_portfolio_rows(std::string* err)
+{
+    try {
+        return select_portfolio_rows(db_, "");
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return {};
+    }
+}
+
+std::optional<Database::PortfolioRow>
+Database::get_portfolio_row(const std::string& ticker, std::string* err)
+{
+    try {
+        if (ticker.empty()) return std::nullopt;
+        auto rows = select_portfolio_rows(db_, ticker);
+        if (rows.empty()) return std::nullopt;
+        return std::move(rows.front());
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return std::nullopt;
+    }
+}
+
+// *
+// **
+// ***
+// ****
+// ***** SUMMARY
+
+static Database::TickerSummary read_ticker_summary(sqlite3_stmt* st)
+{
+    Database::TickerSummary s;
+    s.ticker = col_text(st, 0);
+    s.latest_year = sqlite3_column_int(st, 1);
+    s.latest_period_type = col_text(st, 2);
+    s.period_count = sqlite3_column_int(st, 3);
+    s.yearly_count = sqlite3_column_int(st, 4);
+    s.latest_revenue = col_i64_opt(st, 5);
+    s.latest_eps = col_f64_opt(st, 6);
+    if (const auto y = col_i64_opt(st, 7)) s.ttm_year = static_cast<int>(*y);
+    s.ttm_period_type = col_text(st, 8);
+    s.ttm_eps = col_f64_opt(st, 9);
+    s.ttm_net_income = col_f64_opt(st, 10);
+    s.ttm_cash_flow_ops = col_f64_opt(st, 11);
+    return s;
+}
+
+void Database::refresh_derived_(const std::string& ticker,
+                                int year,
+                                const std::string& period_type)
+{
+    std::string err;
+    const auto rows = get_finances(ticker, &err);
+    if (!err.empty()) throw std::runtime_error(err);
+
+    if (rows.empty()) {
+        Stmt st{db_, db::sql::kDeleteTickerSummary};
+        bind_text(db_, st.get(), 1, ticker);
+        if (sqlite3_step(st.get()) != SQLITE_DONE)
+            db::detail::throw_sqlite(db_, "delete summary step failed");
+        return;
+    }
+
+    int ticker_type = 1;
+    {
+        Stmt st{db_, db::sql::kSelectTickerType};
+        bind_text(db_, st.get(), 1, ticker);
+        const int rc = sqlite3_step(st.get());
+        if (rc == SQLITE_ROW) {
+            ticker_type = sqlite3_column_int(st.get(), 0);
+        }
+        else if (rc != SQLITE_DONE) {
+            db::detail::throw_sqlite(db_, "select ticker type step failed");
+        }
+    }
+
+    // rows come in year/period_type order, so the newest is last
+    const auto& latest = rows.back();
+
+    int yearly = 0;
+    int ttm_index = -1;
+    for (int i = 0; i < static_cast<int>(rows.size()); ++i) {
+        if (metrics::is_yearly_period(rows[i])) yearly += 1;
+        if (metrics::ttm_window_for_family(metrics::period_family(rows[i])) >
+            0) {
+            ttm_index = i;
+        }
+    }
+
+    {
+        Stmt st{db_, db::sql::kUpsertTickerSummary};
+        bind_text(db_, st.get(), 1, ticker);
+        bind_i64_opt(db_, st.get(), 2, latest.year);
+        bind_text(db_, st.get(), 3, latest.period_type);
+        bind_i64_opt(
+            db_, st.get(), 4, static_cast<std::int64_t>(rows.size()));
+        bind_i64_opt(db_, st.get(), 5, yearly);
+        bind_i64_opt(db_, st.get(), 6, latest.revenue);
+        bind_f64_opt(db_, st.get(), 7, latest.eps);
+
+        if (ttm_index >= 0) {
+            const auto& row = rows[ttm_index];
+            const auto ttm = metrics::ttm_at(rows, ttm_index);
+            bind_i64_opt(db_, st.get(), 8, row.year);
+            bind_text(db_, st.get(), 9, row.period_type);
+            bind_f64_opt(db_, st.get(), 10, ttm.eps);
+            bind_f64_opt(db_, st.get(), 11, ttm.net_income);
+            bind_f64_opt(db_, st.get(), 12, ttm.cash_flow_ops);
+        }
+        else {
+            for (int idx = 8; idx <= 12; ++idx) {
+                if (sqlite3_bind_null(st.get(), idx) != SQLITE_OK)
+                    db::detail::throw_sqlite(db_, "bind summary null failed");
+            }
+        }
+
+        if (sqlite3_step(st.get()) != SQLITE_DONE)
+            db::detail::throw_sqlite(db_, "upsert summary step failed");
+    }
+
+    // TTM windows only look backwards, so rows before the changed period
+    // keep their metrics
+    Stmt st{db_, db::sql::finance_metrics_upsert().c_str()};
+    for (int i = 0; i < static_cast<int>(rows.size()); ++i) {
+        const auto& row = rows[i];
+        if (row.year < year ||
+            (row.year == year && row.period_type < period_type)) {
+            continue;
+        }
+
+        const auto values =
+            metrics::derive_finance_metrics(rows, i, ticker_type);
+
+        sqlite3_reset(st.get());
+        bind_text(db_, st.get(), 1, ticker);
+        if (sqlite3_bind_int(st.get(), 2, row.year) != SQLITE_OK)
+            db::detail::throw_sqlite(db_, "bind year failed");
+        bind_text(db_, st.get(), 3, row.period_type);
+
+        int idx = 4;
+        for (const auto& column : metrics::kFinanceMetricColumns) {
+            bind_f64_opt(db_, st.get(), idx++, values.*column.field);
+        }
+
+        if (sqlite3_step(st.get()) != SQLITE_DONE)
+            db::detail::throw_sqlite(db_, "upsert metrics step failed");
+    }
+}
+
+void Database::backfill_derived_(bool all)
+{
+    std::vector<std::string> tickers;
+    {
+        Stmt st{db_,
+                all ? db::sql::kSelectAllTickerNames
+                    : db::sql::kSelectTickersWithoutSummary};
+        while (true) {
+            const int rc = sqlite3_step(st.get());
+            if (rc == SQLITE_ROW) {
+                tickers.push_back(col_text(st.get(), 0));
+            }
+            else if (rc == SQLITE_DONE) {
+                break;
+            }
+            else {
+                db::detail::throw_sqlite(db_, "select backfill failed");
+            }
+        }
+    }
+
+    for (const auto& ticker : tickers) {
+        refresh_derived_(ticker, std::numeric_limits<int>::min(), "");
+    }
+}
+
+std::optional<Database::TickerSummary>
+Database::get_ticker_summary(const std::string& ticker, std::string* err)
+{
+    try {
+        Stmt st{db_, db::sql::kSelectTickerSummary};
+        bind_text(db_, st.get(), 1, ticker);
+
+        const int rc = sqlite3_step(st.get());
+        if (rc == SQLITE_ROW) return read_ticker_summary(st.get());
+        if (rc == SQLITE_DONE) return std::nullopt;
+        db::detail::throw_sqlite(db_, "get ticker summary step failed");
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+    }
+    return std::nullopt;
+}
+
+std::vector<Database::TickerSummary>
+Database::get_ticker_summaries(const std::vector<std::string>& tickers,
+                               std::string* err)
+{
+    try {
+        Stmt st{db_, db::sql::kSelectTickerSummary};
+
+        std::vector<TickerSummary> out;
+        out.reserve(tickers.size());
+        for (const auto& ticker : tickers) {
+            sqlite3_reset(st.get());
+            bind_text(db_, st.get(), 1, ticker);
+
+            const int rc = sqlite3_step(st.get());
+            if (rc == SQLITE_ROW) {
+                out.push_back(read_ticker_summary(st.get()));
+            }
+            else if (rc != SQLITE_DONE) {
+                db::detail::throw_sqlite(db_,
+                                         "get ticker summaries step failed");
+            }
+        }
+        return out;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return {};
+    }
+}
+
+std::vector<Database::MetricScreenRow>
+Database::screen_finance_metric(const std::string& metric,
+                                std::optional<double> min,
+                                std::optional<double> max,
+                                SortDir dir,
+                                int limit,
+                                bool latest_only,
+                                std::string* err)
+{
+    try {
+        const auto* column = metrics::find_finance_metric(metric);
+        if (!column) throw std::runtime_error("unknown metric: " + metric);
+
+        const auto sql =
+            db::sql::screen_finance_metric(column->name, dir, latest_only);
+        Stmt st{db_, sql.c_str()};
+
+        constexpr double kInf = std::numeric_limits<double>::infinity();
+        bind_f64_opt(db_, st.get(), 1, min.value_or(-kInf));
+        bind_f64_opt(db_, st.get(), 2, max.value_or(kInf));
+        if (sqlite3_bind_int(st.get(), 3, std::max(0, limit)) != SQLITE_OK)
+            db::detail::throw_sqlite(db_, "bind limit failed");
+
+        std::vector<MetricScreenRow> out;
+        while (true) {
+            const int rc = sqlite3_step(st.get());
+            if (rc == SQLITE_ROW) {
+                MetricScreenRow r;
                 r.ticker = col_text(st.get(), 0);
                 r.year = sqlite3_column_int(st.get(), 1);
                 r.period_type = col_text(st.get(), 2);
-
-                r.current_assets = col_i64_opt(st.get(), 3);
-                r.non_current_assets = col_i64_opt(st.get(), 4);
-                r.eps = col_f64_opt(st.get(), 5);
-                r.cash_and_equivalents = col_i64_opt(st.get(), 6);
-                r.cash_flow_from_financing = col_i64_opt(st.get(), 7);
-                r.cash_flow_from_investing = col_i64_opt(st.get(), 8);
-                r.cash_flow_from_operations = col_i64_opt(st.get(), 9);
-                r.revenue = col_i64_opt(st.get(), 10);
-                r.current_liabilities = col_i64_opt(st.get(), 11);
-                r.non_current_liabilities = col_i64_opt(st.get(), 12);
-                r.net_income = col_i64_opt(st.get(), 13);
-                r.total_loans = col_i64_opt(st.get(), 14);
-                r.goodwill = col_i64_opt(st.get(), 15);
-                r.total_assets = col_i64_opt(st.get(), 16);
-                r.total_deposits = col_i64_opt(st.get(), 17);
-                r.total_liabilities = col_i64_opt(st.get(), 18);
-                r.net_interest_income = col_i64_opt(st.get(), 19);
-                r.non_interest_income = col_i64_opt(st.get(), 20);
-                r.loan_loss_provisions = col_i64_opt(st.get(), 21);
-                r.non_interest_expense = col_i64_opt(st.get(), 22);
-                r.risk_weighted_assets = col_i64_opt(st.get(), 23);
-                r.common_equity_tier1 = col_i64_opt(st.get(), 24);
-                r.net_charge_offs = col_i64_opt(st.get(), 25);
-                r.non_performing_loans = col_i64_opt(st.get(), 26);
-                r.insurance_reserves = col_i64_opt(st.get(), 27);
-                r.earned_premiums = col_i64_opt(st.get(), 28);
-                r.claims_incurred = col_i64_opt(st.get(), 29);
-                r.interest_expenses = col_i64_opt(st.get(), 30);
-                r.total_expenses = col_i64_opt(st.get(), 31);
-                r.underwriting_expenses = col_i64_opt(st.get(), 32);
-                r.total_debt = col_i64_opt(st.get(), 33);
-
+                r.value = sqlite3_column_double(st.get(), 3);
                 out.push_back(std::move(r));
             }
             else if (rc == SQLITE_DONE) {
                 break;
             }
             else {
-                db::detail::throw_sqlite(db_, "step failed");
+                db::detail::throw_sqlite(db_, "screen metric step failed");
             }
         }
+        return out;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return {};
+    }
+}
+
+// *
+// **
+// ***
+// ****
+// ***** CHANGES
+
+static std::int64_t select_int64(sqlite3* db, const char* sql)
+{
+    Stmt st{db, sql};
+    if (sqlite3_step(st.get()) != SQLITE_ROW)
+        db::detail::throw_sqlite(db, "select value step failed");
+    return sqlite3_column_int64(st.get(), 0);
+}
+
+static std::vector<Database::Change>
+select_changes(sqlite3* db, std::int64_t after, int limit)
+{
+    Stmt st{db, db::sql::kSelectChangesAfter};
+    if (sqlite3_bind_int64(st.get(), 1, after) != SQLITE_OK)
+        db::detail::throw_sqlite(db, "bind seq failed");
+    if (sqlite3_bind_int(st.get(), 2, limit) != SQLITE_OK)
+        db::detail::throw_sqlite(db, "bind limit failed");
+
+    std::vector<Database::Change> out;
+    while (true) {
+        const int rc = sqlite3_step(st.get());
+        if (rc == SQLITE_DONE) break;
+        if (rc != SQLITE_ROW)
+            db::detail::throw_sqlite(db, "select changes step failed");
+
+        Database::Change c;
+        c.seq = sqlite3_column_int64(st.get(), 0);
+        c.op = col_text(st.get(), 1);
+        c.source = col_text(st.get(), 2);
+        c.ticker = col_text(st.get(), 3);
+        if (sqlite3_column_type(st.get(), 4) != SQLITE_NULL)
+            c.year = sqlite3_column_int(st.get(), 4);
+        c.period_type = col_text(st.get(), 5);
+        out.push_back(std::move(c));
+    }
+    return out;
+}
+
+static void insert_sorted_unique(std::vector<std::string>& out,
+                                 std::string ticker)
+{
+    const auto at = std::lower_bound(out.begin(), out.end(), ticker);
+    if (at == out.end() || *at != ticker) out.insert(at, std::move(ticker));
+}
+
+void Database::watch_changes_()
+{
+    data_version_ = select_int64(db_, db::sql::kSelectDataVersion);
+    change_seq_ = select_int64(db_, db::sql::kSelectChangeSeq);
+}
+
+void Database::note_own_write_()
+{
+    try {
+        // seq first: a foreign commit after it moves data_version
+        const std::int64_t seq = select_int64(db_, db::sql::kSelectChangeSeq);
+        if (select_int64(db_, db::sql::kSelectDataVersion) == data_version_)
+            change_seq_ = seq;
+    }
+    catch (const std::exception&) {
+        // the next poll reports them instead
+    }
+
+    if (++writes_since_compaction_ < kChangeLogCompactEvery) return;
+    writes_since_compaction_ = 0;
+    in_transaction(db_, [&] { compact_change_log_(); }); // retried later
+}
+
+void Database::compact_change_log_()
+{
+    const std::int64_t newest = select_int64(db_, db::sql::kSelectChangeSeq);
+    const std::int64_t compacted =
+        select_int64(db_, db::sql::kSelectCompactedSeq);
+
+    std::int64_t through = newest - change_log_keep_rows_;
+    {
+        Stmt st{db_, db::sql::kSelectConsumedSeq};
+        if (sqlite3_step(st.get()) != SQLITE_ROW)
+            db::detail::throw_sqlite(db_, "select consumed step failed");
+        if (sqlite3_column_type(st.get(), 0) != SQLITE_NULL) {
+            through = std::min<std::int64_t>(
+                through, sqlite3_column_int64(st.get(), 0));
+        }
+    }
+    through = std::max(through, newest - change_log_max_rows_);
+    if (through <= compacted) return;
+
+    Stmt del{db_, db::sql::kDeleteChangesThrough};
+    if (sqlite3_bind_int64(del.get(), 1, through) != SQLITE_OK)
+        db::detail::throw_sqlite(db_, "bind seq failed");
+    if (sqlite3_step(del.get()) != SQLITE_DONE)
+        db::detail::throw_sqlite(db_, "delete changes step failed");
+
+    Stmt st{db_, db::sql::kUpdateCompactedSeq};
+    if (sqlite3_bind_int64(st.get(), 1, through) != SQLITE_OK)
+        db::detail::throw_sqlite(db_, "bind seq failed");
+    if (sqlite3_step(st.get()) != SQLITE_DONE)
+        db::detail::throw_sqlite(db_, "update compacted seq step failed");
+}
 
+void Database::set_change_log_retention(std::int64_t keep_rows,
+                                        std::int64_t max_rows)
+{
+    change_log_keep_rows_ = std::max<std::int64_t>(1, keep_rows);
+    change_log_max_rows_ = std::max(change_log_keep_rows_, max_rows);
+}
+
+Database::ExternalChanges Database::poll_external_changes(std::string* err)
+{
+    ExternalChanges out;
+    try {
+        const std::int64_t version =
+            select_int64(db_, db::sql::kSelectDataVersion);
+        if (version == data_version_) return out;
+
+        const auto changes = select_changes(db_, change_seq_, -1);
+        // read after the rows: a compaction racing them only errs towards
+        // truncated
+        out.truncated =
+            select_int64(db_, db::sql::kSelectCompactedSeq) > change_seq_;
+        for (const auto& c : changes) {
+            auto& into = c.source == "prices" ? out.prices : out.tickers;
+            insert_sorted_unique(into, c.ticker);
+        }
+
+        data_version_ = version;
+        if (!changes.empty()) change_seq_ = changes.back().seq;
+        if (out.truncated || !out.tickers.empty()) ++write_generation_;
+        if (out.truncated || !out.prices.empty()) ++price_generation_;
         return out;
     }
     catch (const std::exception& e) {
@@ -752,6 +1283,82 @@ Database::get_finances(const std::string& ticker, std::string* err)
     }
 }
 
-} // namespace db
+Database::ChangeSet
+Database::changes_since(std::int64_t seq, int limit, std::string* err)
+{
+    try {
+        ChangeSet out;
+        out.latest_seq = select_int64(db_, db::sql::kSelectChangeSeq);
+        out.changes = select_changes(db_, seq, std::max(0, limit));
+        out.truncated = select_int64(db_, db::sql::kSelectCompactedSeq) > seq;
+        return out;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return {};
+    }
+}
+
+bool Database::ack_changes(const std::string& consumer,
+                           std::int64_t seq,
+                           std::string* err)
+{
+    try {
+        const bool ok = in_transaction(
+            db_,
+            [&] {
+                Stmt st{db_, db::sql::kUpsertChangeConsumer};
+                bind_text(db_, st.get(), 1, consumer);
+                if (sqlite3_bind_int64(st.get(), 2, seq) != SQLITE_OK)
+                    db::detail::throw_sqlite(db_, "bind seq failed");
+                if (sqlite3_step(st.get()) != SQLITE_DONE)
+                    db::detail::throw_sqlite(db_,
+                                             "upsert consumer step failed");
+
+                compact_change_log_();
+            },
+            err);
+        return ok;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return false;
+    }
+}
+
+std::optional<std::int64_t>
+Database::get_change_watermark(const std::string& consumer, std::string* err)
+{
+    try {
+        Stmt st{db_, db::sql::kSelectChangeConsumer};
+        bind_text(db_, st.get(), 1, consumer);
+
+        const int rc = sqlite3_step(st.get());
+        if (rc == SQLITE_DONE) return std::nullopt;
+        if (rc != SQLITE_ROW)
+            db::detail::throw_sqlite(db_, "select consumer step failed");
+        return sqlite3_column_int64(st.get(), 0);
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return std::nullopt;
+    }
+}
 
+bool Database::drop_change_consumer(const std::string& consumer,
+                                    std::string* err)
+{
+    try {
+        Stmt st{db_, db::sql::kDeleteChangeConsumer};
+        bind_text(db_, st.get(), 1, consumer);
+        if (sqlite3_step(st.get()) != SQLITE_DONE)
+            db::detail::throw_sqlite(db_, "delete consumer step failed");
+        return true;
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return false;
+    }
+}
 
+} // namespace db
@@ -1,4 +1,5 @@
 #include "db/database.hpp"
+#include "db/database_sql.hpp"
 #include "db/sql_helpers.hpp"
 
 #include <string>
@@ -11,7 +12,8 @@ CREATE TABLE IF NOT EXISTS tickers (
     ticker      TEXT    PRIMARY KEY,
     last_update INTEGER NOT NULL,
     portfolio   INTEGER NOT NULL DEFAULT 0,
-    type        INTEGER NOT NULL DEFAULT 1
+    type        INTEGER NOT NULL DEFAULT 1,
+    generation  INTEGER NOT NULL DEFAULT 0
 ) WITHOUT ROWID;
 
 CREATE INDEX IF NOT EXISTS idx_tickers_order ON tickers(last_update DESC, ticker ASC);
@@ -54,6 +56,67 @@ CREATE TABLE IF NOT EXISTS finances (
     PRIMARY KEY (ticker, year, period_type),
     FOREIGN KEY (ticker) REFERENCES tickers(ticker) ON DELETE CASCADE
 ) WITHOUT ROWID;
+
+CREATE TABLE IF NOT EXISTS ticker_summary (
+    ticker              TEXT    PRIMARY KEY,
+    latest_year         INTEGER NOT NULL,
+    latest_period_type  TEXT    NOT NULL,
+    period_count        INTEGER NOT NULL,
+    yearly_count        INTEGER NOT NULL,
+    latest_revenue      INTEGER,
+    latest_eps          REAL,
+    ttm_year            INTEGER,
+    ttm_period_type     TEXT,
+    ttm_eps             REAL,
+    ttm_net_income      REAL,
+    ttm_cash_flow_ops   REAL,
+    FOREIGN KEY (ticker) REFERENCES tickers(ticker) ON DELETE CASCADE
+) WITHOUT ROWID;
+
+CREATE TABLE IF NOT EXISTS prices (
+    ticker  TEXT    NOT NULL,
+    day     INTEGER NOT NULL,
+    close   REAL    NOT NULL,
+    PRIMARY KEY (ticker, day)
+) WITHOUT ROWID;
+
+CREATE TABLE IF NOT EXISTS holdings (
+    ticker      TEXT    PRIMARY KEY,
+    shares      REAL    NOT NULL,
+    cost_basis  REAL    NOT NULL,
+    FOREIGN KEY (ticker) REFERENCES tickers(ticker) ON DELETE CASCADE
+) WITHOUT ROWID;
+
+-- last generation handed to a tickers row; see ensure_ticker_generation_state
+CREATE TABLE IF NOT EXISTS ticker_generation_state (
+    id          INTEGER PRIMARY KEY CHECK (id = 1),
+    generation  INTEGER NOT NULL
+);
+
+-- every write to tickers, finances and holdings (by triggers, see
+-- ensure_change_log_triggers) and every add_prices() batch, in commit order;
+-- readers keep a seq watermark and read what came after it
+CREATE TABLE IF NOT EXISTS change_log (
+    seq         INTEGER PRIMARY KEY AUTOINCREMENT,
+    ticker      TEXT    NOT NULL,
+    source      TEXT    NOT NULL,
+    op          TEXT    NOT NULL DEFAULT '',
+    year        INTEGER,
+    period_type TEXT
+);
+
+-- change_log rows up to compacted_seq are gone
+CREATE TABLE IF NOT EXISTS change_log_state (
+    id              INTEGER PRIMARY KEY CHECK (id = 1),
+    compacted_seq   INTEGER NOT NULL
+);
+INSERT OR IGNORE INTO change_log_state (id, compacted_seq) VALUES (1, 0);
+
+-- durable readers of change_log and the seq each has processed
+CREATE TABLE IF NOT EXISTS change_consumers (
+    name    TEXT    PRIMARY KEY,
+    seq     INTEGER NOT NULL
+) WITHOUT ROWID;
 )SQL";
 
 static bool table_has_column(sqlite3* db,
@@ -116,6 +179,28 @@ static void ensure_tickers_type_column(sqlite3* db)
         db, "tickers", "type", "type INTEGER NOT NULL DEFAULT 1");
 }
 
+// Rows from before per-ticker generations start from their last update.
+static void ensure_tickers_generation_column(sqlite3* db)
+{
+    if (table_has_column(db, "tickers", "generation")) return;
+    ensure_column_exists(
+        db, "tickers", "generation", "generation INTEGER NOT NULL DEFAULT 0");
+    db::detail::exec_sql(db,
+                         "UPDATE tickers SET generation = last_update * 1000;");
+}
+
+// Starts the counter past every stored generation, and for a new file past
+// the clock in milliseconds, so generations of a deleted and re-created
+// database do not repeat those clients may still hold.
+static void ensure_ticker_generation_state(sqlite3* db)
+{
+    db::detail::exec_sql(
+        db,
+        "INSERT OR IGNORE INTO ticker_generation_state (id, generation) "
+        "SELECT 1, MAX(COALESCE(MAX(generation), 0), "
+        "CAST(strftime('%s', 'now') AS INTEGER) * 1000) FROM tickers;");
+}
+
 static void ensure_finances_bank_columns(sqlite3* db)
 {
     ensure_column_exists(db, "finances", "total_loans", "total_loans INTEGER");
@@ -166,6 +251,163 @@ static void ensure_finances_insurance_columns(sqlite3* db)
     ensure_column_exists(db, "finances", "total_debt", "total_debt INTEGER");
 }
 
+// change_log as first created had no operation or period key.
+static void ensure_change_log_columns(sqlite3* db)
+{
+    ensure_column_exists(
+        db, "change_log", "op", "op TEXT NOT NULL DEFAULT ''");
+    ensure_column_exists(db, "change_log", "year", "year INTEGER");
+    ensure_column_exists(db, "change_log", "period_type", "period_type TEXT");
+}
+
+// Stored trigger text, or empty when there is no such trigger.
+static std::string trigger_sql(sqlite3* db, const std::string& name)
+{
+    sqlite3_stmt* st = nullptr;
+    if (sqlite3_prepare_v2(
+            db,
+            "SELECT sql FROM sqlite_master WHERE type = 'trigger' AND "
+            "name = ?;",
+            -1,
+            &st,
+            nullptr) != SQLITE_OK) {
+        db::detail::throw_sqlite(db, "prepare sqlite_master failed");
+    }
+    sqlite3_bind_text(st, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+
+    std::string sql;
+    const int rc = sqlite3_step(st);
+    if (rc == SQLITE_ROW) {
+        const unsigned char* text = sqlite3_column_text(st, 0);
+        if (text) sql = reinterpret_cast<const char*>(text);
+    }
+    sqlite3_finalize(st);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        db::detail::throw_sqlite(db, "sqlite_master step failed");
+    }
+    return sql;
+}
+
+// One AFTER INSERT/UPDATE/DELETE trigger per logged table, appending the
+// operation, the ticker and, for finances, the period to change_log.
+// Triggers whose stored text differs from the current one are replaced,
+// so changing what is logged needs no migration of its own.
+static void ensure_change_log_triggers(sqlite3* db)
+{
+    struct Logged {
+        const char* table;
+        bool has_period;
+    };
+    struct Op {
+        const char* name;
+        const char* event;
+        const char* row; // NEW or OLD
+    };
+    static constexpr Logged kTables[] = {
+        {"tickers", false},
+        {"finances", true},
+        {"holdings", false},
+    };
+    static constexpr Op kOps[] = {
+        {"insert", "INSERT", "NEW"},
+        {"update", "UPDATE", "NEW"},
+        {"delete", "DELETE", "OLD"},
+    };
+
+    for (const auto& table : kTables) {
+        for (const auto& op : kOps) {
+            const std::string name =
+                std::string("change_log_") + table.table + "_" + op.name;
+            const std::string row = op.row;
+            const std::string period =
+                table.has_period ? row + ".year, " + row + ".period_type"
+                                 : std::string("NULL, NULL");
+            const std::string sql =
+                "CREATE TRIGGER " + name + " AFTER " + op.event + " ON " +
+                table.table +
+                " BEGIN INSERT INTO change_log "
+                "(ticker, source, op, year, period_type) VALUES (" +
+                row + ".ticker, '" + table.table + "', '" + op.name + "', " +
+                period + "); END";
+            if (trigger_sql(db, name) == sql) continue;
+
+            const std::string drop = "DROP TRIGGER IF EXISTS " + name;
+            db::detail::exec_sql(db, drop.c_str());
+            db::detail::exec_sql(db, sql.c_str());
+        }
+    }
+}
+
+// Each ORDER BY in get_tickers/search_tickers needs an index whose column
+// order matches exactly (or exactly reversed), otherwise sqlite falls back to
+// a temp b-tree sort over the whole table. Guarded by query_plan_test.
+static void ensure_tickers_order_indexes(sqlite3* db)
+{
+    db::detail::exec_sql(
+        db,
+        "CREATE INDEX IF NOT EXISTS idx_tickers_order_asc "
+        "ON tickers(last_update ASC, ticker ASC);");
+    db::detail::exec_sql(
+        db,
+        "CREATE INDEX IF NOT EXISTS idx_tickers_portfolio "
+        "ON tickers(portfolio, last_update DESC, ticker ASC);");
+    db::detail::exec_sql(
+        db,
+        "CREATE INDEX IF NOT EXISTS idx_tickers_portfolio_asc "
+        "ON tickers(portfolio, last_update ASC, ticker ASC);");
+    db::detail::exec_sql(
+        db,
+        "CREATE INDEX IF NOT EXISTS idx_tickers_portfolio_ticker "
+        "ON tickers(portfolio, ticker);");
+}
+
+static bool table_exists(sqlite3* db, const char* table_name)
+{
+    sqlite3_stmt* st = nullptr;
+    if (sqlite3_prepare_v2(
+            db,
+            "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;",
+            -1,
+            &st,
+            nullptr) != SQLITE_OK) {
+        db::detail::throw_sqlite(db, "prepare sqlite_master failed");
+    }
+    sqlite3_bind_text(st, 1, table_name, -1, SQLITE_STATIC);
+
+    const int rc = sqlite3_step(st);
+    sqlite3_finalize(st);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        db::detail::throw_sqlite(db, "sqlite_master step failed");
+    }
+    return rc == SQLITE_ROW;
+}
+
+// Creates finance_metrics or adds columns registered since it was created.
+// True when existing rows need recomputing.
+static bool ensure_finance_metrics_table(sqlite3* db)
+{
+    bool changed = !table_exists(db, "finance_metrics");
+    db::detail::exec_sql(db, db::sql::finance_metrics_table().c_str());
+
+    for (const auto& column : metrics::kFinanceMetricColumns) {
+        if (table_has_column(db, "finance_metrics", column.name)) continue;
+        const std::string sql = "ALTER TABLE finance_metrics ADD COLUMN " +
+                                std::string(column.name) + " REAL;";
+        db::detail::exec_sql(db, sql.c_str());
+        changed = true;
+    }
+
+    for (const auto& column : metrics::kFinanceMetricColumns) {
+        if (!column.indexed) continue;
+        const std::string sql =
+            "CREATE INDEX IF NOT EXISTS idx_finance_metrics_" +
+            std::string(column.name) + " ON finance_metrics(" + column.name +
+            ");";
+        db::detail::exec_sql(db, sql.c_str());
+    }
+    return changed;
+}
+
 void Database::apply_schema_()
 {
     db::detail::exec_sql(db_, "BEGIN;");
@@ -173,12 +415,16 @@ void Database::apply_schema_()
         db::detail::exec_sql(db_, kSchemaSQL);
         ensure_tickers_portfolio_column(db_);
         ensure_tickers_type_column(db_);
+        ensure_tickers_generation_column(db_);
+        ensure_ticker_generation_state(db_);
         ensure_finances_bank_columns(db_);
         ensure_finances_insurance_columns(db_);
-        db::detail::exec_sql(
-            db_,
-            "CREATE INDEX IF NOT EXISTS idx_tickers_portfolio "
-            "ON tickers(portfolio, last_update DESC, ticker ASC);");
+        ensure_tickers_order_indexes(db_);
+        ensure_change_log_columns(db_);
+        ensure_change_log_triggers(db_);
+        const bool metrics_changed = ensure_finance_metrics_table(db_);
+        backfill_derived_(metrics_changed);
+        compact_change_log_();
         db::detail::exec_sql(db_, "COMMIT;");
     }
     catch (...) {
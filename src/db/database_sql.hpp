@@ -0,0 +1,569 @@
+#pragma once
+
+#include "db/database.hpp"
+#include "metrics/finance_metrics.hpp"
+
+#include <string>
+
+// Production SQL shared by Database and the query plan tests, so the plans
+// asserted in tests are the plans of the statements that actually ship.
+
+namespace db::sql {
+
+// *
+// **
+// ***
+// ****
+// ***** TICKERS
+
+inline const char* tickers_order_by(Database::TickerSortKey key,
+                                    Database::SortDir dir)
+{
+    if (key == Database::TickerSortKey::LastUpdate) {
+        if (dir == Database::SortDir::Desc) {
+            return "last_update DESC, ticker ASC";
+        }
+        return "last_update ASC, ticker ASC";
+    }
+
+    // TickerSortKey::Ticker
+    if (dir == Database::SortDir::Asc) {
+        return "ticker ASC";
+    }
+    return "ticker DESC";
+}
+
+inline std::string tickers_page(Database::TickerSortKey key,
+                                Database::SortDir dir,
+                                bool portfolio_only)
+{
+    std::string sql = "SELECT ticker, last_update, portfolio, type "
+                      "FROM tickers ";
+    if (portfolio_only) {
+        sql += "WHERE portfolio = 1 ";
+    }
+
+    sql += "ORDER BY " + std::string(tickers_order_by(key, dir)) +
+           " "
+           "LIMIT ? OFFSET ?;";
+    return sql;
+}
+
+inline std::string search_tickers(bool portfolio_only)
+{
+    std::string sql = R"SQL(
+        SELECT ticker, last_update, portfolio, type
+        FROM tickers
+        WHERE UPPER(ticker) LIKE '%' || UPPER(?) || '%'
+    )SQL";
+    if (portfolio_only) {
+        sql += " AND portfolio = 1 ";
+    }
+    sql += R"SQL(
+        ORDER BY ticker ASC
+        LIMIT ?;
+    )SQL";
+    return sql;
+}
+
+// Bulk load for the in-memory ticker index, already in ticker order.
+inline constexpr const char* kSelectAllTickers = R"SQL(
+    SELECT ticker, last_update, portfolio, type
+    FROM tickers
+    ORDER BY ticker ASC
+    LIMIT ?;
+)SQL";
+
+inline constexpr const char* kCountTickers = R"SQL(
+    SELECT COUNT(*)
+    FROM tickers;
+)SQL";
+
+inline constexpr const char* kCountPortfolioTickers = R"SQL(
+    SELECT COUNT(*)
+    FROM tickers
+    WHERE portfolio = 1;
+)SQL";
+
+inline constexpr const char* kSelectTicker = R"SQL(
+    SELECT ticker, last_update, portfolio, type
+    FROM tickers
+    WHERE ticker = ?;
+)SQL";
+
+// Every change to a ticker's row or finances sets its generation to the
+// next value of ticker_generation_state (see kNextTickerGeneration), which
+// never repeats, even for a ticker deleted and re-created within a second.
+// ?1 ticker, ?2 generation.
+inline constexpr const char* kToggleTickerPortfolio = R"SQL(
+    UPDATE tickers
+    SET portfolio  = CASE WHEN portfolio = 0 THEN 1 ELSE 0 END,
+        generation = ?2
+    WHERE ticker = ?1;
+)SQL";
+
+inline constexpr const char* kBumpTickerGeneration = R"SQL(
+    UPDATE tickers
+    SET generation = ?2
+    WHERE ticker = ?1;
+)SQL";
+
+// run in the writing transaction, then read with kSelectLastTickerGeneration
+inline constexpr const char* kNextTickerGeneration = R"SQL(
+    UPDATE ticker_generation_state
+    SET generation = generation + 1
+    WHERE id = 1;
+)SQL";
+
+inline constexpr const char* kSelectLastTickerGeneration = R"SQL(
+    SELECT generation
+    FROM ticker_generation_state
+    WHERE id = 1;
+)SQL";
+
+inline constexpr const char* kSelectTickerGeneration = R"SQL(
+    SELECT generation
+    FROM tickers
+    WHERE ticker = ?;
+)SQL";
+
+inline constexpr const char* kSelectTickerType = R"SQL(
+    SELECT type
+    FROM tickers
+    WHERE ticker = ?;
+)SQL";
+
+inline constexpr const char* kDeleteTicker = R"SQL(
+    DELETE FROM tickers
+    WHERE ticker = ?;
+)SQL";
+
+// ?4: the next ticker generation
+inline constexpr const char* kUpsertTicker = R"SQL(
+    INSERT INTO tickers (ticker, last_update, type, generation)
+    VALUES (?1, ?2, ?3, ?4)
+    ON CONFLICT(ticker) DO UPDATE SET
+        last_update = excluded.last_update,
+        generation  = excluded.generation;
+)SQL";
+
+// *
+// **
+// ***
+// ****
+// ***** FINANCES
+
+inline constexpr const char* kCountFinancesForTicker = R"SQL(
+    SELECT COUNT(*)
+    FROM finances
+    WHERE ticker = ?;
+)SQL";
+
+inline constexpr const char* kDeleteFinancePeriod = R"SQL(
+    DELETE FROM finances
+    WHERE ticker = ?
+      AND year = ?
+      AND period_type = ?;
+)SQL";
+
+inline constexpr const char* kUpsertFinances = R"SQL(
+    INSERT INTO finances (
+        ticker, year, period_type,
+        current_assets,
+        non_current_assets,
+        eps,
+        cash_and_equivalents,
+        cash_flow_from_financing,
+        cash_flow_from_investing,
+        cash_flow_from_operations,
+        revenue,
+        current_liabilities,
+        non_current_liabilities,
+        net_income,
+        total_loans,
+        goodwill,
+        total_assets,
+        total_deposits,
+        total_liabilities,
+        net_interest_income,
+        non_interest_income,
+        loan_loss_provisions,
+        non_interest_expense,
+        risk_weighted_assets,
+        common_equity_tier1,
+        net_charge_offs,
+        non_performing_loans,
+        insurance_reserves,
+        earned_premiums,
+        claims_incurred,
+        interest_expenses,
+        total_expenses,
+        underwriting_expenses,
+        total_debt
+    )
+    VALUES (
+        ?, ?, ?,
+        ?, ?, ?,
+        ?, ?, ?, ?,
+        ?, ?, ?, ?,
+        ?, ?, ?, ?, ?,
+        ?, ?, ?, ?,
+        ?, ?, ?, ?,
+        ?, ?, ?, ?, ?, ?, ?
+    )
+    ON CONFLICT(ticker, year, period_type)
+    DO UPDATE SET
+        current_assets            = excluded.current_assets,
+        non_current_assets        = excluded.non_current_assets,
+        eps                       = excluded.eps,
+        cash_and_equivalents      = excluded.cash_and_equivalents,
+        cash_flow_from_financing  = excluded.cash_flow_from_financing,
+        cash_flow_from_investing  = excluded.cash_flow_from_investing,
+        cash_flow_from_operations = excluded.cash_flow_from_operations,
+        revenue                   = excluded.revenue,
+        current_liabilities       = excluded.current_liabilities,
+        non_current_liabilities   = excluded.non_current_liabilities,
+        net_income                = excluded.net_income,
+        total_loans               = excluded.total_loans,
+        goodwill                  = excluded.goodwill,
+        total_assets              = excluded.total_assets,
+        total_deposits            = excluded.total_deposits,
+        total_liabilities         = excluded.total_liabilities,
+        net_interest_income       = excluded.net_interest_income,
+        non_interest_income       = excluded.non_interest_income,
+        loan_loss_provisions      = excluded.loan_loss_provisions,
+        non_interest_expense      = excluded.non_interest_expense,
+        risk_weighted_assets      = excluded.risk_weighted_assets,
+        common_equity_tier1       = excluded.common_equity_tier1,
+        net_charge_offs           = excluded.net_charge_offs,
+        non_performing_loans      = excluded.non_performing_loans,
+        insurance_reserves        = excluded.insurance_reserves,
+        earned_premiums           = excluded.earned_premiums,
+        claims_incurred           = excluded.claims_incurred,
+        interest_expenses         = excluded.interest_expenses,
+        total_expenses            = excluded.total_expenses,
+        underwriting_expenses     = excluded.underwriting_expenses,
+        total_debt                = excluded.total_debt;
+)SQL";
+
+inline constexpr const char* kSelectFinances = R"SQL(
+    SELECT
+        ticker, year, period_type,
+        current_assets,
+        non_current_assets,
+        eps,
+        cash_and_equivalents,
+        cash_flow_from_financing,
+        cash_flow_from_investing,
+        cash_flow_from_operations,
+        revenue,
+        current_liabilities,
+        non_current_liabilities,
+        net_income,
+        total_loans,
+        goodwill,
+        total_assets,
+        total_deposits,
+        total_liabilities,
+        net_interest_income,
+        non_interest_income,
+        loan_loss_provisions,
+        non_interest_expense,
+        risk_weighted_assets,
+        common_equity_tier1,
+        net_charge_offs,
+        non_performing_loans,
+        insurance_reserves,
+        earned_premiums,
+        claims_incurred,
+        interest_expenses,
+        total_expenses,
+        underwriting_expenses,
+        total_debt
+    FROM finances
+    WHERE ticker = ?
+    ORDER BY year ASC, period_type ASC;
+)SQL";
+
+// *
+// **
+// ***
+// ****
+// ***** PRICES
+
+inline constexpr const char* kUpsertPrice = R"SQL(
+    INSERT INTO prices (ticker, day, close)
+    VALUES (?, ?, ?)
+    ON CONFLICT(ticker, day) DO UPDATE SET
+        close = excluded.close;
+)SQL";
+
+inline constexpr const char* kSelectPrices = R"SQL(
+    SELECT day, close
+    FROM prices
+    WHERE ticker = ?
+    ORDER BY day ASC;
+)SQL";
+
+inline constexpr const char* kSelectLatestPrice = R"SQL(
+    SELECT day, close
+    FROM prices
+    WHERE ticker = ?
+    ORDER BY day DESC
+    LIMIT 1;
+)SQL";
+
+// *
+// **
+// ***
+// ****
+// ***** HOLDINGS
+
+inline constexpr const char* kUpsertHolding = R"SQL(
+    INSERT INTO holdings (ticker, shares, cost_basis)
+    VALUES (?, ?, ?)
+    ON CONFLICT(ticker) DO UPDATE SET
+        shares     = excluded.shares,
+        cost_basis = excluded.cost_basis;
+)SQL";
+
+inline constexpr const char* kDeleteHolding = R"SQL(
+    DELETE FROM holdings
+    WHERE ticker = ?;
+)SQL";
+
+// portfolio tickers with their holding and the metrics of their newest
+// period; `?` = '' selects all of them, a ticker just that one
+inline constexpr const char* kSelectPortfolioRows = R"SQL(
+    SELECT
+        t.ticker, t.type,
+        h.shares, h.cost_basis,
+        s.latest_period_type, s.latest_eps,
+        m.ttm_eps, m.tbv_per_share, m.combined_ratio
+    FROM tickers t
+    LEFT JOIN holdings h ON h.ticker = t.ticker
+    LEFT JOIN ticker_summary s ON s.ticker = t.ticker
+    LEFT JOIN finance_metrics m
+        ON m.ticker = s.ticker
+        AND m.year = s.latest_year
+        AND m.period_type = s.latest_period_type
+    WHERE t.portfolio = 1 AND (?1 = '' OR t.ticker = ?1)
+    ORDER BY t.ticker ASC;
+)SQL";
+
+// *
+// **
+// ***
+// ****
+// ***** SUMMARY
+
+inline constexpr const char* kUpsertTickerSummary = R"SQL(
+    INSERT INTO ticker_summary (
+        ticker,
+        latest_year, latest_period_type,
+        period_count, yearly_count,
+        latest_revenue, latest_eps,
+        ttm_year, ttm_period_type,
+        ttm_eps, ttm_net_income, ttm_cash_flow_ops
+    )
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    ON CONFLICT(ticker) DO UPDATE SET
+        latest_year        = excluded.latest_year,
+        latest_period_type = excluded.latest_period_type,
+        period_count       = excluded.period_count,
+        yearly_count       = excluded.yearly_count,
+        latest_revenue     = excluded.latest_revenue,
+        latest_eps         = excluded.latest_eps,
+        ttm_year           = excluded.ttm_year,
+        ttm_period_type    = excluded.ttm_period_type,
+        ttm_eps            = excluded.ttm_eps,
+        ttm_net_income     = excluded.ttm_net_income,
+        ttm_cash_flow_ops  = excluded.ttm_cash_flow_ops;
+)SQL";
+
+inline constexpr const char* kDeleteTickerSummary = R"SQL(
+    DELETE FROM ticker_summary
+    WHERE ticker = ?;
+)SQL";
+
+inline constexpr const char* kSelectTickerSummary = R"SQL(
+    SELECT
+        ticker,
+        latest_year, latest_period_type,
+        period_count, yearly_count,
+        latest_revenue, latest_eps,
+        ttm_year, ttm_period_type,
+        ttm_eps, ttm_net_income, ttm_cash_flow_ops
+    FROM ticker_summary
+    WHERE ticker = ?;
+)SQL";
+
+// tickers written before ticker_summary existed
+inline constexpr const char* kSelectTickersWithoutSummary = R"SQL(
+    SELECT t.ticker
+    FROM tickers t
+    WHERE NOT EXISTS (
+        SELECT 1 FROM ticker_summary s WHERE s.ticker = t.ticker
+    );
+)SQL";
+
+// *
+// **
+// ***
+// ****
+// ***** METRICS
+
+// Columns come from metrics::kFinanceMetricColumns, so adding a metric there
+// is enough for the table, its upsert and its screen statement.
+
+inline std::string finance_metrics_table()
+{
+    std::string sql = "CREATE TABLE IF NOT EXISTS finance_metrics (\n"
+                      "    ticker TEXT NOT NULL,\n"
+                      "    year INTEGER NOT NULL,\n"
+                      "    period_type TEXT NOT NULL,\n";
+    for (const auto& column : metrics::kFinanceMetricColumns) {
+        sql += "    " + std::string(column.name) + " REAL,\n";
+    }
+    sql += "    PRIMARY KEY (ticker, year, period_type),\n"
+           "    FOREIGN KEY (ticker, year, period_type)\n"
+           "        REFERENCES finances(ticker, year, period_type)\n"
+           "        ON DELETE CASCADE\n"
+           ") WITHOUT ROWID;";
+    return sql;
+}
+
+inline const std::string& finance_metrics_upsert()
+{
+    static const std::string sql = [] {
+        std::string columns = "ticker, year, period_type";
+        std::string values = "?, ?, ?";
+        std::string updates;
+        for (const auto& column : metrics::kFinanceMetricColumns) {
+            columns += ", " + std::string(column.name);
+            values += ", ?";
+            if (!updates.empty()) updates += ", ";
+            updates += std::string(column.name) + " = excluded." + column.name;
+        }
+        return "INSERT INTO finance_metrics (" + columns + ") VALUES (" +
+               values + ") ON CONFLICT(ticker, year, period_type) " +
+               "DO UPDATE SET " + updates + ";";
+    }();
+    return sql;
+}
+
+// `column` must come from kFinanceMetricColumns. Bounds are inclusive and
+// NULL metrics never match. With latest_only, only each ticker's newest
+// period (per ticker_summary) is considered.
+inline std::string screen_finance_metric(const char* column,
+                                         Database::SortDir dir,
+                                         bool latest_only)
+{
+    const std::string col = column;
+    const char* d = dir == Database::SortDir::Desc ? " DESC" : " ASC";
+
+    std::string sql = "SELECT m.ticker, m.year, m.period_type, m." + col +
+                      " FROM finance_metrics m "
+                      "WHERE m." +
+                      col + " BETWEEN ? AND ? ";
+    if (latest_only) {
+        sql += "AND EXISTS (SELECT 1 FROM ticker_summary s "
+               "WHERE s.ticker = m.ticker AND s.latest_year = m.year "
+               "AND s.latest_period_type = m.period_type) ";
+    }
+    sql += "ORDER BY m." + col + d + ", m.ticker" + d + ", m.year" + d +
+           ", m.period_type" + d + " LIMIT ?;";
+    return sql;
+}
+
+// tickers the intrinsic_metrics virtual table walks, all or just one
+inline constexpr const char* kSelectTickerTypes = R"SQL(
+    SELECT ticker, type
+    FROM tickers
+    ORDER BY ticker ASC;
+)SQL";
+
+inline constexpr const char* kSelectOneTickerType = R"SQL(
+    SELECT ticker, type
+    FROM tickers
+    WHERE ticker = ?;
+)SQL";
+
+// every ticker, for rebuilding finance_metrics after it changed shape
+inline constexpr const char* kSelectAllTickerNames = R"SQL(
+    SELECT ticker
+    FROM tickers;
+)SQL";
+
+// *
+// **
+// ***
+// ****
+// ***** CHANGES
+
+// add_prices() logs its batch by hand, so a batch costs one row
+inline constexpr const char* kLogPrices = R"SQL(
+    INSERT INTO change_log (ticker, source, op)
+    VALUES (?, 'prices', 'upsert');
+)SQL";
+
+inline constexpr const char* kSelectChangeSeq = R"SQL(
+    SELECT COALESCE(MAX(seq), 0)
+    FROM change_log;
+)SQL";
+
+// LIMIT -1: all of them
+inline constexpr const char* kSelectChangesAfter = R"SQL(
+    SELECT seq, op, source, ticker, year, period_type
+    FROM change_log
+    WHERE seq > ?
+    ORDER BY seq ASC
+    LIMIT ?;
+)SQL";
+
+inline constexpr const char* kSelectCompactedSeq = R"SQL(
+    SELECT COALESCE(
+        (SELECT compacted_seq FROM change_log_state WHERE id = 1), 0);
+)SQL";
+
+inline constexpr const char* kUpdateCompactedSeq = R"SQL(
+    UPDATE change_log_state
+    SET compacted_seq = ?
+    WHERE id = 1;
+)SQL";
+
+inline constexpr const char* kDeleteChangesThrough = R"SQL(
+    DELETE FROM change_log
+    WHERE seq <= ?;
+)SQL";
+
+// NULL without consumers
+inline constexpr const char* kSelectConsumedSeq = R"SQL(
+    SELECT MIN(seq)
+    FROM change_consumers;
+)SQL";
+
+inline constexpr const char* kSelectChangeConsumer = R"SQL(
+    SELECT seq
+    FROM change_consumers
+    WHERE name = ?;
+)SQL";
+
+// watermarks only move forward
+inline constexpr const char* kUpsertChangeConsumer = R"SQL(
+    INSERT INTO change_consumers (name, seq)
+    VALUES (?, ?)
+    ON CONFLICT(name) DO UPDATE SET
+        seq = MAX(seq, excluded.seq);
+)SQL";
+
+inline constexpr const char* kDeleteChangeConsumer = R"SQL(
+    DELETE FROM change_consumers
+    WHERE name = ?;
+)SQL";
+
+inline constexpr const char* kSelectDataVersion = R"SQL(
+    PRAGMA data_version;
+)SQL";
+
+} // namespace db::sql
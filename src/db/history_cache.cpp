@@ -0,0 +1,148 @@
+#include "db/history_cache.hpp"
+
+#include <utility>
+
+namespace db {
+
+static std::size_t estimate_bytes(const HistoryCache::History& h)
+{
+    std::size_t bytes = sizeof(HistoryCache::History) + h.ticker.capacity();
+    bytes += h.rows.capacity() * sizeof(Database::FinanceRow);
+    for (const auto& r : h.rows) {
+        bytes += r.ticker.capacity() + r.period_type.capacity();
+    }
+    bytes += h.ttm.capacity() * sizeof(metrics::Ttm);
+    bytes += h.columns.bytes();
+    bytes += h.yoy.bytes();
+
+    // lru node, map node and the two key copies
+    bytes += 2 * (h.ticker.size() + sizeof(std::string)) + 64;
+    return bytes;
+}
+
+HistoryCache::HistoryPtr
+HistoryCache::build(std::string ticker,
+                    std::uint64_t generation,
+                    std::vector<Database::FinanceRow> rows,
+                    int ticker_type)
+{
+    auto h = std::make_shared<History>();
+    h->ticker = std::move(ticker);
+    h->generation = generation;
+    h->ticker_type = ticker_type;
+    h->rows = std::move(rows);
+
+    h->ttm.reserve(h->rows.size());
+    for (std::size_t i = 0; i < h->rows.size(); ++i) {
+        h->ttm.push_back(metrics::ttm_at(h->rows, static_cast<int>(i)));
+    }
+    h->columns = metrics::FinanceStore(h->rows);
+    h->yoy = metrics::YoyTable(h->rows, h->columns, ticker_type);
+
+    h->bytes = estimate_bytes(*h);
+    return h;
+}
+
+void HistoryCache::set_budget_bytes(std::size_t bytes)
+{
+    budget_bytes_ = bytes;
+    evict_to_(budget_bytes_);
+}
+
+HistoryCache::HistoryPtr
+HistoryCache::load(Database& db, const std::string& ticker, std::string* err)
+{
+    const std::uint64_t generation = db.write_generation();
+
+    const auto it = entries_.find(ticker);
+    if (it != entries_.end()) {
+        if (it->second.generation == generation) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            ++hits_;
+            return it->second.history;
+        }
+        erase(ticker);
+    }
+
+    ++misses_;
+
+    std::string local_err;
+    auto rows = db.get_finances(ticker, &local_err);
+    if (!local_err.empty()) {
+        if (err) *err = local_err;
+        return nullptr;
+    }
+
+    const auto type = db.get_ticker_type(ticker, &local_err);
+    if (!local_err.empty()) {
+        if (err) *err = local_err;
+        return nullptr;
+    }
+
+    auto history =
+        build(ticker, generation, std::move(rows), type.value_or(1));
+    insert(history);
+    return history;
+}
+
+void HistoryCache::carry_over(std::uint64_t from,
+                              std::uint64_t to,
+                              const std::vector<std::string>& changed)
+{
+    for (const auto& ticker : changed) {
+        erase(ticker);
+    }
+    for (auto& [ticker, entry] : entries_) {
+        if (entry.generation == from) entry.generation = to;
+    }
+}
+
+void HistoryCache::erase(const std::string& ticker)
+{
+    const auto it = entries_.find(ticker);
+    if (it == entries_.end()) return;
+
+    bytes_ -= it->second.history->bytes;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+void HistoryCache::clear()
+{
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+bool HistoryCache::has_current(const std::string& ticker,
+                               std::uint64_t generation) const
+{
+    const auto it = entries_.find(ticker);
+    return it != entries_.end() && it->second.generation == generation;
+}
+
+void HistoryCache::insert(const HistoryPtr& history)
+{
+    if (!history) return;
+    erase(history->ticker);
+
+    // too big to ever fit -> serve it uncached
+    if (history->bytes > budget_bytes_) return;
+
+    evict_to_(budget_bytes_ - history->bytes);
+
+    lru_.push_front(history->ticker);
+    entries_.emplace(history->ticker,
+                     Entry{history, history->generation, lru_.begin()});
+    bytes_ += history->bytes;
+}
+
+void HistoryCache::evict_to_(std::size_t budget)
+{
+    while (bytes_ > budget && !lru_.empty()) {
+        const std::string victim = lru_.back();
+        erase(victim);
+    }
+}
+
+} // namespace db
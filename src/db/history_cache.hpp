@@ -0,0 +1,99 @@
+#pragma once
+
+#include "db/database.hpp"
+#include "metrics/finance_store.hpp"
+#include "metrics/metric_math.hpp"
+#include "metrics/yoy_table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace db {
+
+// Decoded finance histories of recently opened tickers, with their TTM sums
+// and year-over-year changes precomputed per row, plus a columnar copy for
+// bulk kernels. Entries are least-recently-used ordered under a byte budget
+// and are only served while Database::write_generation() still matches the
+// one they were decoded at, so any committed write reloads. carry_over()
+// narrows that to the tickers another connection changed.
+class HistoryCache {
+public:
+    static constexpr std::size_t kDefaultBudgetMb = 16;
+
+    struct History {
+        std::string ticker;
+        std::uint64_t generation = 0;
+        int ticker_type = 1;
+        std::vector<Database::FinanceRow> rows; // year ASC, period_type ASC
+        std::vector<metrics::Ttm> ttm;          // one per row
+        metrics::FinanceStore columns;          // rows, field-major
+        metrics::YoyTable yoy;                  // changes vs a year earlier
+        std::size_t bytes = 0;                  // estimated footprint
+    };
+
+    using HistoryPtr = std::shared_ptr<const History>;
+
+    // 0 disables caching; load() then always decodes from sqlite.
+    void set_budget_bytes(std::size_t bytes);
+    std::size_t budget_bytes() const { return budget_bytes_; }
+
+    std::size_t bytes() const { return bytes_; }
+    std::size_t size() const { return entries_.size(); }
+    std::uint64_t hits() const { return hits_; }
+    std::uint64_t misses() const { return misses_; }
+
+    // Cached history when current, otherwise decoded from `db` and cached.
+    // Null on read failure (then *err is set).
+    HistoryPtr
+    load(Database& db, const std::string& ticker, std::string* err = nullptr);
+
+    // True when `ticker` is cached at `generation`; does not touch LRU order.
+    bool has_current(const std::string& ticker,
+                     std::uint64_t generation) const;
+
+    // Adopts a history decoded elsewhere (e.g. by the background prefetcher),
+    // replacing any entry for the same ticker.
+    void insert(const HistoryPtr& history);
+
+    // Keeps entries that were current at write generation `from` current
+    // at `to`, except those of `changed` tickers, which are dropped. For
+    // generation moves that only touched `changed`, like
+    // Database::poll_external_changes().
+    void carry_over(std::uint64_t from,
+                    std::uint64_t to,
+                    const std::vector<std::string>& changed);
+
+    void erase(const std::string& ticker);
+    void clear();
+
+    static HistoryPtr build(std::string ticker,
+                            std::uint64_t generation,
+                            std::vector<Database::FinanceRow> rows,
+                            int ticker_type = 1);
+
+private:
+    struct Entry {
+        HistoryPtr history;
+        // history->generation, or the one it was carried over to
+        std::uint64_t generation = 0;
+        std::list<std::string>::iterator lru;
+    };
+
+    void evict_to_(std::size_t budget);
+
+private:
+    std::size_t budget_bytes_{kDefaultBudgetMb << 20};
+    std::size_t bytes_{0};
+    std::uint64_t hits_{0};
+    std::uint64_t misses_{0};
+
+    std::list<std::string> lru_; // front = most recently used
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace db
@@ -0,0 +1,164 @@
+#include "db/history_prefetcher.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace db {
+
+HistoryPrefetcher::HistoryPrefetcher()
+    : thread_([this] { run_(); })
+{
+}
+
+HistoryPrefetcher::~HistoryPrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+        queue_.clear();
+        if (busy_ && reader_) reader_->interrupt();
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+bool HistoryPrefetcher::wanted_(const std::string& ticker) const
+{
+    return std::find(queue_.begin(), queue_.end(), ticker) != queue_.end();
+}
+
+void HistoryPrefetcher::want(const Database& db,
+                             std::vector<std::string> tickers)
+{
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (db.path().empty()) {
+            queue_.clear();
+        }
+        else {
+            const bool same_file = path_ == db.path();
+            path_ = db.path();
+            generation_ = db.write_generation();
+            queue_.assign(std::make_move_iterator(tickers.begin()),
+                          std::make_move_iterator(tickers.end()));
+            if (!same_file) done_.clear();
+        }
+
+        // in flight for a ticker that fell out of the window -> abort it
+        if (busy_ && !wanted_(in_flight_) && reader_) reader_->interrupt();
+        if (busy_) {
+            queue_.erase(
+                std::remove(queue_.begin(), queue_.end(), in_flight_),
+                queue_.end());
+        }
+    }
+    cv_.notify_all();
+}
+
+void HistoryPrefetcher::cancel()
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    queue_.clear();
+    if (busy_ && reader_) reader_->interrupt();
+}
+
+void HistoryPrefetcher::close()
+{
+    std::unique_lock<std::mutex> lock(mu_);
+    queue_.clear();
+    if (busy_ && reader_) reader_->interrupt();
+    cv_.wait(lock, [this] { return !busy_; });
+
+    reader_.reset();
+    path_.clear();
+    done_.clear();
+}
+
+std::size_t HistoryPrefetcher::drain(HistoryCache& cache,
+                                     const Database& db,
+                                     const std::string& wait_for)
+{
+    std::vector<HistoryCache::HistoryPtr> done;
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        if (!wait_for.empty()) {
+            // the caller is about to read it anyway
+            queue_.erase(std::remove(queue_.begin(), queue_.end(), wait_for),
+                         queue_.end());
+        }
+        if (!wait_for.empty() && busy_ && in_flight_ == wait_for) {
+            cv_.wait(lock, [&] { return !busy_ || in_flight_ != wait_for; });
+        }
+        done.swap(done_);
+    }
+
+    std::size_t adopted = 0;
+    for (auto& history : done) {
+        // a write since want() makes the decode stale
+        if (history->generation != db.write_generation()) continue;
+        cache.insert(history);
+        adopted += 1;
+    }
+    return adopted;
+}
+
+void HistoryPrefetcher::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this] { return stop_ || (queue_.empty() && !busy_); });
+}
+
+void HistoryPrefetcher::run_()
+{
+    std::unique_lock<std::mutex> lock(mu_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (stop_) return;
+
+        std::string ticker = std::move(queue_.front());
+        queue_.pop_front();
+        const std::uint64_t generation = generation_;
+
+        // opening is cheap and keeps reader_ stable for interrupt()
+        if (!reader_ || reader_->path() != path_) {
+            try {
+                auto next = std::make_unique<Database>();
+                next->open_read_only(path_);
+                reader_ = std::move(next);
+            }
+            catch (const std::exception&) {
+                reader_.reset();
+                queue_.clear(); // speculative; the UI thread reads itself
+                cv_.notify_all();
+                continue;
+            }
+        }
+
+        in_flight_ = ticker;
+        busy_ = true;
+        Database* reader = reader_.get();
+        lock.unlock();
+
+        std::string err;
+        auto rows = reader->get_finances(ticker, &err);
+        std::optional<int> type;
+        if (err.empty()) type = reader->get_ticker_type(ticker, &err);
+        HistoryCache::HistoryPtr history;
+        if (err.empty()) {
+            history = HistoryCache::build(
+                ticker, generation, std::move(rows), type.value_or(1));
+        }
+
+        lock.lock();
+        busy_ = false;
+        in_flight_.clear();
+        if (history && generation == generation_ && !stop_) {
+            done_.push_back(std::move(history));
+        }
+        cv_.notify_all();
+    }
+}
+
+} // namespace db
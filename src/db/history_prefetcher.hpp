@@ -0,0 +1,75 @@
+#pragma once
+
+#include "db/database.hpp"
+#include "db/history_cache.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace db {
+
+// Decodes ticker histories on a worker thread with its own read-only
+// connection, so the home grid can warm HistoryCache for the selection and
+// its neighbours while the user is still moving. The cache itself stays
+// single-threaded: finished histories wait here until the UI thread calls
+// drain().
+class HistoryPrefetcher {
+public:
+    HistoryPrefetcher();
+    ~HistoryPrefetcher();
+
+    HistoryPrefetcher(const HistoryPrefetcher&) = delete;
+    HistoryPrefetcher& operator=(const HistoryPrefetcher&) = delete;
+
+    // Replaces the wanted set with `tickers` (highest priority first), read
+    // from `db`'s file at its current write generation. Queued tickers that
+    // are no longer wanted are dropped and an unwanted in-flight load is
+    // interrupted.
+    void want(const Database& db, std::vector<std::string> tickers);
+    void cancel();
+
+    // Cancels everything and closes the read connection; call before the
+    // database file is removed or replaced.
+    void close();
+
+    // Moves finished histories that are still current into `cache` and
+    // returns how many were adopted. When `wait_for` is being decoded right
+    // now, waits for it first instead of letting the caller read it again.
+    std::size_t drain(HistoryCache& cache,
+                      const Database& db,
+                      const std::string& wait_for = {});
+
+    // Blocks until the queue is empty and nothing is in flight.
+    void wait_idle();
+
+private:
+    void run_();
+    bool wanted_(const std::string& ticker) const;
+
+private:
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_{false};
+
+    std::filesystem::path path_;
+    std::uint64_t generation_{0};
+    std::deque<std::string> queue_;
+    std::string in_flight_;
+    bool busy_{false};
+    std::vector<HistoryCache::HistoryPtr> done_;
+
+    // worker-owned; opened, replaced and closed only under mu_ while idle
+    std::unique_ptr<Database> reader_;
+
+    std::thread thread_;
+};
+
+} // namespace db
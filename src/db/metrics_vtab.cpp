@@ -0,0 +1,390 @@
+#include "db/metrics_vtab.hpp"
+#include "db/database_sql.hpp"
+#include "db/sql_helpers.hpp"
+#include "metrics/finance_metrics.hpp"
+#include "metrics/finance_store.hpp"
+#include "metrics/yoy_table.hpp"
+
+#include <exception>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace db {
+
+namespace {
+
+enum Column { kTicker, kPeriod, kMetric, kValue, kYoyChange };
+
+// idxNum bits; argv follows the same order
+constexpr int kHasTicker = 1;
+constexpr int kHasPeriod = 2;
+constexpr int kHasMetric = 4;
+
+constexpr std::size_t kMetricCount =
+    std::size(metrics::kFinanceMetricColumns);
+
+struct MetricsVtab {
+    sqlite3_vtab base{};
+    sqlite3* db = nullptr;
+};
+
+// Walks tickers in order, decoding one ticker's periods at a time into a
+// YoyTable, and within a period every metric column (or just the
+// constrained one).
+struct MetricsCursor {
+    sqlite3_vtab_cursor base{};
+    sqlite3* db = nullptr;
+
+    std::optional<std::string> period;
+    const metrics::FinanceMetricColumn* only_metric = nullptr;
+
+    sqlite3_stmt* tickers = nullptr;
+
+    std::vector<Database::FinanceRow> rows;
+    metrics::YoyTable table;
+    std::vector<std::string> labels;
+
+    std::size_t row = 0;
+    std::size_t metric = 0;
+    bool eof = true;
+    sqlite3_int64 rowid = 0;
+
+    ~MetricsCursor()
+    {
+        if (tickers) sqlite3_finalize(tickers);
+    }
+
+    std::size_t metric_index() const
+    {
+        return only_metric ? static_cast<std::size_t>(
+                                 only_metric - metrics::kFinanceMetricColumns)
+                           : metric;
+    }
+
+    const metrics::FinanceMetricColumn& column() const
+    {
+        return metrics::kFinanceMetricColumns[metric_index()];
+    }
+
+    std::size_t metric_count() const
+    {
+        return only_metric ? 1 : kMetricCount;
+    }
+
+    bool current_has_value() const
+    {
+        return table.metric_values(metric_index()).valid.test(row);
+    }
+
+    // Loads the next ticker with at least one matching period. False at
+    // the end of the ticker list.
+    bool load_next_ticker()
+    {
+        while (true) {
+            const int rc = sqlite3_step(tickers);
+            if (rc == SQLITE_DONE) return false;
+            if (rc != SQLITE_ROW) {
+                db::detail::throw_sqlite(db, "metrics ticker step failed");
+            }
+
+            const unsigned char* t = sqlite3_column_text(tickers, 0);
+            const std::string ticker = t ? reinterpret_cast<const char*>(t)
+                                         : "";
+            const int type = sqlite3_column_int(tickers, 1);
+            if (load_ticker(ticker, type)) return true;
+        }
+    }
+
+    bool load_ticker(const std::string& ticker, int type)
+    {
+        rows.clear();
+        labels.clear();
+
+        sqlite3_stmt* st = nullptr;
+        if (sqlite3_prepare_v2(
+                db, db::sql::kSelectFinances, -1, &st, nullptr) != SQLITE_OK) {
+            db::detail::throw_sqlite(db, "metrics prepare failed");
+        }
+        sqlite3_bind_text(st, 1, ticker.c_str(), -1, SQLITE_TRANSIENT);
+
+        int rc = SQLITE_OK;
+        while ((rc = sqlite3_step(st)) == SQLITE_ROW) {
+            rows.push_back(db::detail::read_finance_row(st));
+        }
+        sqlite3_finalize(st);
+        if (rc != SQLITE_DONE) {
+            db::detail::throw_sqlite(db, "metrics finances step failed");
+        }
+
+        // every period is derived, since yoy needs the one a year back
+        table = metrics::YoyTable(rows, metrics::FinanceStore(rows), type);
+        labels.reserve(rows.size());
+        for (const auto& r : rows) labels.push_back(metrics::period_label(r));
+
+        row = 0;
+        metric = 0;
+        return seek_match();
+    }
+
+    // Moves forward from (row, metric) to the first matching, non-NULL
+    // cell of the loaded ticker.
+    bool seek_match()
+    {
+        for (; row < rows.size(); ++row, metric = 0) {
+            if (period && labels[row] != *period) continue;
+            for (; metric < metric_count(); ++metric) {
+                if (current_has_value()) return true;
+            }
+        }
+        return false;
+    }
+
+    void advance()
+    {
+        ++metric;
+        if (seek_match()) return;
+        eof = !load_next_ticker();
+    }
+};
+
+int set_error(sqlite3_vtab* vtab, const char* message)
+{
+    sqlite3_free(vtab->zErrMsg);
+    vtab->zErrMsg = sqlite3_mprintf("%s", message);
+    return SQLITE_ERROR;
+}
+
+int vt_connect(sqlite3* db,
+               void*,
+               int,
+               const char* const*,
+               sqlite3_vtab** out,
+               char**)
+{
+    const int rc = sqlite3_declare_vtab(
+        db,
+        "CREATE TABLE x(ticker TEXT, period TEXT, metric TEXT, "
+        "value REAL, yoy_change REAL)");
+    if (rc != SQLITE_OK) return rc;
+
+    auto* vtab = new (std::nothrow) MetricsVtab();
+    if (!vtab) return SQLITE_NOMEM;
+    vtab->db = db;
+    *out = &vtab->base;
+
+    sqlite3_vtab_config(db, SQLITE_VTAB_INNOCUOUS);
+    return SQLITE_OK;
+}
+
+int vt_disconnect(sqlite3_vtab* vtab)
+{
+    delete reinterpret_cast<MetricsVtab*>(vtab);
+    return SQLITE_OK;
+}
+
+int vt_best_index(sqlite3_vtab*, sqlite3_index_info* info)
+{
+    int slots[3] = {-1, -1, -1}; // constraint index per pushed column
+    for (int i = 0; i < info->nConstraint; ++i) {
+        const auto& c = info->aConstraint[i];
+        if (!c.usable || c.op != SQLITE_INDEX_CONSTRAINT_EQ) continue;
+        if (c.iColumn >= kTicker && c.iColumn <= kMetric) {
+            slots[c.iColumn] = i;
+        }
+    }
+
+    int idx_num = 0;
+    int argv_index = 1;
+    double cost = 1e6;
+    for (int col = kTicker; col <= kMetric; ++col) {
+        if (slots[col] < 0) continue;
+        idx_num |= 1 << col;
+        info->aConstraintUsage[slots[col]].argvIndex = argv_index++;
+        info->aConstraintUsage[slots[col]].omit = 1;
+        cost /= col == kTicker ? 1000.0 : col == kPeriod ? 40.0 : 30.0;
+    }
+
+    info->idxNum = idx_num;
+    info->estimatedCost = cost;
+    info->estimatedRows = static_cast<sqlite3_int64>(cost);
+
+    // ticker is the outer loop, so ORDER BY ticker needs no sort
+    if (info->nOrderBy == 1 && info->aOrderBy[0].iColumn == kTicker &&
+        !info->aOrderBy[0].desc) {
+        info->orderByConsumed = 1;
+    }
+    return SQLITE_OK;
+}
+
+int vt_open(sqlite3_vtab* vtab, sqlite3_vtab_cursor** out)
+{
+    auto* cursor = new (std::nothrow) MetricsCursor();
+    if (!cursor) return SQLITE_NOMEM;
+    cursor->db = reinterpret_cast<MetricsVtab*>(vtab)->db;
+    *out = &cursor->base;
+    return SQLITE_OK;
+}
+
+int vt_close(sqlite3_vtab_cursor* cur)
+{
+    delete reinterpret_cast<MetricsCursor*>(cur);
+    return SQLITE_OK;
+}
+
+std::optional<std::string> text_arg(sqlite3_value* v)
+{
+    const unsigned char* t = sqlite3_value_text(v);
+    if (!t) return std::nullopt;
+    return std::string(reinterpret_cast<const char*>(t),
+                       static_cast<std::size_t>(sqlite3_value_bytes(v)));
+}
+
+int vt_filter(sqlite3_vtab_cursor* cur,
+              int idx_num,
+              const char*,
+              int,
+              sqlite3_value** argv)
+{
+    auto* c = reinterpret_cast<MetricsCursor*>(cur);
+    try {
+        if (c->tickers) {
+            sqlite3_finalize(c->tickers);
+            c->tickers = nullptr;
+        }
+        c->period.reset();
+        c->only_metric = nullptr;
+        c->rowid = 0;
+        c->eof = true;
+
+        int arg = 0;
+        std::optional<std::string> ticker;
+        if (idx_num & kHasTicker) ticker = text_arg(argv[arg++]);
+        if (idx_num & kHasPeriod) {
+            c->period = text_arg(argv[arg++]);
+            if (!c->period) return SQLITE_OK; // = NULL matches nothing
+        }
+        if (idx_num & kHasMetric) {
+            const auto name = text_arg(argv[arg++]);
+            c->only_metric =
+                name ? metrics::find_finance_metric(*name) : nullptr;
+            if (!c->only_metric) return SQLITE_OK;
+        }
+
+        const char* sql = (idx_num & kHasTicker) ? db::sql::kSelectOneTickerType
+                                                 : db::sql::kSelectTickerTypes;
+        if (sqlite3_prepare_v2(c->db, sql, -1, &c->tickers, nullptr) !=
+            SQLITE_OK) {
+            db::detail::throw_sqlite(c->db, "metrics prepare failed");
+        }
+        if (idx_num & kHasTicker) {
+            if (!ticker) return SQLITE_OK;
+            sqlite3_bind_text(
+                c->tickers, 1, ticker->c_str(), -1, SQLITE_TRANSIENT);
+        }
+
+        c->eof = !c->load_next_ticker();
+        return SQLITE_OK;
+    }
+    catch (const std::exception& e) {
+        c->eof = true;
+        return set_error(cur->pVtab, e.what());
+    }
+}
+
+int vt_next(sqlite3_vtab_cursor* cur)
+{
+    auto* c = reinterpret_cast<MetricsCursor*>(cur);
+    try {
+        c->advance();
+        ++c->rowid;
+        return SQLITE_OK;
+    }
+    catch (const std::exception& e) {
+        c->eof = true;
+        return set_error(cur->pVtab, e.what());
+    }
+}
+
+int vt_eof(sqlite3_vtab_cursor* cur)
+{
+    return reinterpret_cast<MetricsCursor*>(cur)->eof ? 1 : 0;
+}
+
+int vt_column(sqlite3_vtab_cursor* cur, sqlite3_context* ctx, int col)
+{
+    const auto* c = reinterpret_cast<MetricsCursor*>(cur);
+    const auto& row = c->rows[c->row];
+    const auto& column = c->column();
+
+    switch (col) {
+    case kTicker:
+        sqlite3_result_text(
+            ctx, row.ticker.c_str(), -1, SQLITE_TRANSIENT);
+        break;
+    case kPeriod: {
+        const auto& label = c->labels[c->row];
+        sqlite3_result_text(ctx, label.c_str(), -1, SQLITE_TRANSIENT);
+        break;
+    }
+    case kMetric:
+        sqlite3_result_text(ctx, column.name, -1, SQLITE_STATIC);
+        break;
+    case kValue:
+        sqlite3_result_double(
+            ctx, *c->table.metric_value(c->metric_index(), c->row));
+        break;
+    case kYoyChange: {
+        const auto change = c->table.metric_change(c->metric_index(), c->row);
+        if (change)
+            sqlite3_result_double(ctx, *change);
+        else
+            sqlite3_result_null(ctx);
+        break;
+    }
+    default:
+        sqlite3_result_null(ctx);
+        break;
+    }
+    return SQLITE_OK;
+}
+
+int vt_rowid(sqlite3_vtab_cursor* cur, sqlite3_int64* out)
+{
+    *out = reinterpret_cast<MetricsCursor*>(cur)->rowid;
+    return SQLITE_OK;
+}
+
+// read-only, so the write, transaction and rename hooks stay null
+const sqlite3_module kModule = [] {
+    sqlite3_module m{};
+    m.iVersion = 0;
+    m.xCreate = vt_connect;
+    m.xConnect = vt_connect;
+    m.xBestIndex = vt_best_index;
+    m.xDisconnect = vt_disconnect;
+    m.xDestroy = vt_disconnect;
+    m.xOpen = vt_open;
+    m.xClose = vt_close;
+    m.xFilter = vt_filter;
+    m.xNext = vt_next;
+    m.xEof = vt_eof;
+    m.xColumn = vt_column;
+    m.xRowid = vt_rowid;
+    return m;
+}();
+
+} // namespace
+
+void register_metrics_vtab(sqlite3* db)
+{
+    if (sqlite3_create_module_v2(
+            db, "intrinsic_metrics", &kModule, nullptr, nullptr) !=
+        SQLITE_OK) {
+        db::detail::throw_sqlite(db, "register intrinsic_metrics failed");
+    }
+}
+
+} // namespace db
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <sqlite3.h>
+
+namespace db {
+
+// Registers the read-only intrinsic_metrics virtual table module. It streams
+// one row per non-NULL derived metric of every finances period, computed on
+// the fly by metrics::derive_finance_metrics():
+//
+//   ticker TEXT, period TEXT ("2024-Q4"), metric TEXT, value REAL,
+//   yoy_change REAL (percent vs the same period a year earlier)
+//
+// Equality constraints on ticker, period and metric are pushed down, so
+//
+//   SELECT * FROM intrinsic_metrics WHERE ticker = 'ACME' AND metric = 'roe'
+//
+// decodes a single ticker. The module is eponymous and needs no
+// CREATE VIRTUAL TABLE, though `CREATE VIRTUAL TABLE temp.metrics USING
+// intrinsic_metrics` also works. Nothing is written to the database file, so
+// it stays readable without this module. Throws on failure.
+void register_metrics_vtab(sqlite3* db);
+
+} // namespace db
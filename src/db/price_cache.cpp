@@ -0,0 +1,136 @@
+#include "db/price_cache.hpp"
+
+#include <utility>
+
+namespace db {
+
+std::size_t PriceCache::entry_bytes_(const std::string& ticker,
+                                     const PriceSeries& series)
+{
+    // lru node, map node and the two key copies
+    return series.bytes() + 2 * (ticker.size() + sizeof(std::string)) + 64;
+}
+
+void PriceCache::set_budget_bytes(std::size_t bytes)
+{
+    budget_bytes_ = bytes;
+    evict_to_(budget_bytes_);
+}
+
+PriceCache::SeriesPtr
+PriceCache::load(Database& db, const std::string& ticker, std::string* err)
+{
+    const std::uint64_t generation = db.price_generation();
+
+    const auto it = entries_.find(ticker);
+    if (it != entries_.end()) {
+        if (it->second.generation == generation) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            ++hits_;
+            return it->second.series;
+        }
+        erase(ticker);
+    }
+
+    ++misses_;
+
+    std::string local_err;
+    const auto points = db.get_prices(ticker, &local_err);
+    if (!local_err.empty()) {
+        if (err) *err = local_err;
+        return nullptr;
+    }
+
+    auto series = std::make_shared<const PriceSeries>(
+        PriceSeries::encode(points));
+
+    const std::size_t bytes = entry_bytes_(ticker, *series);
+
+    // too big to ever fit -> serve it uncached
+    if (bytes > budget_bytes_) return series;
+
+    evict_to_(budget_bytes_ - bytes);
+    lru_.push_front(ticker);
+    entries_.emplace(ticker, Entry{series, generation, bytes, lru_.begin()});
+    bytes_ += bytes;
+    return series;
+}
+
+bool PriceCache::apply(Database& db,
+                       const std::string& ticker,
+                       const std::vector<Database::PricePoint>& points,
+                       std::string* err)
+{
+    const std::uint64_t before = db.price_generation();
+    if (!db.add_prices(ticker, points, err)) return false;
+    const std::uint64_t after = db.price_generation();
+
+    for (auto& [key, entry] : entries_) {
+        if (key != ticker && entry.generation == before) {
+            entry.generation = after;
+        }
+    }
+
+    const auto it = entries_.find(ticker);
+    if (it == entries_.end()) return true;
+    if (it->second.generation != before) {
+        erase(ticker);
+        return true;
+    }
+
+    // copy on write: views may still hold the old series
+    auto next = std::make_shared<PriceSeries>(*it->second.series);
+    for (const auto& p : points) {
+        if (!next->upsert_latest(p)) {
+            erase(ticker); // back-filled history -> reload on next use
+            return true;
+        }
+    }
+
+    bytes_ -= it->second.bytes;
+    it->second.series = std::move(next);
+    it->second.generation = after;
+    it->second.bytes = entry_bytes_(ticker, *it->second.series);
+    bytes_ += it->second.bytes;
+    evict_to_(budget_bytes_);
+    return true;
+}
+
+void PriceCache::carry_over(std::uint64_t from,
+                            std::uint64_t to,
+                            const std::vector<std::string>& changed)
+{
+    for (const auto& ticker : changed) {
+        erase(ticker);
+    }
+    for (auto& [ticker, entry] : entries_) {
+        if (entry.generation == from) entry.generation = to;
+    }
+}
+
+void PriceCache::erase(const std::string& ticker)
+{
+    const auto it = entries_.find(ticker);
+    if (it == entries_.end()) return;
+
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+void PriceCache::clear()
+{
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+void PriceCache::evict_to_(std::size_t budget)
+{
+    while (bytes_ > budget && !lru_.empty()) {
+        const std::string victim = lru_.back();
+        erase(victim);
+    }
+}
+
+} // namespace db
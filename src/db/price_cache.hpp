@@ -0,0 +1,79 @@
+#pragma once
+
+#include "db/database.hpp"
+#include "db/price_series.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace db {
+
+// Compressed price series of recently used tickers, least-recently-used
+// ordered under a byte budget like HistoryCache. Entries are served while
+// Database::price_generation() matches the one they were loaded at.
+// Tickers without prices are cached too, as empty series, so views can ask
+// on every frame.
+class PriceCache {
+public:
+    static constexpr std::size_t kDefaultBudgetMb = 32;
+
+    using SeriesPtr = std::shared_ptr<const PriceSeries>;
+
+    // 0 disables caching; load() then always reads from sqlite.
+    void set_budget_bytes(std::size_t bytes);
+    std::size_t budget_bytes() const { return budget_bytes_; }
+
+    std::size_t bytes() const { return bytes_; }
+    std::size_t size() const { return entries_.size(); }
+    std::uint64_t hits() const { return hits_; }
+    std::uint64_t misses() const { return misses_; }
+
+    // Cached series when current, otherwise read from `db` and cached.
+    // Null on read failure (then *err is set).
+    SeriesPtr
+    load(Database& db, const std::string& ticker, std::string* err = nullptr);
+
+    // Writes `points` of `ticker` through to `db` and patches its cached
+    // series in place of a reload. Every other entry that was current stays
+    // current: the write touched nothing else.
+    bool apply(Database& db,
+               const std::string& ticker,
+               const std::vector<Database::PricePoint>& points,
+               std::string* err = nullptr);
+
+    // Same as HistoryCache::carry_over(), for price generations.
+    void carry_over(std::uint64_t from,
+                    std::uint64_t to,
+                    const std::vector<std::string>& changed);
+
+    void erase(const std::string& ticker);
+    void clear();
+
+private:
+    struct Entry {
+        SeriesPtr series;
+        std::uint64_t generation = 0;
+        std::size_t bytes = 0;
+        std::list<std::string>::iterator lru;
+    };
+
+    static std::size_t entry_bytes_(const std::string& ticker,
+                                    const PriceSeries& series);
+    void evict_to_(std::size_t budget);
+
+private:
+    std::size_t budget_bytes_{kDefaultBudgetMb << 20};
+    std::size_t bytes_{0};
+    std::uint64_t hits_{0};
+    std::uint64_t misses_{0};
+
+    std::list<std::string> lru_; // front = most recently used
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace db
@@ -0,0 +1,243 @@
+#include "db/price_feed.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace db {
+
+static bool fill_address(const std::filesystem::path& path,
+                         sockaddr_un& addr,
+                         std::string* err)
+{
+    const std::string text = path.string();
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (text.empty() || text.size() >= sizeof(addr.sun_path)) {
+        if (err) *err = "price feed path too long: " + text;
+        return false;
+    }
+    std::memcpy(addr.sun_path, text.c_str(), text.size() + 1);
+    return true;
+}
+
+static bool set_nonblocking(int fd)
+{
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// True when a live session accepts connections on `addr`.
+static bool socket_in_use(const sockaddr_un& addr)
+{
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    const bool live =
+        ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) ==
+        0;
+    ::close(fd);
+    return live;
+}
+
+PriceFeed::~PriceFeed()
+{
+    close();
+}
+
+bool PriceFeed::open(const std::filesystem::path& path, std::string* err)
+{
+    close();
+
+    sockaddr_un addr{};
+    if (!fill_address(path, addr, err)) return false;
+    if (socket_in_use(addr)) {
+        if (err) *err = "price feed already served at " + path.string();
+        return false;
+    }
+    ::unlink(addr.sun_path); // stale file of a session that died
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        if (err) *err = std::string("price feed: ") + std::strerror(errno);
+        return false;
+    }
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) !=
+            0 ||
+        ::chmod(addr.sun_path, S_IRUSR | S_IWUSR) != 0 ||
+        ::listen(fd, static_cast<int>(kMaxFeeders)) != 0 ||
+        !set_nonblocking(fd)) {
+        if (err) *err = "price feed " + path.string() + ": " +
+                        std::strerror(errno);
+        ::close(fd);
+        ::unlink(addr.sun_path);
+        return false;
+    }
+
+    listen_fd_ = fd;
+    path_ = path;
+    return true;
+}
+
+void PriceFeed::close()
+{
+    for (auto& feeder : feeders_) ::close(feeder.fd);
+    feeders_.clear();
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+    path_.clear();
+}
+
+bool PriceFeed::wait(int input_fd, int timeout_ms)
+{
+    std::vector<pollfd> fds;
+    fds.reserve(feeders_.size() + 2);
+    fds.push_back({input_fd, POLLIN, 0});
+    fds.push_back({listen_fd_, POLLIN, 0}); // negative fds are skipped
+    for (const auto& feeder : feeders_) fds.push_back({feeder.fd, POLLIN, 0});
+
+    const int ready =
+        ::poll(fds.data(), static_cast<nfds_t>(fds.size()), timeout_ms);
+    if (ready <= 0) return false; // timeout, or a signal to handle
+
+    // feeders first, by index, before accepting shifts them
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < feeders_.size(); ++i) {
+        const bool keep =
+            fds[2 + i].revents == 0 || read_feeder_(feeders_[i]);
+        if (keep) {
+            feeders_[next++] = std::move(feeders_[i]);
+        }
+        else {
+            ::close(feeders_[i].fd);
+        }
+    }
+    feeders_.resize(next);
+
+    if (fds[1].revents & POLLIN) accept_feeders_();
+    return (fds[0].revents & (POLLIN | POLLHUP)) != 0;
+}
+
+std::vector<PriceFeed::Quote> PriceFeed::take_quotes()
+{
+    return std::exchange(quotes_, {});
+}
+
+std::optional<PriceFeed::Quote> PriceFeed::parse_line(std::string_view line)
+{
+    const auto is_space = [](char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    };
+    const auto skip_space = [&](std::size_t i) {
+        while (i < line.size() && is_space(line[i])) ++i;
+        return i;
+    };
+    const auto word_end = [&](std::size_t i) {
+        while (i < line.size() && !is_space(line[i])) ++i;
+        return i;
+    };
+
+    const std::size_t ticker_at = skip_space(0);
+    const std::size_t ticker_end = word_end(ticker_at);
+    const std::size_t price_at = skip_space(ticker_end);
+    const std::size_t price_end = word_end(price_at);
+    if (ticker_at == ticker_end || price_at == price_end ||
+        skip_space(price_end) != line.size()) {
+        return std::nullopt;
+    }
+
+    const std::string price_text(line.substr(price_at, price_end - price_at));
+    char* end = nullptr;
+    errno = 0;
+    const double price = std::strtod(price_text.c_str(), &end);
+    if (errno != 0 || end != price_text.c_str() + price_text.size() ||
+        !std::isfinite(price) || price <= 0.0) {
+        return std::nullopt;
+    }
+
+    Quote quote;
+    quote.ticker = std::string(line.substr(ticker_at, ticker_end - ticker_at));
+    for (char& c : quote.ticker) {
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    }
+    quote.price = price;
+    return quote;
+}
+
+void PriceFeed::accept_feeders_()
+{
+    while (true) {
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN once the backlog is empty
+        if (feeders_.size() >= kMaxFeeders || !set_nonblocking(fd)) {
+            ::close(fd);
+            continue;
+        }
+        feeders_.push_back({fd, {}, false});
+    }
+}
+
+bool PriceFeed::read_feeder_(Feeder& feeder)
+{
+    char buf[4096];
+    while (true) {
+        const ssize_t n = ::read(feeder.fd, buf, sizeof(buf));
+        if (n == 0) {
+            // a last line without a newline still counts
+            if (!feeder.overflowed && !feeder.pending.empty()) {
+                take_line_(feeder.pending);
+            }
+            return false;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        for (ssize_t i = 0; i < n; ++i) {
+            const char c = buf[i];
+            if (c == '\n') {
+                if (feeder.overflowed) {
+                    ++rejected_;
+                }
+                else {
+                    take_line_(feeder.pending);
+                }
+                feeder.pending.clear();
+                feeder.overflowed = false;
+            }
+            else if (feeder.pending.size() < kMaxLineBytes) {
+                feeder.pending.push_back(c);
+            }
+            else {
+                feeder.overflowed = true;
+            }
+        }
+    }
+}
+
+void PriceFeed::take_line_(std::string_view line)
+{
+    if (line.find_first_not_of(" \t\r") == std::string_view::npos) return;
+    auto quote = parse_line(line);
+    if (!quote.has_value()) {
+        ++rejected_;
+        return;
+    }
+    ++accepted_;
+    quotes_.push_back(std::move(*quote));
+}
+
+} // namespace db
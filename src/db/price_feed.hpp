@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace db {
+
+// Unix domain socket local tools push `TICKER PRICE` lines into, one quote
+// per line. The UI loop waits on it together with the terminal, so quotes
+// land as they arrive rather than on the next keystroke. Malformed lines
+// are counted and dropped; a feeder may stay connected or write and go.
+class PriceFeed {
+public:
+    struct Quote {
+        std::string ticker; // upper-cased
+        double price = 0.0;
+    };
+
+    static constexpr std::size_t kMaxFeeders = 16;
+    static constexpr std::size_t kMaxLineBytes = 256;
+
+    PriceFeed() = default;
+    ~PriceFeed();
+
+    PriceFeed(const PriceFeed&) = delete;
+    PriceFeed& operator=(const PriceFeed&) = delete;
+
+    // Listens on `path`, replacing a stale socket file. Fails when another
+    // session is listening there.
+    bool open(const std::filesystem::path& path, std::string* err = nullptr);
+    void close();
+
+    bool is_open() const { return listen_fd_ >= 0; }
+    const std::filesystem::path& path() const { return path_; }
+
+    // Blocks up to `timeout_ms` until `input_fd` is readable or quotes
+    // arrive, accepting feeders and reading their lines meanwhile. True
+    // when `input_fd` is readable.
+    bool wait(int input_fd, int timeout_ms);
+
+    // Quotes read since the last call, oldest first.
+    std::vector<Quote> take_quotes();
+
+    std::uint64_t accepted() const { return accepted_; }
+    std::uint64_t rejected() const { return rejected_; }
+
+    // `TICKER PRICE` with a positive, finite price.
+    static std::optional<Quote> parse_line(std::string_view line);
+
+private:
+    struct Feeder {
+        int fd = -1;
+        std::string pending; // bytes after the last newline
+        bool overflowed = false;
+    };
+
+    void accept_feeders_();
+    // False once the feeder hung up or failed.
+    bool read_feeder_(Feeder& feeder);
+    void take_line_(std::string_view line);
+
+private:
+    int listen_fd_ = -1;
+    std::filesystem::path path_;
+    std::vector<Feeder> feeders_;
+    std::vector<Quote> quotes_;
+    std::uint64_t accepted_ = 0;
+    std::uint64_t rejected_ = 0;
+};
+
+} // namespace db
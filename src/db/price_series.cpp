@@ -0,0 +1,333 @@
+#include "db/price_series.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <limits>
+
+namespace db {
+
+// *
+// **
+// ***
+// ****
+// ***** DATES
+
+std::int32_t days_from_civil(int year, unsigned month, unsigned day)
+{
+    // H. Hinnant's days_from_civil: years start in March so the leap day
+    // is the last of the year
+    year -= month <= 2 ? 1 : 0;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 +
+                         day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return static_cast<std::int32_t>(era * 146097 +
+                                     static_cast<int>(doe) - 719468);
+}
+
+static bool is_leap_year(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static unsigned days_in_month(int year, unsigned month)
+{
+    static constexpr unsigned kDays[] = {
+        31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && is_leap_year(year)) return 29;
+    return kDays[month - 1];
+}
+
+std::optional<std::int32_t> parse_iso_day(std::string_view text)
+{
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') {
+        return std::nullopt;
+    }
+
+    const auto digits = [&](std::size_t from, std::size_t count) {
+        int v = 0;
+        for (std::size_t i = from; i < from + count; ++i) {
+            if (text[i] < '0' || text[i] > '9') return -1;
+            v = v * 10 + (text[i] - '0');
+        }
+        return v;
+    };
+
+    const int year = digits(0, 4);
+    const int month = digits(5, 2);
+    const int day = digits(8, 2);
+    if (year < 0 || month < 1 || month > 12 || day < 1) return std::nullopt;
+    if (static_cast<unsigned>(day) >
+        days_in_month(year, static_cast<unsigned>(month))) {
+        return std::nullopt;
+    }
+    return days_from_civil(
+        year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+}
+
+std::string format_iso_day(std::int32_t day)
+{
+    // inverse of days_from_civil
+    const int z = day + 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe =
+        (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    const int y = static_cast<int>(yoe) + era * 400 + (m <= 2 ? 1 : 0);
+
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%04d-%02u-%02u", y, m, d);
+    return buf;
+}
+
+std::int32_t local_today()
+{
+    const std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    return days_from_civil(local.tm_year + 1900,
+                           static_cast<unsigned>(local.tm_mon + 1),
+                           static_cast<unsigned>(local.tm_mday));
+}
+
+std::optional<std::int32_t> period_end_day(int year,
+                                           std::string_view period_type)
+{
+    unsigned month = 0;
+    if (period_type == "Y" || period_type == "Q4" || period_type == "S2") {
+        month = 12;
+    }
+    else if (period_type == "Q1") {
+        month = 3;
+    }
+    else if (period_type == "Q2" || period_type == "S1") {
+        month = 6;
+    }
+    else if (period_type == "Q3") {
+        month = 9;
+    }
+    else {
+        return std::nullopt;
+    }
+    return days_from_civil(year, month, days_in_month(year, month));
+}
+
+// *
+// **
+// ***
+// ****
+// ***** SERIES
+
+static void put_varint(std::vector<std::uint8_t>& out, std::int64_t v)
+{
+    // zigzag keeps small negative deltas small
+    std::uint64_t u = (static_cast<std::uint64_t>(v) << 1) ^
+                      static_cast<std::uint64_t>(v >> 63);
+    while (u >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(u | 0x80));
+        u >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(u));
+}
+
+static std::int64_t get_varint(const std::uint8_t*& p)
+{
+    std::uint64_t u = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+        u |= static_cast<std::uint64_t>(*p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    u |= static_cast<std::uint64_t>(*p++) << shift;
+    return static_cast<std::int64_t>(u >> 1) ^
+           -static_cast<std::int64_t>(u & 1);
+}
+
+static std::int64_t to_ticks(double close)
+{
+    return std::llround(close *
+                        static_cast<double>(PriceSeries::kTicksPerUnit));
+}
+
+static double from_ticks(std::int64_t ticks)
+{
+    return static_cast<double>(ticks) /
+           static_cast<double>(PriceSeries::kTicksPerUnit);
+}
+
+PriceSeries PriceSeries::encode(const std::vector<Point>& points)
+{
+    PriceSeries out;
+    out.size_ = points.size();
+    if (points.empty()) return out;
+
+    out.blocks_.reserve((points.size() + kBlockPoints - 1) / kBlockPoints);
+    out.data_.reserve(points.size() * 4);
+
+    std::int32_t prev_day = 0;
+    std::int64_t prev_ticks = 0;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const std::int64_t ticks = to_ticks(points[i].close);
+        if (i % kBlockPoints == 0) {
+            out.blocks_.push_back(
+                {points[i].day,
+                 ticks,
+                 static_cast<std::uint32_t>(out.data_.size())});
+        }
+        else {
+            out.last_offset_ = out.data_.size();
+            put_varint(out.data_,
+                       static_cast<std::int64_t>(points[i].day) - prev_day);
+            put_varint(out.data_, ticks - prev_ticks);
+        }
+        prev_day = points[i].day;
+        prev_ticks = ticks;
+    }
+
+    out.data_.shrink_to_fit();
+    out.last_ = {prev_day, from_ticks(prev_ticks)};
+    out.last_ticks_ = prev_ticks;
+    return out;
+}
+
+bool PriceSeries::upsert_latest(const Point& p)
+{
+    const std::int64_t ticks = to_ticks(p.close);
+    const bool heads_block = size_ % kBlockPoints == 1;
+
+    if (size_ > 0 && p.day == last_.day) {
+        if (heads_block) {
+            blocks_.back().first_ticks = ticks;
+        }
+        else {
+            // re-encode the latest deltas against the point before it
+            const std::uint8_t* cursor = data_.data() + last_offset_;
+            const std::int64_t day_delta = get_varint(cursor);
+            const std::int64_t prev_ticks = last_ticks_ - get_varint(cursor);
+            data_.resize(last_offset_);
+            put_varint(data_, day_delta);
+            put_varint(data_, ticks - prev_ticks);
+        }
+    }
+    else if (size_ == 0 || p.day > last_.day) {
+        if (size_ % kBlockPoints == 0) {
+            blocks_.push_back(
+                {p.day, ticks, static_cast<std::uint32_t>(data_.size())});
+        }
+        else {
+            last_offset_ = data_.size();
+            put_varint(data_, static_cast<std::int64_t>(p.day) - last_.day);
+            put_varint(data_, ticks - last_ticks_);
+        }
+        ++size_;
+    }
+    else {
+        return false;
+    }
+
+    last_ = {p.day, from_ticks(ticks)};
+    last_ticks_ = ticks;
+    return true;
+}
+
+std::size_t PriceSeries::bytes() const
+{
+    return sizeof(PriceSeries) + blocks_.capacity() * sizeof(Block) +
+           data_.capacity();
+}
+
+template <class Fn> void PriceSeries::walk_block_(std::size_t b, Fn&& fn) const
+{
+    const Block& block = blocks_[b];
+    const std::size_t count =
+        std::min(kBlockPoints, size_ - b * kBlockPoints);
+
+    Point p{block.first_day, from_ticks(block.first_ticks)};
+    if (!fn(p)) return;
+
+    std::int32_t day = block.first_day;
+    std::int64_t ticks = block.first_ticks;
+    const std::uint8_t* cursor = data_.data() + block.offset;
+    for (std::size_t i = 1; i < count; ++i) {
+        day += static_cast<std::int32_t>(get_varint(cursor));
+        ticks += get_varint(cursor);
+        if (!fn(Point{day, from_ticks(ticks)})) return;
+    }
+}
+
+std::optional<PriceSeries::Point> PriceSeries::latest() const
+{
+    if (size_ == 0) return std::nullopt;
+    return last_;
+}
+
+std::optional<PriceSeries::Point>
+PriceSeries::at_or_before(std::int32_t day) const
+{
+    if (size_ == 0 || day < blocks_.front().first_day) return std::nullopt;
+    if (day >= last_.day) return last_;
+
+    // last block starting on or before `day`
+    const auto it = std::upper_bound(
+        blocks_.begin(),
+        blocks_.end(),
+        day,
+        [](std::int32_t d, const Block& b) { return d < b.first_day; });
+    const auto b = static_cast<std::size_t>(it - blocks_.begin()) - 1;
+
+    Point found{};
+    walk_block_(b, [&](const Point& p) {
+        if (p.day > day) return false;
+        found = p;
+        return true;
+    });
+    return found;
+}
+
+std::vector<PriceSeries::Point> PriceSeries::range(std::int32_t from,
+                                                   std::int32_t to) const
+{
+    std::vector<Point> out;
+    if (size_ == 0 || from > to || to < blocks_.front().first_day ||
+        from > last_.day) {
+        return out;
+    }
+
+    // the block holding `from` may start before it
+    auto it = std::upper_bound(
+        blocks_.begin(),
+        blocks_.end(),
+        from,
+        [](std::int32_t d, const Block& b) { return d < b.first_day; });
+    if (it != blocks_.begin()) --it;
+
+    bool done = false;
+    for (auto b = static_cast<std::size_t>(it - blocks_.begin());
+         b < blocks_.size() && !done;
+         ++b) {
+        walk_block_(b, [&](const Point& p) {
+            if (p.day > to) {
+                done = true;
+                return false;
+            }
+            if (p.day >= from) out.push_back(p);
+            return true;
+        });
+    }
+    return out;
+}
+
+std::vector<PriceSeries::Point> PriceSeries::decode() const
+{
+    return range(std::numeric_limits<std::int32_t>::min(),
+                 std::numeric_limits<std::int32_t>::max());
+}
+
+} // namespace db
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "db/database.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace db {
+
+// *
+// **
+// ***
+// ****
+// ***** DATES
+
+// Days since 1970-01-01 of a proleptic Gregorian date.
+std::int32_t days_from_civil(int year, unsigned month, unsigned day);
+
+// YYYY-MM-DD, or nullopt when it is not a real date.
+std::optional<std::int32_t> parse_iso_day(std::string_view text);
+std::string format_iso_day(std::int32_t day);
+
+// Today in the local time zone.
+std::int32_t local_today();
+
+// Last calendar day a period covers: Y/Q4/S2 end Dec 31, Q1 Mar 31,
+// Q2/S1 Jun 30, Q3 Sep 30. Nullopt for other period types.
+std::optional<std::int32_t> period_end_day(int year,
+                                           std::string_view period_type);
+
+// *
+// **
+// ***
+// ****
+// ***** SERIES
+
+// Daily closes of one ticker, delta-encoded. Closes are kept as fixed-point
+// ticks of 1 / kTicksPerUnit, and each point after the first of a block of
+// kBlockPoints stores only zigzag varints of its day and tick deltas, which
+// for daily data is 3-4 bytes a point instead of 16. Block heads keep their
+// absolute values, so a lookup binary-searches the heads and decodes at
+// most one block.
+class PriceSeries {
+public:
+    using Point = Database::PricePoint;
+
+    static constexpr std::int64_t kTicksPerUnit = 10000;
+    static constexpr std::size_t kBlockPoints = 128;
+
+    PriceSeries() = default;
+
+    // `points` must be ordered by day with no repeats.
+    static PriceSeries encode(const std::vector<Point>& points);
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    // estimated footprint
+    std::size_t bytes() const;
+
+    std::optional<Point> latest() const;
+    // Newest point on or before `day`.
+    std::optional<Point> at_or_before(std::int32_t day) const;
+    // Points with from <= day <= to, oldest first.
+    std::vector<Point> range(std::int32_t from, std::int32_t to) const;
+    std::vector<Point> decode() const;
+
+    // Appends `p` when it is newer than the latest point, or replaces the
+    // latest close when it is the same day, without re-encoding the rest.
+    // False for older days; the series is then unchanged.
+    bool upsert_latest(const Point& p);
+
+private:
+    struct Block {
+        std::int32_t first_day = 0;
+        std::int64_t first_ticks = 0;
+        std::uint32_t offset = 0; // of the second point in data_
+    };
+
+    // Calls fn(point) for every point of block `b` until it returns false.
+    template <class Fn> void walk_block_(std::size_t b, Fn&& fn) const;
+
+private:
+    std::vector<Block> blocks_;
+    std::vector<std::uint8_t> data_;
+    std::size_t size_ = 0;
+    Point last_{};
+    std::int64_t last_ticks_ = 0;
+    // where the latest point's deltas start in data_, unless it heads a
+    // block
+    std::size_t last_offset_ = 0;
+};
+
+} // namespace db
@@ -0,0 +1,272 @@
+#include "db/sql_functions.hpp"
+#include "db/sql_helpers.hpp"
+#include "metrics/metric_math.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <new>
+#include <optional>
+#include <string_view>
+
+namespace db {
+
+// *
+// **
+// ***
+// ****
+// ***** VALUES
+
+static std::optional<double> arg_f64(sqlite3_value* v)
+{
+    switch (sqlite3_value_numeric_type(v)) {
+    case SQLITE_INTEGER:
+        return static_cast<double>(sqlite3_value_int64(v));
+    case SQLITE_FLOAT:
+        return sqlite3_value_double(v);
+    default:
+        return std::nullopt;
+    }
+}
+
+static std::optional<std::int64_t> arg_i64(sqlite3_value* v)
+{
+    switch (sqlite3_value_numeric_type(v)) {
+    case SQLITE_INTEGER:
+        return sqlite3_value_int64(v);
+    case SQLITE_FLOAT: {
+        const double d = sqlite3_value_double(v);
+        if (!std::isfinite(d) || d != std::trunc(d)) return std::nullopt;
+        if (std::fabs(d) >= 9.2e18) return std::nullopt;
+        return static_cast<std::int64_t>(d);
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
+static void result_f64(sqlite3_context* ctx, std::optional<double> v)
+{
+    if (v.has_value() && std::isfinite(*v))
+        sqlite3_result_double(ctx, *v);
+    else
+        sqlite3_result_null(ctx);
+}
+
+static void result_i64(sqlite3_context* ctx, std::optional<std::int64_t> v)
+{
+    if (v.has_value())
+        sqlite3_result_int64(ctx, *v);
+    else
+        sqlite3_result_null(ctx);
+}
+
+// *
+// **
+// ***
+// ****
+// ***** SCALARS
+
+static void fn_div(sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+    result_f64(ctx,
+               metrics::div_opt_nonzero(arg_f64(argv[0]), arg_f64(argv[1])));
+}
+
+static void fn_pe(sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+    const auto price = metrics::null_if_zero_or_invalid(arg_f64(argv[0]));
+    result_f64(ctx, metrics::div_opt_nonzero(price, arg_f64(argv[1])));
+}
+
+static void fn_pb(sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+    const auto price = metrics::null_if_zero_or_invalid(arg_f64(argv[0]));
+    const auto per_share =
+        metrics::div_opt_nonzero(arg_f64(argv[1]), arg_f64(argv[2]));
+    result_f64(ctx, metrics::div_opt_nonzero(price, per_share));
+}
+
+static void fn_shares(sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+    result_f64(ctx,
+               metrics::approx_shares(arg_f64(argv[0]), arg_f64(argv[1])));
+}
+
+static void fn_equity(sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+    // integer columns stay exact unless the difference would overflow
+    if (sqlite3_value_numeric_type(argv[0]) == SQLITE_INTEGER &&
+        sqlite3_value_numeric_type(argv[1]) == SQLITE_INTEGER) {
+        using Limits = std::numeric_limits<std::int64_t>;
+        const std::int64_t a = sqlite3_value_int64(argv[0]);
+        const std::int64_t b = sqlite3_value_int64(argv[1]);
+        if ((b >= 0 && a >= Limits::min() + b) ||
+            (b < 0 && a <= Limits::max() + b)) {
+            result_i64(ctx, metrics::sub_i64(a, b));
+            return;
+        }
+    }
+
+    const auto assets = arg_f64(argv[0]);
+    const auto liabilities = arg_f64(argv[1]);
+    if (!assets.has_value() || !liabilities.has_value()) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    result_f64(ctx, *assets - *liabilities);
+}
+
+static void
+fn_underwriting_expenses(sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+    result_i64(ctx,
+               metrics::derive_underwriting_expenses(arg_i64(argv[0]),
+                                                     arg_i64(argv[1]),
+                                                     arg_i64(argv[2]),
+                                                     arg_i64(argv[3])));
+}
+
+static void fn_combined_ratio(sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+    result_f64(ctx,
+               metrics::combined_ratio(
+                   arg_f64(argv[0]), arg_f64(argv[1]), arg_f64(argv[2])));
+}
+
+// *
+// **
+// ***
+// ****
+// ***** TTM WINDOW
+
+// Rows currently in the frame, oldest first. The aggregate context only
+// holds a pointer to it, since sqlite hands out zeroed raw memory.
+struct TtmFrame {
+    struct Entry {
+        char family = '\0';
+        std::optional<double> value;
+    };
+    std::deque<Entry> entries;
+};
+
+static TtmFrame* ttm_frame(sqlite3_context* ctx, bool create)
+{
+    auto** slot = static_cast<TtmFrame**>(
+        sqlite3_aggregate_context(ctx, create ? sizeof(TtmFrame*) : 0));
+    if (!slot) {
+        if (create) sqlite3_result_error_nomem(ctx);
+        return nullptr;
+    }
+    if (!*slot && create) {
+        *slot = new (std::nothrow) TtmFrame();
+        if (!*slot) sqlite3_result_error_nomem(ctx);
+    }
+    return *slot;
+}
+
+static void ttm_step(sqlite3_context* ctx, int, sqlite3_value** argv)
+{
+    auto* frame = ttm_frame(ctx, true);
+    if (!frame) return;
+
+    const unsigned char* text = sqlite3_value_text(argv[1]);
+    const std::string_view period_type =
+        text ? reinterpret_cast<const char*>(text) : "";
+    frame->entries.push_back(
+        {metrics::period_type_family(period_type), arg_f64(argv[0])});
+}
+
+static void ttm_inverse(sqlite3_context* ctx, int, sqlite3_value**)
+{
+    auto* frame = ttm_frame(ctx, false);
+    if (frame && !frame->entries.empty()) frame->entries.pop_front();
+}
+
+static void ttm_result(sqlite3_context* ctx, const TtmFrame* frame)
+{
+    if (!frame || frame->entries.empty()) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    const auto& entries = frame->entries;
+    const char family = entries.back().family;
+    result_f64(ctx,
+               metrics::ttm_sum_backwards(
+                   static_cast<int>(entries.size()) - 1,
+                   family,
+                   metrics::ttm_window_for_family(family),
+                   [&](int i) { return entries[i].family; },
+                   [&](int i) { return entries[i].value; }));
+}
+
+static void ttm_value(sqlite3_context* ctx)
+{
+    ttm_result(ctx, ttm_frame(ctx, false));
+}
+
+static void ttm_final(sqlite3_context* ctx)
+{
+    auto* frame = ttm_frame(ctx, false);
+    ttm_result(ctx, frame);
+    delete frame;
+}
+
+// *
+// **
+// ***
+// ****
+// ***** REGISTRATION
+
+void register_sql_functions(sqlite3* db)
+{
+    struct Scalar {
+        const char* name;
+        int args;
+        void (*fn)(sqlite3_context*, int, sqlite3_value**);
+    };
+
+    static constexpr Scalar kScalars[] = {
+        {"intrinsic_div", 2, fn_div},
+        {"intrinsic_pe", 2, fn_pe},
+        {"intrinsic_pb", 3, fn_pb},
+        {"intrinsic_shares", 2, fn_shares},
+        {"intrinsic_equity", 2, fn_equity},
+        {"intrinsic_underwriting_expenses", 4, fn_underwriting_expenses},
+        {"intrinsic_combined_ratio", 3, fn_combined_ratio},
+    };
+
+    constexpr int kFlags =
+        SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
+
+    for (const auto& f : kScalars) {
+        if (sqlite3_create_function_v2(db,
+                                       f.name,
+                                       f.args,
+                                       kFlags,
+                                       nullptr,
+                                       f.fn,
+                                       nullptr,
+                                       nullptr,
+                                       nullptr) != SQLITE_OK) {
+            db::detail::throw_sqlite(db, "register sql function failed");
+        }
+    }
+
+    if (sqlite3_create_window_function(db,
+                                       "intrinsic_ttm",
+                                       2,
+                                       kFlags,
+                                       nullptr,
+                                       ttm_step,
+                                       ttm_final,
+                                       ttm_value,
+                                       ttm_inverse,
+                                       nullptr) != SQLITE_OK) {
+        db::detail::throw_sqlite(db, "register intrinsic_ttm failed");
+    }
+}
+
+} // namespace db
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <sqlite3.h>
+
+namespace db {
+
+// Registers the intrinsic_* SQL functions on `db` so screens and exports
+// can derive metrics inside a query. Each one wraps the metrics:: helper the
+// views use, so SQL and the ticker view always agree:
+//
+//   intrinsic_div(num, den)                    NULL on zero/NULL operands
+//   intrinsic_pe(price, eps)
+//   intrinsic_pb(price, equity, shares)
+//   intrinsic_shares(net_income, eps)          rounded
+//   intrinsic_equity(assets, liabilities)
+//   intrinsic_underwriting_expenses(total_expenses, claims_incurred,
+//                                   interest_expenses, reported)
+//   intrinsic_combined_ratio(claims, underwriting_expenses, premiums)
+//   intrinsic_ttm(value, period_type)          aggregate / window function
+//
+// intrinsic_ttm sums the trailing window (4 quarters, 2 halves) of the
+// current row's period family, e.g.
+//
+//   intrinsic_ttm(eps, period_type) OVER (PARTITION BY ticker
+//                                         ORDER BY year, period_type)
+//
+// and is NULL for yearly rows or windows with a gap. Throws on failure.
+void register_sql_functions(sqlite3* db);
+
+} // namespace db
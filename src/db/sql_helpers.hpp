@@ -1,5 +1,8 @@
 #pragma once
 #include <sqlite3.h>
+
+#include "db/database.hpp"
+
 #include <stdexcept>
 #include <string>
 
@@ -21,6 +24,9 @@ inline void exec_sql(sqlite3* db, const char* sql)
     throw std::runtime_error(std::string(ctx) + ": " + sqlite3_errmsg(db));
 }
 
+// Defined with the finances queries; `st` must be a kSelectFinances row.
+Database::FinanceRow read_finance_row(sqlite3_stmt* st);
+
 } // namespace db::detail
 
 
@@ -0,0 +1,634 @@
+#include "db/ticker_index.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace db {
+
+static constexpr std::uint32_t kNoSlot =
+    std::numeric_limits<std::uint32_t>::max();
+
+static constexpr std::size_t kNoPos = std::numeric_limits<std::size_t>::max();
+
+static char ascii_upper(char c)
+{
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// First occurrence of `needle` in hay[from, n), or kNoPos. The SSE2 path
+// tests 16 candidate positions per step by matching the needle's first and
+// last byte, and only memcmp()s the middle for positions where both hit.
+static std::size_t find_substring(const char* hay,
+                                  std::size_t n,
+                                  std::size_t from,
+                                  std::string_view needle)
+{
+    const std::size_t m = needle.size();
+    if (m == 0 || n < m || from > n - m) return kNoPos;
+
+    std::size_t i = from;
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(needle.front());
+    const __m128i last = _mm_set1_epi8(needle.back());
+
+    for (; i + (m - 1) + 16 <= n; i += 16) {
+        const __m128i block_first =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        const __m128i block_last = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(hay + i + m - 1));
+
+        const __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                           _mm_cmpeq_epi8(last, block_last));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        while (mask != 0) {
+            const auto bit = static_cast<std::size_t>(std::countr_zero(mask));
+            const char* at = hay + i + bit;
+            if (m <= 2 || std::memcmp(at + 1, needle.data() + 1, m - 2) == 0) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    const std::string_view tail{hay + i, n - i};
+    const std::size_t at = tail.find(needle);
+    return at == std::string_view::npos ? kNoPos : i + at;
+}
+
+// One bit per character class a ticker can hold; everything outside
+// [A-Z0-9.] shares the last bit. Used to reject typo candidates cheaply.
+static std::uint64_t char_bit(char c)
+{
+    if (c >= 'A' && c <= 'Z') return std::uint64_t{1} << (c - 'A');
+    if (c >= '0' && c <= '9') return std::uint64_t{1} << (26 + c - '0');
+    if (c == '.') return std::uint64_t{1} << 36;
+    return std::uint64_t{1} << 63;
+}
+
+static std::uint64_t char_mask(std::string_view s)
+{
+    std::uint64_t mask = 0;
+    for (const char c : s) mask |= char_bit(c);
+    return mask;
+}
+
+// Levenshtein distance <= 1, counting an adjacent swap as one edit.
+static bool within_one_edit(std::string_view a, std::string_view b)
+{
+    if (a.size() > b.size()) std::swap(a, b);
+    if (b.size() - a.size() > 1) return false;
+
+    std::size_t i = 0;
+    while (i < a.size() && a[i] == b[i]) ++i;
+    if (i == a.size()) return true; // equal, or one trailing insert
+
+    if (a.size() == b.size()) {
+        if (a.substr(i + 1) == b.substr(i + 1)) return true; // substitution
+        return i + 1 < a.size() && a[i] == b[i + 1] && a[i + 1] == b[i] &&
+               a.substr(i + 2) == b.substr(i + 2); // transposition
+    }
+    return a.substr(i) == b.substr(i + 1); // one insert
+}
+
+// Chars of `q` appear in `t` in order; returns the spanned width or -1.
+static int subsequence_span(std::string_view q, std::string_view t)
+{
+    std::size_t first = std::string_view::npos;
+    std::size_t at = 0;
+    for (const char c : q) {
+        const std::size_t hit = t.find(c, at);
+        if (hit == std::string_view::npos) return -1;
+        if (first == std::string_view::npos) first = hit;
+        at = hit + 1;
+    }
+    return static_cast<int>(at - first);
+}
+
+// *
+// **
+// ***
+// ****
+// ***** LOAD
+
+bool TickerIndex::ensure_loaded(Database& db, std::string* err)
+{
+    if (state_ == State::Ready) return true;
+    if (state_ == State::Disabled) return false;
+
+    std::string load_err;
+    // one extra row tells "exactly at the cap" from "over the cap"
+    auto rows = db.get_all_tickers(static_cast<int>(max_rows_ + 1), &load_err);
+    if (!load_err.empty()) {
+        if (err) *err = load_err;
+        return false;
+    }
+
+    reset();
+    if (rows.size() > max_rows_) {
+        state_ = State::Disabled;
+        return false;
+    }
+
+    std::size_t arena_bytes = 0;
+    for (const auto& row : rows) arena_bytes += row.ticker.size();
+    arena_.reserve(arena_bytes);
+    records_.reserve(rows.size());
+
+    for (const auto& row : rows) {
+        Record r;
+        r.ticker_off = static_cast<std::uint32_t>(arena_.size());
+        r.ticker_len = static_cast<std::uint32_t>(row.ticker.size());
+        r.last_update = row.last_update;
+        r.portfolio = row.portfolio ? 1 : 0;
+        r.type = static_cast<std::uint8_t>(row.type);
+        r.live = 1;
+        arena_ += row.ticker;
+        records_.push_back(r);
+    }
+
+    for (int filter = 0; filter < 2; ++filter) {
+        for (std::size_t order = 0; order < kOrders; ++order) {
+            auto& slots = orders_[filter][order];
+            for (std::uint32_t slot = 0; slot < records_.size(); ++slot) {
+                if (filter == 1 && !records_[slot].portfolio) continue;
+                slots.push_back(slot);
+            }
+
+            // rows arrive ticker ASC, so ByTicker is already sorted
+            if (order == ByTicker) continue;
+            const auto o = static_cast<Order>(order);
+            std::sort(slots.begin(),
+                      slots.end(),
+                      [this, o](std::uint32_t a, std::uint32_t b) {
+                          return less_(o, a, b);
+                      });
+        }
+    }
+
+    state_ = State::Ready;
+    generation_ += 1;
+    scan_dirty_ = true;
+    return true;
+}
+
+void TickerIndex::reset()
+{
+    state_ = State::Unloaded;
+    generation_ += 1;
+    scan_dirty_ = true;
+    scan_arena_.clear();
+    scan_starts_.clear();
+    scan_slots_.clear();
+    scan_off_.clear();
+    scan_mask_.clear();
+    arena_.clear();
+    dead_arena_bytes_ = 0;
+    records_.clear();
+    free_slots_.clear();
+    for (auto& filter : orders_) {
+        for (auto& slots : filter) slots.clear();
+    }
+}
+
+// *
+// **
+// ***
+// ****
+// ***** READS
+
+std::size_t TickerIndex::count(bool portfolio_only) const
+{
+    return orders_[portfolio_only ? 1 : 0][ByTicker].size();
+}
+
+std::vector<Database::TickerRow>
+TickerIndex::page(int page,
+                  int page_size,
+                  Database::TickerSortKey key,
+                  Database::SortDir dir,
+                  bool portfolio_only) const
+{
+    if (page < 0) page = 0;
+    if (page_size <= 0) page_size = 1;
+
+    Order order = ByTicker;
+    bool reversed = false;
+    if (key == Database::TickerSortKey::LastUpdate) {
+        order = dir == Database::SortDir::Desc ? ByUpdateDesc : ByUpdateAsc;
+    }
+    else {
+        reversed = dir == Database::SortDir::Desc;
+    }
+
+    const auto& slots = orders_[portfolio_only ? 1 : 0][order];
+    const std::uint64_t offset = static_cast<std::uint64_t>(page) *
+                                 static_cast<std::uint64_t>(page_size);
+    if (offset >= slots.size()) return {};
+
+    const std::size_t begin = static_cast<std::size_t>(offset);
+    const std::size_t end =
+        std::min(slots.size(), begin + static_cast<std::size_t>(page_size));
+
+    std::vector<Database::TickerRow> out;
+    out.reserve(end - begin);
+    for (std::size_t i = begin; i < end; ++i) {
+        const std::size_t at = reversed ? slots.size() - 1 - i : i;
+        out.push_back(row_(slots[at]));
+    }
+    return out;
+}
+
+bool TickerIndex::contains(std::string_view ticker) const
+{
+    return find_slot_(ticker) != kNoSlot;
+}
+
+// *
+// **
+// ***
+// ****
+// ***** SEARCH
+
+void TickerIndex::search(std::string_view upper_query,
+                         bool portfolio_only,
+                         Search& s)
+{
+    if (state_ != State::Ready || upper_query.empty()) {
+        s.clear();
+        return;
+    }
+
+    if (scan_dirty_) rebuild_scan_arena_();
+
+    // every ticker containing the longer query also contains the shorter
+    const bool narrows = s.valid && s.generation == generation_ &&
+                         s.portfolio_only == portfolio_only &&
+                         upper_query.find(s.query) != std::string_view::npos;
+
+    if (narrows) {
+        if (upper_query.size() != s.query.size()) {
+            const auto misses = [&](std::uint32_t slot) {
+                return upper_of_(slot).find(upper_query) ==
+                       std::string_view::npos;
+            };
+            s.slots.erase(
+                std::remove_if(s.slots.begin(), s.slots.end(), misses),
+                s.slots.end());
+        }
+    }
+    else {
+        s.slots.clear();
+        scan_(upper_query, portfolio_only, s.slots);
+    }
+
+    s.query.assign(upper_query);
+    s.portfolio_only = portfolio_only;
+    s.generation = generation_;
+    s.valid = true;
+}
+
+std::vector<Database::TickerRow>
+TickerIndex::search_rows(const Search& s, std::size_t limit) const
+{
+    if (!s.valid || s.generation != generation_) return {};
+
+    const std::size_t n = std::min(limit, s.slots.size());
+    std::vector<Database::TickerRow> out;
+    out.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) out.push_back(row_(s.slots[i]));
+    return out;
+}
+
+std::vector<Database::TickerRow> TickerIndex::ranked_rows(const Search& s,
+                                                         std::size_t k) const
+{
+    if (!s.valid || s.generation != generation_ || k == 0) return {};
+
+    const std::string_view q = s.query;
+    const auto q_len = static_cast<int>(q.size());
+
+    // Bounded heap: the worst kept rank sits at the front, so a candidate
+    // only costs a push when it beats it.
+    std::vector<Rank> heap;
+    heap.reserve(k + 1);
+    const auto worse_on_top = [this](const Rank& a, const Rank& b) {
+        return better_(a, b);
+    };
+    const auto offer = [&](const Rank& r) {
+        if (heap.size() == k && !better_(r, heap.front())) return;
+        heap.push_back(r);
+        std::push_heap(heap.begin(), heap.end(), worse_on_top);
+        if (heap.size() > k) {
+            std::pop_heap(heap.begin(), heap.end(), worse_on_top);
+            heap.pop_back();
+        }
+    };
+
+    // exact / prefix / substring: exactly the slots already in `s`
+    for (const std::uint32_t slot : s.slots) {
+        const std::string_view t = upper_of_(slot);
+        const std::size_t at = t.find(q);
+        const int len_gap = static_cast<int>(t.size()) - q_len;
+
+        Rank r;
+        r.slot = slot;
+        if (len_gap == 0) {
+            r.tier = 4;
+        }
+        else if (at == 0) {
+            r.tier = 3;
+            r.penalty = len_gap;
+        }
+        else {
+            r.tier = 2;
+            r.penalty = static_cast<int>(at) * 64 + len_gap;
+        }
+        offer(r);
+    }
+
+    // typo tier only runs when the substring tiers left room for it
+    if (heap.size() < k && q.size() >= 2) {
+        const std::uint64_t q_mask = char_mask(q);
+        const auto& slots = orders_[s.portfolio_only ? 1 : 0][ByTicker];
+
+        for (const std::uint32_t slot : slots) {
+            const std::uint64_t missing = q_mask & ~scan_mask_[slot];
+            // a subsequence needs every query char; one edit allows one miss
+            if (std::popcount(missing) > 1) continue;
+
+            const std::string_view t = upper_of_(slot);
+            if (t.find(q) != std::string_view::npos) continue; // ranked above
+
+            const int len_gap = static_cast<int>(t.size()) - q_len;
+            Rank r;
+            r.slot = slot;
+            r.tier = 1;
+            if (len_gap >= -1 && len_gap <= 1 && within_one_edit(q, t)) {
+                r.penalty = len_gap < 0 ? -len_gap : len_gap;
+            }
+            else if (missing == 0) {
+                const int span = subsequence_span(q, t);
+                if (span < 0) continue;
+                r.penalty = 64 + (span - q_len) * 64 + len_gap;
+            }
+            else {
+                continue;
+            }
+            offer(r);
+        }
+    }
+
+    std::sort(heap.begin(), heap.end(), [this](const Rank& a, const Rank& b) {
+        return better_(a, b);
+    });
+
+    std::vector<Database::TickerRow> out;
+    out.reserve(heap.size());
+    for (const Rank& r : heap) out.push_back(row_(r.slot));
+    return out;
+}
+
+bool TickerIndex::better_(const Rank& a, const Rank& b) const
+{
+    if (a.tier != b.tier) return a.tier > b.tier;
+    if (a.penalty != b.penalty) return a.penalty < b.penalty;
+    return ticker_of_(records_[a.slot]) < ticker_of_(records_[b.slot]);
+}
+
+void TickerIndex::rebuild_scan_arena_()
+{
+    const auto& slots = orders_[0][ByTicker];
+
+    scan_arena_.clear();
+    scan_arena_.reserve(arena_.size() - dead_arena_bytes_ + slots.size());
+    scan_starts_.resize(slots.size());
+    scan_slots_.assign(slots.begin(), slots.end());
+    scan_off_.assign(records_.size(), 0);
+    scan_mask_.assign(records_.size(), 0);
+
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        const std::uint32_t slot = slots[i];
+        const auto off = static_cast<std::uint32_t>(scan_arena_.size());
+        scan_starts_[i] = off;
+        scan_off_[slot] = off;
+        for (const char c : ticker_of_(records_[slot])) {
+            scan_arena_.push_back(ascii_upper(c));
+        }
+        scan_arena_.push_back('\n');
+        scan_mask_[slot] = char_mask(upper_of_(slot));
+    }
+
+    scan_dirty_ = false;
+}
+
+void TickerIndex::scan_(std::string_view upper_query,
+                        bool portfolio_only,
+                        std::vector<std::uint32_t>& out) const
+{
+    const char* hay = scan_arena_.data();
+    const std::size_t n = scan_arena_.size();
+
+    std::size_t pos = 0;
+    std::size_t at = 0; // ByTicker position of the ticker holding `pos`
+    while ((pos = find_substring(hay, n, pos, upper_query)) != kNoPos) {
+        at = static_cast<std::size_t>(
+                 std::upper_bound(scan_starts_.begin() +
+                                      static_cast<std::ptrdiff_t>(at),
+                                  scan_starts_.end(),
+                                  static_cast<std::uint32_t>(pos)) -
+                 scan_starts_.begin()) -
+             1;
+
+        const std::uint32_t slot = scan_slots_[at];
+        if (!portfolio_only || records_[slot].portfolio) out.push_back(slot);
+
+        // one hit per ticker; resume at the next one
+        if (at + 1 >= scan_starts_.size()) break;
+        pos = scan_starts_[at + 1];
+    }
+}
+
+// *
+// **
+// ***
+// ****
+// ***** PATCHES
+
+void TickerIndex::upsert(const Database::TickerRow& row)
+{
+    if (state_ != State::Ready) return;
+
+    std::uint32_t slot = find_slot_(row.ticker);
+    if (slot != kNoSlot) {
+        // every ordering key may move, so relink under the new key
+        unlink_(slot);
+    }
+    else {
+        if (records_.size() - free_slots_.size() >= max_rows_) {
+            // grew past the cap; let the caller page through SQL
+            reset();
+            state_ = State::Disabled;
+            return;
+        }
+
+        if (!free_slots_.empty()) {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        }
+        else {
+            slot = static_cast<std::uint32_t>(records_.size());
+            records_.emplace_back();
+        }
+
+        Record& r = records_[slot];
+        r.ticker_off = static_cast<std::uint32_t>(arena_.size());
+        r.ticker_len = static_cast<std::uint32_t>(row.ticker.size());
+        r.live = 1;
+        arena_ += row.ticker;
+    }
+
+    Record& r = records_[slot];
+    r.last_update = row.last_update;
+    r.portfolio = row.portfolio ? 1 : 0;
+    r.type = static_cast<std::uint8_t>(row.type);
+    link_(slot);
+
+    generation_ += 1;
+    scan_dirty_ = true;
+}
+
+void TickerIndex::erase(std::string_view ticker)
+{
+    if (state_ != State::Ready) return;
+
+    const std::uint32_t slot = find_slot_(ticker);
+    if (slot == kNoSlot) return;
+
+    unlink_(slot);
+    Record& r = records_[slot];
+    r.live = 0;
+    dead_arena_bytes_ += r.ticker_len;
+    free_slots_.push_back(slot);
+    generation_ += 1;
+    scan_dirty_ = true;
+
+    if (dead_arena_bytes_ > arena_.size() / 2) compact_arena_();
+}
+
+// *
+// **
+// ***
+// ****
+// ***** HELPERS
+
+bool TickerIndex::less_(Order order, std::uint32_t a, std::uint32_t b) const
+{
+    const Record& ra = records_[a];
+    const Record& rb = records_[b];
+
+    // tickers are unique, so every order is total and binary searches for
+    // a slot land exactly on it
+    if (order == ByUpdateDesc && ra.last_update != rb.last_update) {
+        return ra.last_update > rb.last_update;
+    }
+    if (order == ByUpdateAsc && ra.last_update != rb.last_update) {
+        return ra.last_update < rb.last_update;
+    }
+    return ticker_of_(ra) < ticker_of_(rb);
+}
+
+std::uint32_t TickerIndex::find_slot_(std::string_view ticker) const
+{
+    const auto& slots = orders_[0][ByTicker];
+    const auto it = std::lower_bound(
+        slots.begin(),
+        slots.end(),
+        ticker,
+        [this](std::uint32_t slot, std::string_view needle) {
+            return ticker_of_(records_[slot]) < needle;
+        });
+    if (it == slots.end() || ticker_of_(records_[*it]) != ticker) {
+        return kNoSlot;
+    }
+    return *it;
+}
+
+void TickerIndex::link_(std::uint32_t slot)
+{
+    const bool portfolio = records_[slot].portfolio != 0;
+    for (int filter = 0; filter < 2; ++filter) {
+        if (filter == 1 && !portfolio) continue;
+        for (std::size_t order = 0; order < kOrders; ++order) {
+            auto& slots = orders_[filter][order];
+            const auto o = static_cast<Order>(order);
+            const auto it = std::lower_bound(
+                slots.begin(),
+                slots.end(),
+                slot,
+                [this, o](std::uint32_t a, std::uint32_t b) {
+                    return less_(o, a, b);
+                });
+            slots.insert(it, slot);
+        }
+    }
+}
+
+void TickerIndex::unlink_(std::uint32_t slot)
+{
+    const bool portfolio = records_[slot].portfolio != 0;
+    for (int filter = 0; filter < 2; ++filter) {
+        if (filter == 1 && !portfolio) continue;
+        for (std::size_t order = 0; order < kOrders; ++order) {
+            auto& slots = orders_[filter][order];
+            const auto o = static_cast<Order>(order);
+            const auto it = std::lower_bound(
+                slots.begin(),
+                slots.end(),
+                slot,
+                [this, o](std::uint32_t a, std::uint32_t b) {
+                    return less_(o, a, b);
+                });
+            if (it != slots.end() && *it == slot) slots.erase(it);
+        }
+    }
+}
+
+void TickerIndex::compact_arena_()
+{
+    std::string packed;
+    packed.reserve(arena_.size() - dead_arena_bytes_);
+    for (auto& r : records_) {
+        if (!r.live) {
+            r.ticker_off = 0;
+            r.ticker_len = 0;
+            continue;
+        }
+        const auto off = static_cast<std::uint32_t>(packed.size());
+        packed.append(arena_, r.ticker_off, r.ticker_len);
+        r.ticker_off = off;
+    }
+    arena_ = std::move(packed);
+    dead_arena_bytes_ = 0;
+}
+
+Database::TickerRow TickerIndex::row_(std::uint32_t slot) const
+{
+    const Record& r = records_[slot];
+
+    Database::TickerRow row;
+    row.ticker = std::string(ticker_of_(r));
+    row.last_update = r.last_update;
+    row.portfolio = r.portfolio != 0;
+    row.type = r.type;
+    return row;
+}
+
+} // namespace db
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "db/database.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace db {
+
+// In-memory copy of the tickers table backing the home grid. Each ordering
+// the grid can ask for is a sorted vector of record slots (all rows and
+// portfolio rows), so paging, sort changes and portfolio filtering never
+// touch sqlite. Writes patch it through upsert()/erase(); universes above
+// the row cap (kMaxRows unless set_max_rows() says otherwise) leave it
+// disabled and the caller pages through SQL instead.
+class TickerIndex {
+public:
+    static constexpr std::size_t kMaxRows = 200000;
+
+    // Loads on first use. True when the index can serve pages; false when
+    // disabled or when loading failed (then *err is set).
+    bool ensure_loaded(Database& db, std::string* err = nullptr);
+    void reset();
+
+    // Lowers or raises the cap; takes effect on the next load.
+    void set_max_rows(std::size_t rows) { max_rows_ = rows; }
+
+    bool ready() const { return state_ == State::Ready; }
+    bool disabled() const { return state_ == State::Disabled; }
+
+    std::size_t count(bool portfolio_only) const;
+
+    std::vector<Database::TickerRow> page(int page,
+                                          int page_size,
+                                          Database::TickerSortKey key,
+                                          Database::SortDir dir,
+                                          bool portfolio_only) const;
+
+    bool contains(std::string_view ticker) const;
+
+    void upsert(const Database::TickerRow& row);
+    void erase(std::string_view ticker);
+
+    // Live search state owned by the caller: every slot whose uppercased
+    // ticker contains `query`, in ticker ASC order. Tied to the generation
+    // it was computed at, since patches can reuse slots.
+    struct Search {
+        std::string query;
+        bool portfolio_only = false;
+        std::uint64_t generation = 0;
+        bool valid = false;
+        std::vector<std::uint32_t> slots;
+
+        void clear()
+        {
+            query.clear();
+            slots.clear();
+            valid = false;
+        }
+    };
+
+    // `upper_query` must already be uppercase. A query that contains the
+    // previous one narrows `s` in memory; anything else rescans the arena.
+    void search(std::string_view upper_query, bool portfolio_only, Search& s);
+
+    std::vector<Database::TickerRow> search_rows(const Search& s,
+                                                 std::size_t limit) const;
+
+    // Best `k` matches for the query in `s`, ranked exact > prefix >
+    // substring > one edit or subsequence (typo tier, queries of 2+ chars).
+    // Ties go to the ticker closest in length, then ticker order.
+    std::vector<Database::TickerRow> ranked_rows(const Search& s,
+                                                 std::size_t k) const;
+
+private:
+    enum class State { Unloaded, Ready, Disabled };
+
+    // ticker DESC is served by walking ByTicker backwards
+    enum Order : std::size_t { ByTicker, ByUpdateDesc, ByUpdateAsc, kOrders };
+
+    struct Record {
+        std::uint32_t ticker_off = 0;
+        std::uint32_t ticker_len = 0;
+        std::int64_t last_update = 0;
+        std::uint8_t portfolio = 0;
+        std::uint8_t type = 1;
+        std::uint8_t live = 0;
+    };
+
+    using Slots = std::vector<std::uint32_t>;
+
+    std::string_view ticker_of_(const Record& r) const
+    {
+        return {arena_.data() + r.ticker_off, r.ticker_len};
+    }
+
+    bool less_(Order order, std::uint32_t a, std::uint32_t b) const;
+    std::uint32_t find_slot_(std::string_view ticker) const;
+
+    void link_(std::uint32_t slot);
+    void unlink_(std::uint32_t slot);
+    void compact_arena_();
+
+    Database::TickerRow row_(std::uint32_t slot) const;
+
+    struct Rank {
+        int tier = 0;    // higher is better
+        int penalty = 0; // lower is better within a tier
+        std::uint32_t slot = 0;
+    };
+
+    bool better_(const Rank& a, const Rank& b) const;
+    std::string_view upper_of_(std::uint32_t slot) const
+    {
+        return {scan_arena_.data() + scan_off_[slot],
+                records_[slot].ticker_len};
+    }
+
+    void rebuild_scan_arena_();
+    void scan_(std::string_view upper_query,
+               bool portfolio_only,
+               std::vector<std::uint32_t>& out) const;
+
+private:
+    State state_{State::Unloaded};
+    std::size_t max_rows_{kMaxRows};
+
+    std::string arena_;
+    std::size_t dead_arena_bytes_{0};
+    std::vector<Record> records_;
+    std::vector<std::uint32_t> free_slots_;
+
+    // [0] all rows, [1] portfolio rows
+    std::array<std::array<Slots, kOrders>, 2> orders_{};
+
+    // bumped on every load/patch; invalidates caller Search states
+    std::uint64_t generation_{1};
+
+    // Uppercased tickers in ticker ASC order, '\n' separated so a match can
+    // never straddle two tickers. Rebuilt lazily after patches.
+    bool scan_dirty_{true};
+    std::string scan_arena_;
+    std::vector<std::uint32_t> scan_starts_; // offset per ByTicker position
+    std::vector<std::uint32_t> scan_slots_;  // slot per ByTicker position
+    std::vector<std::uint32_t> scan_off_;    // scan_arena_ offset per slot
+    std::vector<std::uint64_t> scan_mask_;   // chars present, per slot
+};
+
+} // namespace db
@@ -0,0 +1,322 @@
+#include "db/ticker_page_ring.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <utility>
+
+namespace db {
+
+// *
+// **
+// ***
+// ****
+// ***** RING
+
+void TickerPageRing::set_key(const Key& key)
+{
+    if (key == key_) return;
+
+    if (!reverse_into_(key)) {
+        pages_.clear();
+        if (key.portfolio_only != key_.portfolio_only) total_.reset();
+    }
+    key_ = key;
+}
+
+const std::vector<Database::TickerRow>* TickerPageRing::find(int page) const
+{
+    const auto it = pages_.find(page);
+    return it == pages_.end() ? nullptr : &it->second;
+}
+
+void TickerPageRing::store(int page, std::vector<Database::TickerRow> rows)
+{
+    if (page < 0 || key_.page_size <= 0) return;
+
+    const auto size = static_cast<std::size_t>(key_.page_size);
+    if (!rows.empty() && rows.size() < size) {
+        total_ = static_cast<std::size_t>(page) * size + rows.size();
+    }
+    pages_[page] = std::move(rows);
+}
+
+bool TickerPageRing::past_end(int page) const
+{
+    if (page <= 0 || key_.page_size <= 0) return false;
+
+    const auto size = static_cast<std::size_t>(key_.page_size);
+    if (total_.has_value()) {
+        return static_cast<std::size_t>(page) * size >= *total_;
+    }
+
+    // no total yet: a short or empty page at or before `page` ends the list
+    for (const auto& [p, rows] : pages_) {
+        if (p > page) break;
+        if (p < page && rows.size() < size) return true;
+        if (p == page && rows.empty()) return true;
+    }
+    return false;
+}
+
+std::vector<int> TickerPageRing::missing_around(int center) const
+{
+    std::vector<int> out;
+    auto consider = [&](int page) {
+        if (page < 0 || past_end(page) || find(page)) return;
+        out.push_back(page);
+    };
+
+    consider(center);
+    for (int d = 1; d <= kRadius; ++d) {
+        consider(center + d);
+        consider(center - d);
+    }
+    return out;
+}
+
+void TickerPageRing::trim(int center)
+{
+    for (auto it = pages_.begin(); it != pages_.end();) {
+        if (std::abs(it->first - center) > kRadius + 1)
+            it = pages_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void TickerPageRing::invalidate()
+{
+    pages_.clear();
+    total_.reset();
+    epoch_ += 1;
+}
+
+// Ticker ASC and DESC list the same rows back to front: absolute position i
+// in one is total - 1 - i in the other. Contiguous runs of held pages are
+// mirrored and every new page they fully cover is kept.
+bool TickerPageRing::reverse_into_(const Key& next)
+{
+    const bool ticker_flip =
+        key_.sort_key == Database::TickerSortKey::Ticker &&
+        next.sort_key == Database::TickerSortKey::Ticker &&
+        key_.sort_dir != next.sort_dir && key_.page_size == next.page_size &&
+        key_.portfolio_only == next.portfolio_only;
+    if (!ticker_flip || !total_.has_value() || key_.page_size <= 0) {
+        return false;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(key_.page_size);
+    const std::size_t total = *total_;
+
+    struct Run {
+        std::size_t start = 0;
+        std::vector<Database::TickerRow> rows;
+    };
+    std::vector<Run> runs;
+    int prev_page = -2;
+    for (auto& [page, rows] : pages_) {
+        const std::size_t start = static_cast<std::size_t>(page) * size;
+        const bool extends = !runs.empty() && page == prev_page + 1 &&
+                             runs.back().start + runs.back().rows.size() ==
+                                 start;
+        if (!extends) runs.push_back(Run{start, {}});
+        auto& run = runs.back().rows;
+        run.insert(run.end(),
+                   std::make_move_iterator(rows.begin()),
+                   std::make_move_iterator(rows.end()));
+        prev_page = page;
+    }
+    pages_.clear();
+
+    for (const auto& run : runs) {
+        if (run.rows.empty()) continue;
+        // old [a, b) becomes new [total - b, total - a)
+        const std::size_t a = run.start;
+        const std::size_t b = run.start + run.rows.size();
+        if (b > total) continue; // stale total; give up on this run
+        const std::size_t lo = total - b;
+        const std::size_t hi = total - a;
+
+        for (std::size_t q = lo / size; q * size < hi; ++q) {
+            const std::size_t first = q * size;
+            const std::size_t last = std::min(first + size, total);
+            if (first < lo || last > hi) continue;
+
+            std::vector<Database::TickerRow> page;
+            page.reserve(last - first);
+            for (std::size_t j = first; j < last; ++j) {
+                page.push_back(run.rows[(total - 1 - j) - a]);
+            }
+            pages_[static_cast<int>(q)] = std::move(page);
+        }
+    }
+    return true;
+}
+
+// *
+// **
+// ***
+// ****
+// ***** LOADER
+
+TickerPageLoader::TickerPageLoader()
+    : thread_([this] { run_(); })
+{
+}
+
+TickerPageLoader::~TickerPageLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+        queue_.clear();
+        total_pending_ = false;
+        if (busy_ && reader_) reader_->interrupt();
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void TickerPageLoader::want(const Database& db, Request request)
+{
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (request == request_ && path_ == db.path()) return;
+
+        path_ = db.path();
+        request_ = std::move(request);
+        total_pending_ = request_.need_total;
+        queue_.assign(request_.pages.begin(), request_.pages.end());
+
+        if (busy_) {
+            const bool same = in_flight_key_ == request_.key &&
+                              in_flight_epoch_ == request_.epoch;
+            if (!same && reader_) {
+                reader_->interrupt();
+            }
+            else if (same) {
+                queue_.erase(
+                    std::remove(queue_.begin(), queue_.end(), in_flight_page_),
+                    queue_.end());
+                if (in_flight_page_ < 0) total_pending_ = false;
+            }
+        }
+        if (path_.empty()) {
+            queue_.clear();
+            total_pending_ = false;
+        }
+    }
+    cv_.notify_all();
+}
+
+void TickerPageLoader::cancel()
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    queue_.clear();
+    total_pending_ = false;
+    request_ = Request{};
+    if (busy_ && reader_) reader_->interrupt();
+}
+
+void TickerPageLoader::close()
+{
+    std::unique_lock<std::mutex> lock(mu_);
+    queue_.clear();
+    total_pending_ = false;
+    request_ = Request{};
+    if (busy_ && reader_) reader_->interrupt();
+    cv_.wait(lock, [this] { return !busy_; });
+
+    reader_.reset();
+    path_.clear();
+    done_.clear();
+}
+
+std::vector<TickerPageLoader::Result> TickerPageLoader::take()
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    std::vector<Result> out;
+    out.swap(done_);
+    return out;
+}
+
+void TickerPageLoader::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this] {
+        return stop_ || (queue_.empty() && !total_pending_ && !busy_);
+    });
+}
+
+void TickerPageLoader::run_()
+{
+    std::unique_lock<std::mutex> lock(mu_);
+    while (true) {
+        cv_.wait(lock,
+                 [this] { return stop_ || total_pending_ || !queue_.empty(); });
+        if (stop_) return;
+
+        if (!reader_ || reader_->path() != path_) {
+            try {
+                auto next = std::make_unique<Database>();
+                next->open_read_only(path_);
+                reader_ = std::move(next);
+            }
+            catch (const std::exception&) {
+                reader_.reset();
+                queue_.clear(); // the UI thread falls back to reading itself
+                total_pending_ = false;
+                cv_.notify_all();
+                continue;
+            }
+        }
+
+        Result result;
+        result.key = request_.key;
+        result.epoch = request_.epoch;
+        if (total_pending_) {
+            total_pending_ = false; // the total first: it bounds the pages
+        }
+        else {
+            result.page = queue_.front();
+            queue_.pop_front();
+        }
+
+        busy_ = true;
+        in_flight_key_ = result.key;
+        in_flight_epoch_ = result.epoch;
+        in_flight_page_ = result.page;
+        Database* reader = reader_.get();
+        lock.unlock();
+
+        std::string err;
+        if (result.page < 0) {
+            const auto total =
+                reader->count_tickers(result.key.portfolio_only, &err);
+            if (total.has_value() && *total >= 0) {
+                result.total = static_cast<std::size_t>(*total);
+            }
+        }
+        else {
+            result.rows = reader->get_tickers(result.page,
+                                              result.key.page_size,
+                                              result.key.sort_key,
+                                              result.key.sort_dir,
+                                              &err,
+                                              result.key.portfolio_only);
+        }
+
+        lock.lock();
+        busy_ = false;
+        in_flight_page_ = -1;
+        const bool current = result.key == request_.key &&
+                             result.epoch == request_.epoch;
+        if (err.empty() && current && !stop_) {
+            done_.push_back(std::move(result));
+        }
+        cv_.notify_all();
+    }
+}
+
+} // namespace db
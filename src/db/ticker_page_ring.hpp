@@ -0,0 +1,139 @@
+#pragma once
+
+#include "db/database.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace db {
+
+// Pages of the SQL-backed home grid around the current page, for universes
+// the ticker index does not hold. Pages belong to the ordering they were
+// read with. Flipping ticker ASC <-> DESC is an exact reversal, so the rows
+// already held are re-cut into pages of the new direction instead of being
+// dropped; any other key change starts over.
+class TickerPageRing {
+public:
+    static constexpr int kRadius = 2; // pages kept on each side of the focus
+
+    struct Key {
+        int page_size = 0;
+        Database::TickerSortKey sort_key{};
+        Database::SortDir sort_dir{};
+        bool portfolio_only = false;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    void set_key(const Key& key);
+    const Key& key() const { return key_; }
+
+    const std::vector<Database::TickerRow>* find(int page) const;
+
+    // A short page also fixes the total.
+    void store(int page, std::vector<Database::TickerRow> rows);
+    void set_total(std::size_t total) { total_ = total; }
+    std::optional<std::size_t> total() const { return total_; }
+
+    // True when `page` is known to lie past the last row. Page 0 never does.
+    bool past_end(int page) const;
+
+    // Uncached pages within kRadius of `center`, nearest first and forward
+    // before backward at equal distance.
+    std::vector<int> missing_around(int center) const;
+
+    // Drops pages more than kRadius + 1 away from `center`.
+    void trim(int center);
+
+    // Forgets everything after a write. In-flight loads carry the epoch
+    // they were asked for and are ignored once it moves.
+    void invalidate();
+    std::uint64_t epoch() const { return epoch_; }
+
+    std::size_t size() const { return pages_.size(); }
+
+private:
+    bool reverse_into_(const Key& next);
+
+private:
+    Key key_{};
+    std::map<int, std::vector<Database::TickerRow>> pages_;
+    std::optional<std::size_t> total_;
+    std::uint64_t epoch_{1};
+};
+
+// Fills a TickerPageRing from a worker thread with its own read-only
+// connection. Like HistoryPrefetcher, results are handed over on the UI
+// thread through take(); the ring itself is never touched here.
+class TickerPageLoader {
+public:
+    struct Request {
+        TickerPageRing::Key key;
+        std::uint64_t epoch = 0;
+        bool need_total = false;
+        std::vector<int> pages; // highest priority first
+
+        bool operator==(const Request&) const = default;
+    };
+
+    struct Result {
+        TickerPageRing::Key key;
+        std::uint64_t epoch = 0;
+        int page = -1; // -1: total only
+        std::vector<Database::TickerRow> rows;
+        std::optional<std::size_t> total;
+    };
+
+    TickerPageLoader();
+    ~TickerPageLoader();
+
+    TickerPageLoader(const TickerPageLoader&) = delete;
+    TickerPageLoader& operator=(const TickerPageLoader&) = delete;
+
+    // Replaces the pending work with `request`; repeating the last request
+    // is a no-op. A page in flight for another key or epoch is interrupted.
+    void want(const Database& db, Request request);
+    void cancel();
+
+    // Cancels everything and closes the read connection.
+    void close();
+
+    std::vector<Result> take();
+    void wait_idle();
+
+private:
+    void run_();
+
+private:
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_{false};
+
+    std::filesystem::path path_;
+    Request request_;
+    bool total_pending_{false};
+    std::deque<int> queue_;
+
+    bool busy_{false};
+    TickerPageRing::Key in_flight_key_{};
+    std::uint64_t in_flight_epoch_{0};
+    int in_flight_page_{-1};
+    std::vector<Result> done_;
+
+    // worker-owned; opened, replaced and closed only under mu_ while idle
+    std::unique_ptr<Database> reader_;
+
+    std::thread thread_;
+};
+
+} // namespace db
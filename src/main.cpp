@@ -1,11 +1,18 @@
 #include <curses.h>
+#include <clocale>
 #include <csignal>
 #include <cstdio>
 #include <chrono>
+#include <iostream>
 #include <stdexcept>
+#include <string_view>
+#include <unistd.h>
 
 #include "state.hpp"
 #include "settings.hpp"
+#include "cli/cli_implied_growth.hpp"
+#include "cli/cli_import_prices.hpp"
+#include "cli/cli_serve.hpp"
 #include "views/view.hpp"
 #include "views/home/view_home.hpp"
 #include "views/help/view_help.hpp"
@@ -13,6 +20,9 @@
 #include "views/error/view_error.hpp"
 #include "views/add/view_add.hpp"
 #include "views/ticker/view_ticker.hpp"
+#include "views/matrix/view_matrix.hpp"
+#include "views/sweep/view_sweep.hpp"
+#include "views/portfolio/view_portfolio.hpp"
 
 inline short rgb8_to_ncurses(int channel)
 {
@@ -176,6 +186,9 @@ struct Ncurses {
             0; // avoid SA_RESTART so input waits can be interrupted
         has_old_sigint_action_ =
             (sigaction(SIGINT, &action, &old_sigint_action_) == 0);
+        // multibyte output for braille sparklines; numbers stay C-formatted
+        std::setlocale(LC_ALL, "");
+        std::setlocale(LC_NUMERIC, "C");
         initscr();
         cbreak();
         noecho();
@@ -216,16 +229,61 @@ private:
     bool has_old_sigint_action_ = false;
 };
 
-int main()
+int main(int argc, char** argv)
 {
     try {
         db::Database database;
         database.open_or_create();
 
+        // batch commands run without the terminal UI
+        if (argc > 1 && std::string_view(argv[1]) == "implied-growth") {
+            if (argc != 3) {
+                std::fprintf(stderr,
+                             "usage: intrinsic implied-growth <prices.csv>\n");
+                return 2;
+            }
+            metrics::WorkPool work_pool;
+            return cli::run_implied_growth(
+                database, argv[2], work_pool, std::cout, std::cerr);
+        }
+
+        if (argc > 1 && std::string_view(argv[1]) == "import-prices") {
+            if (argc < 3) {
+                std::fprintf(stderr,
+                             "usage: intrinsic import-prices <file.csv>...\n");
+                return 2;
+            }
+            return cli::run_import_prices(
+                database, {argv + 2, argv + argc}, std::cerr);
+        }
+
+        if (argc > 1 && std::string_view(argv[1]) == "serve") {
+            cli::ServeOptions options;
+            std::string err;
+            const std::vector<std::string> args(argv + 2, argv + argc);
+            if (!cli::parse_serve_args(args, options, &err)) {
+                std::fprintf(stderr,
+                             "%s\nusage: intrinsic serve [--port N] "
+                             "[--workers N]\n",
+                             err.c_str());
+                return 2;
+            }
+            return cli::run_serve(database, options, std::cerr);
+        }
+
         Ncurses ncurses;
 
+        db::HistoryPrefetcher prefetcher;
+        db::TickerPageLoader page_loader;
+        metrics::WorkPool work_pool;
+        db::PriceFeed price_feed;
+
         AppState app;
         app.db = &database;
+        app.prefetcher = &prefetcher;
+        app.page_loader = &page_loader;
+        app.work_pool = &work_pool;
+        app.price_feed = &price_feed;
         app.current = views::ViewId::Home;
 
         // load persisted settings
@@ -234,11 +292,23 @@ int main()
             if (!load_settings(app.settings, &err)) {
                 route_error(app, err);
             }
+            app.history_cache.set_budget_bytes(app.settings.history_cache_mb
+                                               << 20);
+            app.price_cache.set_budget_bytes(app.settings.price_cache_mb
+                                             << 20);
         }
 
+        // live quotes; without them (another session already serves the
+        // socket) Settings shows the feed as off
+        price_feed.open(database.path().parent_path() / "feed.sock");
+
         while (true) {
             if (Ncurses::interrupt_requested()) break;
 
+            views::pump_home_history_prefetch(app);
+            views::pump_home_page_prefetch(app);
+            views::pump_ticker_view_refresh(app);
+
             ncurses.sync_terminal_appearance(app.settings.color_mode,
                                              app.current);
             configure_theme(app.settings);
@@ -263,6 +333,15 @@ int main()
             case views::ViewId::Error:
                 views::render_error(app);
                 break;
+            case views::ViewId::Matrix:
+                views::render_matrix(app);
+                break;
+            case views::ViewId::Sweep:
+                views::render_sweep(app);
+                break;
+            case views::ViewId::Portfolio:
+                views::render_portfolio(app);
+                break;
             }
 
             int getch_timeout_ms = -1;
@@ -285,10 +364,22 @@ int main()
                 }
             }
             if (getch_timeout_ms < 0) getch_timeout_ms = 50;
-            timeout(getch_timeout_ms);
+            if (price_feed.is_open()) {
+                // wake on quotes as well as keys; getch then only drains
+                price_feed.wait(STDIN_FILENO, getch_timeout_ms);
+                views::apply_price_quotes(app, price_feed.take_quotes());
+                timeout(0);
+            }
+            else {
+                timeout(getch_timeout_ms);
+            }
             int ch = getch();
             if (Ncurses::interrupt_requested()) break;
-            if (ch == ERR) continue;
+            if (ch == ERR) {
+                // idle: pick up what other sessions wrote meanwhile
+                views::apply_external_changes(app);
+                continue;
+            }
             if (ch == 3) break; // Ctrl+C as key event fallback
 
             // view-local first
@@ -313,6 +404,15 @@ int main()
             case views::ViewId::Error:
                 consumed = views::handle_key_error(app, ch);
                 break;
+            case views::ViewId::Matrix:
+                consumed = views::handle_key_matrix(app, ch);
+                break;
+            case views::ViewId::Sweep:
+                consumed = views::handle_key_sweep(app, ch);
+                break;
+            case views::ViewId::Portfolio:
+                consumed = views::handle_key_portfolio(app, ch);
+                break;
             }
 
             if (app.quit_requested) break;
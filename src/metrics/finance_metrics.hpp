@@ -0,0 +1,315 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "db/database.hpp"
+#include "metrics/metric_math.hpp"
+
+// Price-independent metrics derived from one finances row (and the rows
+// before it, for TTM). Persisted per period in finance_metrics so screens
+// can range-scan them; the column list below is the single source for that
+// table's schema, upsert and screen statements.
+
+namespace metrics {
+
+struct FinanceMetrics {
+    // balance sheet
+    std::optional<double> total_assets;
+    std::optional<double> total_liabilities;
+    std::optional<double> equity;
+    std::optional<double> working_capital;
+    std::optional<double> tangible_equity;
+
+    // per share, from the period's own net income / eps
+    std::optional<double> shares_approx;
+    std::optional<double> book_value_per_share;
+    std::optional<double> tbv_per_share;
+
+    // returns and margins
+    std::optional<double> net_margin;
+    std::optional<double> roa;
+    std::optional<double> roe;
+    std::optional<double> rote;
+
+    // standard: liabilities / equity, bank: assets / tangible equity
+    std::optional<double> leverage;
+    std::optional<double> liquidity;
+    std::optional<double> solvency;
+    std::optional<double> wc_over_non_current;
+
+    // banks
+    std::optional<double> ppop;
+    std::optional<double> ppop_over_assets;
+    std::optional<double> npl_ratio;
+    std::optional<double> chargeoff_ratio;
+    std::optional<double> provision_ratio;
+    std::optional<double> provision_over_ppop;
+    std::optional<double> cet1_ratio;
+    std::optional<double> loan_to_deposit;
+
+    // insurers
+    std::optional<double> underwriting_profit;
+    std::optional<double> loss_ratio;
+    std::optional<double> expense_ratio;
+    std::optional<double> combined_ratio;
+    std::optional<double> underwriting_margin;
+    std::optional<double> reserves_over_equity;
+    std::optional<double> debt_over_equity;
+
+    // trailing twelve months (quarterly/semiannual rows only)
+    std::optional<double> ttm_eps;
+    std::optional<double> ttm_net_income;
+    std::optional<double> ttm_cash_flow_ops;
+    std::optional<double> ttm_shares_approx;
+    std::optional<double> ttm_roa;
+    std::optional<double> ttm_roe;
+};
+
+// Amounts and ratios read year-over-year changes differently; see
+// percent_change() and ratio_percent_change().
+enum class MetricKind { Amount, Ratio };
+
+struct FinanceMetricColumn {
+    const char* name;
+    std::optional<double> FinanceMetrics::*field;
+    bool indexed; // screened by; gets an idx_finance_metrics_<name>
+    MetricKind kind;
+};
+
+inline constexpr FinanceMetricColumn kFinanceMetricColumns[] = {
+    {"total_assets", &FinanceMetrics::total_assets, false, MetricKind::Amount},
+    {"total_liabilities",
+     &FinanceMetrics::total_liabilities,
+     false,
+     MetricKind::Amount},
+    {"equity", &FinanceMetrics::equity, false, MetricKind::Amount},
+    {"working_capital",
+     &FinanceMetrics::working_capital,
+     false,
+     MetricKind::Amount},
+    {"tangible_equity",
+     &FinanceMetrics::tangible_equity,
+     false,
+     MetricKind::Amount},
+    {"shares_approx",
+     &FinanceMetrics::shares_approx,
+     false,
+     MetricKind::Amount},
+    {"book_value_per_share",
+     &FinanceMetrics::book_value_per_share,
+     false,
+     MetricKind::Amount},
+    {"tbv_per_share",
+     &FinanceMetrics::tbv_per_share,
+     false,
+     MetricKind::Amount},
+    {"net_margin", &FinanceMetrics::net_margin, true, MetricKind::Ratio},
+    {"roa", &FinanceMetrics::roa, true, MetricKind::Ratio},
+    {"roe", &FinanceMetrics::roe, true, MetricKind::Ratio},
+    {"rote", &FinanceMetrics::rote, false, MetricKind::Ratio},
+    {"leverage", &FinanceMetrics::leverage, true, MetricKind::Ratio},
+    {"liquidity", &FinanceMetrics::liquidity, false, MetricKind::Ratio},
+    {"solvency", &FinanceMetrics::solvency, false, MetricKind::Ratio},
+    {"wc_over_non_current",
+     &FinanceMetrics::wc_over_non_current,
+     false,
+     MetricKind::Ratio},
+    {"ppop", &FinanceMetrics::ppop, false, MetricKind::Amount},
+    {"ppop_over_assets",
+     &FinanceMetrics::ppop_over_assets,
+     false,
+     MetricKind::Ratio},
+    {"npl_ratio", &FinanceMetrics::npl_ratio, false, MetricKind::Ratio},
+    {"chargeoff_ratio",
+     &FinanceMetrics::chargeoff_ratio,
+     false,
+     MetricKind::Ratio},
+    {"provision_ratio",
+     &FinanceMetrics::provision_ratio,
+     false,
+     MetricKind::Ratio},
+    {"provision_over_ppop",
+     &FinanceMetrics::provision_over_ppop,
+     false,
+     MetricKind::Ratio},
+    {"cet1_ratio", &FinanceMetrics::cet1_ratio, true, MetricKind::Ratio},
+    {"loan_to_deposit",
+     &FinanceMetrics::loan_to_deposit,
+     false,
+     MetricKind::Ratio},
+    {"underwriting_profit",
+     &FinanceMetrics::underwriting_profit,
+     false,
+     MetricKind::Amount},
+    {"loss_ratio", &FinanceMetrics::loss_ratio, false, MetricKind::Ratio},
+    {"expense_ratio", &FinanceMetrics::expense_ratio, false, MetricKind::Ratio},
+    {"combined_ratio",
+     &FinanceMetrics::combined_ratio,
+     true,
+     MetricKind::Ratio},
+    {"underwriting_margin",
+     &FinanceMetrics::underwriting_margin,
+     false,
+     MetricKind::Ratio},
+    {"reserves_over_equity",
+     &FinanceMetrics::reserves_over_equity,
+     false,
+     MetricKind::Ratio},
+    {"debt_over_equity",
+     &FinanceMetrics::debt_over_equity,
+     false,
+     MetricKind::Ratio},
+    {"ttm_eps", &FinanceMetrics::ttm_eps, true, MetricKind::Amount},
+    {"ttm_net_income",
+     &FinanceMetrics::ttm_net_income,
+     false,
+     MetricKind::Amount},
+    {"ttm_cash_flow_ops",
+     &FinanceMetrics::ttm_cash_flow_ops,
+     false,
+     MetricKind::Amount},
+    {"ttm_shares_approx",
+     &FinanceMetrics::ttm_shares_approx,
+     false,
+     MetricKind::Amount},
+    {"ttm_roa", &FinanceMetrics::ttm_roa, false, MetricKind::Ratio},
+    {"ttm_roe", &FinanceMetrics::ttm_roe, true, MetricKind::Ratio},
+};
+
+inline const FinanceMetricColumn* find_finance_metric(std::string_view name)
+{
+    for (const auto& column : kFinanceMetricColumns) {
+        if (name == column.name) return &column;
+    }
+    return nullptr;
+}
+
+// Change of `column` from `previous` to `current`, in percent.
+inline std::optional<double> metric_change(const FinanceMetricColumn& column,
+                                           const FinanceMetrics& current,
+                                           const FinanceMetrics& previous)
+{
+    const auto now = current.*column.field;
+    const auto then = previous.*column.field;
+    if (column.kind == MetricKind::Ratio) {
+        return ratio_percent_change(now, then);
+    }
+    return percent_change(now, then);
+}
+
+// Metrics for rows[index] of a ticker of `ticker_type` (1 standard, 2 bank,
+// 3 insurance). Matches what the ticker view renders for the same row.
+inline FinanceMetrics
+derive_finance_metrics(const std::vector<db::Database::FinanceRow>& rows,
+                       int index,
+                       int ticker_type)
+{
+    FinanceMetrics m;
+    if (index < 0 || index >= static_cast<int>(rows.size())) return m;
+    const auto& row = rows[index];
+
+    const auto net_income_d = to_f64(row.net_income);
+    const auto ttm = ttm_at(rows, index);
+    m.ttm_eps = ttm.eps;
+    m.ttm_net_income = ttm.net_income;
+    m.ttm_cash_flow_ops = ttm.cash_flow_ops;
+    m.shares_approx = approx_shares(net_income_d, row.eps);
+    m.ttm_shares_approx = approx_shares(ttm.net_income, ttm.eps);
+
+    if (ticker_type == 2) {
+        const auto equity = sub_i64(row.total_assets, row.total_liabilities);
+        const auto tangible_equity = sub_i64(equity, row.goodwill);
+        const auto ppop =
+            sub_i64(add_i64(row.net_interest_income, row.non_interest_income),
+                    row.non_interest_expense);
+        const auto assets_d = to_f64(row.total_assets);
+        const auto loans_d = to_f64(row.total_loans);
+        const auto tangible_equity_d = to_f64(tangible_equity);
+        const auto ppop_d = to_f64(ppop);
+        const auto llp_d = to_f64(row.loan_loss_provisions);
+
+        m.total_assets = assets_d;
+        m.total_liabilities = to_f64(row.total_liabilities);
+        m.equity = to_f64(equity);
+        m.tangible_equity = tangible_equity_d;
+        m.ppop = ppop_d;
+        m.tbv_per_share = div_opt_nonzero(tangible_equity_d, m.shares_approx);
+        m.roa = div_opt_nonzero(net_income_d, assets_d);
+        m.roe = div_opt_nonzero(net_income_d, m.equity);
+        m.rote = div_opt_nonzero(net_income_d, tangible_equity_d);
+        m.ppop_over_assets = div_opt_nonzero(ppop_d, assets_d);
+        m.npl_ratio =
+            div_opt_nonzero(to_f64(row.non_performing_loans), loans_d);
+        m.chargeoff_ratio =
+            div_opt_nonzero(to_f64(row.net_charge_offs), loans_d);
+        m.provision_ratio = div_opt_nonzero(llp_d, loans_d);
+        m.provision_over_ppop = div_opt_nonzero(llp_d, ppop_d);
+        m.cet1_ratio = div_opt_nonzero(to_f64(row.common_equity_tier1),
+                                       to_f64(row.risk_weighted_assets));
+        m.leverage = div_opt_nonzero(assets_d, tangible_equity_d);
+        m.loan_to_deposit =
+            div_opt_nonzero(loans_d, to_f64(row.total_deposits));
+    }
+    else if (ticker_type == 3) {
+        const auto equity = sub_i64(row.total_assets, row.total_liabilities);
+        const auto underwriting_expenses =
+            derived_underwriting_expenses_for_row(row);
+        const auto underwriting_profit =
+            sub_i64(sub_i64(row.earned_premiums, row.claims_incurred),
+                    underwriting_expenses);
+        const auto equity_d = to_f64(equity);
+        const auto premiums_d = to_f64(row.earned_premiums);
+
+        m.total_assets = to_f64(row.total_assets);
+        m.total_liabilities = to_f64(row.total_liabilities);
+        m.equity = equity_d;
+        m.underwriting_profit = to_f64(underwriting_profit);
+        m.book_value_per_share = div_opt_nonzero(equity_d, m.shares_approx);
+        m.loss_ratio =
+            div_opt_nonzero(to_f64(row.claims_incurred), premiums_d);
+        m.expense_ratio =
+            div_opt_nonzero(to_f64(underwriting_expenses), premiums_d);
+        m.combined_ratio = combined_ratio(to_f64(row.claims_incurred),
+                                          to_f64(underwriting_expenses),
+                                          premiums_d);
+        m.underwriting_margin =
+            div_opt_nonzero(m.underwriting_profit, premiums_d);
+        m.roa = div_opt_nonzero(net_income_d, m.total_assets);
+        m.roe = div_opt_nonzero(net_income_d, equity_d);
+        m.reserves_over_equity =
+            div_opt_nonzero(to_f64(row.insurance_reserves), equity_d);
+        m.debt_over_equity = div_opt_nonzero(to_f64(row.total_debt), equity_d);
+    }
+    else {
+        const auto total_assets =
+            add_i64(row.current_assets, row.non_current_assets);
+        const auto total_liabilities =
+            add_i64(row.current_liabilities, row.non_current_liabilities);
+        const auto equity = sub_i64(total_assets, total_liabilities);
+        const auto working_capital =
+            sub_i64(row.current_assets, row.current_liabilities);
+
+        m.total_assets = to_f64(total_assets);
+        m.total_liabilities = to_f64(total_liabilities);
+        m.equity = to_f64(equity);
+        m.working_capital = to_f64(working_capital);
+        m.book_value_per_share = div_opt_nonzero(m.equity, m.shares_approx);
+        m.net_margin = div_opt_nonzero(net_income_d, to_f64(row.revenue));
+        m.roa = div_opt_nonzero(net_income_d, m.total_assets);
+        m.roe = div_opt_nonzero(net_income_d, m.equity);
+        m.liquidity = div_opt_nonzero(to_f64(row.current_assets),
+                                      to_f64(row.current_liabilities));
+        m.solvency = div_opt_nonzero(m.total_assets, m.total_liabilities);
+        m.leverage = div_opt_nonzero(m.total_liabilities, m.equity);
+        m.wc_over_non_current = div_opt_nonzero(
+            m.working_capital, to_f64(row.non_current_liabilities));
+    }
+
+    m.ttm_roa = div_opt_nonzero(ttm.net_income, m.total_assets);
+    m.ttm_roe = div_opt_nonzero(ttm.net_income, m.equity);
+    return m;
+}
+
+} // namespace metrics
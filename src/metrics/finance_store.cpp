@@ -0,0 +1,436 @@
+#include "metrics/finance_store.hpp"
+
+#include <bit>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define INTRINSIC_AVX2_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace metrics {
+
+// *
+// **
+// ***
+// ****
+// ***** STORE
+
+std::size_t ValidityBitmap::count() const
+{
+    std::size_t n = 0;
+    for (const auto w : words_) {
+        n += static_cast<std::size_t>(std::popcount(w));
+    }
+    return n;
+}
+
+ValidityBitmap ValidityBitmap::both(const ValidityBitmap& a,
+                                    const ValidityBitmap& b)
+{
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("column sizes differ");
+    }
+    ValidityBitmap out(a.size());
+    for (std::size_t w = 0; w < out.words_.size(); ++w) {
+        out.words_[w] = a.words_[w] & b.words_[w];
+    }
+    return out;
+}
+
+FinanceStore::FinanceStore(const std::vector<db::Database::FinanceRow>& rows)
+    : eps_(rows.size())
+{
+    const std::size_t n = rows.size();
+    years_.reserve(n);
+    period_types_.reserve(n);
+    for (const auto& r : rows) {
+        years_.push_back(r.year);
+        period_types_.push_back(r.period_type);
+    }
+
+    // field-major, so each pass writes one contiguous array
+    columns_.reserve(std::size(kFinanceStoreFields));
+    for (const auto& f : kFinanceStoreFields) {
+        I64Column& c = columns_.emplace_back(n);
+        for (std::size_t i = 0; i < n; ++i) c.set(i, rows[i].*f.field);
+    }
+    for (std::size_t i = 0; i < n; ++i) eps_.set(i, rows[i].eps);
+}
+
+std::size_t FinanceStore::field_index(Field field)
+{
+    for (std::size_t i = 0; i < std::size(kFinanceStoreFields); ++i) {
+        if (kFinanceStoreFields[i].field == field) return i;
+    }
+    throw std::invalid_argument("field is not stored");
+}
+
+std::size_t FinanceStore::bytes() const
+{
+    std::size_t bytes = years_.capacity() * sizeof(int);
+    bytes += period_types_.capacity() * sizeof(std::string);
+    for (const auto& p : period_types_) bytes += p.capacity();
+
+    const std::size_t bitmap_words = (size() + 63) / 64;
+    bytes += (columns_.size() + 1) * (size() * 8 + bitmap_words * 8);
+    return bytes;
+}
+
+// *
+// **
+// ***
+// ****
+// ***** SCALAR KERNELS
+
+namespace {
+
+void require_same_size(std::size_t a, std::size_t b)
+{
+    if (a != b) throw std::invalid_argument("column sizes differ");
+}
+
+// Kernels first set bits for the rows their own arithmetic accepts, then
+// drop the rows null in either input here.
+void and_validity(ValidityBitmap& out,
+                  const ValidityBitmap& a,
+                  const ValidityBitmap& b)
+{
+    for (std::size_t w = 0; w < out.word_count(); ++w) {
+        out.words()[w] &= a.words()[w] & b.words()[w];
+    }
+}
+
+void set_all_valid(ValidityBitmap& out)
+{
+    for (std::size_t w = 0; w < out.word_count(); ++w) {
+        out.words()[w] = ~std::uint64_t{0};
+    }
+}
+
+bool finite_nonzero(double v)
+{
+    return std::isfinite(v) && v != 0.0;
+}
+
+// Shared by both paths for the rows past the last full vector.
+void div_scalar(const F64Column& num,
+                const F64Column& den,
+                F64Column& out,
+                std::size_t from)
+{
+    for (std::size_t i = from; i < out.size(); ++i) {
+        const double n = num.values[i];
+        const double d = den.values[i];
+        if (!finite_nonzero(n) || !finite_nonzero(d)) continue;
+        out.values[i] = n / d;
+        out.valid.set(i);
+    }
+}
+
+void percent_change_scalar(const F64Column& cur,
+                           const F64Column& prev,
+                           F64Column& out,
+                           std::size_t from)
+{
+    for (std::size_t i = from; i < out.size(); ++i) {
+        const double c = cur.values[i];
+        const double p = prev.values[i];
+        if (!std::isfinite(c) || !finite_nonzero(p)) continue;
+        out.values[i] = ((c - p) / std::abs(p)) * 100.0;
+        out.valid.set(i);
+    }
+}
+
+void ratio_percent_change_scalar(const F64Column& cur,
+                                 const F64Column& prev,
+                                 F64Column& out,
+                                 std::size_t from)
+{
+    for (std::size_t i = from; i < out.size(); ++i) {
+        const double c = cur.values[i];
+        const double p = prev.values[i];
+        if (!finite_nonzero(c) || !finite_nonzero(p)) continue;
+
+        const double plain = ((c - p) / p) * 100.0;
+        if (p < 0.0 && c < 0.0)
+            out.values[i] =
+                ((std::abs(p) - std::abs(c)) / std::abs(p)) * 100.0;
+        else if (p < 0.0 && c > 0.0)
+            out.values[i] = std::abs(plain);
+        else
+            out.values[i] = plain;
+        out.valid.set(i);
+    }
+}
+
+// *
+// **
+// ***
+// ****
+// ***** AVX2 KERNELS
+
+#if defined(INTRINSIC_AVX2_KERNELS)
+
+#define INTRINSIC_AVX2 __attribute__((target("avx2")))
+
+// Four lanes' mask bits land inside one bitmap word, since 64 % 4 == 0.
+INTRINSIC_AVX2 inline void
+store_mask(ValidityBitmap& out, std::size_t i, __m256d mask)
+{
+    const auto bits =
+        static_cast<std::uint64_t>(_mm256_movemask_pd(mask)) & 0xFu;
+    out.words()[i >> 6] |= bits << (i & 63);
+}
+
+INTRINSIC_AVX2 inline __m256d abs_pd(__m256d v)
+{
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+}
+
+INTRINSIC_AVX2 inline __m256d finite_pd(__m256d v)
+{
+    return _mm256_cmp_pd(
+        abs_pd(v), _mm256_set1_pd(HUGE_VAL), _CMP_LT_OQ);
+}
+
+INTRINSIC_AVX2 inline __m256d finite_nonzero_pd(__m256d v)
+{
+    return _mm256_and_pd(
+        finite_pd(v),
+        _mm256_cmp_pd(v, _mm256_setzero_pd(), _CMP_NEQ_OQ));
+}
+
+INTRINSIC_AVX2 std::size_t add_sub_avx2(const I64Column& a,
+                                        const I64Column& b,
+                                        I64Column& out,
+                                        bool subtract)
+{
+    const std::size_t n = out.size();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i x = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(a.values.data() + i));
+        const __m256i y = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(b.values.data() + i));
+        const __m256i r =
+            subtract ? _mm256_sub_epi64(x, y) : _mm256_add_epi64(x, y);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.values.data() + i),
+                            r);
+    }
+    return i;
+}
+
+INTRINSIC_AVX2 std::size_t
+div_avx2(const F64Column& num, const F64Column& den, F64Column& out)
+{
+    const std::size_t n = out.size();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d x = _mm256_loadu_pd(num.values.data() + i);
+        const __m256d y = _mm256_loadu_pd(den.values.data() + i);
+        const __m256d ok =
+            _mm256_and_pd(finite_nonzero_pd(x), finite_nonzero_pd(y));
+        // rejected lanes divide by one, so no lane ever divides by zero
+        const __m256d safe = _mm256_blendv_pd(_mm256_set1_pd(1.0), y, ok);
+        _mm256_storeu_pd(out.values.data() + i, _mm256_div_pd(x, safe));
+        store_mask(out.valid, i, ok);
+    }
+    return i;
+}
+
+INTRINSIC_AVX2 std::size_t percent_change_avx2(const F64Column& cur,
+                                               const F64Column& prev,
+                                               F64Column& out)
+{
+    const __m256d hundred = _mm256_set1_pd(100.0);
+    const std::size_t n = out.size();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d c = _mm256_loadu_pd(cur.values.data() + i);
+        const __m256d p = _mm256_loadu_pd(prev.values.data() + i);
+        const __m256d ok = _mm256_and_pd(finite_pd(c), finite_nonzero_pd(p));
+        const __m256d den = _mm256_blendv_pd(hundred, abs_pd(p), ok);
+        const __m256d r =
+            _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(c, p), den), hundred);
+        _mm256_storeu_pd(out.values.data() + i, r);
+        store_mask(out.valid, i, ok);
+    }
+    return i;
+}
+
+INTRINSIC_AVX2 std::size_t ratio_percent_change_avx2(const F64Column& cur,
+                                                     const F64Column& prev,
+                                                     F64Column& out)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d hundred = _mm256_set1_pd(100.0);
+    const std::size_t n = out.size();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d c = _mm256_loadu_pd(cur.values.data() + i);
+        const __m256d p0 = _mm256_loadu_pd(prev.values.data() + i);
+        const __m256d ok =
+            _mm256_and_pd(finite_nonzero_pd(c), finite_nonzero_pd(p0));
+        const __m256d p = _mm256_blendv_pd(hundred, p0, ok);
+
+        const __m256d plain =
+            _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(c, p), p), hundred);
+        const __m256d both_negative =
+            _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(abs_pd(p), abs_pd(c)),
+                                        abs_pd(p)),
+                          hundred);
+
+        const __m256d p_neg = _mm256_cmp_pd(p, zero, _CMP_LT_OQ);
+        const __m256d c_neg = _mm256_cmp_pd(c, zero, _CMP_LT_OQ);
+        const __m256d c_pos = _mm256_cmp_pd(c, zero, _CMP_GT_OQ);
+
+        __m256d r = plain;
+        r = _mm256_blendv_pd(
+            r, abs_pd(plain), _mm256_and_pd(p_neg, c_pos));
+        r = _mm256_blendv_pd(
+            r, both_negative, _mm256_and_pd(p_neg, c_neg));
+        _mm256_storeu_pd(out.values.data() + i, r);
+        store_mask(out.valid, i, ok);
+    }
+    return i;
+}
+
+#undef INTRINSIC_AVX2
+
+#endif
+
+bool use_avx2(KernelIsa isa)
+{
+    return isa == KernelIsa::Avx2 && best_kernel_isa() == KernelIsa::Avx2;
+}
+
+I64Column add_sub(const I64Column& a,
+                  const I64Column& b,
+                  KernelIsa isa,
+                  bool subtract)
+{
+    require_same_size(a.size(), b.size());
+    I64Column out(a.size());
+    std::size_t i = 0;
+#if defined(INTRINSIC_AVX2_KERNELS)
+    if (use_avx2(isa)) i = add_sub_avx2(a, b, out, subtract);
+#else
+    (void)isa;
+#endif
+    // wrap like the hardware lanes do instead of overflowing
+    for (; i < out.size(); ++i) {
+        const auto x = static_cast<std::uint64_t>(a.values[i]);
+        const auto y = static_cast<std::uint64_t>(b.values[i]);
+        out.values[i] = static_cast<std::int64_t>(subtract ? x - y : x + y);
+    }
+    set_all_valid(out.valid);
+    and_validity(out.valid, a.valid, b.valid);
+    return out;
+}
+
+} // namespace
+
+// *
+// **
+// ***
+// ****
+// ***** DISPATCH
+
+KernelIsa best_kernel_isa()
+{
+#if defined(INTRINSIC_AVX2_KERNELS)
+    static const KernelIsa isa = __builtin_cpu_supports("avx2")
+                                     ? KernelIsa::Avx2
+                                     : KernelIsa::Scalar;
+    return isa;
+#else
+    return KernelIsa::Scalar;
+#endif
+}
+
+F64Column to_f64(const I64Column& v)
+{
+    // AVX2 has no int64 -> double convert; this loop is left to the compiler
+    F64Column out(v.size());
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        out.values[i] = static_cast<double>(v.values[i]);
+    }
+    out.valid = v.valid;
+    return out;
+}
+
+I64Column add_i64(const I64Column& a, const I64Column& b, KernelIsa isa)
+{
+    return add_sub(a, b, isa, false);
+}
+
+I64Column sub_i64(const I64Column& a, const I64Column& b, KernelIsa isa)
+{
+    return add_sub(a, b, isa, true);
+}
+
+F64Column
+div_opt_nonzero(const F64Column& num, const F64Column& den, KernelIsa isa)
+{
+    require_same_size(num.size(), den.size());
+    F64Column out(num.size());
+    std::size_t i = 0;
+#if defined(INTRINSIC_AVX2_KERNELS)
+    if (use_avx2(isa)) i = div_avx2(num, den, out);
+#else
+    (void)isa;
+#endif
+    div_scalar(num, den, out, i);
+    and_validity(out.valid, num.valid, den.valid);
+    return out;
+}
+
+F64Column percent_change(const F64Column& current,
+                         const F64Column& previous,
+                         KernelIsa isa)
+{
+    require_same_size(current.size(), previous.size());
+    F64Column out(current.size());
+    std::size_t i = 0;
+#if defined(INTRINSIC_AVX2_KERNELS)
+    if (use_avx2(isa)) i = percent_change_avx2(current, previous, out);
+#else
+    (void)isa;
+#endif
+    percent_change_scalar(current, previous, out, i);
+    and_validity(out.valid, current.valid, previous.valid);
+    return out;
+}
+
+F64Column ratio_percent_change(const F64Column& current,
+                               const F64Column& previous,
+                               KernelIsa isa)
+{
+    require_same_size(current.size(), previous.size());
+    F64Column out(current.size());
+    std::size_t i = 0;
+#if defined(INTRINSIC_AVX2_KERNELS)
+    if (use_avx2(isa)) i = ratio_percent_change_avx2(current, previous, out);
+#else
+    (void)isa;
+#endif
+    ratio_percent_change_scalar(current, previous, out, i);
+    and_validity(out.valid, current.valid, previous.valid);
+    return out;
+}
+
+F64Column gather(const F64Column& v, const std::vector<int>& index)
+{
+    F64Column out(index.size());
+    for (std::size_t i = 0; i < index.size(); ++i) {
+        const int j = index[i];
+        if (j < 0 || static_cast<std::size_t>(j) >= v.size()) continue;
+        out.set(i, v.at(static_cast<std::size_t>(j)));
+    }
+    return out;
+}
+
+} // namespace metrics
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "db/database.hpp"
+
+// Columnar copy of a ticker's finances for batch work (screens, exports,
+// history charts): one contiguous array per field plus a validity bitmap,
+// and kernels that evaluate the metric_math.hpp helpers over whole columns.
+// Kernels propagate nulls by ANDing the input bitmaps word by word; values
+// under a cleared bit are unspecified.
+
+namespace metrics {
+
+// One bit per row, set when the row holds a value. Bits past size() are
+// always clear, so word-wise ANDs never leak into the tail.
+class ValidityBitmap {
+public:
+    ValidityBitmap() = default;
+    explicit ValidityBitmap(std::size_t size)
+        : size_(size), words_((size + 63) / 64, 0)
+    {
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t word_count() const { return words_.size(); }
+    const std::uint64_t* words() const { return words_.data(); }
+    std::uint64_t* words() { return words_.data(); }
+
+    bool test(std::size_t i) const
+    {
+        return (words_[i >> 6] >> (i & 63)) & 1u;
+    }
+
+    void set(std::size_t i)
+    {
+        words_[i >> 6] |= std::uint64_t{1} << (i & 63);
+    }
+
+    std::size_t count() const;
+
+    // Rows valid in both `a` and `b`, which must be the same size.
+    static ValidityBitmap both(const ValidityBitmap& a,
+                               const ValidityBitmap& b);
+
+private:
+    std::size_t size_{0};
+    std::vector<std::uint64_t> words_;
+};
+
+template <class T> struct Column {
+    std::vector<T> values;
+    ValidityBitmap valid;
+
+    Column() = default;
+    explicit Column(std::size_t size) : values(size, T{}), valid(size) {}
+
+    std::size_t size() const { return values.size(); }
+
+    std::optional<T> at(std::size_t i) const
+    {
+        if (!valid.test(i)) return std::nullopt;
+        return values[i];
+    }
+
+    void set(std::size_t i, std::optional<T> v)
+    {
+        if (!v.has_value()) return;
+        values[i] = *v;
+        valid.set(i);
+    }
+};
+
+using I64Column = Column<std::int64_t>;
+using F64Column = Column<double>;
+
+struct FinanceStoreField {
+    const char* name;
+    std::optional<std::int64_t> db::Database::FinanceRow::*field;
+};
+
+// Every integer field of FinanceRow, in declaration order.
+inline constexpr FinanceStoreField kFinanceStoreFields[] = {
+    {"current_assets", &db::Database::FinanceRow::current_assets},
+    {"non_current_assets", &db::Database::FinanceRow::non_current_assets},
+    {"cash_and_equivalents", &db::Database::FinanceRow::cash_and_equivalents},
+    {"cash_flow_from_financing",
+     &db::Database::FinanceRow::cash_flow_from_financing},
+    {"cash_flow_from_investing",
+     &db::Database::FinanceRow::cash_flow_from_investing},
+    {"cash_flow_from_operations",
+     &db::Database::FinanceRow::cash_flow_from_operations},
+    {"revenue", &db::Database::FinanceRow::revenue},
+    {"current_liabilities", &db::Database::FinanceRow::current_liabilities},
+    {"non_current_liabilities",
+     &db::Database::FinanceRow::non_current_liabilities},
+    {"net_income", &db::Database::FinanceRow::net_income},
+    {"total_loans", &db::Database::FinanceRow::total_loans},
+    {"goodwill", &db::Database::FinanceRow::goodwill},
+    {"total_assets", &db::Database::FinanceRow::total_assets},
+    {"total_deposits", &db::Database::FinanceRow::total_deposits},
+    {"total_liabilities", &db::Database::FinanceRow::total_liabilities},
+    {"net_interest_income", &db::Database::FinanceRow::net_interest_income},
+    {"non_interest_income", &db::Database::FinanceRow::non_interest_income},
+    {"loan_loss_provisions", &db::Database::FinanceRow::loan_loss_provisions},
+    {"non_interest_expense", &db::Database::FinanceRow::non_interest_expense},
+    {"risk_weighted_assets", &db::Database::FinanceRow::risk_weighted_assets},
+    {"common_equity_tier1", &db::Database::FinanceRow::common_equity_tier1},
+    {"net_charge_offs", &db::Database::FinanceRow::net_charge_offs},
+    {"non_performing_loans", &db::Database::FinanceRow::non_performing_loans},
+    {"insurance_reserves", &db::Database::FinanceRow::insurance_reserves},
+    {"earned_premiums", &db::Database::FinanceRow::earned_premiums},
+    {"claims_incurred", &db::Database::FinanceRow::claims_incurred},
+    {"interest_expenses", &db::Database::FinanceRow::interest_expenses},
+    {"total_expenses", &db::Database::FinanceRow::total_expenses},
+    {"underwriting_expenses",
+     &db::Database::FinanceRow::underwriting_expenses},
+    {"total_debt", &db::Database::FinanceRow::total_debt},
+};
+
+class FinanceStore {
+public:
+    using Field = std::optional<std::int64_t> db::Database::FinanceRow::*;
+
+    FinanceStore() = default;
+    explicit FinanceStore(const std::vector<db::Database::FinanceRow>& rows);
+
+    std::size_t size() const { return years_.size(); }
+
+    const std::vector<int>& years() const { return years_; }
+    const std::vector<std::string>& period_types() const
+    {
+        return period_types_;
+    }
+
+    // Position of `field` in kFinanceStoreFields. Throws
+    // std::invalid_argument for a field missing from it, as does column().
+    static std::size_t field_index(Field field);
+
+    const I64Column& column(Field field) const
+    {
+        return columns_[field_index(field)];
+    }
+    const F64Column& eps() const { return eps_; }
+
+    // Estimated heap footprint.
+    std::size_t bytes() const;
+
+private:
+    std::vector<int> years_;
+    std::vector<std::string> period_types_;
+    std::vector<I64Column> columns_; // kFinanceStoreFields order
+    F64Column eps_;
+};
+
+// *
+// **
+// ***
+// ****
+// ***** KERNELS
+
+enum class KernelIsa { Scalar, Avx2 };
+
+// Widest kernel set this CPU runs; asking for more falls back to scalar.
+KernelIsa best_kernel_isa();
+
+// Column versions of the metric_math.hpp helpers of the same name. Both
+// operands must be the same size (std::invalid_argument otherwise).
+F64Column to_f64(const I64Column& v);
+I64Column add_i64(const I64Column& a,
+                  const I64Column& b,
+                  KernelIsa isa = best_kernel_isa());
+I64Column sub_i64(const I64Column& a,
+                  const I64Column& b,
+                  KernelIsa isa = best_kernel_isa());
+F64Column div_opt_nonzero(const F64Column& num,
+                          const F64Column& den,
+                          KernelIsa isa = best_kernel_isa());
+F64Column percent_change(const F64Column& current,
+                         const F64Column& previous,
+                         KernelIsa isa = best_kernel_isa());
+F64Column ratio_percent_change(const F64Column& current,
+                               const F64Column& previous,
+                               KernelIsa isa = best_kernel_isa());
+
+// Row `index[i]` of `v` for each i; negative indexes give null rows. Lines
+// a column up with, e.g., the same period a year earlier.
+F64Column gather(const F64Column& v, const std::vector<int>& index);
+
+} // namespace metrics
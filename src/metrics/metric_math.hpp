@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "db/database.hpp"
+
+// Curses-free period and metric arithmetic shared by the ticker views and
+// the decoded history cache.
+
+namespace metrics {
+
+inline std::optional<std::int64_t> add_i64(std::optional<std::int64_t> a,
+                                           std::optional<std::int64_t> b)
+{
+    if (!a.has_value() || !b.has_value()) return std::nullopt;
+    return *a + *b;
+}
+
+inline std::optional<std::int64_t> sub_i64(std::optional<std::int64_t> a,
+                                           std::optional<std::int64_t> b)
+{
+    if (!a.has_value() || !b.has_value()) return std::nullopt;
+    return *a - *b;
+}
+
+inline std::optional<double> to_f64(std::optional<std::int64_t> v)
+{
+    if (!v.has_value()) return std::nullopt;
+    return static_cast<double>(*v);
+}
+
+inline std::optional<std::int64_t> derive_underwriting_expenses(
+    std::optional<std::int64_t> total_expenses,
+    std::optional<std::int64_t> claims_incurred,
+    std::optional<std::int64_t> interest_expenses,
+    std::optional<std::int64_t> fallback = std::nullopt)
+{
+    if (!total_expenses.has_value() || !claims_incurred.has_value()) {
+        return fallback;
+    }
+    return *total_expenses - *claims_incurred - interest_expenses.value_or(0);
+}
+
+inline std::optional<std::int64_t>
+derived_underwriting_expenses_for_row(const db::Database::FinanceRow& row)
+{
+    return derive_underwriting_expenses(row.total_expenses,
+                                        row.claims_incurred,
+                                        row.interest_expenses,
+                                        row.underwriting_expenses);
+}
+
+inline std::optional<double> div_opt(std::optional<double> num,
+                                     std::optional<double> den)
+{
+    if (!num.has_value() || !den.has_value()) return std::nullopt;
+    if (*den == 0.0) return std::nullopt;
+    return *num / *den;
+}
+
+inline bool has_non_zero_value(std::optional<double> v)
+{
+    return v.has_value() && std::isfinite(*v) && *v != 0.0;
+}
+
+inline std::optional<double> null_if_zero_or_invalid(std::optional<double> v)
+{
+    if (!has_non_zero_value(v)) return std::nullopt;
+    return v;
+}
+
+inline std::optional<double> null_if_negative(std::optional<double> v)
+{
+    if (!v.has_value() || !std::isfinite(*v)) return std::nullopt;
+    if (*v < 0.0) return std::nullopt;
+    return v;
+}
+
+inline std::optional<double> div_opt_nonzero(std::optional<double> num,
+                                             std::optional<double> den)
+{
+    if (!has_non_zero_value(num) || !has_non_zero_value(den))
+        return std::nullopt;
+    return *num / *den;
+}
+
+inline std::optional<double> add_opt(std::optional<double> a,
+                                     std::optional<double> b)
+{
+    if (!a.has_value() || !b.has_value()) return std::nullopt;
+    return *a + *b;
+}
+
+// Share count implied by net income / eps, rounded to whole shares.
+inline std::optional<double> approx_shares(std::optional<double> net_income,
+                                           std::optional<double> eps)
+{
+    const auto raw = div_opt_nonzero(net_income, eps);
+    if (!raw.has_value()) return std::nullopt;
+    return std::round(*raw);
+}
+
+// Loss ratio plus expense ratio, both over earned premiums.
+inline std::optional<double>
+combined_ratio(std::optional<double> claims_incurred,
+               std::optional<double> underwriting_expenses,
+               std::optional<double> earned_premiums)
+{
+    return add_opt(div_opt_nonzero(claims_incurred, earned_premiums),
+                   div_opt_nonzero(underwriting_expenses, earned_premiums));
+}
+
+inline std::optional<double> mul_opt_nonzero(std::optional<double> a,
+                                             std::optional<double> b)
+{
+    if (!has_non_zero_value(a) || !has_non_zero_value(b)) return std::nullopt;
+    return *a * *b;
+}
+
+inline std::optional<double> mul_opt(std::optional<double> a,
+                                     std::optional<double> b)
+{
+    if (!a.has_value() || !b.has_value()) return std::nullopt;
+    return *a * *b;
+}
+
+inline bool is_valid_number(std::optional<double> v)
+{
+    return v.has_value() && std::isfinite(*v);
+}
+
+// Year-over-year style change in percent, for amounts.
+inline std::optional<double> percent_change(std::optional<double> current,
+                                            std::optional<double> previous)
+{
+    if (!current.has_value() || !previous.has_value()) return std::nullopt;
+    if (!std::isfinite(*current) || !std::isfinite(*previous))
+        return std::nullopt;
+    if (*previous == 0.0) return std::nullopt;
+    return ((*current - *previous) / std::abs(*previous)) * 100.0;
+}
+
+// Same for ratios, where a move between negative values or from negative
+// to positive is read as an improvement.
+inline std::optional<double>
+ratio_percent_change(std::optional<double> current,
+                     std::optional<double> previous)
+{
+    if (!current.has_value() || !previous.has_value()) return std::nullopt;
+    if (!std::isfinite(*current) || !std::isfinite(*previous))
+        return std::nullopt;
+    if (*current == 0.0 || *previous == 0.0) return std::nullopt;
+
+    if (*previous < 0.0 && *current < 0.0) {
+        return ((std::abs(*previous) - std::abs(*current)) /
+                std::abs(*previous)) *
+               100.0;
+    }
+
+    if (*previous < 0.0 && *current > 0.0) {
+        return std::abs(((*current - *previous) / *previous) * 100.0);
+    }
+
+    return ((*current - *previous) / *previous) * 100.0;
+}
+
+inline char period_type_family(std::string_view period_type)
+{
+    if (period_type.empty()) return '\0';
+    return static_cast<char>(
+        std::toupper(static_cast<unsigned char>(period_type[0])));
+}
+
+inline char period_family(const db::Database::FinanceRow& row)
+{
+    return period_type_family(row.period_type);
+}
+
+inline int ttm_window_for_family(char family)
+{
+    if (family == 'Q') return 4;
+    if (family == 'S') return 2;
+    return 0;
+}
+
+// Sums the value of the `required_periods` most recent entries of `family`
+// at or before `from_index`, skipping other families. Any missing or
+// non-finite value in that window, or too few entries, gives nullopt.
+template <class FamilyAt, class ValueAt>
+inline std::optional<double> ttm_sum_backwards(int from_index,
+                                               char family,
+                                               int required_periods,
+                                               FamilyAt family_at,
+                                               ValueAt value_at)
+{
+    if (from_index < 0 || required_periods <= 0) return std::nullopt;
+
+    int collected = 0;
+    double sum = 0.0;
+
+    for (int i = from_index; i >= 0 && collected < required_periods; --i) {
+        if (family_at(i) != family) continue;
+        auto value = value_at(i);
+        if (!value.has_value() || !std::isfinite(*value)) return std::nullopt;
+        sum += *value;
+        collected += 1;
+    }
+
+    if (collected < required_periods) return std::nullopt;
+    return sum;
+}
+
+template <class Getter>
+inline std::optional<double>
+ttm_sum_for_family(const std::vector<db::Database::FinanceRow>& rows,
+                   int from_index,
+                   char family,
+                   int required_periods,
+                   Getter getter)
+{
+    return ttm_sum_backwards(
+        from_index,
+        family,
+        required_periods,
+        [&](int i) { return period_family(rows[i]); },
+        [&](int i) -> std::optional<double> { return getter(rows[i]); });
+}
+
+inline std::string period_label(const db::Database::FinanceRow& row)
+{
+    return std::to_string(row.year) + "-" + row.period_type;
+}
+
+inline bool is_yearly_period(const db::Database::FinanceRow& row)
+{
+    return row.period_type == "Y";
+}
+
+inline int find_period_index(const std::vector<db::Database::FinanceRow>& rows,
+                             const std::string& period)
+{
+    const auto it = std::find_if(rows.begin(), rows.end(), [&](const auto& r) {
+        return period_label(r) == period;
+    });
+    if (it == rows.end()) return -1;
+    return static_cast<int>(std::distance(rows.begin(), it));
+}
+
+inline const db::Database::FinanceRow* find_previous_year_same_period(
+    const std::vector<db::Database::FinanceRow>& rows,
+    const db::Database::FinanceRow& row)
+{
+    const int prev_year = row.year - 1;
+    const auto it =
+        std::find_if(rows.begin(), rows.end(), [&](const auto& candidate) {
+            return candidate.year == prev_year &&
+                   candidate.period_type == row.period_type;
+        });
+    if (it == rows.end()) return nullptr;
+    return &(*it);
+}
+
+// Trailing-twelve-month sums a ticker view needs for one period. All empty
+// for yearly rows and for windows with a missing or non-finite value.
+struct Ttm {
+    std::optional<double> eps;
+    std::optional<double> net_income;
+    std::optional<double> cash_flow_ops;
+};
+
+inline Ttm ttm_at(const std::vector<db::Database::FinanceRow>& rows, int index)
+{
+    Ttm out;
+    if (index < 0 || index >= static_cast<int>(rows.size())) return out;
+
+    const char family = period_family(rows[index]);
+    const int window = ttm_window_for_family(family);
+    if (window <= 0) return out;
+
+    out.eps = ttm_sum_for_family(
+        rows, index, family, window, [](const db::Database::FinanceRow& r) {
+            return r.eps;
+        });
+    out.net_income = ttm_sum_for_family(
+        rows, index, family, window, [](const db::Database::FinanceRow& r) {
+            return to_f64(r.net_income);
+        });
+    out.cash_flow_ops = ttm_sum_for_family(
+        rows, index, family, window, [](const db::Database::FinanceRow& r) {
+            return to_f64(r.cash_flow_from_operations);
+        });
+    return out;
+}
+
+} // namespace metrics
@@ -0,0 +1,68 @@
+#include "metrics/metric_matrix.hpp"
+
+#include <iterator>
+#include <string>
+#include <utility>
+
+namespace metrics {
+
+MetricMatrix::MetricMatrix(const FinanceStore& store, const YoyTable& yoy)
+{
+    periods_.reserve(store.size());
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        periods_.push_back(std::to_string(store.years()[i]) + "-" +
+                           store.period_types()[i]);
+    }
+
+    const auto add_row = [&](const char* name,
+                             MetricKind kind,
+                             F64Column values,
+                             F64Column changes) {
+        if (values.valid.count() == 0) return;
+        rows_.push_back({name, kind, std::move(values), std::move(changes)});
+    };
+
+    // raw fields, with their changes read back out of the yoy table
+    rows_.reserve(std::size(kFinanceStoreFields) + 1 +
+                  std::size(kFinanceMetricColumns));
+    for (const auto& f : kFinanceStoreFields) {
+        auto values = to_f64(store.column(f.field));
+        F64Column changes(store.size());
+        for (std::size_t i = 0; i < store.size(); ++i) {
+            changes.set(i, yoy.field_change(f.field, i));
+        }
+        add_row(f.name,
+                MetricKind::Amount,
+                std::move(values),
+                std::move(changes));
+    }
+
+    F64Column eps_changes(store.size());
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        eps_changes.set(i, yoy.eps_change(i));
+    }
+    add_row("eps", MetricKind::Amount, store.eps(), std::move(eps_changes));
+
+    for (std::size_t k = 0; k < std::size(kFinanceMetricColumns); ++k) {
+        F64Column changes(store.size());
+        for (std::size_t i = 0; i < store.size(); ++i) {
+            changes.set(i, yoy.metric_change(k, i));
+        }
+        add_row(kFinanceMetricColumns[k].name,
+                kFinanceMetricColumns[k].kind,
+                yoy.metric_values(k),
+                std::move(changes));
+    }
+}
+
+std::size_t MetricMatrix::bytes() const
+{
+    const std::size_t n = column_count();
+    const std::size_t column = n * 8 + ((n + 63) / 64) * 8;
+    std::size_t total = periods_.capacity() * sizeof(std::string);
+    for (const auto& p : periods_) total += p.capacity();
+    return total + rows_.capacity() * sizeof(MetricMatrixRow) +
+           rows_.size() * 2 * column;
+}
+
+} // namespace metrics
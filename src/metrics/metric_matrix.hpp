@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "metrics/finance_metrics.hpp"
+#include "metrics/finance_store.hpp"
+#include "metrics/yoy_table.hpp"
+
+// Every raw field and derived metric of one ticker against every period,
+// laid out metric-major so the matrix view can pull any window of cells
+// without recomputing. Built in bulk from the history's columns; rows with
+// no value in any period are left out.
+
+namespace metrics {
+
+struct MetricMatrixRow {
+    std::string name; // kFinanceStoreFields / kFinanceMetricColumns name
+    MetricKind kind = MetricKind::Amount;
+    F64Column values;
+    F64Column changes; // year-over-year, in percent
+};
+
+class MetricMatrix {
+public:
+    MetricMatrix() = default;
+    MetricMatrix(const FinanceStore& store, const YoyTable& yoy);
+
+    std::size_t row_count() const { return rows_.size(); }
+    std::size_t column_count() const { return periods_.size(); }
+
+    const MetricMatrixRow& row(std::size_t i) const { return rows_[i]; }
+    // "<year>-<period_type>" of column `i`, oldest first.
+    const std::string& period(std::size_t i) const { return periods_[i]; }
+
+    // Estimated heap footprint.
+    std::size_t bytes() const;
+
+private:
+    std::vector<std::string> periods_;
+    std::vector<MetricMatrixRow> rows_; // fields, eps, then derived
+};
+
+} // namespace metrics
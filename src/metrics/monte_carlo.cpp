@@ -0,0 +1,325 @@
+#include "metrics/monte_carlo.hpp"
+#include "metrics/finance_metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+
+namespace metrics {
+
+namespace {
+
+constexpr std::size_t kChunkPaths = std::size_t{1} << 14;
+constexpr std::size_t kLanes = 8;
+
+constexpr double kMinGrowth = -0.5;
+constexpr double kMaxGrowth = 0.5;
+constexpr double kMinMargin = -1.0;
+constexpr double kMaxMargin = 1.0;
+constexpr double kMaxDiscount = 0.30;
+// discount always clears terminal growth by this much
+constexpr double kMinDiscountSpread = 0.01;
+constexpr double kDiscountSd = 0.01;
+
+std::uint64_t splitmix64(std::uint64_t& x)
+{
+    std::uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256+ over kLanes independent streams, state laid out lane-minor so
+// every step is the same shift/xor over a short array and vectorizes.
+class LaneRng {
+public:
+    explicit LaneRng(std::uint64_t seed)
+    {
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            for (auto& word : s_) word[lane] = splitmix64(seed);
+        }
+    }
+
+    // Uniforms in (0, 1].
+    void uniform(double* out)
+    {
+        for (std::size_t i = 0; i < kLanes; ++i) {
+            const std::uint64_t result = s_[0][i] + s_[3][i];
+            const std::uint64_t t = s_[1][i] << 17;
+            s_[2][i] ^= s_[0][i];
+            s_[3][i] ^= s_[1][i];
+            s_[1][i] ^= s_[2][i];
+            s_[0][i] ^= s_[3][i];
+            s_[2][i] ^= t;
+            s_[3][i] = (s_[3][i] << 45) | (s_[3][i] >> 19);
+            out[i] = static_cast<double>((result >> 11) + 1) * 0x1.0p-53;
+        }
+    }
+
+    // Two standard normals per lane (Box-Muller).
+    void normal_pair(double* a, double* b)
+    {
+        constexpr double kTwoPi = 6.283185307179586;
+        double u1[kLanes];
+        double u2[kLanes];
+        uniform(u1);
+        uniform(u2);
+        for (std::size_t i = 0; i < kLanes; ++i) {
+            const double r = std::sqrt(-2.0 * std::log(u1[i]));
+            a[i] = r * std::cos(kTwoPi * u2[i]);
+            b[i] = r * std::sin(kTwoPi * u2[i]);
+        }
+    }
+
+private:
+    std::uint64_t s_[4][kLanes];
+};
+
+NormalDist fit_normal(const std::vector<double>& v)
+{
+    NormalDist out;
+    if (v.empty()) return out;
+    out.mean = std::accumulate(v.begin(), v.end(), 0.0) /
+               static_cast<double>(v.size());
+    if (v.size() < 2) return out;
+    double ss = 0.0;
+    for (const double x : v) ss += (x - out.mean) * (x - out.mean);
+    out.sd = std::sqrt(ss / static_cast<double>(v.size() - 1));
+    return out;
+}
+
+std::optional<double> latest(const F64Column& column,
+                             const std::vector<std::size_t>& rows)
+{
+    for (auto it = rows.rbegin(); it != rows.rend(); ++it) {
+        if (const auto v = column.at(*it); v.has_value()) return v;
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+// *
+// **
+// ***
+// ****
+// ***** INPUTS
+
+std::optional<DcfInputs> dcf_inputs(const FinanceStore& store,
+                                    const YoyTable& yoy)
+{
+    using Row = db::Database::FinanceRow;
+
+    std::vector<std::size_t> yearly;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        if (store.period_types()[i] == "Y") yearly.push_back(i);
+    }
+
+    // cash flow per year: operating cash flow, else net income
+    const auto cfop = to_f64(store.column(&Row::cash_flow_from_operations));
+    const auto ni = to_f64(store.column(&Row::net_income));
+    F64Column cash(store.size());
+    for (const std::size_t i : yearly) {
+        cash.set(i, cfop.valid.test(i) ? cfop.at(i) : ni.at(i));
+    }
+
+    // model revenue * margin when revenue is reported, cash flow alone
+    // (margin 1) otherwise, e.g. for banks
+    const auto revenue = to_f64(store.column(&Row::revenue));
+    const bool use_revenue =
+        std::count_if(yearly.begin(), yearly.end(), [&](std::size_t i) {
+            return revenue.valid.test(i);
+        }) >= 3;
+    const F64Column& base = use_revenue ? revenue : cash;
+
+    std::vector<double> growth;
+    std::vector<double> margin;
+    for (const std::size_t i : yearly) {
+        const int prev = yoy.previous_index(i);
+        const auto prev_cash =
+            prev >= 0 ? cash.at(static_cast<std::size_t>(prev)) : std::nullopt;
+        const auto change = use_revenue ? yoy.field_change(&Row::revenue, i)
+                                        : percent_change(cash.at(i), prev_cash);
+        if (change.has_value()) growth.push_back(*change / 100.0);
+
+        const auto m = div_opt_nonzero(cash.at(i), base.at(i));
+        if (m.has_value() && std::isfinite(*m)) margin.push_back(*m);
+    }
+
+    const std::size_t shares_index = static_cast<std::size_t>(
+        find_finance_metric("shares_approx") - kFinanceMetricColumns);
+    const auto shares = latest(yoy.metric_values(shares_index), yearly);
+    const auto last_base = latest(base, yearly);
+    if (growth.size() < 2 || margin.empty() || !last_base.has_value() ||
+        !shares.has_value() || !(*shares > 0.0)) {
+        return std::nullopt;
+    }
+
+    DcfInputs in;
+    in.base = *last_base;
+    in.shares = *shares;
+    in.growth = fit_normal(growth);
+    in.margin = use_revenue ? fit_normal(margin) : NormalDist{1.0, 0.0};
+    in.discount.mean = std::min(
+        kMaxDiscount, kDcfBaseDiscount + 0.5 * in.growth.sd);
+    in.discount.sd = kDiscountSd;
+    return in;
+}
+
+// *
+// **
+// ***
+// ****
+// ***** SIMULATION
+
+double dcf_value(const DcfInputs& in,
+                 double growth,
+                 double margin,
+                 double discount,
+                 const DcfParams& params)
+{
+    const double g = std::clamp(growth, kMinGrowth, kMaxGrowth);
+    const double m = std::clamp(margin, kMinMargin, kMaxMargin);
+    const double gt = params.terminal_growth;
+    const double r =
+        std::clamp(discount, gt + kMinDiscountSpread, kMaxDiscount);
+    const int n = std::max(1, params.years);
+
+    // sum of q^t for t = 1..n, then the terminal value at year n
+    const double q = (1.0 + g) / (1.0 + r);
+    const double qn = std::pow(q, n);
+    const double annuity = std::abs(1.0 - q) < 1e-12
+                               ? static_cast<double>(n)
+                               : q * (1.0 - qn) / (1.0 - q);
+    const double terminal = qn * (1.0 + gt) / (r - gt);
+    return in.base * m * (annuity + terminal) / in.shares;
+}
+
+DcfDistribution
+simulate_dcf(const DcfInputs& in, const DcfParams& params, WorkPool& pool)
+{
+    DcfDistribution out;
+    out.paths = params.paths;
+    if (params.paths == 0) return out;
+
+    const std::size_t paths = static_cast<std::size_t>(params.paths);
+    const std::size_t chunks = (paths + kChunkPaths - 1) / kChunkPaths;
+    std::vector<double> values(paths);
+
+    pool.parallel_for(chunks, [&](std::size_t chunk) {
+        std::uint64_t mix = params.seed ^ (chunk * 0xd1b54a32d192ed03);
+        LaneRng rng(splitmix64(mix));
+
+        const std::size_t begin = chunk * kChunkPaths;
+        const std::size_t end = std::min(paths, begin + kChunkPaths);
+        double zg[kLanes];
+        double zm[kLanes];
+        double zr[kLanes];
+        double unused[kLanes];
+        for (std::size_t i = begin; i < end; i += kLanes) {
+            rng.normal_pair(zg, zm);
+            rng.normal_pair(zr, unused);
+            const std::size_t lanes = std::min(kLanes, end - i);
+            for (std::size_t lane = 0; lane < lanes; ++lane) {
+                values[i + lane] = dcf_value(
+                    in,
+                    in.growth.mean + in.growth.sd * zg[lane],
+                    in.margin.mean + in.margin.sd * zm[lane],
+                    in.discount.mean + in.discount.sd * zr[lane],
+                    params);
+            }
+        }
+    });
+
+    out.mean = std::accumulate(values.begin(), values.end(), 0.0) /
+               static_cast<double>(paths);
+    std::sort(values.begin(), values.end());
+    out.quantiles.reserve(DcfDistribution::kQuantileSteps + 1);
+    for (std::size_t k = 0; k <= DcfDistribution::kQuantileSteps; ++k) {
+        const std::size_t at =
+            k * (paths - 1) / DcfDistribution::kQuantileSteps;
+        out.quantiles.push_back(values[at]);
+    }
+    return out;
+}
+
+double DcfDistribution::percentile(double p) const
+{
+    if (quantiles.empty()) return 0.0;
+    const double pos =
+        std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(kQuantileSteps);
+    const std::size_t lo = static_cast<std::size_t>(pos);
+    if (lo >= kQuantileSteps) return quantiles.back();
+    const double t = pos - static_cast<double>(lo);
+    return quantiles[lo] + t * (quantiles[lo + 1] - quantiles[lo]);
+}
+
+double DcfDistribution::probability_below(double price) const
+{
+    if (quantiles.empty()) return 0.0;
+    if (price < quantiles.front()) return 1.0;
+    if (price >= quantiles.back()) return 0.0;
+
+    // last step whose lower edge is at or under the price
+    const auto it =
+        std::upper_bound(quantiles.begin(), quantiles.end(), price);
+    const std::size_t k =
+        static_cast<std::size_t>(std::distance(quantiles.begin(), it)) - 1;
+    const double lo = quantiles[k];
+    const double hi = quantiles[k + 1];
+    const double t = hi > lo ? (price - lo) / (hi - lo) : 1.0;
+    const double cdf =
+        (static_cast<double>(k) + t) / static_cast<double>(kQuantileSteps);
+    return 1.0 - cdf;
+}
+
+// *
+// **
+// ***
+// ****
+// ***** CACHE
+
+DcfCache::Key DcfCache::key_(const std::string& ticker,
+                             std::uint64_t generation,
+                             const DcfParams& params)
+{
+    return {ticker,
+            generation,
+            params.paths,
+            params.years,
+            params.terminal_growth,
+            params.seed};
+}
+
+DcfCache::DistributionPtr DcfCache::get(const std::string& ticker,
+                                        std::uint64_t generation,
+                                        const FinanceStore& store,
+                                        const YoyTable& yoy,
+                                        const DcfParams& params,
+                                        WorkPool& pool)
+{
+    auto key = key_(ticker, generation, params);
+    if (const auto it = entries_.find(key); it != entries_.end()) {
+        return it->second;
+    }
+    if (entries_.size() >= kMaxEntries) clear();
+
+    DistributionPtr result;
+    if (const auto in = dcf_inputs(store, yoy); in.has_value()) {
+        result = std::make_shared<const DcfDistribution>(
+            simulate_dcf(*in, params, pool));
+    }
+    entries_.emplace(std::move(key), result);
+    return result;
+}
+
+DcfCache::DistributionPtr DcfCache::find(const std::string& ticker,
+                                         std::uint64_t generation,
+                                         const DcfParams& params) const
+{
+    const auto it = entries_.find(key_(ticker, generation, params));
+    return it == entries_.end() ? nullptr : it->second;
+}
+
+} // namespace metrics
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "metrics/finance_store.hpp"
+#include "metrics/work_pool.hpp"
+#include "metrics/yoy_table.hpp"
+
+// Monte Carlo DCF: intrinsic value per share when next years' growth,
+// cash margin and discount rate are drawn from distributions fitted to the
+// ticker's own yearly history. Paths run in fixed-size chunks on a
+// WorkPool, each chunk with its own lane-parallel generator seeded from
+// the chunk index, so a result depends only on the inputs and DcfParams,
+// never on the thread count.
+
+namespace metrics {
+
+struct DcfParams {
+    std::uint64_t paths = std::uint64_t{1} << 20;
+    int years = 10;
+    double terminal_growth = 0.02;
+    std::uint64_t seed = 0x9e3779b97f4a7c15;
+};
+
+struct NormalDist {
+    double mean = 0.0;
+    double sd = 0.0;
+};
+
+struct DcfInputs {
+    double base = 0.0;   // latest yearly revenue, or cash flow without one
+    double shares = 0.0; // latest yearly shares_approx
+    NormalDist growth;   // yearly growth of base, as a fraction
+    NormalDist margin;   // cash flow (CFop, else NI) over base
+    NormalDist discount; // yearly rate; riskier with more volatile growth
+};
+
+// Discount rate of a ticker with perfectly steady growth; each point of
+// growth volatility adds half a point.
+inline constexpr double kDcfBaseDiscount = 0.08;
+
+// Fits inputs to the yearly rows. Empty without two year-over-year growth
+// observations, a cash flow figure or a share count.
+std::optional<DcfInputs> dcf_inputs(const FinanceStore& store,
+                                    const YoyTable& yoy);
+
+// Value per share of one path: `years` of cash flow base * margin growing
+// at `growth`, plus a Gordon terminal value, discounted at `discount`.
+// Draws are clamped to sane ranges first (see monte_carlo.cpp).
+double dcf_value(const DcfInputs& in,
+                 double growth,
+                 double margin,
+                 double discount,
+                 const DcfParams& params);
+
+struct DcfDistribution {
+    // Values at 0%, 0.1%, ..., 100% of the sorted paths.
+    static constexpr std::size_t kQuantileSteps = 1000;
+
+    std::uint64_t paths = 0;
+    double mean = 0.0;
+    std::vector<double> quantiles;
+
+    // Value at percentile `p` in [0, 100], interpolated.
+    double percentile(double p) const;
+    // Share of paths worth more than `price`: P(price < value).
+    double probability_below(double price) const;
+};
+
+DcfDistribution
+simulate_dcf(const DcfInputs& in, const DcfParams& params, WorkPool& pool);
+
+// Distributions keyed by (ticker, generation, params).
+class DcfCache {
+public:
+    using DistributionPtr = std::shared_ptr<const DcfDistribution>;
+
+    // Simulates on a miss; null when dcf_inputs() finds too little history.
+    DistributionPtr get(const std::string& ticker,
+                        std::uint64_t generation,
+                        const FinanceStore& store,
+                        const YoyTable& yoy,
+                        const DcfParams& params,
+                        WorkPool& pool);
+    // Cached result only; never simulates.
+    DistributionPtr find(const std::string& ticker,
+                         std::uint64_t generation,
+                         const DcfParams& params) const;
+
+    std::size_t size() const { return entries_.size(); }
+    void clear() { entries_.clear(); }
+
+    // Everything is dropped past this many entries.
+    static constexpr std::size_t kMaxEntries = 64;
+
+private:
+    using Key = std::tuple<std::string,
+                           std::uint64_t,
+                           std::uint64_t,
+                           int,
+                           double,
+                           std::uint64_t>;
+    static Key key_(const std::string& ticker,
+                    std::uint64_t generation,
+                    const DcfParams& params);
+
+    std::map<Key, DistributionPtr> entries_;
+};
+
+} // namespace metrics
@@ -0,0 +1,202 @@
+#include "metrics/portfolio.hpp"
+#include "metrics/metric_math.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace metrics {
+
+namespace {
+
+// 1 standard, 2 bank, 3 insurance; anything else counts as standard
+std::size_t type_slot(int ticker_type)
+{
+    return (ticker_type == 2 || ticker_type == 3)
+               ? static_cast<std::size_t>(ticker_type - 1)
+               : 0;
+}
+
+bool is_positive(std::optional<double> v)
+{
+    return is_valid_number(v) && *v > 0.0;
+}
+
+} // namespace
+
+std::optional<double> PortfolioPosition::value() const
+{
+    if (row.shares <= 0.0 || !is_positive(price)) return std::nullopt;
+    return row.shares * *price;
+}
+
+std::optional<double> PortfolioPosition::earnings_yield() const
+{
+    if (!is_positive(price)) return std::nullopt;
+    return div_opt_nonzero(row.eps, price);
+}
+
+std::optional<double> PortfolioPosition::price_earnings() const
+{
+    if (!is_positive(price)) return std::nullopt;
+    return div_opt_nonzero(price, row.eps);
+}
+
+std::optional<double> PortfolioPosition::price_tbv() const
+{
+    if (row.type != 2 || !is_positive(price)) return std::nullopt;
+    return div_opt_nonzero(price, row.tbv_per_share);
+}
+
+std::optional<double> PortfolioTotals::earnings_yield() const
+{
+    return div_opt_nonzero(earnings, earnings_value);
+}
+
+std::optional<double> PortfolioTotals::price_earnings() const
+{
+    return div_opt_nonzero(earnings_value, earnings);
+}
+
+std::optional<double> PortfolioTotals::bank_price_tbv() const
+{
+    return div_opt_nonzero(bank_value, bank_tbv);
+}
+
+std::optional<double> PortfolioTotals::insurer_combined_ratio() const
+{
+    return div_opt_nonzero(insurer_weighted_cr, insurer_value);
+}
+
+std::optional<double> PortfolioTotals::exposure(int ticker_type) const
+{
+    if (ticker_type < 1 || ticker_type > 3) return std::nullopt;
+    const double part = type_value[static_cast<std::size_t>(ticker_type - 1)];
+    if (value <= 0.0) return std::nullopt;
+    return part / value;
+}
+
+PortfolioTotals PortfolioAggregate::terms_of_(const PortfolioPosition& p)
+{
+    PortfolioTotals t;
+    if (p.row.shares <= 0.0) return t;
+
+    t.held = 1;
+    t.cost_basis = p.row.cost_basis;
+    const auto value = p.value();
+    if (!value.has_value()) {
+        t.unpriced = 1;
+        return t;
+    }
+
+    t.value = *value;
+    t.type_value[type_slot(p.row.type)] = *value;
+    if (is_valid_number(p.row.eps)) {
+        t.earnings = p.row.shares * *p.row.eps;
+        t.earnings_value = *value;
+    }
+    if (p.row.type == 2 && is_valid_number(p.row.tbv_per_share)) {
+        t.bank_value = *value;
+        t.bank_tbv = p.row.shares * *p.row.tbv_per_share;
+    }
+    if (p.row.type == 3 && is_valid_number(p.row.combined_ratio)) {
+        t.insurer_value = *value;
+        t.insurer_weighted_cr = *value * *p.row.combined_ratio;
+    }
+    return t;
+}
+
+void PortfolioAggregate::add_(const PortfolioTotals& terms, double sign)
+{
+    totals_.value += sign * terms.value;
+    totals_.cost_basis += sign * terms.cost_basis;
+    totals_.earnings += sign * terms.earnings;
+    totals_.earnings_value += sign * terms.earnings_value;
+    totals_.bank_value += sign * terms.bank_value;
+    totals_.bank_tbv += sign * terms.bank_tbv;
+    totals_.insurer_value += sign * terms.insurer_value;
+    totals_.insurer_weighted_cr += sign * terms.insurer_weighted_cr;
+    for (std::size_t i = 0; i < totals_.type_value.size(); ++i) {
+        totals_.type_value[i] += sign * terms.type_value[i];
+    }
+    const int step = sign > 0.0 ? 1 : -1;
+    totals_.held += step * terms.held;
+    totals_.unpriced += step * terms.unpriced;
+
+    // nothing left to weigh: drop the rounding residue of the sums
+    if (totals_.held == 0) totals_ = PortfolioTotals{};
+}
+
+void PortfolioAggregate::reset(std::vector<PortfolioPosition> positions)
+{
+    entries_.clear();
+    totals_ = PortfolioTotals{};
+    std::sort(positions.begin(),
+              positions.end(),
+              [](const PortfolioPosition& a, const PortfolioPosition& b) {
+                  return a.row.ticker < b.row.ticker;
+              });
+    entries_.reserve(positions.size());
+    for (auto& position : positions) {
+        Entry entry{std::move(position), {}};
+        entry.terms = terms_of_(entry.position);
+        add_(entry.terms, 1.0);
+        entries_.push_back(std::move(entry));
+    }
+}
+
+void PortfolioAggregate::upsert(PortfolioPosition position)
+{
+    const auto it = std::lower_bound(
+        entries_.begin(),
+        entries_.end(),
+        position.row.ticker,
+        [](const Entry& entry, const std::string& ticker) {
+            return entry.position.row.ticker < ticker;
+        });
+
+    Entry next{std::move(position), {}};
+    next.terms = terms_of_(next.position);
+    if (it != entries_.end() &&
+        it->position.row.ticker == next.position.row.ticker) {
+        add_(it->terms, -1.0);
+        add_(next.terms, 1.0);
+        *it = std::move(next);
+        return;
+    }
+    add_(next.terms, 1.0);
+    entries_.insert(it, std::move(next));
+}
+
+bool PortfolioAggregate::update_price(const std::string& ticker,
+                                      std::optional<double> price)
+{
+    const int i = find(ticker);
+    if (i < 0) return false;
+    auto position = entries_[static_cast<std::size_t>(i)].position;
+    position.price = price;
+    upsert(std::move(position));
+    return true;
+}
+
+void PortfolioAggregate::erase(const std::string& ticker)
+{
+    const int i = find(ticker);
+    if (i < 0) return;
+    add_(entries_[static_cast<std::size_t>(i)].terms, -1.0);
+    entries_.erase(entries_.begin() + i);
+}
+
+int PortfolioAggregate::find(const std::string& ticker) const
+{
+    const auto it = std::lower_bound(
+        entries_.begin(),
+        entries_.end(),
+        ticker,
+        [](const Entry& entry, const std::string& key) {
+            return entry.position.row.ticker < key;
+        });
+    if (it == entries_.end() || it->position.row.ticker != ticker) return -1;
+    return static_cast<int>(it - entries_.begin());
+}
+
+} // namespace metrics
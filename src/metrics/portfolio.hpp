@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "db/database.hpp"
+
+// Value-weighted valuation of the portfolio's holdings. Every aggregate is
+// a ratio of sums over positions, so each position keeps its own terms and
+// a holding or price change swaps one position's terms in and out of the
+// totals instead of summing the whole portfolio again.
+
+namespace metrics {
+
+struct PortfolioPosition {
+    db::Database::PortfolioRow row;
+    std::optional<double> price; // latest stored close
+
+    // shares at price; none without a holding or a close
+    std::optional<double> value() const;
+    std::optional<double> earnings_yield() const;
+    std::optional<double> price_earnings() const;
+    std::optional<double> price_tbv() const; // banks only
+};
+
+// Sums the aggregates are ratios of.
+struct PortfolioTotals {
+    double value = 0.0;      // priced holdings at their close
+    double cost_basis = 0.0; // every holding
+    // look-through earnings (shares * eps) and the value they are earned on
+    double earnings = 0.0;
+    double earnings_value = 0.0;
+    // banks with a tangible book value per share
+    double bank_value = 0.0;
+    double bank_tbv = 0.0;
+    // insurers with a combined ratio, and value * combined ratio over them
+    double insurer_value = 0.0;
+    double insurer_weighted_cr = 0.0;
+    // value by ticker type: standard, bank, insurance
+    std::array<double, 3> type_value{};
+    int held = 0;     // positions with shares
+    int unpriced = 0; // ... of which without a close
+
+    // earnings / value; the portfolio's P / E is its inverse
+    std::optional<double> earnings_yield() const;
+    std::optional<double> price_earnings() const;
+    std::optional<double> bank_price_tbv() const;
+    std::optional<double> insurer_combined_ratio() const;
+    // share of value in ticker type 1-3
+    std::optional<double> exposure(int ticker_type) const;
+};
+
+class PortfolioAggregate {
+public:
+    // Replaces every position.
+    void reset(std::vector<PortfolioPosition> positions);
+
+    // Adds or replaces the position of `position.row.ticker`.
+    void upsert(PortfolioPosition position);
+    // False when `ticker` has no position.
+    bool update_price(const std::string& ticker, std::optional<double> price);
+    void erase(const std::string& ticker);
+
+    std::size_t size() const { return entries_.size(); }
+    const PortfolioPosition& position(std::size_t i) const
+    {
+        return entries_[i].position;
+    }
+    // Index of `ticker`'s position, or -1.
+    int find(const std::string& ticker) const;
+
+    const PortfolioTotals& totals() const { return totals_; }
+
+private:
+    struct Entry {
+        PortfolioPosition position;
+        PortfolioTotals terms; // this position's share of totals_
+    };
+
+    static PortfolioTotals terms_of_(const PortfolioPosition& position);
+    void add_(const PortfolioTotals& terms, double sign);
+
+private:
+    std::vector<Entry> entries_; // ticker ASC
+    PortfolioTotals totals_;
+};
+
+} // namespace metrics
@@ -0,0 +1,216 @@
+#include "metrics/price_sweep.hpp"
+#include "metrics/finance_metrics.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace metrics {
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+bool is_nonzero(std::optional<double> v)
+{
+    return is_valid_number(v) && *v != 0.0;
+}
+
+// Inputs the ratios are built from, with TTM on or off.
+struct SweepBasis {
+    std::optional<double> eps;
+    std::optional<double> net_income;
+    std::optional<double> cash_flow_ops;
+    std::optional<double> shares;
+};
+
+SweepBasis sweep_basis(const db::Database::FinanceRow& row,
+                       const FinanceMetrics& m,
+                       bool ttm)
+{
+    // same fallbacks as the ticker view: TTM where it is valid, else the
+    // period's own figure
+    SweepBasis out;
+    out.eps = (ttm && is_valid_number(m.ttm_eps)) ? m.ttm_eps : row.eps;
+    out.net_income = (ttm && is_valid_number(m.ttm_net_income))
+                         ? m.ttm_net_income
+                         : to_f64(row.net_income);
+    out.cash_flow_ops = (ttm && is_valid_number(m.ttm_cash_flow_ops))
+                            ? m.ttm_cash_flow_ops
+                            : to_f64(row.cash_flow_from_operations);
+    out.shares = approx_shares(out.net_income, out.eps);
+    return out;
+}
+
+} // namespace
+
+const char* sweep_metric_label(SweepMetric metric)
+{
+    switch (metric) {
+    case SweepMetric::PriceEarnings:
+        return "P / E";
+    case SweepMetric::PriceBook:
+        return "P / BV";
+    case SweepMetric::PriceTangibleBook:
+        return "P / TBV";
+    case SweepMetric::EvMarketCap:
+        return "EVcap";
+    case SweepMetric::EvNetIncome:
+        return "EV / NI";
+    case SweepMetric::EvCashFlowOps:
+        return "EV / CFop";
+    }
+    return "";
+}
+
+double SweepLine::at(double price) const
+{
+    const double den = c * price + d;
+    if (den == 0.0) return kNaN;
+    const double v = (a * price + b) / den;
+    if (!std::isfinite(v) || (nonnegative && v < 0.0)) return kNaN;
+    return v;
+}
+
+std::optional<double> SweepLine::price_for(double ratio) const
+{
+    // a p + b = ratio (c p + d)
+    const double den = a - ratio * c;
+    if (den == 0.0) return std::nullopt;
+    const double price = (ratio * d - b) / den;
+    if (!std::isfinite(price) || price <= 0.0) return std::nullopt;
+    if (std::isnan(at(price))) return std::nullopt;
+    return price;
+}
+
+std::vector<SweepLine>
+sweep_lines(const std::vector<db::Database::FinanceRow>& rows,
+            int index,
+            int ticker_type)
+{
+    std::vector<SweepLine> out;
+    if (index < 0 || index >= static_cast<int>(rows.size())) return out;
+    const auto& row = rows[static_cast<std::size_t>(index)];
+    const auto m = derive_finance_metrics(rows, index, ticker_type);
+    const bool has_ttm = ttm_window_for_family(period_family(row)) > 0;
+
+    SweepBasis basis[2] = {sweep_basis(row, m, false),
+                           sweep_basis(row, m, true)};
+    const int modes = has_ttm ? 2 : 1;
+
+    const auto add = [&](SweepMetric metric,
+                         auto&& coefficients,
+                         bool nonnegative) {
+        for (int mode = 0; mode < modes; ++mode) {
+            SweepLine line;
+            line.metric = metric;
+            line.ttm = mode == 1;
+            line.nonnegative = nonnegative;
+            if (coefficients(basis[mode], line)) out.push_back(line);
+        }
+    };
+
+    add(
+        SweepMetric::PriceEarnings,
+        [](const SweepBasis& in, SweepLine& line) {
+            if (!is_nonzero(in.eps)) return false;
+            line.a = 1.0;
+            line.d = *in.eps;
+            return true;
+        },
+        false);
+
+    // price over equity per share: price * shares / equity
+    const auto per_share_of = [](std::optional<double> equity) {
+        return [equity](const SweepBasis& in, SweepLine& line) {
+            if (!is_nonzero(in.shares) || !is_nonzero(equity)) return false;
+            line.a = *in.shares;
+            line.d = *equity;
+            return true;
+        };
+    };
+
+    if (ticker_type == 2) {
+        add(SweepMetric::PriceTangibleBook,
+            per_share_of(m.tangible_equity),
+            false);
+        return out;
+    }
+    add(SweepMetric::PriceBook, per_share_of(m.equity), false);
+    if (ticker_type == 3) return out;
+
+    // EV = price * shares + liabilities - cash, when both are reported
+    const auto liabilities = null_if_zero_or_invalid(m.total_liabilities);
+    const auto cash =
+        null_if_zero_or_invalid(to_f64(row.cash_and_equivalents));
+    if (!liabilities.has_value() || !cash.has_value()) return out;
+    const double debt_less_cash = *liabilities - *cash;
+
+    const auto ev_over = [&](auto denominator) {
+        return [&, denominator](const SweepBasis& in, SweepLine& line) {
+            if (!is_nonzero(in.shares)) return false;
+            line.a = *in.shares;
+            line.b = debt_less_cash;
+            return denominator(in, line);
+        };
+    };
+
+    add(SweepMetric::EvMarketCap,
+        ev_over([](const SweepBasis& in, SweepLine& line) {
+            line.c = *in.shares;
+            return true;
+        }),
+        true);
+    add(SweepMetric::EvCashFlowOps,
+        ev_over([](const SweepBasis& in, SweepLine& line) {
+            if (!is_nonzero(in.cash_flow_ops)) return false;
+            line.d = *in.cash_flow_ops;
+            return true;
+        }),
+        true);
+    add(SweepMetric::EvNetIncome,
+        ev_over([](const SweepBasis& in, SweepLine& line) {
+            if (!is_nonzero(in.net_income)) return false;
+            line.d = *in.net_income;
+            return true;
+        }),
+        true);
+    return out;
+}
+
+PriceSweep sweep_prices(const std::vector<SweepLine>& lines,
+                        double base_price,
+                        int half_steps,
+                        double step)
+{
+    PriceSweep out;
+    if (!(base_price > 0.0) || !std::isfinite(base_price)) return out;
+
+    for (int k = -half_steps; k <= half_steps; ++k) {
+        const double price = base_price * (1.0 + k * step);
+        if (price <= 0.0) continue;
+        if (k == 0) out.base_column = out.prices.size();
+        out.prices.push_back(price);
+    }
+
+    // branch-free inner loop over plain arrays, so it vectorizes
+    const std::size_t n = out.prices.size();
+    const double* prices = out.prices.data();
+    out.values.resize(lines.size() * n);
+    for (std::size_t l = 0; l < lines.size(); ++l) {
+        const SweepLine& line = lines[l];
+        const double floor = line.nonnegative ? 0.0 : -kInfinity;
+        double* values = out.values.data() + l * n;
+        for (std::size_t i = 0; i < n; ++i) {
+            const double num = line.a * prices[i] + line.b;
+            const double den = line.c * prices[i] + line.d;
+            const double v = num / den;
+            const bool ok =
+                den != 0.0 && v >= floor && std::abs(v) < kInfinity;
+            values[i] = ok ? v : kNaN;
+        }
+    }
+    return out;
+}
+
+} // namespace metrics
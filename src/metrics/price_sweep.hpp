@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "db/database.hpp"
+
+// Price sensitivity of the ticker view's valuation ratios. Every
+// price-dependent ratio is a ratio of two linear functions of the price,
+// so one row's ratios reduce to four coefficients each, and a whole grid
+// of prices is one multiply-add-divide pass per ratio with no row data
+// touched again.
+
+namespace metrics {
+
+enum class SweepMetric {
+    PriceEarnings,
+    PriceBook,
+    PriceTangibleBook,
+    EvMarketCap,
+    EvNetIncome,
+    EvCashFlowOps,
+};
+
+// Ticker view label of `metric`.
+const char* sweep_metric_label(SweepMetric metric);
+
+// ratio(price) = (a * price + b) / (c * price + d)
+struct SweepLine {
+    SweepMetric metric = SweepMetric::PriceEarnings;
+    bool ttm = false;
+    double a = 0.0;
+    double b = 0.0;
+    double c = 0.0;
+    double d = 0.0;
+    // EV ratios below zero show as n/a, as in the ticker view
+    bool nonnegative = false;
+
+    // NaN where the ratio is undefined.
+    double at(double price) const;
+    // Positive price at which the ratio equals `ratio`, if any.
+    std::optional<double> price_for(double ratio) const;
+};
+
+// Lines for rows[index] of a ticker of `ticker_type`: P / E, then the
+// type's other valuation ratios. Each comes with TTM off and, for
+// quarterly and semiannual rows, TTM on right after it; ratios the row
+// lacks inputs for are left out.
+std::vector<SweepLine>
+sweep_lines(const std::vector<db::Database::FinanceRow>& rows,
+            int index,
+            int ticker_type);
+
+// Grid of +/-50% around the typed price in 1% steps.
+inline constexpr int kSweepHalfSteps = 50;
+inline constexpr double kSweepStep = 0.01;
+
+struct PriceSweep {
+    std::vector<double> prices;
+    // column of the base price itself
+    std::size_t base_column = 0;
+    // line-major, prices.size() per line; NaN where undefined
+    std::vector<double> values;
+
+    std::size_t columns() const { return prices.size(); }
+    double value(std::size_t line, std::size_t column) const
+    {
+        return values[line * prices.size() + column];
+    }
+};
+
+// Every line at base * (1 + k * step) for k in [-half_steps, half_steps];
+// prices at or below zero are left out.
+PriceSweep sweep_prices(const std::vector<SweepLine>& lines,
+                        double base_price,
+                        int half_steps = kSweepHalfSteps,
+                        double step = kSweepStep);
+
+} // namespace metrics
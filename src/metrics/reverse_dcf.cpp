@@ -0,0 +1,90 @@
+#include "metrics/reverse_dcf.hpp"
+#include "metrics/metric_math.hpp"
+
+namespace metrics {
+
+namespace {
+
+// Solves are cheap, so hand them to workers in blocks.
+constexpr std::size_t kBatchChunk = 256;
+
+// Growth is reported to a hundredth of a percentage point at best.
+constexpr double kGrowthTolerance = 1e-6;
+
+bool is_positive(std::optional<double> v)
+{
+    return v.has_value() && std::isfinite(*v) && *v > 0.0;
+}
+
+} // namespace
+
+std::optional<ReverseDcfInputs>
+reverse_dcf_inputs(std::optional<double> cash_flow_ops,
+                   std::optional<double> net_income,
+                   std::optional<double> shares)
+{
+    const auto cash =
+        (cash_flow_ops.has_value() && std::isfinite(*cash_flow_ops))
+            ? cash_flow_ops
+            : net_income;
+    if (!is_positive(cash) || !is_positive(shares)) return std::nullopt;
+    return ReverseDcfInputs{*cash, *shares};
+}
+
+std::optional<ReverseDcfInputs>
+reverse_dcf_inputs(const std::vector<db::Database::FinanceRow>& rows,
+                   int index)
+{
+    if (index < 0 || index >= static_cast<int>(rows.size())) {
+        return std::nullopt;
+    }
+    const auto& row = rows[static_cast<std::size_t>(index)];
+
+    if (ttm_window_for_family(period_family(row)) > 0) {
+        const auto ttm = ttm_at(rows, index);
+        return reverse_dcf_inputs(ttm.cash_flow_ops,
+                                  ttm.net_income,
+                                  approx_shares(ttm.net_income, ttm.eps));
+    }
+    const auto net_income = to_f64(row.net_income);
+    return reverse_dcf_inputs(to_f64(row.cash_flow_from_operations),
+                              net_income,
+                              approx_shares(net_income, row.eps));
+}
+
+std::optional<double> implied_growth(const ReverseDcfInputs& in,
+                                     double price,
+                                     const DcfParams& params)
+{
+    if (!(price > 0.0) || !std::isfinite(price)) return std::nullopt;
+
+    const DcfInputs dcf{in.cash, in.shares, {}, {}, {}};
+    // value rises with growth, so the bracket holds a root exactly when the
+    // price lies between the values at its ends
+    return brent_root(
+        [&](double g) {
+            return dcf_value(dcf, g, 1.0, kDcfBaseDiscount, params) - price;
+        },
+        kImpliedGrowthMin,
+        kImpliedGrowthMax,
+        kGrowthTolerance);
+}
+
+std::vector<std::optional<double>>
+implied_growth_batch(const std::vector<ImpliedGrowthJob>& jobs,
+                     WorkPool& pool,
+                     const DcfParams& params)
+{
+    std::vector<std::optional<double>> out(jobs.size());
+    const std::size_t chunks = (jobs.size() + kBatchChunk - 1) / kBatchChunk;
+    pool.parallel_for(chunks, [&](std::size_t chunk) {
+        const std::size_t begin = chunk * kBatchChunk;
+        const std::size_t end = std::min(jobs.size(), begin + kBatchChunk);
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i] = implied_growth(jobs[i].inputs, jobs[i].price, params);
+        }
+    });
+    return out;
+}
+
+} // namespace metrics
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "db/database.hpp"
+#include "metrics/monte_carlo.hpp"
+#include "metrics/work_pool.hpp"
+
+// Reverse DCF: the steady growth rate at which the DCF value of a ticker's
+// cash flow equals a given price. Uses the same model as the Monte Carlo
+// simulator with the margin fixed at 1 and the base discount rate, so the
+// two agree on what a growth rate is worth.
+
+namespace metrics {
+
+struct ReverseDcfInputs {
+    double cash = 0.0;   // TTM CFop, else TTM NI (the row's own when yearly)
+    double shares = 0.0; // shares_approx of the same figures
+};
+
+// Growth is searched in this bracket, as a fraction per year.
+inline constexpr double kImpliedGrowthMin = -0.5;
+inline constexpr double kImpliedGrowthMax = 0.5;
+
+// Inputs from rows[index]. Empty unless cash flow is positive and a share
+// count can be approximated.
+std::optional<ReverseDcfInputs>
+reverse_dcf_inputs(const std::vector<db::Database::FinanceRow>& rows,
+                   int index);
+
+// Same, from figures the caller already has (the ticker view).
+std::optional<ReverseDcfInputs>
+reverse_dcf_inputs(std::optional<double> cash_flow_ops,
+                   std::optional<double> net_income,
+                   std::optional<double> shares);
+
+// Brent's method on [lo, hi]: inverse quadratic or secant steps, falling
+// back to bisection whenever a step would leave the bracket or converge
+// too slowly. Empty when f(lo) and f(hi) have the same sign.
+template <typename F>
+std::optional<double>
+brent_root(F f, double lo, double hi, double tolerance, int max_iter = 100)
+{
+    double a = lo;
+    double b = hi;
+    double fa = f(a);
+    double fb = f(b);
+    if (fa == 0.0) return a;
+    if (fb == 0.0) return b;
+    if ((fa > 0.0) == (fb > 0.0)) return std::nullopt;
+
+    if (std::abs(fa) < std::abs(fb)) {
+        std::swap(a, b);
+        std::swap(fa, fb);
+    }
+    double c = a;
+    double fc = fa;
+    double d = b - a;
+    bool bisected = true;
+
+    for (int i = 0; i < max_iter; ++i) {
+        if (fb == 0.0 || std::abs(b - a) <= tolerance) return b;
+
+        double s = 0.0;
+        if (fa != fc && fb != fc) {
+            s = a * fb * fc / ((fa - fb) * (fa - fc)) +
+                b * fa * fc / ((fb - fa) * (fb - fc)) +
+                c * fa * fb / ((fc - fa) * (fc - fb));
+        }
+        else {
+            s = b - fb * (b - a) / (fb - fa);
+        }
+
+        const double lo_edge = std::min((3.0 * a + b) / 4.0, b);
+        const double hi_edge = std::max((3.0 * a + b) / 4.0, b);
+        const bool use_bisection =
+            s < lo_edge || s > hi_edge ||
+            (bisected && std::abs(s - b) >= std::abs(b - c) / 2.0) ||
+            (!bisected && std::abs(s - b) >= std::abs(c - d) / 2.0) ||
+            (bisected && std::abs(b - c) < tolerance) ||
+            (!bisected && std::abs(c - d) < tolerance);
+        if (use_bisection) s = (a + b) / 2.0;
+        bisected = use_bisection;
+
+        const double fs = f(s);
+        d = c;
+        c = b;
+        fc = fb;
+        if ((fa > 0.0) == (fs > 0.0)) {
+            a = s;
+            fa = fs;
+        }
+        else {
+            b = s;
+            fb = fs;
+        }
+        if (std::abs(fa) < std::abs(fb)) {
+            std::swap(a, b);
+            std::swap(fa, fb);
+        }
+    }
+    return b;
+}
+
+// Growth per year implied by `price`. Empty for a non-positive price, or
+// one the bracket cannot reach.
+std::optional<double> implied_growth(const ReverseDcfInputs& in,
+                                     double price,
+                                     const DcfParams& params = {});
+
+struct ImpliedGrowthJob {
+    ReverseDcfInputs inputs;
+    double price = 0.0;
+};
+
+// implied_growth() for every job, in job order, spread over `pool`.
+std::vector<std::optional<double>>
+implied_growth_batch(const std::vector<ImpliedGrowthJob>& jobs,
+                     WorkPool& pool,
+                     const DcfParams& params = {});
+
+} // namespace metrics
@@ -0,0 +1,242 @@
+#include "metrics/sparkline.hpp"
+#include "metrics/finance_metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace metrics {
+
+namespace {
+
+std::size_t metric_column_index(std::string_view name)
+{
+    return static_cast<std::size_t>(find_finance_metric(name) -
+                                    kFinanceMetricColumns);
+}
+
+// Dot level 0 (bottom) to levels - 1 of `v` within [lo, hi]; a flat
+// series sits on the middle.
+int spark_level(double v, double lo, double hi, int levels)
+{
+    if (!(hi > lo)) return (levels - 1) / 2;
+    const double t = (v - lo) / (hi - lo);
+    const int level = static_cast<int>(std::lround(t * (levels - 1)));
+    return std::clamp(level, 0, levels - 1);
+}
+
+bool bucket_range(const std::vector<SparkBucket>& buckets,
+                  double* lo,
+                  double* hi)
+{
+    bool any = false;
+    for (const auto& b : buckets) {
+        if (!b.valid) continue;
+        *lo = any ? std::min(*lo, b.min) : b.min;
+        *hi = any ? std::max(*hi, b.max) : b.max;
+        any = true;
+    }
+    return any;
+}
+
+void append_utf8(std::string& out, unsigned codepoint)
+{
+    // braille lives in U+2800..U+28FF, always three bytes
+    out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+}
+
+} // namespace
+
+// *
+// **
+// ***
+// ****
+// ***** SERIES
+
+F64Column spark_series(SparkMetric metric,
+                       const FinanceStore& store,
+                       const YoyTable& yoy,
+                       bool yearly)
+{
+    const F64Column* source = nullptr;
+    F64Column converted;
+    switch (metric) {
+    case SparkMetric::Revenue:
+        converted = to_f64(store.column(&db::Database::FinanceRow::revenue));
+        source = &converted;
+        break;
+    case SparkMetric::CashFlowOps:
+        converted = to_f64(store.column(
+            &db::Database::FinanceRow::cash_flow_from_operations));
+        source = &converted;
+        break;
+    case SparkMetric::TtmEps:
+    case SparkMetric::PriceEarnings:
+        // a yearly row already spans twelve months and has no ttm value
+        source = yearly ? &store.eps()
+                        : &yoy.metric_values(metric_column_index("ttm_eps"));
+        break;
+    case SparkMetric::Cet1Ratio:
+        source = &yoy.metric_values(metric_column_index("cet1_ratio"));
+        break;
+    case SparkMetric::CombinedRatio:
+        source = &yoy.metric_values(metric_column_index("combined_ratio"));
+        break;
+    }
+
+    const auto& types = store.period_types();
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        if ((types[i] == "Y") == yearly) ++count;
+    }
+
+    F64Column out(count);
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        if ((types[i] == "Y") != yearly) continue;
+        auto v = source->at(i);
+        if (metric == SparkMetric::PriceEarnings) {
+            v = (v.has_value() && *v > 0.0) ? std::optional(1.0 / *v)
+                                            : std::nullopt;
+        }
+        if (v.has_value() && std::isfinite(*v)) out.set(j, v);
+        ++j;
+    }
+    return out;
+}
+
+// *
+// **
+// ***
+// ****
+// ***** BUCKETS
+
+std::vector<SparkBucket> minmax_buckets(const F64Column& series,
+                                        std::size_t width)
+{
+    const std::size_t n = series.size();
+    const std::size_t count = std::min(width, n);
+    std::vector<SparkBucket> buckets(count);
+    for (std::size_t b = 0; b < count; ++b) {
+        const std::size_t begin = b * n / count;
+        const std::size_t end = (b + 1) * n / count;
+        auto& bucket = buckets[b];
+        for (std::size_t i = begin; i < end; ++i) {
+            if (!series.valid.test(i)) continue;
+            const double v = series.values[i];
+            bucket.min = bucket.valid ? std::min(bucket.min, v) : v;
+            bucket.max = bucket.valid ? std::max(bucket.max, v) : v;
+            bucket.valid = true;
+        }
+    }
+    return buckets;
+}
+
+std::string braille_sparkline(const std::vector<SparkBucket>& buckets)
+{
+    // dot bits from the top row down, left and right column
+    static constexpr unsigned kLeft[4] = {0x01, 0x02, 0x04, 0x40};
+    static constexpr unsigned kRight[4] = {0x08, 0x10, 0x20, 0x80};
+    constexpr int kLevels = 4;
+
+    double lo = 0.0;
+    double hi = 0.0;
+    if (!bucket_range(buckets, &lo, &hi)) return {};
+
+    const auto dots = [&](const SparkBucket& b, const unsigned* column) {
+        if (!b.valid) return 0u;
+        const int top = spark_level(b.max, lo, hi, kLevels);
+        const int bottom = spark_level(b.min, lo, hi, kLevels);
+        unsigned bits = 0;
+        for (int level = bottom; level <= top; ++level) {
+            bits |= column[kLevels - 1 - level];
+        }
+        return bits;
+    };
+
+    std::string out;
+    out.reserve(((buckets.size() + 1) / 2) * 3);
+    for (std::size_t i = 0; i < buckets.size(); i += 2) {
+        unsigned bits = dots(buckets[i], kLeft);
+        if (i + 1 < buckets.size()) bits |= dots(buckets[i + 1], kRight);
+        append_utf8(out, 0x2800 + bits);
+    }
+    return out;
+}
+
+std::string ascii_sparkline(const std::vector<SparkBucket>& buckets)
+{
+    static constexpr std::string_view kRamp = "_.:-=+*#";
+
+    double lo = 0.0;
+    double hi = 0.0;
+    if (!bucket_range(buckets, &lo, &hi)) return {};
+
+    const int levels = static_cast<int>(kRamp.size());
+    std::string out;
+    out.reserve(buckets.size());
+    for (const auto& b : buckets) {
+        if (!b.valid) {
+            out.push_back(' ');
+            continue;
+        }
+        const double mid = b.min + (b.max - b.min) / 2.0;
+        out.push_back(kRamp[static_cast<std::size_t>(
+            spark_level(mid, lo, hi, levels))]);
+    }
+    return out;
+}
+
+// *
+// **
+// ***
+// ****
+// ***** CACHE
+
+const std::string& SparklineCache::strip(const std::string& ticker,
+                                         std::uint64_t generation,
+                                         const FinanceStore& store,
+                                         const YoyTable& yoy,
+                                         SparkMetric metric,
+                                         bool yearly,
+                                         int width,
+                                         bool braille)
+{
+    SeriesKey series_key{ticker, generation, metric, yearly};
+    StripKey strip_key{series_key, width, braille};
+    if (const auto it = strips_.find(strip_key); it != strips_.end()) {
+        return it->second;
+    }
+
+    if (strips_.size() >= kMaxStrips) clear();
+
+    auto series_it = series_.find(series_key);
+    if (series_it == series_.end()) {
+        series_it =
+            series_
+                .emplace(series_key, spark_series(metric, store, yoy, yearly))
+                .first;
+    }
+
+    const F64Column& series = series_it->second;
+    std::string text;
+    if (width > 0 && series.valid.count() >= 2) {
+        const std::size_t cells = static_cast<std::size_t>(width);
+        text = braille ? braille_sparkline(minmax_buckets(series, cells * 2))
+                       : ascii_sparkline(minmax_buckets(series, cells));
+    }
+    return strips_.emplace(std::move(strip_key), std::move(text))
+        .first->second;
+}
+
+void SparklineCache::clear()
+{
+    series_.clear();
+    strips_.clear();
+}
+
+} // namespace metrics
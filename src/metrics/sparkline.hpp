@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "metrics/finance_store.hpp"
+#include "metrics/yoy_table.hpp"
+
+// Sparkline strips of a ticker's metric history for the ticker view. Series
+// are pulled in bulk from the history's columns, squeezed to the strip
+// width by min/max bucketing, and drawn as braille (two buckets and four
+// levels per cell) or, where the terminal cannot show it, an ASCII ramp.
+
+namespace metrics {
+
+enum class SparkMetric {
+    Revenue,
+    TtmEps,
+    CashFlowOps,
+    PriceEarnings,
+    Cet1Ratio,
+    CombinedRatio,
+};
+
+struct SparkMetricInfo {
+    SparkMetric metric;
+    const char* label;
+};
+
+inline constexpr SparkMetricInfo kSparkMetrics[] = {
+    {SparkMetric::Revenue, "revenue"},
+    {SparkMetric::TtmEps, "eps ttm"},
+    {SparkMetric::CashFlowOps, "cf ops"},
+    {SparkMetric::PriceEarnings, "p/e"},
+    {SparkMetric::Cet1Ratio, "cet1"},
+    {SparkMetric::CombinedRatio, "combined"},
+};
+
+// Points of `metric` for the yearly (or the non-yearly) rows of the store,
+// in row order; TtmEps of a yearly row is its EPS. PriceEarnings is
+// 1 / TtmEps for positive EPS: a strip is scaled to its own range, so the
+// same shape holds for any price.
+F64Column spark_series(SparkMetric metric,
+                       const FinanceStore& store,
+                       const YoyTable& yoy,
+                       bool yearly);
+
+struct SparkBucket {
+    double min = 0.0;
+    double max = 0.0;
+    bool valid = false;
+};
+
+// Splits `series` into min(width, size) runs of consecutive points and
+// keeps the extremes of each, so spikes survive the downsampling. Buckets
+// with no valid point stay invalid.
+std::vector<SparkBucket> minmax_buckets(const F64Column& series,
+                                        std::size_t width);
+
+// UTF-8 braille, one cell per two buckets; each bucket lights the dots
+// between its min and max level.
+std::string braille_sparkline(const std::vector<SparkBucket>& buckets);
+// One character per bucket from a density ramp of its midpoint.
+std::string ascii_sparkline(const std::vector<SparkBucket>& buckets);
+
+// Strips keyed by (ticker, generation, metric, cadence, width, glyphs). The
+// series behind them are cached apart from the width, so a resize only
+// rebuckets and scrolling redraws cached text.
+class SparklineCache {
+public:
+    // Empty when the series has fewer than two points.
+    const std::string& strip(const std::string& ticker,
+                             std::uint64_t generation,
+                             const FinanceStore& store,
+                             const YoyTable& yoy,
+                             SparkMetric metric,
+                             bool yearly,
+                             int width,
+                             bool braille);
+
+    std::size_t series_count() const { return series_.size(); }
+    std::size_t strip_count() const { return strips_.size(); }
+    void clear();
+
+    // Both maps are dropped past this many strips.
+    static constexpr std::size_t kMaxStrips = 256;
+
+private:
+    using SeriesKey = std::tuple<std::string, std::uint64_t, SparkMetric, bool>;
+    using StripKey = std::tuple<SeriesKey, int, bool>;
+
+    std::map<SeriesKey, F64Column> series_;
+    std::map<StripKey, std::string> strips_;
+};
+
+} // namespace metrics
@@ -0,0 +1,145 @@
+#include "metrics/work_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace metrics {
+
+WorkPool::WorkPool(unsigned threads)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    threads = std::max(1u, threads);
+
+    ranges_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        ranges_.push_back(std::make_unique<Range>());
+    }
+    threads_.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i) {
+        threads_.emplace_back([this, i] { run_(i); });
+    }
+}
+
+WorkPool::~WorkPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+void WorkPool::parallel_for(std::size_t count,
+                            const std::function<void(std::size_t)>& task)
+{
+    if (count == 0) return;
+
+    // even split up front; stealing evens out the rest
+    const std::size_t n = ranges_.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        std::lock_guard<std::mutex> lock(ranges_[i]->mu);
+        ranges_[i]->begin = count * i / n;
+        ranges_[i]->end = count * (i + 1) / n;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        task_ = &task;
+        error_ = nullptr;
+        busy_ = static_cast<unsigned>(threads_.size());
+        ++round_;
+    }
+    start_cv_.notify_all();
+
+    work_(0);
+
+    std::unique_lock<std::mutex> lock(mu_);
+    done_cv_.wait(lock, [&] { return busy_ == 0; });
+    task_ = nullptr;
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+}
+
+void WorkPool::run_(unsigned self)
+{
+    std::uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            start_cv_.wait(lock, [&] { return stop_ || round_ != seen; });
+            if (stop_) return;
+            seen = round_;
+        }
+
+        work_(self);
+
+        std::lock_guard<std::mutex> lock(mu_);
+        if (--busy_ == 0) done_cv_.notify_one();
+    }
+}
+
+void WorkPool::work_(unsigned self)
+{
+    std::size_t index = 0;
+    while (next_(self, &index)) {
+        try {
+            (*task_)(index);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (!error_) error_ = std::current_exception();
+        }
+    }
+}
+
+bool WorkPool::next_(unsigned self, std::size_t* index)
+{
+    {
+        auto& own = *ranges_[self];
+        std::lock_guard<std::mutex> lock(own.mu);
+        if (own.begin < own.end) {
+            *index = own.begin++;
+            return true;
+        }
+    }
+
+    // steal the back half of the fullest range; ranges only shrink during
+    // a round, so one sweep that finds nothing means the round is drained
+    while (true) {
+        std::size_t victim = ranges_.size();
+        std::size_t most = 0;
+        for (std::size_t i = 0; i < ranges_.size(); ++i) {
+            if (i == self) continue;
+            std::lock_guard<std::mutex> lock(ranges_[i]->mu);
+            const std::size_t left = ranges_[i]->end - ranges_[i]->begin;
+            if (left > most) {
+                most = left;
+                victim = i;
+            }
+        }
+        if (victim == ranges_.size()) return false;
+
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        {
+            auto& other = *ranges_[victim];
+            std::lock_guard<std::mutex> lock(other.mu);
+            const std::size_t left = other.end - other.begin;
+            if (left == 0) continue;
+            const std::size_t take = (left + 1) / 2;
+            end = other.end;
+            begin = end - take;
+            other.end = begin;
+        }
+
+        auto& own = *ranges_[self];
+        std::lock_guard<std::mutex> lock(own.mu);
+        own.begin = begin + 1;
+        own.end = end;
+        *index = begin;
+        return true;
+    }
+}
+
+} // namespace metrics
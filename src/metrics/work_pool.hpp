@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace metrics {
+
+// Fixed set of worker threads for batch metric work (simulations, solver
+// batches). parallel_for() deals each worker a contiguous range of task
+// indexes; a worker that runs dry steals the back half of the fullest
+// range left, so uneven tasks still finish together. The calling thread
+// works too, and a pool of one runs everything inline.
+class WorkPool {
+public:
+    // 0 picks std::thread::hardware_concurrency().
+    explicit WorkPool(unsigned threads = 0);
+    ~WorkPool();
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    // Threads that run tasks, the caller included.
+    unsigned size() const { return static_cast<unsigned>(ranges_.size()); }
+
+    // Runs task(i) for every i in [0, count) and returns once all are done.
+    // One call at a time; the first exception a task throws is rethrown
+    // here after the rest have run.
+    void parallel_for(std::size_t count,
+                      const std::function<void(std::size_t)>& task);
+
+private:
+    struct Range {
+        std::mutex mu;
+        std::size_t begin{0};
+        std::size_t end{0};
+    };
+
+    void run_(unsigned self);
+    bool next_(unsigned self, std::size_t* index);
+    void work_(unsigned self);
+
+private:
+    std::vector<std::unique_ptr<Range>> ranges_; // [0] is the caller's
+
+    std::mutex mu_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    bool stop_{false};
+    std::uint64_t round_{0};
+    unsigned busy_{0};
+    const std::function<void(std::size_t)>* task_{nullptr};
+    std::exception_ptr error_;
+
+    std::vector<std::thread> threads_;
+};
+
+} // namespace metrics
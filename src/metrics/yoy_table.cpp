@@ -0,0 +1,154 @@
+#include "metrics/yoy_table.hpp"
+#include "metrics/finance_metrics.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <string>
+
+namespace metrics {
+
+// *
+// **
+// ***
+// ****
+// ***** PERIOD KEYS
+
+std::vector<std::int64_t> packed_period_keys(const FinanceStore& store)
+{
+    const auto& types = store.period_types();
+
+    std::vector<std::string> distinct(types.begin(), types.end());
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                   distinct.end());
+
+    std::vector<std::int64_t> keys;
+    keys.reserve(store.size());
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        const auto id = std::lower_bound(
+                            distinct.begin(), distinct.end(), types[i]) -
+                        distinct.begin();
+        keys.push_back(static_cast<std::int64_t>(store.years()[i]) *
+                           kPeriodKeyYearStride +
+                       id);
+    }
+    return keys;
+}
+
+std::vector<int> previous_year_indexes(const FinanceStore& store)
+{
+    const auto keys = packed_period_keys(store);
+    const std::size_t n = keys.size();
+
+    // rows come back key-ordered from get_finances; sort only if not
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    if (!std::is_sorted(keys.begin(), keys.end())) {
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return keys[a] < keys[b];
+        });
+    }
+
+    // targets rise with the keys, so one forward cursor finds them all
+    std::vector<int> previous(n, -1);
+    std::size_t j = 0;
+    for (const int i : order) {
+        const std::int64_t target = keys[i] - kPeriodKeyYearStride;
+        while (j < n && keys[order[j]] < target) ++j;
+        if (j < n && keys[order[j]] == target) previous[i] = order[j];
+    }
+    return previous;
+}
+
+// *
+// **
+// ***
+// ****
+// ***** TABLE
+
+YoyTable::YoyTable(const std::vector<db::Database::FinanceRow>& rows,
+                   const FinanceStore& store,
+                   int ticker_type)
+    : ticker_type_(ticker_type), previous_(previous_year_indexes(store))
+{
+    field_changes_.reserve(std::size(kFinanceStoreFields) + 1);
+    for (const auto& f : kFinanceStoreFields) {
+        const auto values = to_f64(store.column(f.field));
+        field_changes_.push_back(
+            percent_change(values, gather(values, previous_)));
+    }
+    field_changes_.push_back(
+        percent_change(store.eps(), gather(store.eps(), previous_)));
+
+    // TTM windows look back across rows, so metrics stay row-wise
+    constexpr std::size_t kMetrics = std::size(kFinanceMetricColumns);
+    metric_values_.assign(kMetrics, F64Column(rows.size()));
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const auto m =
+            derive_finance_metrics(rows, static_cast<int>(i), ticker_type);
+        for (std::size_t k = 0; k < kMetrics; ++k) {
+            metric_values_[k].set(i, m.*kFinanceMetricColumns[k].field);
+        }
+    }
+
+    metric_changes_.reserve(kMetrics);
+    for (std::size_t k = 0; k < kMetrics; ++k) {
+        const auto& values = metric_values_[k];
+        const auto previous = gather(values, previous_);
+        metric_changes_.push_back(
+            kFinanceMetricColumns[k].kind == MetricKind::Ratio
+                ? ratio_percent_change(values, previous)
+                : percent_change(values, previous));
+    }
+}
+
+int YoyTable::previous_index(std::size_t row) const
+{
+    return row < previous_.size() ? previous_[row] : -1;
+}
+
+std::optional<double> YoyTable::field_change(FinanceStore::Field field,
+                                             std::size_t row) const
+{
+    const std::size_t index = FinanceStore::field_index(field);
+    if (field_changes_.empty() || row >= size()) return std::nullopt;
+    return field_changes_[index].at(row);
+}
+
+std::optional<double> YoyTable::eps_change(std::size_t row) const
+{
+    if (field_changes_.empty() || row >= size()) return std::nullopt;
+    return field_changes_.back().at(row);
+}
+
+const F64Column& YoyTable::metric_values(std::size_t metric) const
+{
+    return metric_values_.at(metric);
+}
+
+std::optional<double> YoyTable::metric_value(std::size_t metric,
+                                             std::size_t row) const
+{
+    if (metric >= metric_values_.size() || row >= size()) return std::nullopt;
+    return metric_values_[metric].at(row);
+}
+
+std::optional<double> YoyTable::metric_change(std::size_t metric,
+                                              std::size_t row) const
+{
+    if (metric >= metric_changes_.size() || row >= size()) return std::nullopt;
+    return metric_changes_[metric].at(row);
+}
+
+std::size_t YoyTable::bytes() const
+{
+    const std::size_t n = size();
+    const std::size_t column = n * 8 + ((n + 63) / 64) * 8;
+    return previous_.capacity() * sizeof(int) +
+           (field_changes_.size() + metric_values_.size() +
+            metric_changes_.size()) *
+               column;
+}
+
+} // namespace metrics
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "db/database.hpp"
+#include "metrics/finance_store.hpp"
+
+// Year-over-year changes of every raw field and derived metric for every
+// period of one ticker, computed in a single pass over FinanceStore
+// columns. Built once per decoded history and read by the ticker view, the
+// clipboard text and the intrinsic_metrics virtual table.
+
+namespace metrics {
+
+// Packs (year, period_type) as year << 16 | id, where ids number the
+// ticker's distinct period types in string order. Keys sort like
+// (year, period_type), and the same period a year earlier is
+// key - kPeriodKeyYearStride.
+inline constexpr std::int64_t kPeriodKeyYearStride = std::int64_t{1} << 16;
+
+std::vector<std::int64_t> packed_period_keys(const FinanceStore& store);
+
+// Index of the same period a year earlier for every row, or -1.
+std::vector<int> previous_year_indexes(const FinanceStore& store);
+
+class YoyTable {
+public:
+    YoyTable() = default;
+    YoyTable(const std::vector<db::Database::FinanceRow>& rows,
+             const FinanceStore& store,
+             int ticker_type);
+
+    std::size_t size() const { return previous_.size(); }
+    int ticker_type() const { return ticker_type_; }
+
+    // -1 when the row has no same-period row a year earlier.
+    int previous_index(std::size_t row) const;
+
+    // percent_change() of a raw field against the previous year. Throws
+    // std::invalid_argument for a field missing from kFinanceStoreFields.
+    std::optional<double> field_change(FinanceStore::Field field,
+                                       std::size_t row) const;
+    std::optional<double> eps_change(std::size_t row) const;
+
+    // Derived metrics by kFinanceMetricColumns index; changes use the
+    // column's MetricKind like metric_change().
+    const F64Column& metric_values(std::size_t metric) const;
+    std::optional<double> metric_value(std::size_t metric,
+                                       std::size_t row) const;
+    std::optional<double> metric_change(std::size_t metric,
+                                        std::size_t row) const;
+
+    // Estimated heap footprint.
+    std::size_t bytes() const;
+
+private:
+    int ticker_type_{1};
+    std::vector<int> previous_;
+    std::vector<F64Column> field_changes_; // kFinanceStoreFields, then eps
+    std::vector<F64Column> metric_values_;
+    std::vector<F64Column> metric_changes_;
+};
+
+} // namespace metrics
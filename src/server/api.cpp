@@ -0,0 +1,384 @@
+#include "server/api.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cli/cli_csv.hpp"
+#include "db/price_series.hpp"
+#include "metrics/finance_metrics.hpp"
+#include "metrics/finance_store.hpp"
+#include "metrics/metric_math.hpp"
+#include "metrics/price_sweep.hpp"
+#include "server/json_writer.hpp"
+#include "server/response_cache.hpp"
+
+namespace server {
+
+namespace {
+
+HttpResponse json_error(int status, const std::string& message)
+{
+    HttpResponse response;
+    response.status = status;
+    JsonWriter json(response.body);
+    json.begin_object().key("error").value(message).end_object();
+    return response;
+}
+
+// `text` as an integer in [min, max]; `fallback` when empty.
+std::optional<int>
+parse_int(const std::string& text, int fallback, int min, int max)
+{
+    if (text.empty()) return fallback;
+    char* end = nullptr;
+    errno = 0;
+    const long value = std::strtol(text.c_str(), &end, 10);
+    if (errno != 0 || end != text.c_str() + text.size() || value < min ||
+        value > max) {
+        return std::nullopt;
+    }
+    return static_cast<int>(value);
+}
+
+std::optional<double> parse_price(const std::string& text)
+{
+    char* end = nullptr;
+    errno = 0;
+    const double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || errno != 0 || end != text.c_str() + text.size() ||
+        !std::isfinite(value) || value <= 0.0) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+bool is_flag_set(const HttpRequest& request, const std::string& name)
+{
+    const auto value = request.param(name);
+    return value == "1" || value == "true";
+}
+
+// Machine name of a sweep metric; sweep_metric_label() is the display one.
+const char* sweep_metric_key(metrics::SweepMetric metric)
+{
+    switch (metric) {
+    case metrics::SweepMetric::PriceEarnings:
+        return "price_earnings";
+    case metrics::SweepMetric::PriceBook:
+        return "price_book";
+    case metrics::SweepMetric::PriceTangibleBook:
+        return "price_tangible_book";
+    case metrics::SweepMetric::EvMarketCap:
+        return "ev_market_cap";
+    case metrics::SweepMetric::EvNetIncome:
+        return "ev_net_income";
+    case metrics::SweepMetric::EvCashFlowOps:
+        return "ev_cash_flow_ops";
+    }
+    return "";
+}
+
+void write_ticker_rows(JsonWriter& json,
+                       const std::vector<db::Database::TickerRow>& rows)
+{
+    json.begin_array();
+    for (const auto& row : rows) {
+        json.begin_object()
+            .key("ticker")
+            .value(row.ticker)
+            .key("last_update")
+            .value(row.last_update)
+            .key("portfolio")
+            .value(row.portfolio)
+            .key("type")
+            .value(row.type)
+            .end_object();
+    }
+    json.end_array();
+}
+
+HttpResponse tickers_page(db::Database& database, const HttpRequest& request)
+{
+    const auto page = parse_int(request.param("page"), 0, 0, 1 << 24);
+    const auto size =
+        parse_int(request.param("size"), 50, 1, kApiMaxPageSize);
+    const auto sort = request.param("sort", "ticker");
+    const auto dir = request.param("dir", "asc");
+    if (!page || !size) return json_error(400, "bad page or size");
+    if (sort != "ticker" && sort != "updated") {
+        return json_error(400, "sort must be ticker or updated");
+    }
+    if (dir != "asc" && dir != "desc") {
+        return json_error(400, "dir must be asc or desc");
+    }
+    const bool portfolio = is_flag_set(request, "portfolio");
+
+    std::string err;
+    const auto rows = database.get_tickers(
+        *page,
+        *size,
+        sort == "ticker" ? db::Database::TickerSortKey::Ticker
+                         : db::Database::TickerSortKey::LastUpdate,
+        dir == "asc" ? db::Database::SortDir::Asc
+                     : db::Database::SortDir::Desc,
+        &err,
+        portfolio);
+    const auto total = database.count_tickers(portfolio, &err);
+    if (!err.empty()) return json_error(500, err);
+
+    HttpResponse response;
+    JsonWriter json(response.body);
+    json.begin_object()
+        .key("page")
+        .value(*page)
+        .key("size")
+        .value(*size)
+        .key("total")
+        .value(total)
+        .key("tickers");
+    write_ticker_rows(json, rows);
+    json.end_object();
+    return response;
+}
+
+HttpResponse search(db::Database& database, const HttpRequest& request)
+{
+    const auto limit =
+        parse_int(request.param("limit"), 20, 1, kApiMaxPageSize);
+    if (!limit) return json_error(400, "bad limit");
+
+    std::string err;
+    const auto query = cli::upper_ticker(request.param("q"));
+    const bool portfolio = is_flag_set(request, "portfolio");
+    const auto rows =
+        database.search_tickers(query, *limit, &err, portfolio);
+    if (!err.empty()) return json_error(500, err);
+
+    HttpResponse response;
+    JsonWriter json(response.body);
+    json.begin_object().key("tickers");
+    write_ticker_rows(json, rows);
+    json.end_object();
+    return response;
+}
+
+// 200 with `payload`, or 304 when the client already holds it.
+HttpResponse respond(const HttpRequest& request,
+                     const ResponseCache::Payload& payload)
+{
+    HttpResponse response;
+    response.headers.push_back({"ETag", payload.etag});
+    if (etag_matches(request.header("if-none-match"), payload.etag)) {
+        response.status = 304;
+        return response;
+    }
+    response.content_type = payload.content_type;
+    response.body = payload.body;
+    return response;
+}
+
+// Generation of `ticker`, read before its data so a payload is never
+// stored under a generation newer than what it was rendered from.
+std::optional<std::uint64_t> ticker_generation(db::Database& database,
+                                               const std::string& ticker,
+                                               HttpResponse& error)
+{
+    std::string err;
+    const auto generation = database.get_ticker_generation(ticker, &err);
+    if (!err.empty()) {
+        error = json_error(500, err);
+    }
+    else if (!generation) {
+        error = json_error(404, "unknown ticker " + ticker);
+    }
+    return generation;
+}
+
+HttpResponse history(db::Database& database,
+                     const std::string& ticker,
+                     const HttpRequest& request,
+                     ResponseCache* cache)
+{
+    HttpResponse error;
+    const auto generation = ticker_generation(database, ticker, error);
+    if (!generation) return error;
+
+    const std::string key = "history/" + ticker;
+    if (cache) {
+        if (const auto hit = cache->find(key, *generation)) {
+            return respond(request, *hit);
+        }
+    }
+
+    std::string err;
+    const auto rows = database.get_finances(ticker, &err);
+    if (!err.empty()) return json_error(500, err);
+    if (rows.empty()) return json_error(404, "unknown ticker " + ticker);
+    const int type = database.get_ticker_type(ticker, &err).value_or(1);
+
+    std::string body;
+    JsonWriter json(body);
+    json.begin_object()
+        .key("ticker")
+        .value(ticker)
+        .key("type")
+        .value(type)
+        .key("periods")
+        .begin_array();
+    for (const auto& row : rows) {
+        json.begin_object()
+            .key("period")
+            .value(metrics::period_label(row))
+            .key("eps")
+            .value(row.eps);
+        for (const auto& field : metrics::kFinanceStoreFields) {
+            json.key(field.name).value(row.*field.field);
+        }
+        json.end_object();
+    }
+    json.end_array().end_object();
+
+    const auto payload = cache ? cache->store(key, *generation, std::move(body))
+                               : make_payload(*generation, std::move(body));
+    return respond(request, *payload);
+}
+
+HttpResponse ticker_metrics(db::Database& database,
+                            const std::string& ticker,
+                            const HttpRequest& request,
+                            ResponseCache* cache)
+{
+    HttpResponse error;
+    const auto generation = ticker_generation(database, ticker, error);
+    if (!generation) return error;
+
+    std::string err;
+    std::optional<double> price;
+    std::optional<std::int32_t> price_day;
+    if (const auto text = request.param("price"); !text.empty()) {
+        price = parse_price(text);
+        if (!price) return json_error(400, "bad price");
+    }
+    else {
+        const auto latest = database.get_latest_price(ticker, &err);
+        if (!err.empty()) return json_error(500, err);
+        if (latest) {
+            price = latest->close;
+            price_day = latest->day;
+        }
+    }
+
+    // the ticker's generation covers its finances; the price is in the key
+    const auto period = request.param("period");
+    std::string key = "metrics/" + ticker + "?period=" + period;
+    if (price) {
+        char text[64];
+        std::snprintf(text,
+                      sizeof(text),
+                      "&price=%a&day=%d",
+                      *price,
+                      price_day.value_or(-1));
+        key += text;
+    }
+    if (cache) {
+        if (const auto hit = cache->find(key, *generation)) {
+            return respond(request, *hit);
+        }
+    }
+
+    const auto rows = database.get_finances(ticker, &err);
+    if (!err.empty()) return json_error(500, err);
+    if (rows.empty()) return json_error(404, "unknown ticker " + ticker);
+    const int type = database.get_ticker_type(ticker, &err).value_or(1);
+
+    const int index = period.empty()
+                          ? static_cast<int>(rows.size()) - 1
+                          : metrics::find_period_index(rows, period);
+    if (index < 0) return json_error(404, "unknown period " + period);
+
+    const auto derived = metrics::derive_finance_metrics(rows, index, type);
+
+    std::string body;
+    JsonWriter json(body);
+    json.begin_object()
+        .key("ticker")
+        .value(ticker)
+        .key("type")
+        .value(type)
+        .key("period")
+        .value(metrics::period_label(rows[static_cast<std::size_t>(index)]))
+        .key("price")
+        .value(price)
+        .key("price_date");
+    if (price_day) {
+        json.value(db::format_iso_day(*price_day));
+    }
+    else {
+        json.null();
+    }
+
+    json.key("metrics").begin_object();
+    for (const auto& column : metrics::kFinanceMetricColumns) {
+        json.key(column.name).value(derived.*column.field);
+    }
+    json.end_object();
+
+    // price-dependent ratios; empty without a price
+    json.key("valuation").begin_array();
+    if (price) {
+        for (const auto& line : metrics::sweep_lines(rows, index, type)) {
+            json.begin_object()
+                .key("metric")
+                .value(sweep_metric_key(line.metric))
+                .key("label")
+                .value(metrics::sweep_metric_label(line.metric))
+                .key("ttm")
+                .value(line.ttm)
+                .key("value")
+                .value(line.at(*price))
+                .end_object();
+        }
+    }
+    json.end_array().end_object();
+
+    const auto payload = cache ? cache->store(key, *generation, std::move(body))
+                               : make_payload(*generation, std::move(body));
+    return respond(request, *payload);
+}
+
+} // namespace
+
+HttpResponse handle_api_request(db::Database& database,
+                                const HttpRequest& request,
+                                ResponseCache* cache)
+{
+    const std::string_view path = request.path;
+    if (path == "/api/tickers") return tickers_page(database, request);
+    if (path == "/api/search") return search(database, request);
+
+    // /api/tickers/{ticker}/{history|metrics}
+    constexpr std::string_view prefix = "/api/tickers/";
+    if (path.substr(0, prefix.size()) == prefix) {
+        const auto rest = path.substr(prefix.size());
+        const auto slash = rest.find('/');
+        if (slash != std::string_view::npos && slash > 0) {
+            const auto ticker = cli::upper_ticker(rest.substr(0, slash));
+            const auto what = rest.substr(slash + 1);
+            if (what == "history") {
+                return history(database, ticker, request, cache);
+            }
+            if (what == "metrics") {
+                return ticker_metrics(database, ticker, request, cache);
+            }
+        }
+    }
+    return json_error(404, "no such endpoint");
+}
+
+} // namespace server
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "db/database.hpp"
+#include "server/http_server.hpp"
+#include "server/response_cache.hpp"
+
+// JSON endpoints of `intrinsic serve`:
+//
+//   GET /api/tickers?page=&size=&sort=ticker|updated&dir=asc|desc&portfolio=1
+//   GET /api/search?q=&limit=&portfolio=1
+//   GET /api/tickers/{ticker}/history
+//   GET /api/tickers/{ticker}/metrics?period=YYYY-P&price=
+//
+// Metrics default to the newest period and the newest stored close.
+// Errors are {"error": "..."} with a 4xx/5xx status. Per-ticker answers
+// carry an ETag from the ticker's generation; If-None-Match gets a 304.
+
+namespace server {
+
+inline constexpr int kApiMaxPageSize = 500;
+
+// `cache`, when given, keeps per-ticker payloads across requests.
+HttpResponse handle_api_request(db::Database& database,
+                                const HttpRequest& request,
+                                ResponseCache* cache = nullptr);
+
+} // namespace server
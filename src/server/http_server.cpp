@@ -0,0 +1,548 @@
+#include "server/http_server.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace server {
+
+namespace {
+
+constexpr int kMaxEvents = 64;
+constexpr int kMaxAcceptsPerWake = 16;
+constexpr int kSweepIntervalMs = 1000;
+constexpr std::size_t kReadChunk = 4096;
+
+std::int64_t now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string lower(std::string_view text)
+{
+    std::string out(text);
+    for (auto& c : out) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return out;
+}
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+const char* status_reason(int status)
+{
+    switch (status) {
+    case 200:
+        return "OK";
+    case 304:
+        return "Not Modified";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    case 413:
+        return "Content Too Large";
+    case 431:
+        return "Request Header Fields Too Large";
+    case 500:
+        return "Internal Server Error";
+    case 505:
+        return "HTTP Version Not Supported";
+    }
+    return "Unknown";
+}
+
+void parse_query(std::string_view text,
+                 std::map<std::string, std::string>& out)
+{
+    while (!text.empty()) {
+        const auto amp = text.find('&');
+        const auto pair = text.substr(0, amp);
+        text = amp == std::string_view::npos ? std::string_view{}
+                                             : text.substr(amp + 1);
+        if (pair.empty()) continue;
+        const auto eq = pair.find('=');
+        auto name = percent_decode(pair.substr(0, eq), true);
+        auto value = eq == std::string_view::npos
+                         ? std::string{}
+                         : percent_decode(pair.substr(eq + 1), true);
+        out[std::move(name)] = std::move(value);
+    }
+}
+
+// True when the comma-separated `list` holds `token`, ignoring case.
+bool has_token(const std::string& list, std::string_view token)
+{
+    std::string_view rest = list;
+    while (!rest.empty()) {
+        const auto comma = rest.find(',');
+        if (lower(trim(rest.substr(0, comma))) == token) return true;
+        if (comma == std::string_view::npos) break;
+        rest.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+} // namespace
+
+std::string HttpRequest::param(const std::string& name,
+                               const std::string& fallback) const
+{
+    const auto it = query.find(name);
+    return it == query.end() ? fallback : it->second;
+}
+
+std::string HttpRequest::header(const std::string& name) const
+{
+    const auto it = headers.find(name);
+    return it == headers.end() ? std::string{} : it->second;
+}
+
+std::string percent_decode(std::string_view text, bool plus_is_space)
+{
+    std::string out;
+    out.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c == '+' && plus_is_space) {
+            out.push_back(' ');
+        }
+        else if (c == '%' && i + 2 < text.size() &&
+                 hex_value(text[i + 1]) >= 0 && hex_value(text[i + 2]) >= 0) {
+            out.push_back(static_cast<char>(hex_value(text[i + 1]) * 16 +
+                                            hex_value(text[i + 2])));
+            i += 2;
+        }
+        else {
+            out.push_back(c);
+        }
+    }
+    return out;
+}
+
+ParseStatus parse_request(std::string_view buffer,
+                          HttpRequest& out,
+                          std::size_t& consumed,
+                          int& error_status)
+{
+    const auto head_end = buffer.find("\r\n\r\n");
+    if (head_end == std::string_view::npos) {
+        if (buffer.size() <= HttpServer::kMaxHeadBytes) {
+            return ParseStatus::Incomplete;
+        }
+        error_status = 431;
+        return ParseStatus::Error;
+    }
+    if (head_end + 4 > HttpServer::kMaxHeadBytes) {
+        error_status = 431;
+        return ParseStatus::Error;
+    }
+
+    error_status = 400;
+    std::string_view head = buffer.substr(0, head_end);
+    const auto line_end = head.find("\r\n");
+    const auto request_line = head.substr(0, line_end);
+    head = line_end == std::string_view::npos ? std::string_view{}
+                                              : head.substr(line_end + 2);
+
+    const auto sp1 = request_line.find(' ');
+    const auto sp2 = sp1 == std::string_view::npos
+                         ? std::string_view::npos
+                         : request_line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos) return ParseStatus::Error;
+    const auto target = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+    const auto version = request_line.substr(sp2 + 1);
+    if (target.empty() || target.front() != '/') return ParseStatus::Error;
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+        error_status = version.substr(0, 5) == "HTTP/" ? 505 : 400;
+        return ParseStatus::Error;
+    }
+
+    out = HttpRequest{};
+    out.method = std::string(request_line.substr(0, sp1));
+    const auto question = target.find('?');
+    out.path = percent_decode(target.substr(0, question), false);
+    if (question != std::string_view::npos) {
+        parse_query(target.substr(question + 1), out.query);
+    }
+
+    while (!head.empty()) {
+        const auto eol = head.find("\r\n");
+        const auto line = head.substr(0, eol);
+        head = eol == std::string_view::npos ? std::string_view{}
+                                             : head.substr(eol + 2);
+        const auto colon = line.find(':');
+        if (colon == std::string_view::npos || colon == 0) {
+            return ParseStatus::Error;
+        }
+        out.headers[lower(line.substr(0, colon))] =
+            std::string(trim(line.substr(colon + 1)));
+    }
+
+    const auto connection = out.header("connection");
+    out.keep_alive = version == "HTTP/1.1"
+                         ? !has_token(connection, "close")
+                         : has_token(connection, "keep-alive");
+
+    // there is nothing to post: bodies would desync the connection
+    const auto length = out.header("content-length");
+    if (!out.header("transfer-encoding").empty() ||
+        (!length.empty() && length != "0")) {
+        error_status = 413;
+        return ParseStatus::Error;
+    }
+    if (out.method != "GET" && out.method != "HEAD") {
+        error_status = 405;
+        return ParseStatus::Error;
+    }
+
+    consumed = head_end + 4;
+    return ParseStatus::Done;
+}
+
+void write_response(const HttpResponse& response,
+                    bool keep_alive,
+                    bool head_only,
+                    std::string& out)
+{
+    out += "HTTP/1.1 ";
+    out += std::to_string(response.status);
+    out += ' ';
+    out += status_reason(response.status);
+    out += "\r\nContent-Type: ";
+    out += response.content_type;
+    // a 304 has no body, and its length would be the cached one's
+    if (response.status != 304) {
+        out += "\r\nContent-Length: ";
+        out += std::to_string(response.body.size());
+    }
+    out += keep_alive ? "\r\nConnection: keep-alive" : "\r\nConnection: close";
+    for (const auto& [name, value] : response.headers) {
+        out += "\r\n";
+        out += name;
+        out += ": ";
+        out += value;
+    }
+    out += "\r\n\r\n";
+    if (!head_only) out += response.body;
+}
+
+HttpServer::HttpServer()
+{
+    stop_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+HttpServer::~HttpServer()
+{
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+    if (stop_fd_ >= 0) ::close(stop_fd_);
+}
+
+bool HttpServer::listen(std::uint16_t port, std::string* err)
+{
+    if (stop_fd_ < 0) {
+        if (err) *err = std::string("eventfd: ") + std::strerror(errno);
+        return false;
+    }
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+
+    listen_fd_ =
+        ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        if (err) *err = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    const int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    socklen_t len = sizeof(addr);
+    if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr), len) !=
+            0 ||
+        ::listen(listen_fd_, SOMAXCONN) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) !=
+            0) {
+        if (err) *err = "127.0.0.1:" + std::to_string(port) + ": " +
+                        std::strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    port_ = ntohs(addr.sin_port);
+    return true;
+}
+
+bool HttpServer::run(const std::filesystem::path& db_path,
+                     unsigned workers,
+                     Handler handler,
+                     std::string* err)
+{
+    if (listen_fd_ < 0) {
+        if (err) *err = "server is not listening";
+        return false;
+    }
+    workers = std::max(workers, 1u);
+
+    std::vector<std::unique_ptr<db::Database>> readers;
+    try {
+        for (unsigned i = 0; i < workers; ++i) {
+            readers.push_back(std::make_unique<db::Database>());
+            readers.back()->open_read_only(db_path);
+        }
+    }
+    catch (const std::exception& e) {
+        if (err) *err = e.what();
+        return false;
+    }
+
+    handler_ = std::move(handler);
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (unsigned i = 1; i < workers; ++i) {
+        threads.emplace_back([this, &readers, i] { work_(*readers[i]); });
+    }
+    work_(*readers[0]);
+    for (auto& thread : threads) thread.join();
+    return true;
+}
+
+void HttpServer::stop()
+{
+    const std::uint64_t one = 1;
+    if (stop_fd_ >= 0) {
+        [[maybe_unused]] const auto n = ::write(stop_fd_, &one, sizeof(one));
+    }
+}
+
+void HttpServer::work_(db::Database& database)
+{
+    const int ep = ::epoll_create1(EPOLL_CLOEXEC);
+    if (ep < 0) return;
+
+    // one worker wakes per pending connection; the stop event wakes all
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+    ev.data.fd = listen_fd_;
+    ::epoll_ctl(ep, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.events = EPOLLIN;
+    ev.data.fd = stop_fd_;
+    ::epoll_ctl(ep, EPOLL_CTL_ADD, stop_fd_, &ev);
+
+    std::unordered_map<int, Connection> connections;
+    const auto drop = [&](int fd) {
+        ::epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(fd);
+    };
+
+    epoll_event events[kMaxEvents];
+    std::int64_t last_sweep = now_ms();
+    bool running = true;
+    while (running) {
+        const int n = ::epoll_wait(ep, events, kMaxEvents, kSweepIntervalMs);
+        if (n < 0 && errno != EINTR) break;
+        const std::int64_t now = now_ms();
+
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == stop_fd_) {
+                running = false;
+                continue;
+            }
+            if (fd == listen_fd_) {
+                for (int k = 0; k < kMaxAcceptsPerWake; ++k) {
+                    const int client = ::accept4(listen_fd_,
+                                                 nullptr,
+                                                 nullptr,
+                                                 SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (client < 0) break;
+                    const int one = 1;
+                    ::setsockopt(
+                        client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    epoll_event cev{};
+                    cev.events = EPOLLIN;
+                    cev.data.fd = client;
+                    if (::epoll_ctl(ep, EPOLL_CTL_ADD, client, &cev) != 0) {
+                        ::close(client);
+                        continue;
+                    }
+                    Connection& connection = connections[client];
+                    connection.last_active_ms = now;
+                    connection.armed = EPOLLIN;
+                }
+                continue;
+            }
+
+            const auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            Connection& connection = it->second;
+            connection.last_active_ms = now;
+            if (events[i].events & EPOLLERR) {
+                drop(fd);
+                continue;
+            }
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP)) {
+                char buf[kReadChunk];
+                while (!connection.close_after &&
+                       connection.out.size() - connection.out_sent <
+                           kMaxPendingOut) {
+                    const ssize_t got = ::read(fd, buf, sizeof(buf));
+                    if (got > 0) {
+                        connection.in.append(buf,
+                                             static_cast<std::size_t>(got));
+                        serve_input_(database, connection);
+                        continue;
+                    }
+                    if (got < 0 && errno == EINTR) continue;
+                    if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                        break;
+                    }
+                    // peer hung up: answer what it sent, then close
+                    connection.close_after = true;
+                }
+            }
+
+            if (!flush_(fd, connection)) {
+                drop(fd);
+                continue;
+            }
+            // Level-triggered EPOLLIN stays ready after a half-close, so
+            // stop reading once closing or while `out` is backed up.
+            const bool want_read =
+                !connection.close_after &&
+                connection.out.size() - connection.out_sent < kMaxPendingOut;
+            const std::uint32_t want =
+                (want_read ? EPOLLIN : 0u) |
+                (connection.out.empty() ? 0u : EPOLLOUT);
+            if (want != connection.armed) {
+                epoll_event mev{};
+                mev.events = want;
+                mev.data.fd = fd;
+                ::epoll_ctl(ep, EPOLL_CTL_MOD, fd, &mev);
+                connection.armed = want;
+            }
+        }
+
+        if (now - last_sweep >= kSweepIntervalMs) {
+            last_sweep = now;
+            std::vector<int> idle;
+            for (const auto& [fd, connection] : connections) {
+                if (now - connection.last_active_ms >= kIdleTimeoutMs) {
+                    idle.push_back(fd);
+                }
+            }
+            for (const int fd : idle) drop(fd);
+        }
+    }
+
+    std::vector<int> open;
+    for (const auto& entry : connections) open.push_back(entry.first);
+    for (const int fd : open) drop(fd);
+    ::close(ep);
+}
+
+void HttpServer::serve_input_(db::Database& database, Connection& connection)
+{
+    std::size_t offset = 0;
+    while (!connection.close_after) {
+        HttpRequest request;
+        std::size_t consumed = 0;
+        int error_status = 400;
+        const std::string_view pending =
+            std::string_view(connection.in).substr(offset);
+        const auto status =
+            parse_request(pending, request, consumed, error_status);
+        if (status == ParseStatus::Incomplete) break;
+        if (status == ParseStatus::Error) {
+            HttpResponse response;
+            response.status = error_status;
+            response.content_type = "text/plain";
+            write_response(response, false, false, connection.out);
+            connection.close_after = true;
+            break;
+        }
+        offset += consumed;
+
+        HttpResponse response;
+        try {
+            response = handler_(database, request);
+        }
+        catch (const std::exception& e) {
+            response = HttpResponse{};
+            response.status = 500;
+            response.content_type = "text/plain";
+            response.body = e.what();
+        }
+        write_response(response,
+                       request.keep_alive,
+                       request.method == "HEAD",
+                       connection.out);
+        served_.fetch_add(1, std::memory_order_relaxed);
+        if (!request.keep_alive) connection.close_after = true;
+    }
+    connection.in.erase(0, offset);
+}
+
+bool HttpServer::flush_(int fd, Connection& connection)
+{
+    while (connection.out_sent < connection.out.size()) {
+        const ssize_t sent =
+            ::send(fd,
+                   connection.out.data() + connection.out_sent,
+                   connection.out.size() - connection.out_sent,
+                   MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection.out_sent += static_cast<std::size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        return false;
+    }
+    connection.out.clear();
+    connection.out_sent = 0;
+    return !connection.close_after;
+}
+
+} // namespace server
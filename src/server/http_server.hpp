@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "db/database.hpp"
+
+// Minimal HTTP/1.1 server for `intrinsic serve`: GET and HEAD only, no
+// request bodies, keep-alive and pipelining. Each worker thread runs its
+// own epoll loop over connections it accepted from the shared listening
+// socket, and answers them from its own read-only connection to the
+// database, so requests never wait on a lock held by another worker.
+
+namespace server {
+
+struct HttpRequest {
+    std::string method;
+    std::string path; // percent-decoded, without the query
+    std::map<std::string, std::string> query;
+    std::map<std::string, std::string> headers; // names lower-cased
+    bool keep_alive = true;
+
+    // Query parameter `name`, or `fallback` when absent.
+    std::string param(const std::string& name,
+                      const std::string& fallback = {}) const;
+    // Header `name` (lower-case), or empty.
+    std::string header(const std::string& name) const;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "application/json";
+    std::string body;
+    std::vector<std::pair<std::string, std::string>> headers;
+};
+
+enum class ParseStatus { Done, Incomplete, Error };
+
+// Parses the request head at the front of `buffer`. Done sets `consumed`
+// to its length; Error sets `error_status` to the status to answer with
+// before closing the connection.
+ParseStatus parse_request(std::string_view buffer,
+                          HttpRequest& out,
+                          std::size_t& consumed,
+                          int& error_status);
+
+// Decodes %XX escapes, and '+' as a space when `plus_is_space`. Malformed
+// escapes are kept as they are.
+std::string percent_decode(std::string_view text, bool plus_is_space);
+
+// Appends the status line, headers and (unless `head_only`) body.
+void write_response(const HttpResponse& response,
+                    bool keep_alive,
+                    bool head_only,
+                    std::string& out);
+
+class HttpServer {
+public:
+    using Handler =
+        std::function<HttpResponse(db::Database&, const HttpRequest&)>;
+
+    static constexpr std::size_t kMaxHeadBytes = 8192;
+    // A connection is not read while more than this awaits sending.
+    static constexpr std::size_t kMaxPendingOut = 1 << 20;
+    static constexpr int kIdleTimeoutMs = 30000;
+
+    HttpServer();
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Binds 127.0.0.1:`port`; 0 picks a free port, see port().
+    bool listen(std::uint16_t port, std::string* err = nullptr);
+    std::uint16_t port() const { return port_; }
+
+    // Serves with `workers` threads until stop(), each reading `db_path`
+    // through its own read-only connection. Fails without serving when a
+    // connection cannot be opened.
+    bool run(const std::filesystem::path& db_path,
+             unsigned workers,
+             Handler handler,
+             std::string* err = nullptr);
+
+    // Makes run() return once every worker has left its loop. Safe from a
+    // signal handler and from other threads.
+    void stop();
+
+    std::uint64_t requests_served() const { return served_.load(); }
+
+private:
+    struct Connection {
+        std::string in;
+        std::string out;
+        std::size_t out_sent = 0;
+        bool close_after = false; // once `out` is flushed
+        std::uint32_t armed = 0;  // epoll events registered
+        std::int64_t last_active_ms = 0;
+    };
+
+    void work_(db::Database& database);
+    void serve_input_(db::Database& database, Connection& connection);
+    // False once the connection is to be closed.
+    bool flush_(int fd, Connection& connection);
+
+private:
+    int listen_fd_ = -1;
+    int stop_fd_ = -1; // eventfd, readable once stop() was called
+    std::uint16_t port_ = 0;
+    Handler handler_;
+    std::atomic<std::uint64_t> served_{0};
+};
+
+} // namespace server
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace server {
+
+// Appends compact JSON to a string. Commas are placed from a stack of open
+// containers, so callers only say what comes next. Missing and non-finite
+// numbers are written as null.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    JsonWriter& begin_object()
+    {
+        separate_();
+        out_.push_back('{');
+        first_.push_back(true);
+        return *this;
+    }
+
+    JsonWriter& end_object()
+    {
+        out_.push_back('}');
+        first_.pop_back();
+        return *this;
+    }
+
+    JsonWriter& begin_array()
+    {
+        separate_();
+        out_.push_back('[');
+        first_.push_back(true);
+        return *this;
+    }
+
+    JsonWriter& end_array()
+    {
+        out_.push_back(']');
+        first_.pop_back();
+        return *this;
+    }
+
+    // Member name; the next value is its value.
+    JsonWriter& key(std::string_view name)
+    {
+        separate_();
+        write_string_(name);
+        out_.push_back(':');
+        after_key_ = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view v)
+    {
+        separate_();
+        write_string_(v);
+        return *this;
+    }
+
+    JsonWriter& value(const char* v) { return value(std::string_view(v)); }
+
+    JsonWriter& value(bool v)
+    {
+        separate_();
+        out_ += v ? "true" : "false";
+        return *this;
+    }
+
+    JsonWriter& value(std::int64_t v)
+    {
+        separate_();
+        out_ += std::to_string(v);
+        return *this;
+    }
+
+    JsonWriter& value(int v) { return value(static_cast<std::int64_t>(v)); }
+
+    JsonWriter& value(double v)
+    {
+        separate_();
+        if (!std::isfinite(v)) {
+            out_ += "null";
+            return *this;
+        }
+        // shortest text that reads back as the same double
+        char buf[32];
+        const auto end = std::to_chars(buf, buf + sizeof(buf), v).ptr;
+        out_.append(buf, end);
+        return *this;
+    }
+
+    template <class T> JsonWriter& value(const std::optional<T>& v)
+    {
+        if (!v.has_value()) return null();
+        return value(*v);
+    }
+
+    JsonWriter& null()
+    {
+        separate_();
+        out_ += "null";
+        return *this;
+    }
+
+private:
+    void separate_()
+    {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (first_.empty()) return;
+        if (!first_.back()) out_.push_back(',');
+        first_.back() = false;
+    }
+
+    void write_string_(std::string_view s)
+    {
+        out_.push_back('"');
+        for (const char c : s) {
+            switch (c) {
+            case '"':
+                out_ += "\\\"";
+                break;
+            case '\\':
+                out_ += "\\\\";
+                break;
+            case '\n':
+                out_ += "\\n";
+                break;
+            case '\r':
+                out_ += "\\r";
+                break;
+            case '\t':
+                out_ += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf,
+                                  sizeof(buf),
+                                  "\\u%04x",
+                                  static_cast<unsigned>(c));
+                    out_ += buf;
+                }
+                else {
+                    out_.push_back(c);
+                }
+            }
+        }
+        out_.push_back('"');
+    }
+
+private:
+    std::string& out_;
+    std::vector<bool> first_; // per open container: nothing written yet
+    bool after_key_ = false;
+};
+
+} // namespace server
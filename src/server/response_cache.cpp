@@ -0,0 +1,148 @@
+#include "server/response_cache.hpp"
+
+#include <cstdio>
+#include <utility>
+
+namespace server {
+
+namespace {
+
+// Per-entry bookkeeping on top of key and body: map node, list node,
+// payload header.
+constexpr std::size_t kEntryOverheadBytes = 160;
+
+std::uint64_t fnv1a(std::string_view text)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+} // namespace
+
+ResponseCache::ResponseCache(std::size_t budget_bytes)
+    : budget_bytes_(budget_bytes)
+{
+}
+
+ResponseCache::PayloadPtr ResponseCache::find(const std::string& key,
+                                              std::uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    const auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.payload->generation != generation) {
+        ++misses_;
+        return nullptr;
+    }
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return it->second.payload;
+}
+
+ResponseCache::PayloadPtr ResponseCache::store(const std::string& key,
+                                               std::uint64_t generation,
+                                               std::string body,
+                                               std::string content_type)
+{
+    auto payload =
+        make_payload(generation, std::move(body), std::move(content_type));
+    const std::size_t bytes = key.size() + payload->body.size() +
+                              payload->etag.size() + kEntryOverheadBytes;
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (const auto it = entries_.find(key); it != entries_.end()) {
+        // a worker that read an older generation must not undo a newer one
+        if (it->second.payload->generation > generation) return payload;
+        erase_(it);
+    }
+    if (bytes > budget_bytes_) return payload;
+
+    while (bytes_ + bytes > budget_bytes_ && !lru_.empty()) {
+        erase_(entries_.find(lru_.back()));
+    }
+    lru_.push_front(key);
+    entries_[key] = Entry{payload, bytes, lru_.begin()};
+    bytes_ += bytes;
+    return payload;
+}
+
+void ResponseCache::erase_(
+    std::unordered_map<std::string, Entry>::iterator it)
+{
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+std::size_t ResponseCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return entries_.size();
+}
+
+std::size_t ResponseCache::bytes() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return bytes_;
+}
+
+std::uint64_t ResponseCache::hits() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return hits_;
+}
+
+std::uint64_t ResponseCache::misses() const
+{
+    std::lock_guard<std::mutex> lock(mu_);
+    return misses_;
+}
+
+ResponseCache::PayloadPtr make_payload(std::uint64_t generation,
+                                       std::string body,
+                                       std::string content_type)
+{
+    auto payload = std::make_shared<ResponseCache::Payload>();
+    payload->generation = generation;
+    char etag[48];
+    std::snprintf(etag,
+                  sizeof(etag),
+                  "\"%llx-%016llx\"",
+                  static_cast<unsigned long long>(generation),
+                  static_cast<unsigned long long>(fnv1a(body)));
+    payload->etag = etag;
+    payload->content_type = std::move(content_type);
+    payload->body = std::move(body);
+    return payload;
+}
+
+bool etag_matches(std::string_view if_none_match, std::string_view etag)
+{
+    while (!if_none_match.empty()) {
+        const auto comma = if_none_match.find(',');
+        auto tag = trim(if_none_match.substr(0, comma));
+        if (tag == "*") return true;
+        // weak comparison: W/"x" matches "x"
+        if (tag.substr(0, 2) == "W/") tag.remove_prefix(2);
+        if (tag == etag) return true;
+        if (comma == std::string_view::npos) break;
+        if_none_match.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+} // namespace server
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Serialized payloads (JSON, text) keyed by what they were rendered from,
+// and valid while the generation they were rendered at is current; see
+// Database::get_ticker_generation(). A current payload costs one hash
+// lookup instead of a read and a serialization, and carries an ETag so
+// HTTP clients can revalidate without a body. Shared by every server
+// worker and usable by any in-process reader that renders the same data.
+
+namespace server {
+
+class ResponseCache {
+public:
+    static constexpr std::size_t kDefaultBudgetMb = 16;
+
+    struct Payload {
+        std::uint64_t generation = 0;
+        std::string etag; // quoted, from the generation and body hash
+        std::string content_type;
+        std::string body;
+    };
+
+    using PayloadPtr = std::shared_ptr<const Payload>;
+
+    explicit ResponseCache(std::size_t budget_bytes = kDefaultBudgetMb << 20);
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    // Payload of `key` when it was stored at `generation`, else null.
+    PayloadPtr find(const std::string& key, std::uint64_t generation);
+
+    // Stores `body` for `key` at `generation`, replacing older payloads and
+    // evicting the least recently used ones over budget. Payloads larger
+    // than the budget are returned but not kept.
+    PayloadPtr store(const std::string& key,
+                     std::uint64_t generation,
+                     std::string body,
+                     std::string content_type = "application/json");
+
+    // find(), or render() into a stored payload on a miss.
+    template <class Render>
+    PayloadPtr get_or_render(const std::string& key,
+                             std::uint64_t generation,
+                             Render&& render)
+    {
+        if (auto hit = find(key, generation)) return hit;
+        return store(key, generation, render());
+    }
+
+    std::size_t size() const;
+    std::size_t bytes() const;
+    std::uint64_t hits() const;
+    std::uint64_t misses() const;
+
+private:
+    struct Entry {
+        PayloadPtr payload;
+        std::size_t bytes = 0;
+        std::list<std::string>::iterator lru; // into lru_, newest first
+    };
+
+    void erase_(std::unordered_map<std::string, Entry>::iterator it);
+
+private:
+    mutable std::mutex mu_;
+    std::size_t budget_bytes_;
+    std::size_t bytes_ = 0;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;
+};
+
+// Payload of `body` at `generation`, outside any cache.
+ResponseCache::PayloadPtr make_payload(
+    std::uint64_t generation,
+    std::string body,
+    std::string content_type = "application/json");
+
+// True when an If-None-Match header value names `etag` (or is "*").
+bool etag_matches(std::string_view if_none_match, std::string_view etag);
+
+} // namespace server
@@ -4,12 +4,16 @@
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <optional>
 #include <sstream>
 #include <string>
 
 #include "paths.hpp"
 #include "state.hpp"
 
+inline constexpr std::size_t kMaxHistoryCacheMb = 4096;
+inline constexpr std::size_t kMaxPriceCacheMb = 4096;
+
 inline std::string trim_copy(std::string s)
 {
     auto not_space = [](unsigned char c) { return !std::isspace(c); };
@@ -26,6 +30,19 @@ inline std::string lower_copy(std::string s)
     return s;
 }
 
+// Plain non-negative MiB count, capped at `cap`; empty for anything else.
+inline std::optional<std::size_t> parse_cache_mb(const std::string& val,
+                                                 std::size_t cap)
+{
+    if (val.empty() || val.size() > 6 ||
+        !std::all_of(val.begin(), val.end(), [](unsigned char c) {
+            return std::isdigit(c) != 0;
+        })) {
+        return std::nullopt;
+    }
+    return std::min<std::size_t>(std::stoul(val), cap);
+}
+
 inline std::filesystem::path intrinsic_config_path(std::string* err)
 {
     try {
@@ -78,6 +95,10 @@ inline bool save_settings(const AppState::Settings& s, std::string* err)
             color_mode_str = "white_background";
         if (s.color_mode == ColorMode::Black) color_mode_str = "black";
         out << "color_mode=" << color_mode_str << "\n";
+        out << "history_cache_mb=" << s.history_cache_mb << "\n";
+        out << "price_cache_mb=" << s.price_cache_mb << "\n";
+        out << "report_date_prices=" << (s.report_date_prices ? "1" : "0")
+            << "\n";
         out.flush();
         out.close();
 
@@ -171,6 +192,20 @@ inline bool load_settings(AppState::Settings& s, std::string* err)
                 if (val == "black" || val == "dark" || val == "dark_mode")
                     s.color_mode = ColorMode::Black;
             }
+            else if (key == "history_cache_mb") {
+                if (const auto mb = parse_cache_mb(val, kMaxHistoryCacheMb))
+                    s.history_cache_mb = *mb;
+            }
+            else if (key == "price_cache_mb") {
+                if (const auto mb = parse_cache_mb(val, kMaxPriceCacheMb))
+                    s.price_cache_mb = *mb;
+            }
+            else if (key == "report_date_prices") {
+                if (val == "1" || val == "true" || val == "yes" || val == "on")
+                    s.report_date_prices = true;
+                if (val == "0" || val == "false" || val == "no" || val == "off")
+                    s.report_date_prices = false;
+            }
             else if (key == "white_background" || key == "white_bg") {
                 if (val == "1" || val == "true" || val == "yes" || val == "on")
                     s.color_mode = ColorMode::White;
@@ -6,9 +6,21 @@
 #include <variant>
 #include <array>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 
 #include "db/database.hpp"
+#include "db/history_cache.hpp"
+#include "db/history_prefetcher.hpp"
+#include "db/price_cache.hpp"
+#include "db/price_feed.hpp"
+#include "db/ticker_index.hpp"
+#include "db/ticker_page_ring.hpp"
+#include "metrics/metric_matrix.hpp"
+#include "metrics/monte_carlo.hpp"
+#include "metrics/portfolio.hpp"
+#include "metrics/sparkline.hpp"
 #include "views/view.hpp"
 
 enum class AddMode {
@@ -73,6 +85,23 @@ struct AppState {
 
     AddState add;
 
+    // decoded histories of recently opened tickers
+    db::HistoryCache history_cache;
+    // delta-encoded daily closes of recently opened tickers
+    db::PriceCache price_cache;
+    // ticker view chart strips, by ticker, metric and width
+    metrics::SparklineCache sparklines;
+    // intrinsic-value simulations, by ticker and parameters
+    metrics::DcfCache dcf;
+    // runs batch metric work; optional, non-owning
+    metrics::WorkPool* work_pool = nullptr;
+    // warms history_cache off the UI thread; optional, non-owning
+    db::HistoryPrefetcher* prefetcher = nullptr;
+    // fills tickers.pages off the UI thread; optional, non-owning
+    db::TickerPageLoader* page_loader = nullptr;
+    // live quotes pushed over a local socket; optional, non-owning
+    db::PriceFeed* price_feed = nullptr;
+
     struct Settings {
         // defaults
         db::Database::TickerSortKey sort_key =
@@ -81,6 +110,12 @@ struct AppState {
         bool ttm = false;
         bool show_help = true;
         ColorMode color_mode = ColorMode::Default;
+        // byte budget of history_cache, in MiB; 0 disables it
+        std::size_t history_cache_mb = db::HistoryCache::kDefaultBudgetMb;
+        // byte budget of price_cache, in MiB; 0 disables it
+        std::size_t price_cache_mb = db::PriceCache::kDefaultBudgetMb;
+        // price each period's ratios at its stored report-date close
+        bool report_date_prices = false;
     } settings;
 
     struct SettingsViewState {
@@ -99,22 +134,33 @@ struct AppState {
         bool search_exit_armed = false;
         bool portfolio_only = false;
         std::string search_query;
-        // frozen query used for the currently displayed results
+        // query the currently displayed results were computed for
         std::string search_submitted_query;
+        // ranked results for search_submitted_query; search_rows is the
+        // page of them currently on screen
+        std::vector<db::Database::TickerRow> search_results;
         std::vector<db::Database::TickerRow> search_rows;
+        int search_page = 0;
+        // every match for search_submitted_query, narrowed while typing
+        db::TickerIndex::Search search_matches;
         std::vector<db::Database::TickerRow> last_rows;
 
-        struct Prefetch {
-            int page = 0;
-            int page_size = 0;
-            db::Database::TickerSortKey sort_key{};
-            db::Database::SortDir sort_dir{};
-            bool portfolio_only = false;
-            std::vector<db::Database::TickerRow> rows;
-            bool valid = false;
-        } prefetch;
+        // tickers last handed to the history prefetcher, and at which
+        // write generation
+        std::vector<std::string> history_prefetch;
+        std::uint64_t history_prefetch_generation = 0;
+
+        // ticker_summary row shown for the selection, keyed by ticker and
+        // write generation so moving around does not requery
+        std::string summary_ticker;
+        std::uint64_t summary_generation = 0;
+        std::optional<db::Database::TickerSummary> summary;
 
-        void invalidate_prefetch() { prefetch.valid = false; }
+        // in-memory pages for the grid; the ring covers the SQL fallback
+        db::TickerIndex index;
+        db::TickerPageRing pages;
+
+        void invalidate_prefetch() { pages.invalidate(); }
 
         void clear_search()
         {
@@ -122,7 +168,10 @@ struct AppState {
             search_exit_armed = false;
             search_query.clear();
             search_submitted_query.clear();
+            search_results.clear();
             search_rows.clear();
+            search_page = 0;
+            search_matches.clear();
             row_scroll = 0;
         }
     } tickers;
@@ -131,6 +180,10 @@ struct AppState {
         std::string ticker;
         std::vector<db::Database::FinanceRow> all_rows;
         std::vector<db::Database::FinanceRow> rows;
+        // cache entry all_rows was copied from; null when set directly
+        db::HistoryCache::HistoryPtr history;
+        // stored closes of the ticker; null until the view first loads them
+        db::PriceCache::SeriesPtr prices;
         int index = 0;
         int scroll = 0;
         std::string status_line;
@@ -141,6 +194,9 @@ struct AppState {
         // inline editor buffers for date/value inputs
         std::array<std::string, 2> inputs{};
         int input_index = 0;
+        // another session changed the ticker; its history is being decoded
+        // again and replaces `history` once cached
+        bool refresh_pending = false;
 
         void reset(std::string next_ticker,
                    std::vector<db::Database::FinanceRow> next_rows,
@@ -148,6 +204,8 @@ struct AppState {
         {
             ticker = std::move(next_ticker);
             all_rows = std::move(next_rows);
+            history.reset();
+            prices.reset();
             rows = all_rows;
             index = rows.empty() ? 0 : static_cast<int>(rows.size() - 1);
             scroll = 0;
@@ -157,6 +215,14 @@ struct AppState {
             ticker_type = (next_ticker_type > 0) ? next_ticker_type : 1;
             inputs = {};
             input_index = 0;
+            refresh_pending = false;
+        }
+
+        void reset(db::HistoryCache::HistoryPtr next_history,
+                   int next_ticker_type = 1)
+        {
+            reset(next_history->ticker, next_history->rows, next_ticker_type);
+            history = std::move(next_history);
         }
 
         void clamp_index()
@@ -170,6 +236,72 @@ struct AppState {
                 index = static_cast<int>(rows.size() - 1);
         }
     } ticker_view;
+
+    struct MatrixViewState {
+        // history the matrix was built from; reopening the same one reuses
+        // the matrix instead of rebuilding it
+        db::HistoryCache::HistoryPtr history;
+        std::shared_ptr<const metrics::MetricMatrix> matrix;
+        // first period column and first metric row on screen
+        int column = 0;
+        int row = 0;
+        // period columns that fit; render_matrix keeps it current so paging
+        // moves by a screenful
+        int visible_columns = 1;
+
+        void reset(db::HistoryCache::HistoryPtr next_history)
+        {
+            if (next_history != history || !matrix) {
+                matrix = std::make_shared<const metrics::MetricMatrix>(
+                    next_history->columns, next_history->yoy);
+                history = std::move(next_history);
+            }
+            // newest periods first on screen
+            column = static_cast<int>(matrix->column_count());
+            row = 0;
+        }
+    } matrix_view;
+
+    struct SweepViewState {
+        // shift of the price window from centring on the typed price, in
+        // grid steps
+        int offset = 0;
+        // price columns that fit; render_sweep keeps it current
+        int visible_columns = 1;
+
+        void reset()
+        {
+            offset = 0;
+        }
+    } sweep_view;
+
+    struct PortfolioViewState {
+        // one position per portfolio ticker, totals kept current as
+        // holdings and prices change
+        metrics::PortfolioAggregate aggregate;
+        // generations the positions were read at: a finances write reloads
+        // them, a prices write not applied to them re-prices them
+        std::uint64_t write_generation = 0;
+        std::uint64_t price_generation = 0;
+        bool loaded = false;
+        int selected = 0;
+        int scroll = 0;
+        // holding editor of the selected ticker: shares, cost basis
+        bool editing = false;
+        int edit_field = 0;
+        std::array<std::string, 2> inputs{};
+        // inputs as the editor opened them; a field saved unchanged keeps
+        // its stored value rather than the rounded text
+        std::array<std::string, 2> prefilled{};
+
+        void reset()
+        {
+            loaded = false;
+            selected = 0;
+            scroll = 0;
+            editing = false;
+        }
+    } portfolio_view;
 };
 
 // *
@@ -189,4 +321,23 @@ inline void route_error(AppState& app, const char* err)
     route_error(app, std::string(err ? err : ""));
 }
 
+// Re-reads one ticker after a write and patches the home grid index with it.
+inline void sync_ticker_index(AppState& app, const std::string& ticker)
+{
+    auto& index = app.tickers.index;
+    if (!index.ready()) return;
+
+    std::string err;
+    const auto row = app.db->get_ticker(ticker, &err);
+    if (!err.empty()) {
+        index.reset(); // reload on the next page fetch
+        return;
+    }
+
+    if (row.has_value())
+        index.upsert(*row);
+    else
+        index.erase(ticker);
+}
+
 
@@ -430,6 +430,8 @@ add_submit_parsed_period(AppState& app,
         return false;
     }
 
+    sync_ticker_index(app, *ticker_opt);
+
     if (out_ticker) *out_ticker = *ticker_opt;
     if (out_period) *out_period = *period_opt;
     return true;
@@ -482,19 +484,20 @@ inline bool handle_key_add(AppState& app, int ch)
 
             if (app.add.mode == AddMode::EditFromTicker) {
                 std::string err;
-                auto refreshed = app.db->get_finances(last_ticker, &err);
-                if (!err.empty()) {
+                auto refreshed =
+                    app.history_cache.load(*app.db, last_ticker, &err);
+                if (!refreshed) {
                     route_error(app, err);
                     return true;
                 }
-                if (refreshed.empty()) {
+                if (refreshed->rows.empty()) {
                     app.add.active = false;
                     app.current = views::ViewId::Home;
                     return true;
                 }
 
-                app.ticker_view.reset(
-                    last_ticker, std::move(refreshed), app.add.ticker_type);
+                app.ticker_view.reset(std::move(refreshed),
+                                      app.add.ticker_type);
                 const int idx =
                     add_find_period_index(app.ticker_view.rows, last_period);
                 if (idx >= 0) app.ticker_view.index = idx;
@@ -20,7 +20,7 @@ inline void render_help(const AppState& app)
         if (COLS > 11) mvprintw(0, 11, " help");
     }
 
-    static constexpr std::array<const char*, 18> lines = {
+    static constexpr std::array<const char*, 23> lines = {
         "q  - quit",
         "h / esc  - home",
         "?  - help",
@@ -31,6 +31,7 @@ inline void render_help(const AppState& app)
         "",
         "p  - mark/unmark portfolio ticker",
         "P  - show all or only portfolio tickers",
+        "o  - holdings and portfolio valuation",
         "",
         "esc  - exit search/add mode",
         "-  - back to home from ticker",
@@ -39,6 +40,10 @@ inline void render_help(const AppState& app)
         "e  - edit period",
         "c  - copy period data",
         "y  - toggle yearly/all periods",
+        "m  - metric matrix of every period (ticker)",
+        "v  - simulate intrinsic value (ticker)",
+        "g  - price sweep of valuation ratios (ticker)",
+        "</> pgup/pgdn  - scroll periods (matrix)",
     };
 
     const int start_y = 2;
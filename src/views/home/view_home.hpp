@@ -3,6 +3,8 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <cstdio>
 #include <limits>
 #include <numeric>
 #include <string>
@@ -20,7 +22,8 @@ inline constexpr int kHomeGridGap = 2;
 inline constexpr int kHomeMinTextWidth = 8;
 inline constexpr int kHomeMaxTextWidth = 18;
 inline constexpr int kHomeTextCushion = 2;
-inline constexpr int kHomeSearchLimit = 15;
+inline constexpr int kHomeSearchLimit = 15; // results per search page
+inline constexpr int kHomeSearchMaxResults = 150;
 inline constexpr std::size_t kHomeSearchMaxLen = 12;
 inline constexpr std::string_view kHomeHelpMainRowWide =
     "a: add   q: quit   s: settings   ?: help";
@@ -29,7 +32,7 @@ inline constexpr std::string_view kHomeHelpMainRowNarrowTop =
 inline constexpr std::string_view kHomeHelpMainRowNarrowMiddle =
     "space: search   ?: help";
 inline constexpr std::string_view kHomeHelpMainRowNarrowBottom =
-    "p: mark portfolio   P: portfolio view";
+    "p: mark portfolio   P: portfolio view   o: holdings";
 inline constexpr int kHomeThreeRowHelpExtraCols = 6;
 
 inline bool home_use_three_row_help_layout(int term_cols)
@@ -38,30 +41,84 @@ inline bool home_use_three_row_help_layout(int term_cols)
                            kHomeThreeRowHelpExtraCols;
 }
 
-inline bool prefetch_matches(const AppState& app, int page)
+inline db::TickerPageRing::Key home_page_ring_key(const AppState& app)
 {
-    const auto& p = app.tickers.prefetch;
-    return p.valid && p.page == page && p.page_size == app.tickers.page_size &&
-           p.sort_key == app.settings.sort_key &&
-           p.sort_dir == app.settings.sort_dir &&
-           p.portfolio_only == app.tickers.portfolio_only;
+    db::TickerPageRing::Key key;
+    key.page_size = app.tickers.page_size;
+    key.sort_key = app.settings.sort_key;
+    key.sort_dir = app.settings.sort_dir;
+    key.portfolio_only = app.tickers.portfolio_only;
+    return key;
 }
 
+// Index pages when the index is loaded; otherwise the page ring, reading
+// synchronously only when the background loader has not got there yet.
 inline std::vector<db::Database::TickerRow>
 fetch_page(AppState& app, int page, std::string* err)
 {
-    if (prefetch_matches(app, page)) {
-        auto rows = std::move(app.tickers.prefetch.rows);
-        app.tickers.prefetch.valid = false;
-        return rows;
-    }
-
-    return app.db->get_tickers(page,
-                               app.tickers.page_size,
-                               app.settings.sort_key,
-                               app.settings.sort_dir,
-                               err,
-                               app.tickers.portfolio_only);
+    auto& index = app.tickers.index;
+    if (index.ensure_loaded(*app.db, err)) {
+        return index.page(page,
+                          app.tickers.page_size,
+                          app.settings.sort_key,
+                          app.settings.sort_dir,
+                          app.tickers.portfolio_only);
+    }
+    if (err && !err->empty()) return {};
+
+    auto& ring = app.tickers.pages;
+    ring.set_key(home_page_ring_key(app));
+    if (const auto* rows = ring.find(page)) return *rows;
+    if (ring.past_end(page)) return {};
+
+    std::string local_err;
+    auto rows = app.db->get_tickers(page,
+                                    app.tickers.page_size,
+                                    app.settings.sort_key,
+                                    app.settings.sort_dir,
+                                    &local_err,
+                                    app.tickers.portfolio_only);
+    if (!local_err.empty()) {
+        if (err) *err = local_err;
+        return {};
+    }
+    ring.store(page, rows);
+    return rows;
+}
+
+// Called once per main loop pass alongside the history prefetch: adopts
+// pages the loader finished and asks for the ones still missing around the
+// current page. Only the SQL fallback needs it.
+inline void pump_home_page_prefetch(AppState& app)
+{
+    if (!app.page_loader || !app.db) return;
+
+    auto& ring = app.tickers.pages;
+    for (auto& result : app.page_loader->take()) {
+        if (!(result.key == ring.key()) || result.epoch != ring.epoch()) {
+            continue;
+        }
+        if (result.total.has_value()) ring.set_total(*result.total);
+        if (result.page >= 0 && !ring.find(result.page)) {
+            ring.store(result.page, std::move(result.rows));
+        }
+    }
+
+    if (app.current != views::ViewId::Home || app.tickers.search_mode ||
+        !app.tickers.index.disabled()) {
+        app.page_loader->cancel();
+        return;
+    }
+
+    ring.set_key(home_page_ring_key(app));
+    ring.trim(app.tickers.page);
+
+    db::TickerPageLoader::Request request;
+    request.key = ring.key();
+    request.epoch = ring.epoch();
+    request.need_total = !ring.total().has_value();
+    request.pages = ring.missing_around(app.tickers.page);
+    app.page_loader->want(*app.db, std::move(request));
 }
 
 inline int home_cell_width(const std::vector<db::Database::TickerRow>& rows)
@@ -125,6 +182,117 @@ inline int home_best_index_in_col(
     return -1;
 }
 
+// Tickers worth decoding ahead of Enter: the selection first, then the
+// cells one arrow key away.
+inline std::vector<std::string>
+home_history_prefetch_targets(const AppState& app)
+{
+    const auto& rows = app.tickers.last_rows;
+    const int count = static_cast<int>(rows.size());
+    if (count <= 0) return {};
+
+    const int grid_cols = home_active_grid_cols(COLS, rows);
+    const int grid_rows = home_active_grid_rows(count, grid_cols);
+    const int selected = std::clamp(app.tickers.selected, 0, count - 1);
+    const int col = selected / grid_rows;
+    const int row = selected % grid_rows;
+
+    const int candidates[] = {
+        selected,
+        home_index_for_cell(count, col, row + 1, grid_cols, grid_rows),
+        home_index_for_cell(count, col, row - 1, grid_cols, grid_rows),
+        home_best_index_in_col(count, col + 1, row, grid_cols, grid_rows),
+        home_best_index_in_col(count, col - 1, row, grid_cols, grid_rows),
+    };
+
+    std::vector<std::string> out;
+    for (int idx : candidates) {
+        if (idx < 0) continue;
+        const auto& ticker = rows[static_cast<std::size_t>(idx)].ticker;
+        if (std::find(out.begin(), out.end(), ticker) == out.end()) {
+            out.push_back(ticker);
+        }
+    }
+    return out;
+}
+
+// Called once per main loop pass: adopts finished background decodes and,
+// on the home view, retargets the prefetcher when the selection moved.
+inline void pump_home_history_prefetch(AppState& app)
+{
+    if (!app.prefetcher || !app.db) return;
+
+    app.prefetcher->drain(app.history_cache, *app.db);
+    if (app.current != views::ViewId::Home) return;
+
+    const std::uint64_t generation = app.db->write_generation();
+    auto targets = home_history_prefetch_targets(app);
+    if (targets == app.tickers.history_prefetch &&
+        generation == app.tickers.history_prefetch_generation) {
+        return;
+    }
+    app.tickers.history_prefetch = targets;
+    app.tickers.history_prefetch_generation = generation;
+
+    targets.erase(std::remove_if(targets.begin(),
+                                 targets.end(),
+                                 [&](const std::string& t) {
+                                     return app.history_cache.has_current(
+                                         t, generation);
+                                 }),
+                  targets.end());
+    app.prefetcher->want(*app.db, std::move(targets));
+}
+
+// "latest 2024-Q4  periods 12 (3y)  ttm eps 6.42"; the ttm part is left
+// out for tickers with yearly data only.
+inline std::string
+home_summary_line(const db::Database::TickerSummary& summary)
+{
+    char buf[128];
+    std::snprintf(buf,
+                  sizeof(buf),
+                  "latest %d-%s  periods %d (%dy)",
+                  summary.latest_year,
+                  summary.latest_period_type.c_str(),
+                  summary.period_count,
+                  summary.yearly_count);
+    std::string out = buf;
+
+    if (summary.ttm_year.has_value()) {
+        if (summary.ttm_eps.has_value()) {
+            std::snprintf(buf, sizeof(buf), "  ttm eps %.2f", *summary.ttm_eps);
+            out += buf;
+        }
+        else {
+            out += "  ttm eps -";
+        }
+    }
+    return out;
+}
+
+// Summary row of the selected ticker, read once per selection and write
+// generation. Lookup failures only hide the line.
+inline const db::Database::TickerSummary*
+selected_home_summary(AppState& app)
+{
+    const auto& rows = app.tickers.last_rows;
+    if (!app.db || rows.empty() || app.tickers.selected < 0 ||
+        app.tickers.selected >= static_cast<int>(rows.size())) {
+        return nullptr;
+    }
+
+    const auto& ticker = rows[app.tickers.selected].ticker;
+    const std::uint64_t generation = app.db->write_generation();
+    if (ticker != app.tickers.summary_ticker ||
+        generation != app.tickers.summary_generation) {
+        app.tickers.summary = app.db->get_ticker_summary(ticker);
+        app.tickers.summary_ticker = ticker;
+        app.tickers.summary_generation = generation;
+    }
+    return app.tickers.summary ? &*app.tickers.summary : nullptr;
+}
+
 inline bool open_selected_home_ticker(AppState& app)
 {
     const auto& rows = app.tickers.last_rows;
@@ -136,15 +304,18 @@ inline bool open_selected_home_ticker(AppState& app)
     }
 
     const auto& ticker = rows[app.tickers.selected].ticker;
+    if (app.prefetcher) {
+        app.prefetcher->drain(app.history_cache, *app.db, ticker);
+    }
+
     std::string err;
-    auto finances = app.db->get_finances(ticker, &err);
-    if (!err.empty()) {
+    auto history = app.history_cache.load(*app.db, ticker, &err);
+    if (!history) {
         route_error(app, err);
         return true;
     }
 
-    app.ticker_view.reset(
-        ticker, std::move(finances), rows[app.tickers.selected].type);
+    app.ticker_view.reset(std::move(history), rows[app.tickers.selected].type);
     app.current = views::ViewId::Ticker;
     return true;
 }
@@ -155,7 +326,10 @@ inline void enter_home_search_mode(AppState& app)
     app.tickers.search_exit_armed = false;
     app.tickers.search_query.clear();
     app.tickers.search_submitted_query.clear();
+    app.tickers.search_results.clear();
     app.tickers.search_rows.clear();
+    app.tickers.search_page = 0;
+    app.tickers.search_matches.clear();
     app.tickers.selected = 0;
     app.tickers.row_scroll = 0;
 }
@@ -167,22 +341,72 @@ inline void exit_home_search_mode(AppState& app)
     app.tickers.row_scroll = 0;
 }
 
+inline int home_search_page_count(const AppState& app)
+{
+    const int total = static_cast<int>(app.tickers.search_results.size());
+    return std::max(1, (total + kHomeSearchLimit - 1) / kHomeSearchLimit);
+}
+
+inline void show_home_search_page(AppState& app, int page)
+{
+    auto& tickers = app.tickers;
+    tickers.search_page = std::clamp(page, 0, home_search_page_count(app) - 1);
+
+    const std::size_t total = tickers.search_results.size();
+    const std::size_t per_page = kHomeSearchLimit;
+    const std::size_t first =
+        static_cast<std::size_t>(tickers.search_page) * per_page;
+    const std::size_t begin = std::min(total, first);
+    const std::size_t end = std::min(total, begin + per_page);
+
+    tickers.search_rows.assign(
+        tickers.search_results.begin() + static_cast<std::ptrdiff_t>(begin),
+        tickers.search_results.begin() + static_cast<std::ptrdiff_t>(end));
+    tickers.last_rows = tickers.search_rows;
+    tickers.selected = 0;
+    tickers.row_scroll = 0;
+}
+
+// Runs on every keystroke. With the ticker index loaded this never touches
+// sqlite: a longer query narrows the previous matches, a shorter one rescans
+// the uppercase arena, and the survivors are ranked with typo tolerance.
+// Without it (huge universe) it falls back to an unranked LIKE.
 inline bool run_home_search(AppState& app)
 {
+    auto& tickers = app.tickers;
+
+    if (tickers.search_query.empty()) {
+        tickers.search_results.clear();
+        tickers.search_matches.clear();
+        tickers.search_submitted_query.clear();
+        show_home_search_page(app, 0);
+        return true;
+    }
+
     std::string err;
-    auto rows = app.db->search_tickers(app.tickers.search_query,
-                                       kHomeSearchLimit,
-                                       &err,
-                                       app.tickers.portfolio_only);
+    std::vector<db::Database::TickerRow> results;
+    if (tickers.index.ensure_loaded(*app.db, &err)) {
+        tickers.index.search(tickers.search_query,
+                             tickers.portfolio_only,
+                             tickers.search_matches);
+        results = tickers.index.ranked_rows(tickers.search_matches,
+                                            kHomeSearchMaxResults);
+    }
+    else if (err.empty()) {
+        results = app.db->search_tickers(tickers.search_query,
+                                         kHomeSearchMaxResults,
+                                         &err,
+                                         tickers.portfolio_only);
+    }
+
     if (!err.empty()) {
         route_error(app, err);
         return false;
     }
 
-    app.tickers.search_rows = std::move(rows);
-    app.tickers.search_submitted_query = app.tickers.search_query;
-    app.tickers.selected = 0;
-    app.tickers.row_scroll = 0;
+    tickers.search_results = std::move(results);
+    tickers.search_submitted_query = tickers.search_query;
+    show_home_search_page(app, 0);
     return true;
 }
 
@@ -196,17 +420,7 @@ inline bool toggle_home_portfolio_mode(AppState& app)
 
     if (!app.tickers.search_mode) return true;
 
-    const bool has_submitted_query =
-        !app.tickers.search_submitted_query.empty();
-    const bool showing_submitted_query =
-        app.tickers.search_query == app.tickers.search_submitted_query;
-    if (has_submitted_query && showing_submitted_query) {
-        run_home_search(app);
-    }
-    else {
-        app.tickers.search_rows.clear();
-        app.tickers.search_submitted_query.clear();
-    }
+    run_home_search(app);
     return true;
 }
 
@@ -227,6 +441,7 @@ inline bool toggle_selected_home_ticker_portfolio(AppState& app)
         return true;
     }
 
+    sync_ticker_index(app, ticker);
     app.tickers.invalidate_prefetch();
     if (app.tickers.portfolio_only) {
         app.tickers.page = 0;
@@ -241,7 +456,6 @@ inline bool go_prev_home_page(AppState& app)
 {
     if (app.tickers.page <= 0) return true;
     app.tickers.page -= 1;
-    app.tickers.invalidate_prefetch();
     app.tickers.selected = 0;
     app.tickers.row_scroll = 0;
     return true;
@@ -252,38 +466,42 @@ inline bool go_next_home_page(AppState& app)
     if (app.tickers.page >= std::numeric_limits<int>::max()) return true;
     const int next_page = app.tickers.page + 1;
 
-    if (prefetch_matches(app, next_page)) {
-        if (!app.tickers.prefetch.rows.empty()) {
-            app.tickers.page = next_page;
-            app.tickers.selected = 0;
-            app.tickers.row_scroll = 0;
-        }
+    std::string err;
+    auto& index = app.tickers.index;
+    if (index.ensure_loaded(*app.db, &err)) {
+        const std::uint64_t first =
+            static_cast<std::uint64_t>(next_page) *
+            static_cast<std::uint64_t>(std::max(1, app.tickers.page_size));
+        if (first >= index.count(app.tickers.portfolio_only)) return true;
+
+        app.tickers.page = next_page;
+        app.tickers.selected = 0;
+        app.tickers.row_scroll = 0;
         return true;
     }
-
-    std::string err;
-    auto next_rows = app.db->get_tickers(next_page,
-                                         app.tickers.page_size,
-                                         app.settings.sort_key,
-                                         app.settings.sort_dir,
-                                         &err,
-                                         app.tickers.portfolio_only);
-
     if (!err.empty()) {
         route_error(app, err);
         return true;
     }
 
-    if (next_rows.empty()) return true;
+    auto& ring = app.tickers.pages;
+    ring.set_key(home_page_ring_key(app));
+    if (ring.past_end(next_page)) return true;
 
-    auto& p = app.tickers.prefetch;
-    p.page = next_page;
-    p.page_size = app.tickers.page_size;
-    p.sort_key = app.settings.sort_key;
-    p.sort_dir = app.settings.sort_dir;
-    p.portfolio_only = app.tickers.portfolio_only;
-    p.rows = std::move(next_rows);
-    p.valid = true;
+    if (!ring.find(next_page)) {
+        auto next_rows = app.db->get_tickers(next_page,
+                                             app.tickers.page_size,
+                                             app.settings.sort_key,
+                                             app.settings.sort_dir,
+                                             &err,
+                                             app.tickers.portfolio_only);
+        if (!err.empty()) {
+            route_error(app, err);
+            return true;
+        }
+        ring.store(next_page, std::move(next_rows));
+    }
+    if (ring.find(next_page)->empty()) return true;
 
     app.tickers.page = next_page;
     app.tickers.selected = 0;
@@ -339,6 +557,10 @@ inline void render_home(AppState& app)
                          11,
                          app.tickers.portfolio_only ? " search portfolio"
                                                     : " search");
+                const int pages = home_search_page_count(app);
+                if (pages > 1) {
+                    printw(" %d/%d", app.tickers.search_page + 1, pages);
+                }
             }
         }
         if (LINES > 1) {
@@ -374,6 +596,16 @@ inline void render_home(AppState& app)
                          app.tickers.page + 1);
             }
         }
+
+        const auto* summary = selected_home_summary(app);
+        if (summary && LINES > 1) {
+            const std::string line = home_summary_line(*summary);
+            const int shown =
+                std::min(std::max(0, COLS - 1), static_cast<int>(line.size()));
+            attron(A_DIM);
+            mvprintw(1, 0, "%.*s", shown, line.c_str());
+            attroff(A_DIM);
+        }
     }
 
     int help_lines = 0;
@@ -481,7 +713,8 @@ inline void render_home(AppState& app)
                 print_help(y0 + 2, kHomeHelpMainRowWide);
                 print_help(
                     y0 + 3,
-                    "space: search   p: mark portfolio   P: portfolio view");
+                    "space: search   p: mark portfolio   P: portfolio view   "
+                    "o: holdings");
             }
             attroff(A_DIM);
         }
@@ -520,7 +753,8 @@ inline void render_home(AppState& app)
                 print_help(y0 + 0, kHomeHelpMainRowWide);
                 print_help(
                     y0 + 1,
-                    "space: search   p: mark portfolio   P: portfolio view");
+                    "space: search   p: mark portfolio   P: portfolio view   "
+                    "o: holdings");
             }
             attroff(A_DIM);
         }
@@ -560,9 +794,8 @@ inline bool handle_key_home(AppState& app, int ch)
         if (ch == BACKSPACE_1 || ch == BACKSPACE_2 || ch == BACKSPACE_3) {
             if (!app.tickers.search_query.empty()) {
                 app.tickers.search_query.pop_back();
+                run_home_search(app);
             }
-            app.tickers.search_submitted_query.clear();
-            app.tickers.search_rows.clear();
             return true;
         }
 
@@ -574,8 +807,7 @@ inline bool handle_key_home(AppState& app, int ch)
 
             if (app.tickers.search_submitted_query !=
                 app.tickers.search_query) {
-                run_home_search(app);
-                return true;
+                if (!run_home_search(app)) return true;
             }
 
             return open_selected_home_ticker(app);
@@ -584,21 +816,11 @@ inline bool handle_key_home(AppState& app, int ch)
         if (ch >= 0 && ch <= 255) {
             const unsigned char c = static_cast<unsigned char>(ch);
             if (std::isalnum(c) || c == '.') {
-                const bool start_new =
-                    !app.tickers.search_submitted_query.empty() &&
-                    app.tickers.search_query ==
-                        app.tickers.search_submitted_query;
-                if (start_new) {
-                    app.tickers.search_query.clear();
-                    app.tickers.search_rows.clear();
-                    app.tickers.selected = 0;
-                }
-
                 if (app.tickers.search_query.size() < kHomeSearchMaxLen) {
                     app.tickers.search_query.push_back(
                         static_cast<char>(std::toupper(c)));
+                    run_home_search(app);
                 }
-                app.tickers.search_submitted_query.clear();
                 return true;
             }
         }
@@ -611,6 +833,11 @@ inline bool handle_key_home(AppState& app, int ch)
         if (ch == 'p') {
             return toggle_selected_home_ticker_portfolio(app);
         }
+        if (ch == 'o' || ch == 'O') {
+            app.portfolio_view.reset();
+            app.current = views::ViewId::Portfolio;
+            return true;
+        }
     }
 
     if (ch == KEY_UP) {
@@ -643,7 +870,12 @@ inline bool handle_key_home(AppState& app, int ch)
             app.tickers.selected = target;
             return true;
         }
-        if (app.tickers.search_mode) return true;
+        if (app.tickers.search_mode) {
+            if (app.tickers.search_page > 0) {
+                show_home_search_page(app, app.tickers.search_page - 1);
+            }
+            return true;
+        }
         return go_prev_home_page(app);
     }
 
@@ -657,10 +889,27 @@ inline bool handle_key_home(AppState& app, int ch)
             app.tickers.selected = target;
             return true;
         }
-        if (app.tickers.search_mode) return true;
+        if (app.tickers.search_mode) {
+            if (app.tickers.search_page + 1 < home_search_page_count(app)) {
+                show_home_search_page(app, app.tickers.search_page + 1);
+            }
+            return true;
+        }
         return go_next_home_page(app);
     }
 
+    if (ch == KEY_NPAGE || ch == KEY_PPAGE) {
+        const int step = (ch == KEY_NPAGE) ? 1 : -1;
+        if (app.tickers.search_mode) {
+            const int next = app.tickers.search_page + step;
+            if (next >= 0 && next < home_search_page_count(app)) {
+                show_home_search_page(app, next);
+            }
+            return true;
+        }
+        return (step > 0) ? go_next_home_page(app) : go_prev_home_page(app);
+    }
+
     if (ch == '\n' || ch == '\r' || ch == KEY_ENTER) {
         return open_selected_home_ticker(app);
     }
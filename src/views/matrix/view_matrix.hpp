@@ -0,0 +1,265 @@
+#pragma once
+#include <curses.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "metrics/metric_matrix.hpp"
+#include "state.hpp"
+#include "views/ticker/view_ticker_helpers.hpp"
+
+namespace views {
+
+inline constexpr int kMatrixLabelWidth = 24;
+inline constexpr int kMatrixValueWidth = 10;
+inline constexpr int kMatrixChangeWidth = 7;
+// value, a space, the change, and two columns of gutter
+inline constexpr int kMatrixCellWidth =
+    kMatrixValueWidth + 1 + kMatrixChangeWidth + 2;
+inline constexpr int kMatrixFirstRowY = 4;
+inline constexpr std::string_view kMatrixHelpRowActions =
+    "</>: period   pgup/pgdn: page   home/end: first/last";
+inline constexpr std::string_view kMatrixHelpRowNav =
+    "m/-/esc: ticker   ?: help   q: quit";
+
+// Period columns that fit beside the label column; always at least one.
+inline int matrix_visible_columns(int term_cols)
+{
+    return std::max(1, (term_cols - 1 - kMatrixLabelWidth) / kMatrixCellWidth);
+}
+
+// First column of a window of `visible` columns kept inside the matrix.
+inline int clamp_matrix_column(int column, int column_count, int visible)
+{
+    return std::max(0, std::min(column, column_count - visible));
+}
+
+// Ratios shown as percents, like margins and returns in the ticker view;
+// the rest (leverage, liquidity, ...) print as plain multiples.
+inline bool matrix_metric_is_percent(std::string_view name)
+{
+    static constexpr std::string_view kPercentMetrics[] = {
+        "net_margin", "roa", "roe", "rote", "ppop_over_assets", "npl_ratio",
+        "chargeoff_ratio", "provision_ratio", "cet1_ratio", "loss_ratio",
+        "expense_ratio", "combined_ratio", "underwriting_margin", "ttm_roa",
+        "ttm_roe",
+    };
+    return std::find(std::begin(kPercentMetrics),
+                     std::end(kPercentMetrics),
+                     name) != std::end(kPercentMetrics);
+}
+
+inline std::string format_matrix_value(const metrics::MetricMatrixRow& row,
+                                       std::optional<double> v)
+{
+    if (row.kind == metrics::MetricKind::Ratio) {
+        return format_f64_opt(v, matrix_metric_is_percent(row.name));
+    }
+    if (v.has_value() && std::abs(*v) >= 1e4) {
+        return format_compact_i64_from_f64_opt(v);
+    }
+    return format_f64_opt(v);
+}
+
+inline std::string matrix_row_label(const metrics::MetricMatrixRow& row)
+{
+    std::string label = row.name;
+    std::replace(label.begin(), label.end(), '_', ' ');
+    return label;
+}
+
+inline void render_matrix_cell(int y,
+                               int x,
+                               const metrics::MetricMatrixRow& row,
+                               std::size_t column)
+{
+    const std::string value = format_matrix_value(row, row.values.at(column));
+    mvprintw(y,
+             x,
+             "%*.*s",
+             kMatrixValueWidth,
+             kMatrixValueWidth,
+             value.c_str());
+
+    const std::string change = format_change(row.changes.at(column));
+    if (change.empty()) return;
+    const short pair = color_pair_for_change_text(change);
+    const bool colored = has_colors() && pair != 0;
+    if (colored) attron(COLOR_PAIR(pair));
+    mvprintw(y,
+             x + kMatrixValueWidth + 1,
+             "%*.*s",
+             kMatrixChangeWidth,
+             kMatrixChangeWidth,
+             change.c_str());
+    if (colored) attroff(COLOR_PAIR(pair));
+}
+
+inline void render_matrix(AppState& app)
+{
+    curs_set(0);
+    erase();
+
+    auto& view = app.matrix_view;
+    const int help_lines = (app.settings.show_help && LINES >= 8) ? 2 : 0;
+
+    if (LINES > 0) {
+        if (has_colors()) attron(COLOR_PAIR(kColorPairHeader));
+        attron(A_BOLD);
+        mvprintw(0, 0, "intrinsic ~");
+        attroff(A_BOLD);
+        if (has_colors()) attroff(COLOR_PAIR(kColorPairHeader));
+        if (COLS > 11 && view.history) {
+            mvprintw(0, 11, " %s matrix", view.history->ticker.c_str());
+        }
+    }
+
+    const metrics::MetricMatrix* matrix = view.matrix.get();
+    if (!matrix || matrix->column_count() == 0 || matrix->row_count() == 0) {
+        if (LINES > 2) mvprintw(2, 0, "no data for ticker");
+        wnoutrefresh(stdscr);
+        doupdate();
+        return;
+    }
+
+    // only the window on screen is ever formatted
+    const int column_count = static_cast<int>(matrix->column_count());
+    const int row_count = static_cast<int>(matrix->row_count());
+    view.visible_columns =
+        std::min(matrix_visible_columns(COLS), column_count);
+    view.column =
+        clamp_matrix_column(view.column, column_count, view.visible_columns);
+    const int visible_rows =
+        std::max(1, LINES - kMatrixFirstRowY - help_lines);
+    view.row = std::max(0, std::min(view.row, row_count - visible_rows));
+    const int rows_shown = std::min(visible_rows, row_count - view.row);
+
+    if (LINES > 1) {
+        mvprintw(1,
+                 0,
+                 "periods: %d-%d/%d  metrics: %d-%d/%d",
+                 view.column + 1,
+                 view.column + view.visible_columns,
+                 column_count,
+                 view.row + 1,
+                 view.row + rows_shown,
+                 row_count);
+    }
+
+    if (LINES > kMatrixFirstRowY - 1) {
+        attron(A_BOLD);
+        for (int c = 0; c < view.visible_columns; ++c) {
+            const int x = kMatrixLabelWidth + c * kMatrixCellWidth;
+            const auto& period =
+                matrix->period(static_cast<std::size_t>(view.column + c));
+            mvprintw(kMatrixFirstRowY - 1,
+                     x,
+                     "%*.*s",
+                     kMatrixValueWidth,
+                     kMatrixValueWidth,
+                     period.c_str());
+        }
+        attroff(A_BOLD);
+    }
+
+    for (int r = 0; r < rows_shown; ++r) {
+        const int y = kMatrixFirstRowY + r;
+        if (y >= LINES - help_lines) break;
+        const auto& row = matrix->row(static_cast<std::size_t>(view.row + r));
+        const std::string label = matrix_row_label(row);
+        mvprintw(y, 0, "%.*s", kMatrixLabelWidth - 1, label.c_str());
+        for (int c = 0; c < view.visible_columns; ++c) {
+            render_matrix_cell(y,
+                               kMatrixLabelWidth + c * kMatrixCellWidth,
+                               row,
+                               static_cast<std::size_t>(view.column + c));
+        }
+    }
+
+    if (help_lines > 0) {
+        const int max_width = std::max(0, COLS - 1);
+        attron(A_DIM);
+        mvprintw(
+            LINES - 2, 0, "%.*s", max_width, kMatrixHelpRowActions.data());
+        mvprintw(LINES - 1, 0, "%.*s", max_width, kMatrixHelpRowNav.data());
+        attroff(A_DIM);
+    }
+
+    wnoutrefresh(stdscr);
+    doupdate();
+}
+
+inline bool handle_key_matrix(AppState& app, int ch)
+{
+    auto& view = app.matrix_view;
+    const int column_count =
+        view.matrix ? static_cast<int>(view.matrix->column_count()) : 0;
+    const int row_count =
+        view.matrix ? static_cast<int>(view.matrix->row_count()) : 0;
+    const int page = std::max(1, view.visible_columns);
+
+    const auto move_column = [&](int next) {
+        view.column = clamp_matrix_column(next, column_count, page);
+    };
+
+    if (ch == KEY_LEFT) {
+        move_column(view.column - 1);
+        return true;
+    }
+
+    if (ch == KEY_RIGHT) {
+        move_column(view.column + 1);
+        return true;
+    }
+
+    if (ch == KEY_NPAGE
+#ifdef KEY_SF
+        || ch == KEY_SF
+#endif
+    ) {
+        move_column(view.column + page);
+        return true;
+    }
+
+    if (ch == KEY_PPAGE
+#ifdef KEY_SR
+        || ch == KEY_SR
+#endif
+    ) {
+        move_column(view.column - page);
+        return true;
+    }
+
+    if (ch == KEY_HOME) {
+        move_column(0);
+        return true;
+    }
+
+    if (ch == KEY_END) {
+        move_column(column_count);
+        return true;
+    }
+
+    if (ch == KEY_UP) {
+        if (view.row > 0) view.row -= 1;
+        return true;
+    }
+
+    if (ch == KEY_DOWN) {
+        if (view.row + 1 < row_count) view.row += 1;
+        return true;
+    }
+
+    if (ch == 27 /*ESC*/ || ch == '-' || ch == 'm' || ch == 'M') {
+        app.current = views::ViewId::Ticker;
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace views
@@ -0,0 +1,404 @@
+#pragma once
+#include <curses.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "metrics/portfolio.hpp"
+#include "state.hpp"
+#include "views/ticker/view_ticker_helpers.hpp"
+
+namespace views {
+
+inline constexpr int kPortfolioFirstRowY = 6;
+inline constexpr int kPortfolioTickerWidth = 8;
+inline constexpr int kPortfolioCellWidth = 10;
+inline constexpr std::string_view kPortfolioHelpRowActions =
+    "up/down: ticker   enter/e: edit holding   tab: next field";
+inline constexpr std::string_view kPortfolioHelpRowNav =
+    "o/-/esc: home   ?: help   q: quit";
+
+// Latest stored close of `ticker`, from the price cache.
+inline std::optional<double> portfolio_latest_close(AppState& app,
+                                                    const std::string& ticker,
+                                                    std::string* err)
+{
+    const auto series = app.price_cache.load(*app.db, ticker, err);
+    if (!series) return std::nullopt;
+    const auto latest = series->latest();
+    if (!latest.has_value()) return std::nullopt;
+    return latest->close;
+}
+
+// Reads every portfolio ticker's holding and newest metrics.
+inline void load_portfolio(AppState& app)
+{
+    auto& view = app.portfolio_view;
+    if (!app.db) return;
+
+    std::string err;
+    auto rows = app.db->get_portfolio_rows(&err);
+    if (!err.empty()) {
+        route_error(app, err);
+        return;
+    }
+
+    std::vector<metrics::PortfolioPosition> positions;
+    positions.reserve(rows.size());
+    for (auto& row : rows) {
+        metrics::PortfolioPosition position;
+        position.price = portfolio_latest_close(app, row.ticker, &err);
+        if (!err.empty()) {
+            route_error(app, err);
+            return;
+        }
+        position.row = std::move(row);
+        positions.push_back(std::move(position));
+    }
+
+    view.aggregate.reset(std::move(positions));
+    view.write_generation = app.db->write_generation();
+    view.price_generation = app.db->price_generation();
+    view.loaded = true;
+}
+
+// After a prices write the view did not apply itself (e.g. an import):
+// re-prices the positions whose close moved.
+inline void reprice_portfolio(AppState& app)
+{
+    auto& view = app.portfolio_view;
+    for (std::size_t i = 0; i < view.aggregate.size(); ++i) {
+        const auto& position = view.aggregate.position(i);
+        std::string err;
+        const auto close =
+            portfolio_latest_close(app, position.row.ticker, &err);
+        if (!err.empty()) {
+            route_error(app, err);
+            return;
+        }
+        if (close != position.price) {
+            view.aggregate.update_price(position.row.ticker, close);
+        }
+    }
+    view.price_generation = app.db->price_generation();
+}
+
+inline void sync_portfolio(AppState& app)
+{
+    auto& view = app.portfolio_view;
+    if (!app.db) return;
+    if (!view.loaded || view.write_generation != app.db->write_generation()) {
+        load_portfolio(app);
+    }
+    else if (view.price_generation != app.db->price_generation()) {
+        reprice_portfolio(app);
+    }
+}
+
+// Stores the edited holding of the selected ticker and swaps its position
+// into the totals.
+inline void save_portfolio_holding(AppState& app)
+{
+    auto& view = app.portfolio_view;
+    if (view.selected < 0 ||
+        view.selected >= static_cast<int>(view.aggregate.size())) {
+        return;
+    }
+
+    auto position =
+        view.aggregate.position(static_cast<std::size_t>(view.selected));
+    const auto field = [&](int i, double stored) {
+        if (view.inputs[i] == view.prefilled[i]) return stored;
+        return parse_decimal_input(view.inputs[i]).value_or(0.0);
+    };
+    const double shares = field(0, position.row.shares);
+    const double cost_basis =
+        shares > 0.0 ? field(1, position.row.cost_basis) : 0.0;
+
+    std::string err;
+    if (!app.db->set_holding(position.row.ticker, shares, cost_basis, &err)) {
+        route_error(app, err);
+        return;
+    }
+    position.row.shares = shares;
+    position.row.cost_basis = cost_basis;
+    view.aggregate.upsert(std::move(position));
+    view.editing = false;
+}
+
+inline std::string portfolio_percent(std::optional<double> v)
+{
+    return format_f64_opt(v, true);
+}
+
+inline void render_portfolio_summary(const metrics::PortfolioTotals& totals)
+{
+    // unpriced holdings have a cost but no value yet
+    std::optional<double> gain;
+    if (totals.cost_basis > 0.0 && totals.unpriced == 0) {
+        gain = totals.value / totals.cost_basis - 1.0;
+    }
+    if (LINES > 1) {
+        mvprintw(1,
+                 0,
+                 "held: %d  value: %s  cost: %s  gain: %s%s",
+                 totals.held,
+                 format_compact_i64_from_f64_opt(totals.value).c_str(),
+                 format_compact_i64_from_f64_opt(totals.cost_basis).c_str(),
+                 portfolio_percent(gain).c_str(),
+                 totals.unpriced > 0 ? "  (some unpriced)" : "");
+    }
+    if (LINES > 2) {
+        mvprintw(2,
+                 0,
+                 "E/P: %s  P/E: %s  banks P/TBV: %s  insurers CR: %s",
+                 portfolio_percent(totals.earnings_yield()).c_str(),
+                 format_ratio_opt(totals.price_earnings()).c_str(),
+                 format_ratio_opt(totals.bank_price_tbv()).c_str(),
+                 portfolio_percent(totals.insurer_combined_ratio()).c_str());
+    }
+    if (LINES > 3) {
+        mvprintw(3,
+                 0,
+                 "exposure: standard %s  banks %s  insurers %s",
+                 portfolio_percent(totals.exposure(1)).c_str(),
+                 portfolio_percent(totals.exposure(2)).c_str(),
+                 portfolio_percent(totals.exposure(3)).c_str());
+    }
+}
+
+inline void render_portfolio_cell(int y, int column, const std::string& text)
+{
+    const int x = 2 + kPortfolioTickerWidth + column * kPortfolioCellWidth;
+    if (x + kPortfolioCellWidth >= COLS) return;
+    mvprintw(y,
+             x,
+             "%*.*s",
+             kPortfolioCellWidth - 1,
+             kPortfolioCellWidth - 1,
+             text.c_str());
+}
+
+inline void render_portfolio_editor(const AppState& app, int y)
+{
+    const auto& view = app.portfolio_view;
+    if (y < 0 || y >= LINES) return;
+
+    static constexpr const char* kLabels[] = {"shares", "cost basis"};
+    int x = 0;
+    for (int i = 0; i < 2; ++i) {
+        const auto& text = view.inputs[static_cast<std::size_t>(i)];
+        const bool active = i == view.edit_field;
+        if (active) attron(A_BOLD);
+        mvprintw(y, x, "%s %s: ", active ? ">" : " ", kLabels[i]);
+        if (active) attroff(A_BOLD);
+        x += static_cast<int>(std::strlen(kLabels[i])) + 4;
+        if (has_colors()) attron(COLOR_PAIR(kColorPairInputValue));
+        mvprintw(y, x, "%s", text.c_str());
+        if (has_colors()) attroff(COLOR_PAIR(kColorPairInputValue));
+        x += static_cast<int>(text.size());
+        if (active) render_blinking_input_caret(app, y, x);
+        x += 3;
+    }
+}
+
+inline void render_portfolio(AppState& app)
+{
+    sync_portfolio(app);
+    if (app.current != views::ViewId::Portfolio) return; // routed to error
+
+    curs_set(0);
+    erase();
+
+    auto& view = app.portfolio_view;
+    const int help_lines = (app.settings.show_help && LINES >= 8) ? 2 : 0;
+
+    if (LINES > 0) {
+        if (has_colors()) attron(COLOR_PAIR(kColorPairHeader));
+        attron(A_BOLD);
+        mvprintw(0, 0, "intrinsic ~");
+        attroff(A_BOLD);
+        if (has_colors()) attroff(COLOR_PAIR(kColorPairHeader));
+        if (COLS > 11) mvprintw(0, 11, " holdings");
+    }
+
+    const auto& aggregate = view.aggregate;
+    render_portfolio_summary(aggregate.totals());
+
+    const int count = static_cast<int>(aggregate.size());
+    if (count == 0) {
+        if (LINES > 5) {
+            mvprintw(5, 0, "No portfolio tickers. Press 'p' on a ticker.");
+        }
+        wnoutrefresh(stdscr);
+        doupdate();
+        return;
+    }
+
+    if (LINES > kPortfolioFirstRowY - 1) {
+        static constexpr const char* kHeaders[] = {
+            "shares", "price", "value", "weight", "gain", "E/P", "P/E",
+            "P/TBV|CR"};
+        attron(A_BOLD);
+        mvprintw(kPortfolioFirstRowY - 1, 2, "ticker");
+        for (int c = 0; c < 8; ++c) {
+            render_portfolio_cell(kPortfolioFirstRowY - 1, c, kHeaders[c]);
+        }
+        attroff(A_BOLD);
+    }
+
+    const int editor_lines = view.editing ? 2 : 0;
+    const int visible =
+        std::max(1, LINES - kPortfolioFirstRowY - help_lines - editor_lines);
+    view.selected = std::clamp(view.selected, 0, count - 1);
+    if (view.selected < view.scroll) view.scroll = view.selected;
+    if (view.selected >= view.scroll + visible) {
+        view.scroll = view.selected - visible + 1;
+    }
+    view.scroll = std::clamp(view.scroll, 0, std::max(0, count - visible));
+
+    const double total_value = aggregate.totals().value;
+    for (int r = 0; r < visible && view.scroll + r < count; ++r) {
+        const int y = kPortfolioFirstRowY + r;
+        if (y >= LINES - help_lines - editor_lines) break;
+        const int index = view.scroll + r;
+        const auto& p = aggregate.position(static_cast<std::size_t>(index));
+        const auto value = p.value();
+
+        const bool selected = index == view.selected;
+        if (selected) attron(A_BOLD);
+        mvprintw(y,
+                 0,
+                 "%c %.*s",
+                 selected ? '>' : ' ',
+                 kPortfolioTickerWidth - 1,
+                 p.row.ticker.c_str());
+        std::optional<double> shares;
+        if (p.row.shares > 0.0) shares = p.row.shares;
+        const auto gain = value.has_value() && p.row.cost_basis > 0.0
+                              ? std::optional<double>(
+                                    *value / p.row.cost_basis - 1.0)
+                              : std::nullopt;
+        const auto weight = value.has_value() && total_value > 0.0
+                                ? std::optional<double>(*value / total_value)
+                                : std::nullopt;
+        const auto type_ratio = p.row.type == 3
+                                    ? portfolio_percent(p.row.combined_ratio)
+                                    : format_ratio_opt(p.price_tbv());
+
+        render_portfolio_cell(y, 0, format_shares_opt(shares));
+        render_portfolio_cell(y, 1, format_ratio_opt(p.price));
+        render_portfolio_cell(y, 2, format_compact_i64_from_f64_opt(value));
+        render_portfolio_cell(y, 3, portfolio_percent(weight));
+        render_portfolio_cell(y, 4, portfolio_percent(gain));
+        render_portfolio_cell(y, 5, portfolio_percent(p.earnings_yield()));
+        render_portfolio_cell(y, 6, format_ratio_opt(p.price_earnings()));
+        render_portfolio_cell(y, 7, type_ratio);
+        if (selected) attroff(A_BOLD);
+    }
+
+    if (view.editing) {
+        render_portfolio_editor(app, LINES - help_lines - 1);
+    }
+
+    if (help_lines > 0) {
+        const int max_width = std::max(0, COLS - 1);
+        attron(A_DIM);
+        mvprintw(LINES - 2,
+                 0,
+                 "%.*s",
+                 max_width,
+                 kPortfolioHelpRowActions.data());
+        mvprintw(
+            LINES - 1, 0, "%.*s", max_width, kPortfolioHelpRowNav.data());
+        attroff(A_DIM);
+    }
+
+    wnoutrefresh(stdscr);
+    doupdate();
+}
+
+inline bool handle_key_portfolio_editor(AppState& app, int ch)
+{
+    auto& view = app.portfolio_view;
+
+    if (ch == 27 /*ESC*/) {
+        view.editing = false;
+        return true;
+    }
+
+    if (ch == '\n' || ch == '\r' || ch == KEY_ENTER) {
+        save_portfolio_holding(app);
+        return true;
+    }
+
+    if (ch == '\t' || ch == KEY_UP || ch == KEY_DOWN) {
+        view.edit_field = 1 - view.edit_field;
+        return true;
+    }
+
+    std::string& input = view.inputs[static_cast<std::size_t>(view.edit_field)];
+    if (ch == KEY_BACKSPACE || ch == 127 || ch == 8) {
+        if (!input.empty()) input.pop_back();
+        return true;
+    }
+
+    if (ch == KEY_DC) {
+        input.clear();
+        return true;
+    }
+
+    if (is_allowed_ticker_input_char(ch, input)) {
+        input.push_back(static_cast<char>(ch));
+    }
+    return true; // the editor swallows every other key
+}
+
+inline bool handle_key_portfolio(AppState& app, int ch)
+{
+    auto& view = app.portfolio_view;
+    if (view.editing) return handle_key_portfolio_editor(app, ch);
+
+    const int count = static_cast<int>(view.aggregate.size());
+
+    if (ch == KEY_UP) {
+        if (view.selected > 0) view.selected -= 1;
+        return true;
+    }
+
+    if (ch == KEY_DOWN) {
+        if (view.selected + 1 < count) view.selected += 1;
+        return true;
+    }
+
+    if (ch == '\n' || ch == '\r' || ch == KEY_ENTER || ch == 'e' ||
+        ch == 'E') {
+        if (view.selected < 0 || view.selected >= count) return true;
+        const auto& row =
+            view.aggregate.position(static_cast<std::size_t>(view.selected))
+                .row;
+        view.inputs[0] =
+            row.shares > 0.0 ? format_price_input(row.shares) : std::string();
+        view.inputs[1] = row.shares > 0.0 ? format_price_input(row.cost_basis)
+                                          : std::string();
+        view.prefilled = view.inputs;
+        view.edit_field = 0;
+        view.editing = true;
+        return true;
+    }
+
+    if (ch == 27 /*ESC*/ || ch == '-' || ch == 'o' || ch == 'O') {
+        app.current = views::ViewId::Home;
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace views
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <array>
 #include <cerrno>
+#include <cstdio>
 #include <cstdlib>
 #include <curses.h>
 #include <cstring>
@@ -36,6 +37,51 @@ inline const char* color_mode_label(ColorMode mode)
     return "default";
 }
 
+// One-line occupancy report for the ticker history cache.
+inline std::string history_cache_status_line(const db::HistoryCache& cache)
+{
+    if (cache.budget_bytes() == 0) return "history cache: off";
+
+    char buf[128];
+    std::snprintf(buf,
+                  sizeof(buf),
+                  "history cache: %zu tickers  %.1f/%zu MiB  hits %llu  "
+                  "misses %llu",
+                  cache.size(),
+                  static_cast<double>(cache.bytes()) / (1024.0 * 1024.0),
+                  cache.budget_bytes() >> 20,
+                  static_cast<unsigned long long>(cache.hits()),
+                  static_cast<unsigned long long>(cache.misses()));
+    return buf;
+}
+
+// Same for the stored price series.
+inline std::string price_cache_status_line(const db::PriceCache& cache)
+{
+    if (cache.budget_bytes() == 0) return "price cache: off";
+
+    char buf[128];
+    std::snprintf(buf,
+                  sizeof(buf),
+                  "price cache: %zu tickers  %.1f/%zu MiB  hits %llu  "
+                  "misses %llu",
+                  cache.size(),
+                  static_cast<double>(cache.bytes()) / (1024.0 * 1024.0),
+                  cache.budget_bytes() >> 20,
+                  static_cast<unsigned long long>(cache.hits()),
+                  static_cast<unsigned long long>(cache.misses()));
+    return buf;
+}
+
+inline std::string price_feed_status_line(const db::PriceFeed* feed)
+{
+    if (!feed || !feed->is_open()) return "price feed: off";
+
+    return "price feed: " + feed->path().string() + "  quotes " +
+           std::to_string(feed->accepted()) + "  rejected " +
+           std::to_string(feed->rejected());
+}
+
 inline void print_centered_line(int y, const char* text)
 {
     if (!text || y < 0 || y >= LINES || COLS <= 0) return;
@@ -226,6 +272,12 @@ inline void render_settings(const AppState& app)
     y += 1;
     if (LINES > y)
         mvprintw(y, 2, "T  TTM       : %s", app.settings.ttm ? "on" : "off");
+    y += 1;
+    if (LINES > y)
+        mvprintw(y,
+                 2,
+                 "R  report px : %s",
+                 app.settings.report_date_prices ? "on" : "off");
     y += 2;
     if (LINES > y)
         mvprintw(y,
@@ -258,6 +310,30 @@ inline void render_settings(const AppState& app)
         attroff(A_DIM);
     }
 
+    y += 2;
+    if (LINES > y) {
+        attron(A_DIM);
+        mvprintw(y,
+                 2,
+                 "%s",
+                 history_cache_status_line(app.history_cache).c_str());
+        attroff(A_DIM);
+    }
+    y += 1;
+    if (LINES > y) {
+        attron(A_DIM);
+        mvprintw(
+            y, 2, "%s", price_cache_status_line(app.price_cache).c_str());
+        attroff(A_DIM);
+    }
+    y += 1;
+    if (LINES > y) {
+        attron(A_DIM);
+        mvprintw(
+            y, 2, "%s", price_feed_status_line(app.price_feed).c_str());
+        attroff(A_DIM);
+    }
+
     if (app.settings.show_help && LINES > 1) {
         attron(A_DIM);
         mvprintw(LINES - 1, 0, "h / esc: home   ?: help   q: quit");
@@ -270,8 +346,8 @@ inline void render_settings(const AppState& app)
 
 inline void apply_settings_changed(AppState& app)
 {
+    // the page ring follows the new ordering by itself (see set_key)
     app.tickers.page = 0;
-    app.tickers.invalidate_prefetch();
 
     std::string err;
     if (!save_settings(app.settings, &err)) {
@@ -402,10 +478,17 @@ inline bool run_update_command(std::string* err)
 inline void nuke_and_reset_app(AppState& app)
 {
     db::Database* db = app.db;
-    auto reopen_after_failure = [db] {
+    db::PriceFeed* feed = app.price_feed;
+    // the feed socket lives in the data directory, next to the database
+    auto reopen_feed = [db, feed] {
+        if (feed && db && !db->path().empty())
+            feed->open(db->path().parent_path() / "feed.sock");
+    };
+    auto reopen_after_failure = [db, reopen_feed] {
         if (!db) return;
         try {
             db->open_or_create();
+            reopen_feed();
         }
         catch (...) {
         }
@@ -428,6 +511,9 @@ inline void nuke_and_reset_app(AppState& app)
         }
         const fs::path config_dir = cfg.parent_path();
 
+        if (app.prefetcher) app.prefetcher->close();
+        if (app.page_loader) app.page_loader->close();
+        if (feed) feed->close();
         db->close();
 
         std::string remove_err;
@@ -446,9 +532,14 @@ inline void nuke_and_reset_app(AppState& app)
         }
 
         db->open_or_create();
+        reopen_feed();
 
         AppState fresh;
         fresh.db = db;
+        fresh.prefetcher = app.prefetcher;
+        fresh.page_loader = app.page_loader;
+        fresh.price_feed = feed;
+        fresh.work_pool = app.work_pool;
         app = std::move(fresh);
     }
     catch (const std::exception& e) {
@@ -490,6 +581,12 @@ inline bool handle_key_settings(AppState& app, int ch)
         return true;
     }
 
+    if (ch == 'R') {
+        app.settings.report_date_prices = !app.settings.report_date_prices;
+        apply_settings_changed(app);
+        return true;
+    }
+
     if (ch == 'H') {
         app.settings.show_help = !app.settings.show_help;
         apply_settings_changed(app);
@@ -0,0 +1,345 @@
+#pragma once
+#include <curses.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "metrics/price_sweep.hpp"
+#include "state.hpp"
+#include "views/ticker/view_ticker_helpers.hpp"
+
+namespace views {
+
+inline constexpr int kSweepLabelWidth = 14;
+inline constexpr int kSweepCrossWidth = 11;
+inline constexpr int kSweepCellWidth = 8;
+inline constexpr int kSweepFirstRowY = 5;
+// ratio / wished P/E beyond which a cell is drawn bold
+inline constexpr double kSweepHeatFar = 0.25;
+inline constexpr std::string_view kSweepHelpRowActions =
+    "</>: prices   pgup/pgdn: page   home: centre   up/down: input";
+inline constexpr std::string_view kSweepHelpRowNav =
+    "g/-/esc: ticker   ?: help   q: quit";
+
+// Price columns that fit beside the label and crossing columns.
+inline int sweep_visible_columns(int term_cols)
+{
+    return std::max(
+        1,
+        (term_cols - 1 - kSweepLabelWidth - kSweepCrossWidth) /
+            kSweepCellWidth);
+}
+
+// First column of a window of `visible` columns centred on the base price
+// shifted by `offset`, kept inside the grid.
+inline int
+sweep_first_column(int base_column, int offset, int column_count, int visible)
+{
+    const int first = base_column + offset - visible / 2;
+    return std::max(0, std::min(first, column_count - visible));
+}
+
+// Ratio lines of the ticker view's selected period.
+inline std::vector<metrics::SweepLine>
+ticker_sweep_lines(const AppState::TickerViewState& view)
+{
+    if (view.rows.empty()) return {};
+    const auto& row = view.rows[static_cast<std::size_t>(view.index)];
+    const int all_index = find_period_index(view.all_rows, period_label(row));
+    return metrics::sweep_lines(view.all_rows, all_index, view.ticker_type);
+}
+
+inline std::string format_sweep_number(double v)
+{
+    if (std::isnan(v)) return kNaValue;
+    if (std::abs(v) >= 1e4) return format_compact_i64_from_f64_opt(v);
+    return format_f64_raw(v);
+}
+
+// Green at or under the wished P/E, red over it; bold once the ratio is
+// more than kSweepHeatFar away from it.
+inline attr_t sweep_heat_attr(double value, std::optional<double> wished)
+{
+    if (!wished.has_value() || std::isnan(value)) return A_NORMAL;
+    const double rel = value / *wished - 1.0;
+    attr_t attr = std::abs(rel) > kSweepHeatFar ? A_BOLD : A_NORMAL;
+    if (has_colors()) {
+        attr |= COLOR_PAIR(rel <= 0.0 ? kColorPairPositive
+                                      : kColorPairNegative);
+    }
+    return attr;
+}
+
+// True when the ratio passes the wished P/E between column - 1 and column.
+inline bool sweep_crosses(const metrics::PriceSweep& sweep,
+                          std::size_t line,
+                          std::size_t column,
+                          double wished)
+{
+    if (column == 0) return false;
+    const double before = sweep.value(line, column - 1);
+    const double at = sweep.value(line, column);
+    if (std::isnan(before) || std::isnan(at)) return false;
+    return (before <= wished) != (at <= wished);
+}
+
+inline void render_sweep_inputs(const AppState::TickerViewState& view)
+{
+    constexpr const char* kLabels[] = {"price", "wished per"};
+    int x = 0;
+    for (int i = 0; i < 2; ++i) {
+        const bool active = view.input_index == i;
+        const std::string& text = view.inputs[static_cast<std::size_t>(i)];
+        if (active) attron(A_BOLD);
+        mvprintw(1, x, "%s%s: ", active ? ">" : " ", kLabels[i]);
+        if (active) attroff(A_BOLD);
+        x += static_cast<int>(std::string_view(kLabels[i]).size()) + 3;
+        if (has_colors()) attron(COLOR_PAIR(kColorPairInputValue));
+        mvprintw(1, x, "%s", text.empty() ? "--" : text.c_str());
+        if (has_colors()) attroff(COLOR_PAIR(kColorPairInputValue));
+        x += std::max(2, static_cast<int>(text.size())) + 3;
+    }
+}
+
+inline void render_sweep(AppState& app)
+{
+    curs_set(0);
+    erase();
+
+    const auto& ticker = app.ticker_view;
+    auto& view = app.sweep_view;
+    const int help_lines = (app.settings.show_help && LINES >= 8) ? 2 : 0;
+
+    if (LINES > 0) {
+        if (has_colors()) attron(COLOR_PAIR(kColorPairHeader));
+        attron(A_BOLD);
+        mvprintw(0, 0, "intrinsic ~");
+        attroff(A_BOLD);
+        if (has_colors()) attroff(COLOR_PAIR(kColorPairHeader));
+        if (COLS > 11 && !ticker.rows.empty()) {
+            const auto& row =
+                ticker.rows[static_cast<std::size_t>(ticker.index)];
+            mvprintw(0,
+                     11,
+                     " %s sweep %s",
+                     ticker.ticker.c_str(),
+                     period_label(row).c_str());
+        }
+    }
+    if (LINES > 1) render_sweep_inputs(ticker);
+
+    // recomputed on every frame: a row's lines are a handful of TTM sums,
+    // and the grid one pass over a few hundred cells
+    const auto lines = ticker_sweep_lines(ticker);
+    const auto price =
+        ticker.rows.empty()
+            ? std::nullopt
+            : ticker_ratio_price(
+                  app, ticker.rows[static_cast<std::size_t>(ticker.index)]);
+    const auto wished = null_if_zero_or_invalid(
+        parse_decimal_input(ticker.inputs[1]));
+    const auto sweep =
+        metrics::sweep_prices(lines, price.has_value() ? *price : 0.0);
+
+    if (lines.empty() || sweep.columns() == 0) {
+        if (LINES > 3) {
+            mvprintw(3,
+                     0,
+                     "%s",
+                     lines.empty() ? "no price-dependent metrics for period"
+                                   : "type a price to sweep");
+        }
+        wnoutrefresh(stdscr);
+        doupdate();
+        return;
+    }
+
+    const int column_count = static_cast<int>(sweep.columns());
+    const int base_column = static_cast<int>(sweep.base_column);
+    view.visible_columns =
+        std::min(sweep_visible_columns(COLS), column_count);
+    const int first = sweep_first_column(
+        base_column, view.offset, column_count, view.visible_columns);
+    const int cells_x = kSweepLabelWidth + kSweepCrossWidth;
+
+    if (LINES > 2) {
+        mvprintw(2,
+                 0,
+                 "TTM setting: %s   step: %g%%",
+                 app.settings.ttm ? "on" : "off",
+                 metrics::kSweepStep * 100.0);
+    }
+
+    // header: offset from the typed price, then the price itself
+    if (LINES > kSweepFirstRowY - 1) {
+        attron(A_BOLD);
+        mvprintw(kSweepFirstRowY - 2,
+                 kSweepLabelWidth,
+                 "%*s",
+                 kSweepCrossWidth - 1,
+                 "@ wished");
+        for (int c = 0; c < view.visible_columns; ++c) {
+            const int column = first + c;
+            const int x = cells_x + c * kSweepCellWidth;
+            const bool base = column == base_column;
+            const int pct = static_cast<int>(std::lround(
+                (column - base_column) * metrics::kSweepStep * 100.0));
+            const std::string pct_text =
+                (pct > 0 ? "+" : "") + std::to_string(pct) + "%";
+            const std::string price_text = format_sweep_number(
+                sweep.prices[static_cast<std::size_t>(column)]);
+            if (base) attron(A_REVERSE);
+            mvprintw(kSweepFirstRowY - 2,
+                     x,
+                     "%*.*s",
+                     kSweepCellWidth - 1,
+                     kSweepCellWidth - 1,
+                     pct_text.c_str());
+            mvprintw(kSweepFirstRowY - 1,
+                     x,
+                     "%*.*s",
+                     kSweepCellWidth - 1,
+                     kSweepCellWidth - 1,
+                     price_text.c_str());
+            if (base) attroff(A_REVERSE);
+        }
+        attroff(A_BOLD);
+    }
+
+    for (std::size_t l = 0; l < lines.size(); ++l) {
+        const int y = kSweepFirstRowY + static_cast<int>(l);
+        if (y >= LINES - help_lines) break;
+        const auto& line = lines[l];
+
+        std::string label = metrics::sweep_metric_label(line.metric);
+        if (line.ttm) label += " ttm";
+        mvprintw(y, 0, "%.*s", kSweepLabelWidth - 1, label.c_str());
+
+        // price at which the ratio meets the wished P/E, grid or not
+        const auto cross =
+            wished.has_value() ? line.price_for(*wished) : std::nullopt;
+        const std::string cross_text =
+            cross.has_value() ? format_sweep_number(*cross) : kNaValue;
+        mvprintw(y,
+                 kSweepLabelWidth,
+                 "%*.*s",
+                 kSweepCrossWidth - 1,
+                 kSweepCrossWidth - 1,
+                 cross_text.c_str());
+
+        for (int c = 0; c < view.visible_columns; ++c) {
+            const auto column = static_cast<std::size_t>(first + c);
+            const double v = sweep.value(l, column);
+            const std::string text = format_sweep_number(v);
+            attr_t attr = sweep_heat_attr(v, wished);
+            if (wished.has_value() && sweep_crosses(sweep, l, column, *wished))
+                attr |= A_REVERSE;
+            attron(attr);
+            mvprintw(y,
+                     cells_x + c * kSweepCellWidth,
+                     "%*.*s",
+                     kSweepCellWidth - 1,
+                     kSweepCellWidth - 1,
+                     text.c_str());
+            attroff(attr);
+        }
+    }
+
+    if (help_lines > 0) {
+        const int max_width = std::max(0, COLS - 1);
+        attron(A_DIM);
+        mvprintw(
+            LINES - 2, 0, "%.*s", max_width, kSweepHelpRowActions.data());
+        mvprintw(LINES - 1, 0, "%.*s", max_width, kSweepHelpRowNav.data());
+        attroff(A_DIM);
+    }
+
+    wnoutrefresh(stdscr);
+    doupdate();
+}
+
+inline bool handle_key_sweep(AppState& app, int ch)
+{
+    auto& view = app.sweep_view;
+    auto& ticker = app.ticker_view;
+    const int page = std::max(1, view.visible_columns);
+
+    const auto move_offset = [&](int next) {
+        view.offset = std::clamp(
+            next, -metrics::kSweepHalfSteps, metrics::kSweepHalfSteps);
+    };
+
+    if (ch == KEY_LEFT) {
+        move_offset(view.offset - 1);
+        return true;
+    }
+
+    if (ch == KEY_RIGHT) {
+        move_offset(view.offset + 1);
+        return true;
+    }
+
+    if (ch == KEY_NPAGE
+#ifdef KEY_SF
+        || ch == KEY_SF
+#endif
+    ) {
+        move_offset(view.offset + page);
+        return true;
+    }
+
+    if (ch == KEY_PPAGE
+#ifdef KEY_SR
+        || ch == KEY_SR
+#endif
+    ) {
+        move_offset(view.offset - page);
+        return true;
+    }
+
+    if (ch == KEY_HOME) {
+        view.offset = 0;
+        return true;
+    }
+
+    if (ch == KEY_UP) {
+        if (ticker.input_index > 0) ticker.input_index -= 1;
+        return true;
+    }
+
+    if (ch == KEY_DOWN) {
+        if (ticker.input_index < 1) ticker.input_index += 1;
+        return true;
+    }
+
+    // the grid follows the ticker view's inputs as they are typed
+    std::string& input = ticker.inputs[ticker.input_index];
+    if (ch == KEY_BACKSPACE || ch == 127 || ch == 8) {
+        if (!input.empty()) input.pop_back();
+        return true;
+    }
+
+    if (ch == KEY_DC) {
+        input.clear();
+        return true;
+    }
+
+    if (is_allowed_ticker_input_char(ch, input)) {
+        input.push_back(static_cast<char>(ch));
+        return true;
+    }
+
+    if (ch == 27 /*ESC*/ || ch == '-' || ch == 'g' || ch == 'G') {
+        app.current = views::ViewId::Ticker;
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace views
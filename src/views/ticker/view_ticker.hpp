@@ -13,6 +13,7 @@ inline void render_ticker(AppState& app)
     curs_set(0);
     erase();
 
+    load_ticker_view_prices(app);
     auto& view = app.ticker_view;
     view.clamp_index();
     if (view.input_index < 0) view.input_index = 0;
@@ -59,7 +60,7 @@ inline void render_ticker(AppState& app)
 
     const auto& row = view.rows[view.index];
     const db::Database::FinanceRow* previous_row =
-        find_previous_year_same_period(view.all_rows, row);
+        ticker_previous_row(view, row);
     const std::string period = period_label(row);
     if (view.ticker_type == 2) {
         render_ticker_type2(app, help_lines, row, previous_row, period);
@@ -153,33 +154,10 @@ inline void render_ticker(AppState& app)
     std::optional<double> ttm_cash_flow_ops_d;
 
     if (ttm_family_supported) {
-        const std::string selected_period = period_label(row);
-        const int all_index = find_period_index(view.all_rows, selected_period);
-
-        ttm_eps = ttm_sum_for_family(
-            view.all_rows,
-            all_index,
-            family,
-            ttm_window,
-            [](const db::Database::FinanceRow& r) { return r.eps; });
-
-        ttm_net_income_d =
-            ttm_sum_for_family(view.all_rows,
-                               all_index,
-                               family,
-                               ttm_window,
-                               [](const db::Database::FinanceRow& r) {
-                                   return to_f64(r.net_income);
-                               });
-
-        ttm_cash_flow_ops_d =
-            ttm_sum_for_family(view.all_rows,
-                               all_index,
-                               family,
-                               ttm_window,
-                               [](const db::Database::FinanceRow& r) {
-                                   return to_f64(r.cash_flow_from_operations);
-                               });
+        const auto ttm = ticker_ttm_for_row(view, row);
+        ttm_eps = ttm.eps;
+        ttm_net_income_d = ttm.net_income;
+        ttm_cash_flow_ops_d = ttm.cash_flow_ops;
     }
 
     const bool prefer_ttm_for_derived =
@@ -218,21 +196,13 @@ inline void render_ticker(AppState& app)
     const auto leverage = div_opt_nonzero(total_liabilities_d, equity_d);
     const auto wc_over_non_current =
         div_opt_nonzero(working_capital_d, non_current_liabilities_d);
-    const auto shares_approx_raw =
-        div_opt_nonzero(net_income_for_derived, eps_for_derived);
     const auto shares_approx =
-        shares_approx_raw.has_value()
-            ? std::optional<double>(std::round(*shares_approx_raw))
-            : std::nullopt;
+        approx_shares(net_income_for_derived, eps_for_derived);
     const auto book_value = div_opt_nonzero(equity_d, shares_approx);
     const auto prev_wc_over_non_current =
         div_opt_nonzero(prev_working_capital_d, prev_non_current_liabilities_d);
-    const auto prev_shares_approx_raw =
-        div_opt_nonzero(prev_net_income_d, prev_eps_d);
     const auto prev_shares_approx =
-        prev_shares_approx_raw.has_value()
-            ? std::optional<double>(std::round(*prev_shares_approx_raw))
-            : std::nullopt;
+        approx_shares(prev_net_income_d, prev_eps_d);
     const auto prev_book_value =
         div_opt_nonzero(prev_equity_d, prev_shares_approx);
     const auto prev_net_margin =
@@ -247,8 +217,7 @@ inline void render_ticker(AppState& app)
     const auto prev_leverage =
         div_opt_nonzero(prev_total_liabilities_d, prev_equity_d);
 
-    const std::optional<double> typed_price =
-        parse_decimal_input(view.inputs[0]);
+    const std::optional<double> typed_price = ticker_ratio_price(app, row);
     const std::optional<double> wished_per =
         parse_decimal_input(view.inputs[1]);
     const auto ratio_price = null_if_zero_or_invalid(typed_price);
@@ -311,6 +280,11 @@ inline void render_ticker(AppState& app)
     const auto required_net_income = mul_opt(required_eps, shares_for_wished);
     const auto price_needed_change =
         percent_change(price_needed_for_wished_per, typed_price);
+    const auto implied_growth =
+        implied_growth_for_price(ratio_price,
+                                 cash_flow_ops_for_derived,
+                                 net_income_for_derived,
+                                 shares_approx);
     const auto required_net_income_change = required_net_income_change_pct(
         required_net_income, net_income_for_wished);
 
@@ -454,6 +428,7 @@ inline void render_ticker(AppState& app)
              required_net_income_change),
          false,
          true},
+        {"implied g", format_f64_opt(implied_growth, true), false, true},
     };
 
     const std::vector<Metric> performance_box = {
@@ -560,13 +535,16 @@ inline void render_ticker(AppState& app)
     const auto& active_quality_cashflow_box =
         two_metric_cols ? quality_cashflow_box : quality_cashflow_box_single;
 
-    const std::vector<std::vector<Metric>> metric_boxes = {
+    std::vector<std::vector<Metric>> metric_boxes = {
         target_box,
         valuation_box,
         active_balance_sheet_box,
         active_quality_cashflow_box,
         performance_box,
     };
+    if (auto dcf_box = ticker_dcf_box(app); !dcf_box.empty()) {
+        metric_boxes.push_back(std::move(dcf_box));
+    }
 
     const int first_input_y = 0;
     const int second_input_y = 1;
@@ -591,6 +569,9 @@ inline void render_ticker(AppState& app)
         total_metric_rows += box_rows(metric_boxes[i]);
         if (i + 1 < metric_boxes.size()) total_metric_rows += box_gap_rows;
     }
+    const auto spark_strips =
+        ticker_spark_strips(app, row, ticker_spark_width(label_w));
+    total_metric_rows += spark_strip_rows(spark_strips, box_gap_rows);
     const int total_body_lines = metrics_start_y + total_metric_rows;
 
     const int max_scroll = std::max(0, total_body_lines - body_height);
@@ -633,6 +614,13 @@ inline void render_ticker(AppState& app)
         else {
             mvprintw(screen_y, input_x, "%s", shown.c_str());
         }
+        if (i == 0) {
+            render_report_price_note(
+                app,
+                row,
+                screen_y,
+                input_x + std::max(2, static_cast<int>(shown.size())) + 2);
+        }
     }
 
     auto render_box = [&](int start_y, const std::vector<Metric>& box) {
@@ -676,6 +664,12 @@ inline void render_ticker(AppState& app)
         box_y += box_rows(metric_boxes[b]);
         if (b + 1 < metric_boxes.size()) box_y += box_gap_rows;
     }
+    render_spark_strips(box_y + box_gap_rows,
+                        label_w,
+                        spark_strips,
+                        view.scroll,
+                        body_top,
+                        body_height);
 
     render_ticker_help_rows(help_lines, COLS);
 
@@ -686,6 +680,146 @@ inline void render_ticker(AppState& app)
     doupdate();
 }
 
+// History behind the open ticker, loaded and kept on the view when it was
+// set from plain rows. Routes to the error view and returns null on failure.
+inline db::HistoryCache::HistoryPtr ticker_view_history(AppState& app)
+{
+    auto& view = app.ticker_view;
+    if (view.history) return view.history;
+
+    std::string err;
+    view.history = app.history_cache.load(*app.db, view.ticker, &err);
+    if (!view.history) route_error(app, err);
+    return view.history;
+}
+
+// Swaps a reloaded history of the open ticker in, keeping the shown period,
+// the yearly filter, the inputs and the matrix position.
+inline void adopt_ticker_view_history(AppState& app,
+                                      db::HistoryCache::HistoryPtr history)
+{
+    auto& view = app.ticker_view;
+    const std::string current_period =
+        view.rows.empty() ? std::string{} : period_label(view.rows[view.index]);
+
+    view.all_rows = history->rows;
+    view.ticker_type = history->ticker_type;
+    view.rows = view.all_rows;
+    if (view.yearly_only) {
+        std::vector<db::Database::FinanceRow> yearly;
+        std::copy_if(view.all_rows.begin(),
+                     view.all_rows.end(),
+                     std::back_inserter(yearly),
+                     is_yearly_period);
+        if (yearly.empty())
+            view.yearly_only = false;
+        else
+            view.rows = std::move(yearly);
+    }
+    const int idx = current_period.empty()
+                        ? -1
+                        : find_period_index(view.rows, current_period);
+    view.index = (idx >= 0) ? idx : static_cast<int>(view.rows.size()) - 1;
+    view.clamp_index();
+
+    auto& matrix = app.matrix_view;
+    if (matrix.history && matrix.history->ticker == history->ticker) {
+        const int column = matrix.column;
+        const int row = matrix.row;
+        matrix.reset(history); // render_matrix clamps both
+        matrix.column = column;
+        matrix.row = row;
+    }
+    view.history = std::move(history);
+}
+
+// Folds what other sessions committed since the last call into the caches
+// (see Database::poll_external_changes()). Only the changed tickers lose
+// their cached histories and closes and have their home grid rows re-read,
+// unless the log was compacted past this session's last look.
+// An open ticker view re-reads its closes at once and has its history
+// decoded in the background; pump_ticker_view_refresh() swaps it in.
+// Meant for idle ticks; read errors wait for the next one.
+inline void apply_external_changes(AppState& app)
+{
+    if (!app.db) return;
+
+    const std::uint64_t write_before = app.db->write_generation();
+    const std::uint64_t price_before = app.db->price_generation();
+    const auto changes = app.db->poll_external_changes();
+    if (changes.empty()) return;
+
+    if (changes.truncated) {
+        // the generations moved without a carry-over: everything reloads
+        app.tickers.index.reset();
+    }
+    else {
+        app.history_cache.carry_over(
+            write_before, app.db->write_generation(), changes.tickers);
+        app.price_cache.carry_over(
+            price_before, app.db->price_generation(), changes.prices);
+        for (const auto& ticker : changes.tickers) {
+            sync_ticker_index(app, ticker);
+        }
+    }
+    const bool any_ticker = changes.truncated || !changes.tickers.empty();
+    if (any_ticker) app.tickers.invalidate_prefetch();
+
+    auto& view = app.ticker_view;
+    if (view.ticker.empty()) return;
+    const auto changed = [&](const std::vector<std::string>& tickers) {
+        return changes.truncated ||
+               std::binary_search(tickers.begin(), tickers.end(), view.ticker);
+    };
+
+    if (view.prices && changed(changes.prices)) {
+        // the price input follows the newest close unless typed over
+        const auto previous = view.prices->latest();
+        if (previous.has_value() &&
+            view.inputs[0] == format_price_input(previous->close)) {
+            view.inputs[0].clear();
+        }
+        view.prices.reset();
+        load_ticker_view_prices(app);
+    }
+
+    // a decode queued before this poll is stale now, so ask again
+    if (changed(changes.tickers)) view.refresh_pending = true;
+    if (view.refresh_pending && app.prefetcher && any_ticker)
+        app.prefetcher->want(*app.db, {view.ticker});
+}
+
+// Called once per main loop pass: adopts the open ticker's history once
+// apply_external_changes() had it reloaded. Without a prefetcher it is
+// decoded here. A ticker deleted elsewhere leaves its views for home.
+inline void pump_ticker_view_refresh(AppState& app)
+{
+    auto& view = app.ticker_view;
+    if (!view.refresh_pending || !app.db) return;
+    if (app.prefetcher &&
+        !app.history_cache.has_current(view.ticker,
+                                       app.db->write_generation())) {
+        return;
+    }
+
+    view.refresh_pending = false;
+    std::string err;
+    auto history = app.history_cache.load(*app.db, view.ticker, &err);
+    if (!history) {
+        route_error(app, err);
+        return;
+    }
+
+    const bool showing = app.current == views::ViewId::Ticker ||
+                         app.current == views::ViewId::Matrix ||
+                         app.current == views::ViewId::Sweep;
+    if (history->rows.empty() && showing) {
+        app.current = views::ViewId::Home;
+        return;
+    }
+    adopt_ticker_view_history(app, std::move(history));
+}
+
 inline bool handle_key_ticker(AppState& app, int ch)
 {
     auto& view = app.ticker_view;
@@ -798,6 +932,56 @@ inline bool handle_key_ticker(AppState& app, int ch)
         return true;
     }
 
+    if (ch == 'm' || ch == 'M') {
+        if (view.rows.empty()) return true;
+        auto history = ticker_view_history(app);
+        if (!history) return true;
+        app.matrix_view.reset(std::move(history));
+        app.current = views::ViewId::Matrix;
+        return true;
+    }
+
+    if (ch == 'g' || ch == 'G') {
+        if (view.rows.empty()) return true;
+        app.sweep_view.reset();
+        app.current = views::ViewId::Sweep;
+        return true;
+    }
+
+    if (ch == 'v' || ch == 'V') {
+        if (view.rows.empty()) return true;
+        const auto history = ticker_view_history(app);
+        if (!history) return true;
+
+        const metrics::DcfParams params;
+        metrics::WorkPool inline_pool(1);
+        metrics::WorkPool& pool = app.work_pool ? *app.work_pool : inline_pool;
+        const auto started = std::chrono::steady_clock::now();
+        const auto dist = app.dcf.get(history->ticker,
+                                      history->generation,
+                                      history->columns,
+                                      history->yoy,
+                                      params,
+                                      pool);
+        const auto elapsed_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - started)
+                .count();
+
+        if (dist) {
+            const auto paths = static_cast<std::int64_t>(params.paths);
+            view.status_line = "simulated " + format_i64_value(paths) +
+                               " paths in " + std::to_string(elapsed_ms) +
+                               " ms";
+        }
+        else {
+            view.status_line = "not enough yearly history to simulate";
+        }
+        view.status_line_expires_at =
+            std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        return true;
+    }
+
     const int BACKSPACE_1 = KEY_BACKSPACE;
     const int BACKSPACE_2 = 127;
     const int BACKSPACE_3 = 8;
@@ -819,20 +1003,22 @@ inline bool handle_key_ticker(AppState& app, int ch)
             return true;
         }
 
+        sync_ticker_index(app, view.ticker);
         app.tickers.invalidate_prefetch();
 
-        auto refreshed = app.db->get_finances(view.ticker, &err);
-        if (!err.empty()) {
+        auto refreshed = app.history_cache.load(*app.db, view.ticker, &err);
+        if (!refreshed) {
             route_error(app, err);
             return true;
         }
 
-        if (refreshed.empty()) {
+        if (refreshed->rows.empty()) {
             app.current = views::ViewId::Home;
             return true;
         }
 
-        view.all_rows = std::move(refreshed);
+        view.all_rows = refreshed->rows;
+        view.history = std::move(refreshed);
 
         if (view.yearly_only) {
             std::vector<db::Database::FinanceRow> yearly;
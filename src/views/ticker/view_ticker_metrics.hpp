@@ -1,5 +1,6 @@
 #pragma once
 #include <curses.h>
+#include <langinfo.h>
 
 #include <array>
 #include <algorithm>
@@ -17,6 +18,11 @@
 #include <string_view>
 #include <vector>
 
+#include "db/price_series.hpp"
+#include "metrics/metric_math.hpp"
+#include "metrics/monte_carlo.hpp"
+#include "metrics/reverse_dcf.hpp"
+#include "metrics/sparkline.hpp"
 #include "state.hpp"
 #include "views/add/view_add.hpp"
 
@@ -35,6 +41,7 @@ inline constexpr short kColorPairPositive = 1;
 inline constexpr short kColorPairNegative = 2;
 inline constexpr short kColorPairHeader = 3;
 inline constexpr short kColorPairInputValue = 4;
+inline constexpr int kSparklineMaxWidth = 40;
 inline constexpr std::string_view kTickerHelpRowActions =
     "x: delete   e: edit   c: copy";
 inline constexpr std::string_view kTickerHelpRowWide =
@@ -339,94 +346,31 @@ inline std::string format_shares_opt(std::optional<double> v,
         std::optional<double>(static_cast<double>(rounded)), na_value);
 }
 
-inline std::optional<std::int64_t> add_i64(std::optional<std::int64_t> a,
-                                           std::optional<std::int64_t> b)
-{
-    if (!a.has_value() || !b.has_value()) return std::nullopt;
-    return *a + *b;
-}
-
-inline std::optional<std::int64_t> sub_i64(std::optional<std::int64_t> a,
-                                           std::optional<std::int64_t> b)
-{
-    if (!a.has_value() || !b.has_value()) return std::nullopt;
-    return *a - *b;
-}
-
-inline std::optional<double> to_f64(std::optional<std::int64_t> v)
-{
-    if (!v.has_value()) return std::nullopt;
-    return static_cast<double>(*v);
-}
-
-inline std::optional<std::int64_t> derive_underwriting_expenses(
-    std::optional<std::int64_t> total_expenses,
-    std::optional<std::int64_t> claims_incurred,
-    std::optional<std::int64_t> interest_expenses,
-    std::optional<std::int64_t> fallback = std::nullopt)
-{
-    if (!total_expenses.has_value() || !claims_incurred.has_value()) {
-        return fallback;
-    }
-    return *total_expenses - *claims_incurred - interest_expenses.value_or(0);
-}
-
-inline std::optional<std::int64_t>
-derived_underwriting_expenses_for_row(const db::Database::FinanceRow& row)
-{
-    return derive_underwriting_expenses(row.total_expenses,
-                                        row.claims_incurred,
-                                        row.interest_expenses,
-                                        row.underwriting_expenses);
-}
-
-inline std::optional<double> div_opt(std::optional<double> num,
-                                     std::optional<double> den)
-{
-    if (!num.has_value() || !den.has_value()) return std::nullopt;
-    if (*den == 0.0) return std::nullopt;
-    return *num / *den;
-}
-
-inline bool has_non_zero_value(std::optional<double> v)
-{
-    return v.has_value() && std::isfinite(*v) && *v != 0.0;
-}
-
-inline std::optional<double> null_if_zero_or_invalid(std::optional<double> v)
-{
-    if (!has_non_zero_value(v)) return std::nullopt;
-    return v;
-}
-
-inline std::optional<double> null_if_negative(std::optional<double> v)
-{
-    if (!v.has_value() || !std::isfinite(*v)) return std::nullopt;
-    if (*v < 0.0) return std::nullopt;
-    return v;
-}
-
-inline std::optional<double> div_opt_nonzero(std::optional<double> num,
-                                             std::optional<double> den)
-{
-    if (!has_non_zero_value(num) || !has_non_zero_value(den))
-        return std::nullopt;
-    return *num / *den;
-}
-
-inline std::optional<double> mul_opt_nonzero(std::optional<double> a,
-                                             std::optional<double> b)
-{
-    if (!has_non_zero_value(a) || !has_non_zero_value(b)) return std::nullopt;
-    return *a * *b;
-}
-
-inline std::optional<double> mul_opt(std::optional<double> a,
-                                     std::optional<double> b)
-{
-    if (!a.has_value() || !b.has_value()) return std::nullopt;
-    return *a * *b;
-}
+// pure period/metric math lives in metrics::, shared with the db caches
+using metrics::add_i64;
+using metrics::add_opt;
+using metrics::approx_shares;
+using metrics::derive_underwriting_expenses;
+using metrics::derived_underwriting_expenses_for_row;
+using metrics::div_opt;
+using metrics::div_opt_nonzero;
+using metrics::find_period_index;
+using metrics::find_previous_year_same_period;
+using metrics::has_non_zero_value;
+using metrics::is_valid_number;
+using metrics::is_yearly_period;
+using metrics::mul_opt;
+using metrics::mul_opt_nonzero;
+using metrics::null_if_negative;
+using metrics::null_if_zero_or_invalid;
+using metrics::percent_change;
+using metrics::period_family;
+using metrics::period_label;
+using metrics::ratio_percent_change;
+using metrics::sub_i64;
+using metrics::to_f64;
+using metrics::ttm_sum_for_family;
+using metrics::ttm_window_for_family;
 
 inline std::optional<double> parse_decimal_input(const std::string& text)
 {
@@ -452,82 +396,172 @@ inline bool is_allowed_ticker_input_char(int ch, const std::string& buf)
     return false;
 }
 
-inline bool is_valid_number(std::optional<double> v)
+// Stored close as price input text: at most four decimals, trailing zeros
+// dropped.
+inline std::string format_price_input(double close)
 {
-    return v.has_value() && std::isfinite(*v);
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.4f", close);
+    std::string text = buf;
+    while (!text.empty() && text.back() == '0') text.pop_back();
+    if (!text.empty() && text.back() == '.') text.pop_back();
+    if (text.size() > kTickerInputMaxLen) return {};
+    return text;
 }
 
-inline char period_family(const db::Database::FinanceRow& row)
+// Loads the open ticker's stored closes once per visit, and starts an
+// empty price input at the latest of them.
+inline void load_ticker_view_prices(AppState& app)
 {
-    if (row.period_type.empty()) return '\0';
-    return static_cast<char>(
-        std::toupper(static_cast<unsigned char>(row.period_type[0])));
-}
+    auto& view = app.ticker_view;
+    if (view.prices || view.ticker.empty() || !app.db) return;
 
-inline int ttm_window_for_family(char family)
-{
-    if (family == 'Q') return 4;
-    if (family == 'S') return 2;
-    return 0;
+    std::string err;
+    view.prices = app.price_cache.load(*app.db, view.ticker, &err);
+    if (!view.prices) {
+        route_error(app, err);
+        return;
+    }
+
+    const auto latest = view.prices->latest();
+    if (latest.has_value() && view.inputs[0].empty() && latest->close > 0.0) {
+        view.inputs[0] = format_price_input(latest->close);
+    }
 }
 
-template <class Getter>
-inline std::optional<double>
-ttm_sum_for_family(const std::vector<db::Database::FinanceRow>& rows,
-                   int from_index,
-                   char family,
-                   int required_periods,
-                   Getter getter)
+// Stores live quotes as today's closes, the last quote of a ticker winning.
+// Only the quoted tickers' cached series and holdings positions change;
+// histories, charts and simulations stay cached. An open ticker's price
+// input follows the quote unless the user typed over the previous close.
+inline void apply_price_quotes(AppState& app,
+                               const std::vector<db::PriceFeed::Quote>& quotes)
 {
-    if (from_index < 0 || required_periods <= 0) return std::nullopt;
-
-    int collected = 0;
-    double sum = 0.0;
+    if (quotes.empty() || !app.db) return;
+
+    std::vector<std::pair<std::string, double>> latest;
+    for (const auto& quote : quotes) {
+        const auto it = std::find_if(
+            latest.begin(), latest.end(), [&](const auto& entry) {
+                return entry.first == quote.ticker;
+            });
+        if (it != latest.end()) {
+            it->second = quote.price;
+        }
+        else {
+            latest.emplace_back(quote.ticker, quote.price);
+        }
+    }
 
-    for (int i = from_index; i >= 0 && collected < required_periods; --i) {
-        if (period_family(rows[i]) != family) continue;
-        auto value = getter(rows[i]);
-        if (!value.has_value() || !std::isfinite(*value)) return std::nullopt;
-        sum += *value;
-        collected += 1;
+    const std::int32_t today = db::local_today();
+    auto& view = app.ticker_view;
+    auto& portfolio = app.portfolio_view;
+    for (const auto& [ticker, price] : latest) {
+        std::string err;
+        const std::uint64_t before = app.db->price_generation();
+        if (!app.price_cache.apply(*app.db, ticker, {{today, price}}, &err)) {
+            route_error(app, err);
+            return;
+        }
+        // holdings swap in the one position instead of re-pricing them all
+        if (portfolio.loaded && portfolio.price_generation == before) {
+            portfolio.aggregate.update_price(ticker, price);
+            portfolio.price_generation = app.db->price_generation();
+        }
+        if (ticker != view.ticker || !view.prices) continue;
+
+        const auto previous = view.prices->latest();
+        const bool follows =
+            view.inputs[0].empty() ||
+            (previous.has_value() &&
+             view.inputs[0] == format_price_input(previous->close));
+        view.prices = app.price_cache.load(*app.db, ticker, &err);
+        if (!view.prices) {
+            route_error(app, err);
+            return;
+        }
+        if (follows) view.inputs[0] = format_price_input(price);
     }
+}
 
-    if (collected < required_periods) return std::nullopt;
-    return sum;
+// Stored close `row`'s ratios are priced at with report-date pricing on:
+// the last one on or before the period's end.
+inline std::optional<db::Database::PricePoint>
+ticker_report_date_close(const AppState& app,
+                         const db::Database::FinanceRow& row)
+{
+    const auto& prices = app.ticker_view.prices;
+    if (!app.settings.report_date_prices || !prices || prices->empty())
+        return std::nullopt;
+    const auto end = db::period_end_day(row.year, row.period_type);
+    if (!end.has_value()) return std::nullopt;
+    return prices->at_or_before(*end);
 }
 
-inline std::string period_label(const db::Database::FinanceRow& row)
+// Price `row`'s ratios use. With report-date pricing on and prices stored
+// for the ticker, that is the period's report-date close (none when the
+// series starts later); otherwise the typed price.
+inline std::optional<double>
+ticker_ratio_price(const AppState& app, const db::Database::FinanceRow& row)
 {
-    return std::to_string(row.year) + "-" + row.period_type;
+    const auto& prices = app.ticker_view.prices;
+    if (app.settings.report_date_prices && prices && !prices->empty()) {
+        const auto close = ticker_report_date_close(app, row);
+        if (!close.has_value()) return std::nullopt;
+        return close->close;
+    }
+    return parse_decimal_input(app.ticker_view.inputs[0]);
 }
 
-inline bool is_yearly_period(const db::Database::FinanceRow& row)
+// Dim "ratios @ <date> close" note after the price input, shown while
+// report-date pricing overrides it.
+inline void render_report_price_note(const AppState& app,
+                                     const db::Database::FinanceRow& row,
+                                     int y,
+                                     int x)
 {
-    return row.period_type == "Y";
+    const auto& prices = app.ticker_view.prices;
+    if (!app.settings.report_date_prices || !prices || prices->empty())
+        return;
+    if (x >= COLS - 1) return;
+
+    const auto close = ticker_report_date_close(app, row);
+    const std::string note =
+        close.has_value()
+            ? "ratios @ " + db::format_iso_day(close->day) + " close " +
+                  format_price_input(close->close)
+            : std::string("ratios @ report date: no stored close");
+    attron(A_DIM);
+    mvprintw(y, x, "%.*s", COLS - 1 - x, note.c_str());
+    attroff(A_DIM);
 }
 
-inline int find_period_index(const std::vector<db::Database::FinanceRow>& rows,
-                             const std::string& period)
+// TTM sums for `row`, from the cached history when the view has one.
+inline metrics::Ttm ticker_ttm_for_row(const AppState::TickerViewState& view,
+                                       const db::Database::FinanceRow& row)
 {
-    const auto it = std::find_if(rows.begin(), rows.end(), [&](const auto& r) {
-        return period_label(r) == period;
-    });
-    if (it == rows.end()) return -1;
-    return static_cast<int>(std::distance(rows.begin(), it));
+    const int all_index = find_period_index(view.all_rows, period_label(row));
+    if (view.history && all_index >= 0 &&
+        all_index < static_cast<int>(view.history->ttm.size())) {
+        return view.history->ttm[static_cast<std::size_t>(all_index)];
+    }
+    return metrics::ttm_at(view.all_rows, all_index);
 }
 
-inline const db::Database::FinanceRow* find_previous_year_same_period(
-    const std::vector<db::Database::FinanceRow>& rows,
-    const db::Database::FinanceRow& row)
+// Same period a year earlier, from the history's YoY table when the view
+// has one.
+inline const db::Database::FinanceRow*
+ticker_previous_row(const AppState::TickerViewState& view,
+                    const db::Database::FinanceRow& row)
 {
-    const int prev_year = row.year - 1;
-    const auto it =
-        std::find_if(rows.begin(), rows.end(), [&](const auto& candidate) {
-            return candidate.year == prev_year &&
-                   candidate.period_type == row.period_type;
-        });
-    if (it == rows.end()) return nullptr;
-    return &(*it);
+    const int all_index = find_period_index(view.all_rows, period_label(row));
+    if (view.history && all_index >= 0 &&
+        all_index < static_cast<int>(view.history->yoy.size())) {
+        const int prev = view.history->yoy.previous_index(
+            static_cast<std::size_t>(all_index));
+        if (prev < 0) return nullptr;
+        return &view.all_rows[static_cast<std::size_t>(prev)];
+    }
+    return find_previous_year_same_period(view.all_rows, row);
 }
 
 inline void append_clipboard_i64(std::ostringstream& out,
@@ -547,6 +581,32 @@ inline void append_clipboard_f64(std::ostringstream& out,
     out << label << ": " << format_clip_f64_value(*value) << "\n";
 }
 
+// "<field> yoy: <pct>%" for every raw field that has a change, read from
+// the history's YoY table; nothing without one.
+inline void append_clipboard_changes(std::ostringstream& out,
+                                     const AppState::TickerViewState& view,
+                                     const db::Database::FinanceRow& row)
+{
+    if (!view.history) return;
+    const int all_index = find_period_index(view.all_rows, period_label(row));
+    if (all_index < 0 ||
+        all_index >= static_cast<int>(view.history->yoy.size()))
+        return;
+
+    const auto& yoy = view.history->yoy;
+    const auto index = static_cast<std::size_t>(all_index);
+    const auto append = [&](const char* name, std::optional<double> change) {
+        if (!change.has_value() || !std::isfinite(*change)) return;
+        std::string label(name);
+        std::replace(label.begin(), label.end(), '_', ' ');
+        out << label << " yoy: " << format_clip_f64_value(*change) << "%\n";
+    };
+    for (const auto& f : metrics::kFinanceStoreFields) {
+        append(f.name, yoy.field_change(f.field, index));
+    }
+    append("eps", yoy.eps_change(index));
+}
+
 inline std::string period_clipboard_text(const AppState& app,
                                          const AppState::TickerViewState& view,
                                          const db::Database::FinanceRow& row)
@@ -602,24 +662,9 @@ inline std::string period_clipboard_text(const AppState& app,
         std::optional<double> ttm_net_income_d;
 
         if (ttm_family_supported) {
-            const std::string selected_period = period_label(row);
-            const int all_index =
-                find_period_index(view.all_rows, selected_period);
-
-            ttm_eps = ttm_sum_for_family(
-                view.all_rows,
-                all_index,
-                family,
-                ttm_window,
-                [](const db::Database::FinanceRow& r) { return r.eps; });
-            ttm_net_income_d =
-                ttm_sum_for_family(view.all_rows,
-                                   all_index,
-                                   family,
-                                   ttm_window,
-                                   [](const db::Database::FinanceRow& r) {
-                                       return to_f64(r.net_income);
-                                   });
+            const auto ttm = ticker_ttm_for_row(view, row);
+            ttm_eps = ttm.eps;
+            ttm_net_income_d = ttm.net_income;
         }
 
         const bool prefer_ttm_for_derived =
@@ -633,16 +678,11 @@ inline std::string period_clipboard_text(const AppState& app,
                 ? ttm_net_income_d
                 : net_income_d;
 
-        const auto shares_outstanding_raw =
-            div_opt_nonzero(net_income_for_derived, eps_for_derived);
         const auto shares_outstanding =
-            shares_outstanding_raw.has_value()
-                ? std::optional<double>(std::round(*shares_outstanding_raw))
-                : std::nullopt;
+            approx_shares(net_income_for_derived, eps_for_derived);
         const auto tbv_per_share =
             div_opt_nonzero(tangible_equity_d, shares_outstanding);
-        const std::optional<double> typed_price =
-            parse_decimal_input(view.inputs[0]);
+        const std::optional<double> typed_price = ticker_ratio_price(app, row);
         const auto ratio_price = null_if_zero_or_invalid(typed_price);
         const auto p_tbv = div_opt_nonzero(ratio_price, tbv_per_share);
         const auto p_e = div_opt_nonzero(ratio_price, eps_for_derived);
@@ -672,6 +712,7 @@ inline std::string period_clipboard_text(const AppState& app,
             out, "loan / deposit", div_opt_nonzero(loans_d, deposits_d));
         append_clipboard_f64(out, "p / tbv", p_tbv);
         append_clipboard_f64(out, "p / e", p_e);
+        append_clipboard_changes(out, view, row);
         return out.str();
     }
     if (view.ticker_type == 3) {
@@ -705,10 +746,7 @@ inline std::string period_clipboard_text(const AppState& app,
         const auto underwriting_profit_d = to_f64(underwriting_profit);
         const auto loss_ratio = div_opt_nonzero(claims_d, premiums_d);
         const auto expense_ratio = div_opt_nonzero(expenses_d, premiums_d);
-        const auto combined_ratio =
-            (loss_ratio.has_value() && expense_ratio.has_value())
-                ? std::optional<double>(*loss_ratio + *expense_ratio)
-                : std::nullopt;
+        const auto combined_ratio = add_opt(loss_ratio, expense_ratio);
 
         const char family = period_family(row);
         const int ttm_window = ttm_window_for_family(family);
@@ -717,24 +755,9 @@ inline std::string period_clipboard_text(const AppState& app,
         std::optional<double> ttm_eps;
         std::optional<double> ttm_net_income_d;
         if (ttm_family_supported) {
-            const std::string selected_period = period_label(row);
-            const int all_index =
-                find_period_index(view.all_rows, selected_period);
-
-            ttm_eps = ttm_sum_for_family(
-                view.all_rows,
-                all_index,
-                family,
-                ttm_window,
-                [](const db::Database::FinanceRow& r) { return r.eps; });
-            ttm_net_income_d =
-                ttm_sum_for_family(view.all_rows,
-                                   all_index,
-                                   family,
-                                   ttm_window,
-                                   [](const db::Database::FinanceRow& r) {
-                                       return to_f64(r.net_income);
-                                   });
+            const auto ttm = ticker_ttm_for_row(view, row);
+            ttm_eps = ttm.eps;
+            ttm_net_income_d = ttm.net_income;
         }
 
         const bool prefer_ttm_for_derived =
@@ -748,16 +771,11 @@ inline std::string period_clipboard_text(const AppState& app,
                 ? ttm_net_income_d
                 : net_income_d;
 
-        const auto shares_outstanding_raw =
-            div_opt_nonzero(net_income_for_derived, eps_for_derived);
         const auto shares_outstanding =
-            shares_outstanding_raw.has_value()
-                ? std::optional<double>(std::round(*shares_outstanding_raw))
-                : std::nullopt;
+            approx_shares(net_income_for_derived, eps_for_derived);
         const auto book_value_per_share =
             div_opt_nonzero(equity_d, shares_outstanding);
-        const std::optional<double> typed_price =
-            parse_decimal_input(view.inputs[0]);
+        const std::optional<double> typed_price = ticker_ratio_price(app, row);
         const auto ratio_price = null_if_zero_or_invalid(typed_price);
         const auto p_bv = div_opt_nonzero(ratio_price, book_value_per_share);
         const auto p_e = div_opt_nonzero(ratio_price, eps_for_derived);
@@ -781,6 +799,7 @@ inline std::string period_clipboard_text(const AppState& app,
             out, "debt / equity", div_opt_nonzero(debt_d, equity_d));
         append_clipboard_f64(out, "p / bv", p_bv);
         append_clipboard_f64(out, "p / e", p_e);
+        append_clipboard_changes(out, view, row);
         return out.str();
     }
 
@@ -828,31 +847,10 @@ inline std::string period_clipboard_text(const AppState& app,
     std::optional<double> ttm_cash_flow_ops_d;
 
     if (ttm_family_supported) {
-        const std::string selected_period = period_label(row);
-        const int all_index = find_period_index(view.all_rows, selected_period);
-
-        ttm_eps = ttm_sum_for_family(
-            view.all_rows,
-            all_index,
-            family,
-            ttm_window,
-            [](const db::Database::FinanceRow& r) { return r.eps; });
-        ttm_net_income_d =
-            ttm_sum_for_family(view.all_rows,
-                               all_index,
-                               family,
-                               ttm_window,
-                               [](const db::Database::FinanceRow& r) {
-                                   return to_f64(r.net_income);
-                               });
-        ttm_cash_flow_ops_d =
-            ttm_sum_for_family(view.all_rows,
-                               all_index,
-                               family,
-                               ttm_window,
-                               [](const db::Database::FinanceRow& r) {
-                                   return to_f64(r.cash_flow_from_operations);
-                               });
+        const auto ttm = ticker_ttm_for_row(view, row);
+        ttm_eps = ttm.eps;
+        ttm_net_income_d = ttm.net_income;
+        ttm_cash_flow_ops_d = ttm.cash_flow_ops;
     }
 
     const bool prefer_ttm_for_derived =
@@ -878,16 +876,11 @@ inline std::string period_clipboard_text(const AppState& app,
     const auto leverage = div_opt_nonzero(total_liabilities_d, equity_d);
     const auto wc_over_non_current =
         div_opt_nonzero(to_f64(working_capital), non_current_liabilities_d);
-    const auto shares_approx_raw =
-        div_opt_nonzero(net_income_for_derived, eps_for_derived);
     const auto shares_approx =
-        shares_approx_raw.has_value()
-            ? std::optional<double>(std::round(*shares_approx_raw))
-            : std::nullopt;
+        approx_shares(net_income_for_derived, eps_for_derived);
     const auto book_value = div_opt_nonzero(equity_d, shares_approx);
 
-    const std::optional<double> typed_price =
-        parse_decimal_input(view.inputs[0]);
+    const std::optional<double> typed_price = ticker_ratio_price(app, row);
     const auto ratio_price = null_if_zero_or_invalid(typed_price);
     const auto ratio_total_liabilities =
         null_if_zero_or_invalid(total_liabilities_d);
@@ -933,42 +926,11 @@ inline std::string period_clipboard_text(const AppState& app,
     append_clipboard_f64(out, "price / book value", price_to_book);
     append_clipboard_f64(out, "ev / market cap", ev_over_market_cap);
     append_clipboard_f64(out, "ev / net income", ev_over_net_income);
+    append_clipboard_changes(out, view, row);
 
     return out.str();
 }
 
-inline std::optional<double> percent_change(std::optional<double> current,
-                                            std::optional<double> previous)
-{
-    if (!current.has_value() || !previous.has_value()) return std::nullopt;
-    if (!std::isfinite(*current) || !std::isfinite(*previous))
-        return std::nullopt;
-    if (*previous == 0.0) return std::nullopt;
-    return ((*current - *previous) / std::abs(*previous)) * 100.0;
-}
-
-inline std::optional<double>
-ratio_percent_change(std::optional<double> current,
-                     std::optional<double> previous)
-{
-    if (!current.has_value() || !previous.has_value()) return std::nullopt;
-    if (!std::isfinite(*current) || !std::isfinite(*previous))
-        return std::nullopt;
-    if (*current == 0.0 || *previous == 0.0) return std::nullopt;
-
-    if (*previous < 0.0 && *current < 0.0) {
-        return ((std::abs(*previous) - std::abs(*current)) /
-                std::abs(*previous)) *
-               100.0;
-    }
-
-    if (*previous < 0.0 && *current > 0.0) {
-        return std::abs(((*current - *previous) / *previous) * 100.0);
-    }
-
-    return ((*current - *previous) / *previous) * 100.0;
-}
-
 inline std::optional<double>
 required_net_income_change_pct(std::optional<double> required_net_income,
                                std::optional<double> baseline_net_income)
@@ -1006,6 +968,21 @@ rounded_price_for_wished_per(std::optional<double> wished_per,
     return std::round(*wished_per * *eps_to_use);
 }
 
+// Growth the typed price implies for the row's cash flow (CFop, else NI),
+// TTM when the view derives from TTM.
+inline std::optional<double>
+implied_growth_for_price(std::optional<double> price,
+                         std::optional<double> cash_flow_ops,
+                         std::optional<double> net_income,
+                         std::optional<double> shares)
+{
+    if (!price.has_value()) return std::nullopt;
+    const auto in =
+        metrics::reverse_dcf_inputs(cash_flow_ops, net_income, shares);
+    if (!in.has_value()) return std::nullopt;
+    return metrics::implied_growth(*in, *price);
+}
+
 inline std::string format_change(std::optional<double> change)
 {
     if (!change.has_value() || !std::isfinite(*change)) return {};
@@ -1200,6 +1177,110 @@ inline void render_metric_at(int x,
     if (dim_zero_change) attroff(A_DIM);
 }
 
-} // namespace views
+struct SparkStrip {
+    const char* label;
+    std::string text;
+};
+
+// Braille needs the wide-character curses build and a UTF-8 locale.
+inline bool sparkline_use_braille()
+{
+#if defined(INTRINSIC_WIDE_CURSES)
+    static const bool utf8 = [] {
+        const char* codeset = nl_langinfo(CODESET);
+        return codeset != nullptr && std::strcmp(codeset, "UTF-8") == 0;
+    }();
+    return utf8;
+#else
+    return false;
+#endif
+}
+
+inline int ticker_spark_width(int label_w)
+{
+    return std::clamp(COLS - 1 - (std::max(4, label_w) + 1),
+                      0,
+                      kSparklineMaxWidth);
+}
+
+// Chart strips over the selected period's cadence (yearly or interim);
+// none without a cached history. P/E needs a typed price.
+inline std::vector<SparkStrip>
+ticker_spark_strips(AppState& app,
+                    const db::Database::FinanceRow& row,
+                    int width)
+{
+    std::vector<SparkStrip> strips;
+    const auto& history = app.ticker_view.history;
+    if (!history || width <= 0) return strips;
+
+    const auto price = parse_decimal_input(app.ticker_view.inputs[0]);
+    const bool has_price = price.has_value() && *price > 0.0;
+    const bool braille = sparkline_use_braille();
+    for (const auto& info : metrics::kSparkMetrics) {
+        if (info.metric == metrics::SparkMetric::PriceEarnings && !has_price)
+            continue;
+        std::string text = app.sparklines.strip(history->ticker,
+                                                history->generation,
+                                                history->columns,
+                                                history->yoy,
+                                                info.metric,
+                                                is_yearly_period(row),
+                                                width,
+                                                braille);
+        if (!text.empty()) strips.push_back({info.label, std::move(text)});
+    }
+    return strips;
+}
 
+// Body rows the strips take below the metric boxes, gap included.
+inline int spark_strip_rows(const std::vector<SparkStrip>& strips,
+                            int box_gap_rows)
+{
+    if (strips.empty()) return 0;
+    return box_gap_rows + static_cast<int>(strips.size());
+}
 
+inline void render_spark_strips(int start_y,
+                                int label_w,
+                                const std::vector<SparkStrip>& strips,
+                                int body_scroll,
+                                int body_top,
+                                int body_height)
+{
+    const int clamped_label_w = std::max(4, label_w);
+    for (std::size_t i = 0; i < strips.size(); ++i) {
+        const int screen_y =
+            body_top + start_y + static_cast<int>(i) - body_scroll;
+        if (screen_y < body_top || screen_y >= body_top + body_height)
+            continue;
+        render_metric_label(screen_y, 0, clamped_label_w, strips[i].label);
+        if (clamped_label_w + 1 >= COLS) continue;
+        mvaddstr(screen_y, clamped_label_w + 1, strips[i].text.c_str());
+    }
+}
+
+// Intrinsic-value rows of the finished simulation for the open history;
+// empty until one ran. The probability needs a typed price.
+inline std::vector<Metric> ticker_dcf_box(const AppState& app)
+{
+    const auto& history = app.ticker_view.history;
+    if (!history) return {};
+    const auto dist = app.dcf.find(
+        history->ticker, history->generation, metrics::DcfParams{});
+    if (!dist || dist->quantiles.empty()) return {};
+
+    const auto price = parse_decimal_input(app.ticker_view.inputs[0]);
+    std::optional<double> price_below;
+    if (price.has_value() && *price > 0.0) {
+        price_below = dist->probability_below(*price);
+    }
+    return {
+        {"IV p10", format_f64_opt(dist->percentile(10.0))},
+        {"IV p50", format_f64_opt(dist->percentile(50.0))},
+        {"IV p90", format_f64_opt(dist->percentile(90.0))},
+        {"P(px<IV)", format_f64_opt(price_below, true), false, true},
+    };
+}
+
+} // namespace views
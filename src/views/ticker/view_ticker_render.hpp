@@ -86,22 +86,9 @@ inline void render_ticker_type3(AppState& app,
     std::optional<double> ttm_eps;
     std::optional<double> ttm_net_income_d;
     if (ttm_family_supported) {
-        const int all_index =
-            find_period_index(view.all_rows, period_label(row));
-        ttm_eps = ttm_sum_for_family(
-            view.all_rows,
-            all_index,
-            family,
-            ttm_window,
-            [](const db::Database::FinanceRow& r) { return r.eps; });
-        ttm_net_income_d =
-            ttm_sum_for_family(view.all_rows,
-                               all_index,
-                               family,
-                               ttm_window,
-                               [](const db::Database::FinanceRow& r) {
-                                   return to_f64(r.net_income);
-                               });
+        const auto ttm = ticker_ttm_for_row(view, row);
+        ttm_eps = ttm.eps;
+        ttm_net_income_d = ttm.net_income;
     }
 
     const bool prefer_ttm = app.settings.ttm && ttm_family_supported;
@@ -120,21 +107,13 @@ inline void render_ticker_type3(AppState& app,
             ? ttm_net_income_d
             : net_income_d;
 
-    const auto shares_outstanding_raw =
-        div_opt_nonzero(net_income_for_derived, eps_for_derived);
     const auto shares_outstanding =
-        shares_outstanding_raw.has_value()
-            ? std::optional<double>(std::round(*shares_outstanding_raw))
-            : std::nullopt;
+        approx_shares(net_income_for_derived, eps_for_derived);
     const auto book_value_per_share =
         div_opt_nonzero(equity_d, shares_outstanding);
 
-    const auto prev_shares_outstanding_raw =
-        div_opt_nonzero(prev_net_income_d, prev_eps_d);
     const auto prev_shares_outstanding =
-        prev_shares_outstanding_raw.has_value()
-            ? std::optional<double>(std::round(*prev_shares_outstanding_raw))
-            : std::nullopt;
+        approx_shares(prev_net_income_d, prev_eps_d);
     const auto prev_book_value_per_share =
         div_opt_nonzero(prev_equity_d, prev_shares_outstanding);
 
@@ -142,10 +121,7 @@ inline void render_ticker_type3(AppState& app,
         div_opt_nonzero(claims_incurred_d, earned_premiums_d);
     const auto expense_ratio =
         div_opt_nonzero(underwriting_expenses_d, earned_premiums_d);
-    const auto combined_ratio =
-        (loss_ratio.has_value() && expense_ratio.has_value())
-            ? std::optional<double>(*loss_ratio + *expense_ratio)
-            : std::nullopt;
+    const auto combined_ratio = add_opt(loss_ratio, expense_ratio);
     const auto underwriting_margin =
         div_opt_nonzero(underwriting_profit_d, earned_premiums_d);
     const auto roe = div_opt_nonzero(net_income_d, equity_d);
@@ -157,9 +133,7 @@ inline void render_ticker_type3(AppState& app,
     const auto prev_expense_ratio =
         div_opt_nonzero(prev_underwriting_expenses_d, prev_earned_premiums_d);
     const auto prev_combined_ratio =
-        (prev_loss_ratio.has_value() && prev_expense_ratio.has_value())
-            ? std::optional<double>(*prev_loss_ratio + *prev_expense_ratio)
-            : std::nullopt;
+        add_opt(prev_loss_ratio, prev_expense_ratio);
     const auto prev_underwriting_margin =
         div_opt_nonzero(prev_underwriting_profit_d, prev_earned_premiums_d);
     const auto prev_roe = div_opt_nonzero(prev_net_income_d, prev_equity_d);
@@ -168,8 +142,7 @@ inline void render_ticker_type3(AppState& app,
     const auto prev_debt_to_equity =
         div_opt_nonzero(prev_total_debt_d, prev_equity_d);
 
-    const std::optional<double> typed_price =
-        parse_decimal_input(view.inputs[0]);
+    const std::optional<double> typed_price = ticker_ratio_price(app, row);
     const std::optional<double> wished_per =
         parse_decimal_input(view.inputs[1]);
     const auto ratio_price = null_if_zero_or_invalid(typed_price);
@@ -187,6 +160,8 @@ inline void render_ticker_type3(AppState& app,
     const auto required_net_income = mul_opt(required_eps, shares_for_wished);
     const auto price_needed_change =
         percent_change(price_needed_for_wished_per, typed_price);
+    const auto implied_growth = implied_growth_for_price(
+        ratio_price, std::nullopt, net_income_for_derived, shares_outstanding);
     const auto required_net_income_change = required_net_income_change_pct(
         required_net_income, net_income_for_wished);
 
@@ -203,6 +178,7 @@ inline void render_ticker_type3(AppState& app,
              required_net_income_change),
          false,
          true},
+        {"implied g", format_f64_opt(implied_growth, true), false, true},
     };
 
     const std::vector<Metric> valuation_box = {
@@ -333,13 +309,16 @@ inline void render_ticker_type3(AppState& app,
     const int c2_x = two_metric_cols ? (c1_x + col_w + metric_col_gap) : c1_x;
     const int label_w = std::clamp(col_w - 15, 6, 13);
 
-    const std::vector<std::vector<Metric>> metric_boxes = {
+    std::vector<std::vector<Metric>> metric_boxes = {
         target_box,
         valuation_box,
         balance_box,
         income_box,
         ratios_box,
     };
+    if (auto dcf_box = ticker_dcf_box(app); !dcf_box.empty()) {
+        metric_boxes.push_back(std::move(dcf_box));
+    }
 
     const int first_input_y = 0;
     const int second_input_y = 1;
@@ -364,6 +343,9 @@ inline void render_ticker_type3(AppState& app,
         total_metric_rows += box_rows(metric_boxes[i]);
         if (i + 1 < metric_boxes.size()) total_metric_rows += box_gap_rows;
     }
+    const auto spark_strips =
+        ticker_spark_strips(app, row, ticker_spark_width(label_w));
+    total_metric_rows += spark_strip_rows(spark_strips, box_gap_rows);
     const int total_body_lines = metrics_start_y + total_metric_rows;
 
     const int max_scroll = std::max(0, total_body_lines - body_height);
@@ -406,6 +388,13 @@ inline void render_ticker_type3(AppState& app,
         else {
             mvprintw(screen_y, input_x, "%s", shown.c_str());
         }
+        if (i == 0) {
+            render_report_price_note(
+                app,
+                row,
+                screen_y,
+                input_x + std::max(2, static_cast<int>(shown.size())) + 2);
+        }
     }
 
     auto render_box = [&](int start_y, const std::vector<Metric>& box) {
@@ -449,6 +438,12 @@ inline void render_ticker_type3(AppState& app,
         box_y += box_rows(metric_boxes[b]);
         if (b + 1 < metric_boxes.size()) box_y += box_gap_rows;
     }
+    render_spark_strips(box_y + box_gap_rows,
+                        label_w,
+                        spark_strips,
+                        view.scroll,
+                        body_top,
+                        body_height);
 
     render_ticker_help_rows(help_lines, COLS);
 
@@ -559,22 +554,9 @@ inline void render_ticker_type2(AppState& app,
     std::optional<double> ttm_eps;
     std::optional<double> ttm_net_income_d;
     if (ttm_family_supported) {
-        const int all_index =
-            find_period_index(view.all_rows, period_label(row));
-        ttm_eps = ttm_sum_for_family(
-            view.all_rows,
-            all_index,
-            family,
-            ttm_window,
-            [](const db::Database::FinanceRow& r) { return r.eps; });
-        ttm_net_income_d =
-            ttm_sum_for_family(view.all_rows,
-                               all_index,
-                               family,
-                               ttm_window,
-                               [](const db::Database::FinanceRow& r) {
-                                   return to_f64(r.net_income);
-                               });
+        const auto ttm = ticker_ttm_for_row(view, row);
+        ttm_eps = ttm.eps;
+        ttm_net_income_d = ttm.net_income;
     }
 
     const bool prefer_ttm = app.settings.ttm && ttm_family_supported;
@@ -593,21 +575,13 @@ inline void render_ticker_type2(AppState& app,
             ? ttm_net_income_d
             : net_income_d;
 
-    const auto shares_outstanding_raw =
-        div_opt_nonzero(net_income_for_derived, eps_for_derived);
     const auto shares_outstanding =
-        shares_outstanding_raw.has_value()
-            ? std::optional<double>(std::round(*shares_outstanding_raw))
-            : std::nullopt;
+        approx_shares(net_income_for_derived, eps_for_derived);
     const auto tbv_per_share =
         div_opt_nonzero(tangible_equity_d, shares_outstanding);
 
-    const auto prev_shares_outstanding_raw =
-        div_opt_nonzero(prev_net_income_d, prev_eps_d);
     const auto prev_shares_outstanding =
-        prev_shares_outstanding_raw.has_value()
-            ? std::optional<double>(std::round(*prev_shares_outstanding_raw))
-            : std::nullopt;
+        approx_shares(prev_net_income_d, prev_eps_d);
     const auto prev_tbv_per_share =
         div_opt_nonzero(prev_tangible_equity_d, prev_shares_outstanding);
 
@@ -639,8 +613,7 @@ inline void render_ticker_type2(AppState& app,
     const auto prev_loan_to_deposit =
         div_opt_nonzero(prev_loans_d, prev_total_deposits_d);
 
-    const std::optional<double> typed_price =
-        parse_decimal_input(view.inputs[0]);
+    const std::optional<double> typed_price = ticker_ratio_price(app, row);
     const std::optional<double> wished_per =
         parse_decimal_input(view.inputs[1]);
     const auto ratio_price = null_if_zero_or_invalid(typed_price);
@@ -657,6 +630,8 @@ inline void render_ticker_type2(AppState& app,
     const auto required_net_income = mul_opt(required_eps, shares_for_wished);
     const auto price_needed_change =
         percent_change(price_needed_for_wished_per, typed_price);
+    const auto implied_growth = implied_growth_for_price(
+        ratio_price, std::nullopt, net_income_for_derived, shares_outstanding);
     const auto required_net_income_change = required_net_income_change_pct(
         required_net_income, net_income_for_wished);
 
@@ -673,6 +648,7 @@ inline void render_ticker_type2(AppState& app,
              required_net_income_change),
          false,
          true},
+        {"implied g", format_f64_opt(implied_growth, true), false, true},
     };
 
     const std::vector<Metric> valuation_box = {
@@ -823,13 +799,16 @@ inline void render_ticker_type2(AppState& app,
     const int c2_x = two_metric_cols ? (c1_x + col_w + metric_col_gap) : c1_x;
     const int label_w = std::clamp(col_w - 15, 6, 13);
 
-    const std::vector<std::vector<Metric>> metric_boxes = {
+    std::vector<std::vector<Metric>> metric_boxes = {
         target_box,
         valuation_box,
         balance_reg_box,
         earnings_box,
         asset_quality_box,
     };
+    if (auto dcf_box = ticker_dcf_box(app); !dcf_box.empty()) {
+        metric_boxes.push_back(std::move(dcf_box));
+    }
 
     const int first_input_y = 0;
     const int second_input_y = 1;
@@ -854,6 +833,9 @@ inline void render_ticker_type2(AppState& app,
         total_metric_rows += box_rows(metric_boxes[i]);
         if (i + 1 < metric_boxes.size()) total_metric_rows += box_gap_rows;
     }
+    const auto spark_strips =
+        ticker_spark_strips(app, row, ticker_spark_width(label_w));
+    total_metric_rows += spark_strip_rows(spark_strips, box_gap_rows);
     const int total_body_lines = metrics_start_y + total_metric_rows;
 
     const int max_scroll = std::max(0, total_body_lines - body_height);
@@ -896,6 +878,13 @@ inline void render_ticker_type2(AppState& app,
         else {
             mvprintw(screen_y, input_x, "%s", shown.c_str());
         }
+        if (i == 0) {
+            render_report_price_note(
+                app,
+                row,
+                screen_y,
+                input_x + std::max(2, static_cast<int>(shown.size())) + 2);
+        }
     }
 
     auto render_box = [&](int start_y, const std::vector<Metric>& box) {
@@ -939,6 +928,12 @@ inline void render_ticker_type2(AppState& app,
         box_y += box_rows(metric_boxes[b]);
         if (b + 1 < metric_boxes.size()) box_y += box_gap_rows;
     }
+    render_spark_strips(box_y + box_gap_rows,
+                        label_w,
+                        spark_strips,
+                        view.scroll,
+                        body_top,
+                        body_height);
 
     render_ticker_help_rows(help_lines, COLS);
 
@@ -4,7 +4,17 @@ struct AppState;
 
 namespace views {
 
-enum class ViewId { Home, Help, Settings, Ticker, Error, Add };
+enum class ViewId {
+    Home,
+    Help,
+    Settings,
+    Ticker,
+    Error,
+    Add,
+    Matrix,
+    Sweep,
+    Portfolio
+};
 
 bool handle_key_home(AppState& app, int ch);
 bool handle_key_help(AppState& app, int ch);
@@ -12,6 +22,9 @@ bool handle_key_settings(AppState& app, int ch);
 bool handle_key_ticker(AppState& app, int ch);
 bool handle_key_error(AppState& app, int ch);
 bool handle_key_add(AppState& app, int ch);
+bool handle_key_matrix(AppState& app, int ch);
+bool handle_key_sweep(AppState& app, int ch);
+bool handle_key_portfolio(AppState& app, int ch);
 
 } // namespace views
 
@@ -730,3 +730,463 @@ TEST_CASE("database supports concurrent writes across separate connections")
 }
 
 
+
+TEST_CASE("database keeps ticker_summary current on add and delete")
+{
+    test::TempDir temp;
+    db::Database database;
+    open_test_db(database, temp.path());
+
+    std::string err;
+    REQUIRE(database.add_finances("ACME", "2023-Y", make_payload(), &err));
+    for (int q = 1; q <= 4; ++q) {
+        const std::string period = "2024-Q" + std::to_string(q);
+        REQUIRE(database.add_finances(
+            "ACME", period, make_payload(100 + q, 10 + q, 1.5), &err));
+    }
+
+    auto summary = database.get_ticker_summary("ACME", &err);
+    REQUIRE(err.empty());
+    REQUIRE(summary.has_value());
+    REQUIRE_EQ(summary->latest_year, 2024);
+    REQUIRE_EQ(summary->latest_period_type, std::string("Q4"));
+    REQUIRE_EQ(summary->period_count, 5);
+    REQUIRE_EQ(summary->yearly_count, 1);
+    REQUIRE_EQ(summary->latest_revenue.value_or(0), std::int64_t{104});
+    REQUIRE_EQ(summary->ttm_year.value_or(0), 2024);
+    REQUIRE_EQ(summary->ttm_period_type, std::string("Q4"));
+    REQUIRE_EQ(summary->ttm_eps.value_or(0.0), 6.0);
+    REQUIRE_EQ(summary->ttm_net_income.value_or(0.0), 50.0);
+    REQUIRE_EQ(summary->ttm_cash_flow_ops.value_or(0.0), 280.0);
+
+    // a broken window clears the ttm sums but keeps the period it ends at
+    REQUIRE(database.delete_period("ACME", "2024-Q1", &err));
+    summary = database.get_ticker_summary("ACME", &err);
+    REQUIRE(summary.has_value());
+    REQUIRE_EQ(summary->period_count, 4);
+    REQUIRE_EQ(summary->ttm_period_type, std::string("Q4"));
+    REQUIRE(!summary->ttm_eps.has_value());
+
+    for (const char* period : {"2024-Q2", "2024-Q3", "2024-Q4"}) {
+        REQUIRE(database.delete_period("ACME", period, &err));
+    }
+    summary = database.get_ticker_summary("ACME", &err);
+    REQUIRE(summary.has_value());
+    REQUIRE_EQ(summary->latest_year, 2023);
+    REQUIRE_EQ(summary->latest_period_type, std::string("Y"));
+    REQUIRE(!summary->ttm_year.has_value());
+    REQUIRE(!summary->ttm_eps.has_value());
+
+    // last period cascades through tickers
+    REQUIRE(database.delete_period("ACME", "2023-Y", &err));
+    REQUIRE(!database.get_ticker_summary("ACME", &err).has_value());
+    REQUIRE(err.empty());
+}
+
+TEST_CASE("database get_ticker_summaries keeps order and skips unknowns")
+{
+    test::TempDir temp;
+    db::Database database;
+    open_test_db(database, temp.path());
+
+    std::string err;
+    REQUIRE(database.add_finances("AAA", "2024-Y", make_payload(), &err));
+    REQUIRE(database.add_finances("BBB", "2024-Y", make_payload(), &err));
+
+    const auto summaries =
+        database.get_ticker_summaries({"BBB", "NOPE", "AAA"}, &err);
+    REQUIRE(err.empty());
+    REQUIRE_EQ(summaries.size(), std::size_t{2});
+    REQUIRE_EQ(summaries[0].ticker, std::string("BBB"));
+    REQUIRE_EQ(summaries[1].ticker, std::string("AAA"));
+}
+
+TEST_CASE("database backfills ticker_summary for rows written without it")
+{
+    test::TempDir temp;
+    std::filesystem::path db_path;
+    {
+        db::Database database;
+        open_test_db(database, temp.path());
+        std::string err;
+        REQUIRE(database.add_finances("OLD", "2022-Y", make_payload(), &err));
+        REQUIRE(database.add_finances("OLD", "2023-Y", make_payload(), &err));
+        db_path = database.path();
+    }
+
+    sqlite3* raw = nullptr;
+    REQUIRE(sqlite3_open(db_path.string().c_str(), &raw) == SQLITE_OK);
+    REQUIRE(sqlite3_exec(raw,
+                         "DELETE FROM ticker_summary;",
+                         nullptr,
+                         nullptr,
+                         nullptr) == SQLITE_OK);
+    sqlite3_close(raw);
+
+    db::Database reopened;
+    open_test_db(reopened, temp.path());
+
+    std::string err;
+    const auto summary = reopened.get_ticker_summary("OLD", &err);
+    REQUIRE(err.empty());
+    REQUIRE(summary.has_value());
+    REQUIRE_EQ(summary->latest_year, 2023);
+    REQUIRE_EQ(summary->period_count, 2);
+    REQUIRE_EQ(summary->yearly_count, 2);
+}
+
+TEST_CASE("database keeps finance_metrics current on add and delete")
+{
+    test::TempDir temp;
+    db::Database database;
+    open_test_db(database, temp.path());
+
+    std::string err;
+    for (int q = 2; q <= 4; ++q) {
+        const std::string period = "2024-Q" + std::to_string(q);
+        REQUIRE(database.add_finances(
+            "ACME", period, make_payload(200, 20, 2.0), &err));
+    }
+
+    // equity = (1000 + 5000) - (800 + 2000)
+    auto rows = database.screen_finance_metric("roe",
+                                               std::nullopt,
+                                               std::nullopt,
+                                               db::Database::SortDir::Asc,
+                                               10,
+                                               false,
+                                               &err);
+    REQUIRE(err.empty());
+    REQUIRE_EQ(rows.size(), std::size_t{3});
+    REQUIRE_EQ(rows.front().value, 20.0 / 3200.0);
+
+    rows = database.screen_finance_metric("ttm_eps",
+                                          std::nullopt,
+                                          std::nullopt,
+                                          db::Database::SortDir::Asc,
+                                          10,
+                                          false,
+                                          &err);
+    REQUIRE(rows.empty());
+
+    // an earlier quarter completes the window of the rows after it
+    REQUIRE(database.add_finances(
+        "ACME", "2024-Q1", make_payload(200, 20, 2.0), &err));
+    rows = database.screen_finance_metric("ttm_eps",
+                                          std::nullopt,
+                                          std::nullopt,
+                                          db::Database::SortDir::Asc,
+                                          10,
+                                          false,
+                                          &err);
+    REQUIRE_EQ(rows.size(), std::size_t{1});
+    REQUIRE_EQ(rows.front().period_type, std::string("Q4"));
+    REQUIRE_EQ(rows.front().value, 8.0);
+
+    REQUIRE(database.delete_period("ACME", "2024-Q3", &err));
+    rows = database.screen_finance_metric("roe",
+                                          std::nullopt,
+                                          std::nullopt,
+                                          db::Database::SortDir::Asc,
+                                          10,
+                                          false,
+                                          &err);
+    REQUIRE_EQ(rows.size(), std::size_t{3});
+    rows = database.screen_finance_metric("ttm_eps",
+                                          std::nullopt,
+                                          std::nullopt,
+                                          db::Database::SortDir::Asc,
+                                          10,
+                                          false,
+                                          &err);
+    REQUIRE(rows.empty());
+}
+
+TEST_CASE("database screen_finance_metric filters, orders and limits")
+{
+    test::TempDir temp;
+    db::Database database;
+    open_test_db(database, temp.path());
+
+    std::string err;
+    REQUIRE(database.add_finances(
+        "LOW", "2024-Y", make_payload(100, 5, 1.0), &err));
+    REQUIRE(database.add_finances(
+        "MID", "2023-Y", make_payload(100, 90, 1.0), &err));
+    REQUIRE(database.add_finances(
+        "MID", "2024-Y", make_payload(100, 10, 1.0), &err));
+    REQUIRE(database.add_finances(
+        "TOP", "2024-Y", make_payload(100, 50, 1.0), &err));
+
+    auto rows = database.screen_finance_metric("net_margin",
+                                               0.08,
+                                               std::nullopt,
+                                               db::Database::SortDir::Desc,
+                                               10,
+                                               false,
+                                               &err);
+    REQUIRE(err.empty());
+    REQUIRE_EQ(rows.size(), std::size_t{3});
+    REQUIRE_EQ(rows[0].ticker, std::string("MID"));
+    REQUIRE_EQ(rows[0].year, 2023);
+    REQUIRE_EQ(rows[1].ticker, std::string("TOP"));
+    REQUIRE_EQ(rows[2].ticker, std::string("MID"));
+
+    rows = database.screen_finance_metric("net_margin",
+                                          0.08,
+                                          std::nullopt,
+                                          db::Database::SortDir::Desc,
+                                          10,
+                                          true,
+                                          &err);
+    REQUIRE_EQ(rows.size(), std::size_t{2});
+    REQUIRE_EQ(rows[0].ticker, std::string("TOP"));
+    REQUIRE_EQ(rows[1].ticker, std::string("MID"));
+    REQUIRE_EQ(rows[1].year, 2024);
+
+    rows = database.screen_finance_metric("net_margin",
+                                          std::nullopt,
+                                          0.2,
+                                          db::Database::SortDir::Asc,
+                                          1,
+                                          false,
+                                          &err);
+    REQUIRE_EQ(rows.size(), std::size_t{1});
+    REQUIRE_EQ(rows[0].ticker, std::string("LOW"));
+
+    err.clear();
+    rows = database.screen_finance_metric("price; DROP TABLE finances",
+                                          std::nullopt,
+                                          std::nullopt,
+                                          db::Database::SortDir::Asc,
+                                          10,
+                                          false,
+                                          &err);
+    REQUIRE(rows.empty());
+    REQUIRE_CONTAINS(err, "unknown metric");
+}
+
+TEST_CASE("database rebuilds finance_metrics when the table is new")
+{
+    test::TempDir temp;
+    std::filesystem::path db_path;
+    {
+        db::Database database;
+        open_test_db(database, temp.path());
+        std::string err;
+        REQUIRE(database.add_finances(
+            "OLD", "2023-Y", make_payload(100, 25, 1.0), &err));
+        db_path = database.path();
+    }
+
+    sqlite3* raw = nullptr;
+    REQUIRE(sqlite3_open(db_path.string().c_str(), &raw) == SQLITE_OK);
+    REQUIRE(sqlite3_exec(raw,
+                         "DROP TABLE finance_metrics;",
+                         nullptr,
+                         nullptr,
+                         nullptr) == SQLITE_OK);
+    sqlite3_close(raw);
+
+    db::Database reopened;
+    open_test_db(reopened, temp.path());
+
+    std::string err;
+    const auto rows =
+        reopened.screen_finance_metric("net_margin",
+                                       std::nullopt,
+                                       std::nullopt,
+                                       db::Database::SortDir::Asc,
+                                       10,
+                                       false,
+                                       &err);
+    REQUIRE(err.empty());
+    REQUIRE_EQ(rows.size(), std::size_t{1});
+    REQUIRE_EQ(rows[0].value, 0.25);
+}
+
+TEST_CASE("database moves a ticker's generation on each of its writes")
+{
+    test::TempDir temp;
+    db::Database database;
+    open_test_db(database, temp.path());
+    std::string err;
+    REQUIRE(database.add_finances(
+        "AAA", "2023-Y", make_payload(100, 25, 1.0), &err));
+    REQUIRE(database.add_finances(
+        "BBB", "2023-Y", make_payload(100, 25, 1.0), &err));
+
+    const auto generation = [&](const char* ticker) {
+        return database.get_ticker_generation(ticker, &err).value_or(0);
+    };
+    const auto first = generation("AAA");
+    const auto other = generation("BBB");
+    REQUIRE(other > first);
+
+    REQUIRE(database.add_finances(
+        "AAA", "2024-Y", make_payload(100, 25, 1.0), &err));
+    const auto added = generation("AAA");
+    REQUIRE(added > first);
+    REQUIRE(database.toggle_ticker_portfolio("AAA", &err));
+    const auto toggled = generation("AAA");
+    REQUIRE(toggled > added);
+    REQUIRE(database.delete_period("AAA", "2023-Y", &err));
+    REQUIRE(generation("AAA") > toggled);
+    REQUIRE_EQ(generation("BBB"), other);
+
+    const auto last = generation("AAA");
+    REQUIRE(database.delete_period("AAA", "2024-Y", &err));
+    REQUIRE(!database.get_ticker_generation("AAA", &err).has_value());
+    REQUIRE(err.empty());
+
+    // re-created in the same second: still past the deleted one
+    REQUIRE(database.add_finances(
+        "AAA", "2023-Y", make_payload(100, 25, 1.0), &err));
+    REQUIRE(generation("AAA") > last);
+}
+
+TEST_CASE("database reports exactly the tickers other connections wrote")
+{
+    test::TempDir temp;
+    db::Database left;
+    db::Database right;
+    open_test_db(left, temp.path());
+    open_test_db(right, temp.path());
+    std::string err;
+    REQUIRE(left.poll_external_changes(&err).empty());
+
+    REQUIRE(right.add_finances(
+        "BBB", "2024-Y", make_payload(100, 25, 1.0), &err));
+    REQUIRE(right.add_finances(
+        "AAA", "2024-Y", make_payload(100, 25, 1.0), &err));
+    REQUIRE(right.add_prices("CCC", {{19000, 1.0}, {19001, 2.0}}, &err));
+    // its own writes are not news to the writer
+    REQUIRE(right.poll_external_changes(&err).empty());
+
+    const auto write_generation = left.write_generation();
+    const auto price_generation = left.price_generation();
+    auto changes = left.poll_external_changes(&err);
+    REQUIRE(err.empty());
+    REQUIRE(changes.tickers == std::vector<std::string>({"AAA", "BBB"}));
+    REQUIRE(changes.prices == std::vector<std::string>({"CCC"}));
+    REQUIRE(left.write_generation() > write_generation);
+    REQUIRE(left.price_generation() > price_generation);
+    REQUIRE(left.poll_external_changes(&err).empty());
+
+    // holdings, toggles and deletes count; the reader's own write does not
+    REQUIRE(right.set_holding("AAA", 10.0, 100.0, &err));
+    REQUIRE(right.toggle_ticker_portfolio("BBB", &err));
+    REQUIRE(right.delete_period("BBB", "2024-Y", &err));
+    changes = left.poll_external_changes(&err);
+    REQUIRE(changes.tickers == std::vector<std::string>({"AAA", "BBB"}));
+    REQUIRE(changes.prices.empty());
+    REQUIRE(left.add_finances(
+        "DDD", "2024-Y", make_payload(100, 25, 1.0), &err));
+    REQUIRE(right.poll_external_changes(&err).tickers ==
+            std::vector<std::string>({"DDD"}));
+}
+
+TEST_CASE("database change log records op, ticker and period since a seq")
+{
+    test::TempDir temp;
+    db::Database database;
+    open_test_db(database, temp.path());
+    std::string err;
+    const auto start = database.changes_since(0, 100, &err).latest_seq;
+
+    REQUIRE(database.add_finances(
+        "AAA", "2024-Y", make_payload(100, 25, 1.0), &err));
+    REQUIRE(database.add_finances(
+        "AAA", "2024-Y", make_payload(200, 25, 1.0), &err));
+    REQUIRE(database.add_prices("AAA", {{19000, 1.0}, {19001, 2.0}}, &err));
+    REQUIRE(database.delete_period("AAA", "2024-Y", &err));
+
+    const auto set = database.changes_since(start, 100, &err);
+    REQUIRE(err.empty());
+    REQUIRE(!set.truncated);
+    std::vector<std::string> seen;
+    for (const auto& c : set.changes) {
+        REQUIRE_EQ(c.ticker, std::string("AAA"));
+        std::string text = c.op + " " + c.source;
+        if (c.year.has_value())
+            text += " " + std::to_string(*c.year) + "-" + c.period_type;
+        seen.push_back(text);
+    }
+    REQUIRE(seen == std::vector<std::string>({
+                        "insert tickers",
+                        "insert finances 2024-Y",
+                        "update tickers",
+                        "update finances 2024-Y",
+                        "upsert prices",
+                        // the cascade runs before the ticker's trigger
+                        "delete finances 2024-Y",
+                        "delete tickers",
+                    }));
+    REQUIRE_EQ(set.latest_seq, set.changes.back().seq);
+    REQUIRE(std::is_sorted(
+        set.changes.begin(),
+        set.changes.end(),
+        [](const auto& a, const auto& b) { return a.seq < b.seq; }));
+
+    // paged by the consumer's own watermark
+    const auto page = database.changes_since(start, 2, &err);
+    REQUIRE_EQ(page.changes.size(), std::size_t{2});
+    REQUIRE_EQ(
+        database.changes_since(page.changes.back().seq, 100, &err)
+            .changes.size(),
+        std::size_t{5});
+}
+
+TEST_CASE("database compacts change log entries every consumer processed")
+{
+    test::TempDir temp;
+    db::Database database;
+    db::Database other;
+    open_test_db(database, temp.path());
+    open_test_db(other, temp.path());
+    database.set_change_log_retention(2, 6);
+    std::string err;
+
+    const auto log_prices = [&](int n) {
+        for (int i = 0; i < n; ++i) {
+            REQUIRE(database.add_prices("AAA", {{19000 + i, 1.0}}, &err));
+        }
+    };
+    log_prices(4);
+    const auto first = database.changes_since(0, 100, &err);
+    REQUIRE_EQ(first.changes.size(), std::size_t{4});
+
+    // a consumer pins what it has not processed
+    REQUIRE(database.ack_changes("export", first.changes[0].seq, &err));
+    REQUIRE_EQ(database.get_change_watermark("export", &err).value_or(-1),
+               first.changes[0].seq);
+    REQUIRE_EQ(database.changes_since(0, 100, &err).changes.size(),
+               std::size_t{3});
+    REQUIRE(database.changes_since(0, 100, &err).truncated);
+    REQUIRE(!database.changes_since(first.changes[0].seq, 100, &err)
+                 .truncated);
+
+    // watermarks only move forward; processed entries past the newest
+    // two go
+    REQUIRE(database.ack_changes("export", 0, &err));
+    REQUIRE(database.ack_changes("export", first.latest_seq, &err));
+    REQUIRE_EQ(database.changes_since(0, 100, &err).changes.size(),
+               std::size_t{2});
+
+    // a consumer that stopped acknowledging is cut off at the cap
+    log_prices(10);
+    REQUIRE(database.ack_changes("other", first.latest_seq, &err));
+    REQUIRE_EQ(database.changes_since(0, 100, &err).changes.size(),
+               std::size_t{6});
+    REQUIRE(database.changes_since(first.latest_seq, 100, &err).truncated);
+
+    // a session that missed compacted entries reloads everything
+    REQUIRE(database.drop_change_consumer("other", &err));
+    REQUIRE(!database.get_change_watermark("other", &err).has_value());
+    const auto generation = other.price_generation();
+    const auto missed = other.poll_external_changes(&err);
+    REQUIRE(err.empty());
+    REQUIRE(missed.truncated);
+    REQUIRE(!missed.empty());
+    REQUIRE(other.price_generation() > generation);
+}
@@ -0,0 +1,124 @@
+#include "metrics/finance_store.hpp"
+#include "metrics/metric_math.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace {
+
+using Row = db::Database::FinanceRow;
+
+metrics::F64Column f64_column(const std::vector<std::optional<double>>& v)
+{
+    metrics::F64Column c(v.size());
+    for (std::size_t i = 0; i < v.size(); ++i) c.set(i, v[i]);
+    return c;
+}
+
+// Same value or both null; NaN never reaches a valid slot.
+bool same(std::optional<double> a, std::optional<double> b)
+{
+    if (a.has_value() != b.has_value()) return false;
+    return !a.has_value() || *a == *b;
+}
+
+const metrics::KernelIsa kIsas[] = {metrics::KernelIsa::Scalar,
+                                    metrics::KernelIsa::Avx2};
+
+} // namespace
+
+TEST_CASE("finance store lays rows out per field with validity bits")
+{
+    const std::vector<Row> rows = {
+        test::finance_row(2023, "Y").revenue(100).net_income(10).eps(1.0),
+        test::finance_row(2024, "Y").net_income(20),
+        test::finance_row(2025, "Y").revenue(300).eps(3.0),
+    };
+    const metrics::FinanceStore store(rows);
+
+    REQUIRE_EQ(store.size(), std::size_t{3});
+    REQUIRE_EQ(store.years()[2], 2025);
+    REQUIRE_EQ(store.period_types()[0], std::string("Y"));
+
+    const auto& revenue = store.column(&Row::revenue);
+    REQUIRE_EQ(revenue.at(0), std::optional<std::int64_t>(100));
+    REQUIRE(!revenue.at(1).has_value());
+    REQUIRE_EQ(revenue.valid.count(), std::size_t{2});
+
+    REQUIRE_EQ(store.column(&Row::net_income).valid.count(), std::size_t{2});
+    REQUIRE(!store.column(&Row::total_debt).valid.test(0));
+    REQUIRE(!store.eps().at(1).has_value());
+    REQUIRE(store.bytes() > 0);
+
+    // net margin over whole columns, nulls from either side drop out
+    const auto net_income = metrics::to_f64(store.column(&Row::net_income));
+    const auto margin =
+        metrics::div_opt_nonzero(net_income, metrics::to_f64(revenue));
+    REQUIRE_EQ(margin.at(0), std::optional<double>(0.1));
+    REQUIRE(!margin.at(1).has_value());
+    REQUIRE(!margin.at(2).has_value());
+}
+
+TEST_CASE("finance store kernels match the scalar helpers on every isa")
+{
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+    const double nan = std::nan("");
+
+    // odd length, so both the vector body and the scalar tail run
+    const std::vector<std::optional<double>> a = {
+        1.5, -2.0, 0.0, 4.0, std::nullopt, kInf, -3.0, 7.0, 9.0, nan, -0.5,
+    };
+    const std::vector<std::optional<double>> b = {
+        3.0, -4.0, 2.0, 0.0, 1.0, 2.0, 1.5, std::nullopt, -kInf, 1.0, -0.25,
+    };
+    const auto ca = f64_column(a);
+    const auto cb = f64_column(b);
+
+    for (const auto isa : kIsas) {
+        const auto div = metrics::div_opt_nonzero(ca, cb, isa);
+        const auto pct = metrics::percent_change(ca, cb, isa);
+        const auto ratio = metrics::ratio_percent_change(ca, cb, isa);
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            REQUIRE(same(div.at(i), metrics::div_opt_nonzero(a[i], b[i])));
+            REQUIRE(same(pct.at(i), metrics::percent_change(a[i], b[i])));
+            REQUIRE(same(ratio.at(i),
+                         metrics::ratio_percent_change(a[i], b[i])));
+        }
+    }
+
+    metrics::I64Column x(9);
+    metrics::I64Column y(9);
+    for (std::size_t i = 0; i < 9; ++i) {
+        x.set(i, static_cast<std::int64_t>(i) * 1000);
+        if (i % 3 != 0) y.set(i, -static_cast<std::int64_t>(i));
+    }
+    for (const auto isa : kIsas) {
+        const auto sum = metrics::add_i64(x, y, isa);
+        const auto diff = metrics::sub_i64(x, y, isa);
+        for (std::size_t i = 0; i < 9; ++i) {
+            REQUIRE_EQ(sum.at(i), metrics::add_i64(x.at(i), y.at(i)));
+            REQUIRE_EQ(diff.at(i), metrics::sub_i64(x.at(i), y.at(i)));
+        }
+    }
+
+    REQUIRE_THROWS(metrics::div_opt_nonzero(ca, f64_column({1.0})));
+}
+
+TEST_CASE("finance store gather lines columns up by row index")
+{
+    const auto values = f64_column({10.0, std::nullopt, 30.0});
+    const auto shifted = metrics::gather(values, {-1, 0, 1, 2, 7});
+
+    REQUIRE_EQ(shifted.size(), std::size_t{5});
+    REQUIRE(!shifted.at(0).has_value());
+    REQUIRE_EQ(shifted.at(1), std::optional<double>(10.0));
+    REQUIRE(!shifted.at(2).has_value());
+    REQUIRE_EQ(shifted.at(3), std::optional<double>(30.0));
+    REQUIRE(!shifted.at(4).has_value());
+}
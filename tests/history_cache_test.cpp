@@ -0,0 +1,144 @@
+#include "db/database.hpp"
+#include "db/history_cache.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+#include "views/settings/view_settings.hpp"
+#include "views/ticker/view_ticker.hpp"
+
+#include <optional>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+TEST_CASE("history cache serves repeat loads without touching sqlite")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+    sandbox.add_finance("AAA", "2025-Y");
+
+    db::HistoryCache cache;
+    std::string err;
+    const auto first = cache.load(sandbox.database, "AAA", &err);
+    REQUIRE(first != nullptr);
+    REQUIRE(err.empty());
+    REQUIRE_EQ(first->rows.size(), std::size_t{2});
+    REQUIRE_EQ(cache.misses(), std::uint64_t{1});
+
+    const auto second = cache.load(sandbox.database, "AAA", &err);
+    REQUIRE(second.get() == first.get());
+    REQUIRE_EQ(cache.hits(), std::uint64_t{1});
+    REQUIRE_EQ(cache.size(), std::size_t{1});
+    REQUIRE_EQ(cache.bytes(), first->bytes);
+}
+
+TEST_CASE("history cache reloads after a finances write")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+
+    db::HistoryCache cache;
+    const auto before = cache.load(sandbox.database, "AAA");
+    REQUIRE(before != nullptr);
+    REQUIRE_EQ(before->rows.size(), std::size_t{1});
+
+    const auto generation = sandbox.database.write_generation();
+    sandbox.add_finance("AAA", "2025-Y");
+    REQUIRE(sandbox.database.write_generation() > generation);
+
+    const auto after = cache.load(sandbox.database, "AAA");
+    REQUIRE(after != nullptr);
+    REQUIRE_EQ(after->rows.size(), std::size_t{2});
+    REQUIRE_EQ(cache.misses(), std::uint64_t{2});
+    REQUIRE_EQ(cache.size(), std::size_t{1});
+
+    std::string err;
+    REQUIRE(sandbox.database.delete_period("AAA", "2024-Y", &err));
+    REQUIRE_EQ(cache.load(sandbox.database, "AAA")->rows.size(),
+               std::size_t{1});
+}
+
+TEST_CASE("history cache carries unchanged entries over a generation move")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+    sandbox.add_finance("BBB", "2024-Y");
+
+    db::HistoryCache cache;
+    const auto kept = cache.load(sandbox.database, "AAA");
+    REQUIRE(cache.load(sandbox.database, "BBB") != nullptr);
+
+    const auto from = sandbox.database.write_generation();
+    cache.carry_over(from, from + 1, {"BBB"});
+    REQUIRE(cache.has_current("AAA", from + 1));
+    REQUIRE(!cache.has_current("AAA", from));
+    REQUIRE_EQ(cache.size(), std::size_t{1});
+    REQUIRE_EQ(cache.bytes(), kept->bytes);
+}
+
+TEST_CASE("history cache evicts least recently used entries over budget")
+{
+    test::AppSandbox sandbox;
+    for (const char* t : {"AAA", "BBB", "CCC"}) {
+        sandbox.add_finance(t, "2024-Y");
+    }
+
+    db::HistoryCache cache;
+    const auto probe = cache.load(sandbox.database, "AAA");
+    REQUIRE(probe != nullptr);
+
+    // room for exactly two entries of this shape
+    cache.set_budget_bytes(probe->bytes * 2);
+    cache.load(sandbox.database, "BBB");
+    cache.load(sandbox.database, "AAA"); // AAA is now most recent
+    cache.load(sandbox.database, "CCC"); // evicts BBB
+    REQUIRE_EQ(cache.size(), std::size_t{2});
+    REQUIRE(cache.bytes() <= cache.budget_bytes());
+
+    const auto misses = cache.misses();
+    cache.load(sandbox.database, "AAA");
+    REQUIRE_EQ(cache.misses(), misses);
+    cache.load(sandbox.database, "BBB");
+    REQUIRE_EQ(cache.misses(), misses + 1);
+
+    cache.set_budget_bytes(0);
+    REQUIRE_EQ(cache.size(), std::size_t{0});
+    REQUIRE_EQ(cache.bytes(), std::size_t{0});
+    REQUIRE(cache.load(sandbox.database, "AAA") != nullptr);
+    REQUIRE_EQ(cache.size(), std::size_t{0});
+    REQUIRE_CONTAINS(views::history_cache_status_line(cache), "off");
+}
+
+TEST_CASE("history cache precomputes the TTM sums the ticker view shows")
+{
+    test::AppSandbox sandbox;
+    for (const char* p : {"2024-Q1", "2024-Q2", "2024-Q3", "2024-Q4"}) {
+        sandbox.add_finance("QQQ", p, test::standard_payload(100, 10, 0.5));
+    }
+    sandbox.add_finance("QQQ", "2024-Y");
+
+    db::HistoryCache cache;
+    const auto history = cache.load(sandbox.database, "QQQ");
+    REQUIRE(history != nullptr);
+    REQUIRE_EQ(history->ttm.size(), history->rows.size());
+
+    sandbox.app.ticker_view.reset(history);
+    const auto& view = sandbox.app.ticker_view;
+    REQUIRE_EQ(view.ticker, std::string("QQQ"));
+    for (std::size_t i = 0; i < view.all_rows.size(); ++i) {
+        const auto& row = view.all_rows[i];
+        const auto cached = views::ticker_ttm_for_row(view, row);
+        const auto direct =
+            metrics::ttm_at(view.all_rows, static_cast<int>(i));
+        REQUIRE_EQ(cached.eps.has_value(), direct.eps.has_value());
+        REQUIRE_EQ(cached.net_income, direct.net_income);
+        REQUIRE_EQ(cached.cash_flow_ops, direct.cash_flow_ops);
+    }
+
+    const int q4 = views::find_period_index(view.all_rows, "2024-Q4");
+    REQUIRE(q4 >= 0);
+    REQUIRE_EQ(history->ttm[static_cast<std::size_t>(q4)].net_income,
+               std::optional<double>(40.0));
+    const int q3 = views::find_period_index(view.all_rows, "2024-Q3");
+    REQUIRE(!history->ttm[static_cast<std::size_t>(q3)].net_income);
+}
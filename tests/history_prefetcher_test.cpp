@@ -0,0 +1,113 @@
+#include "db/history_cache.hpp"
+#include "db/history_prefetcher.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+#include "views/home/view_home.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+TEST_CASE("history prefetcher decodes wanted tickers off the ui thread")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+    sandbox.add_finance("BBB", "2024-Y");
+    sandbox.add_finance("BBB", "2025-Y");
+
+    db::HistoryPrefetcher prefetcher;
+    db::HistoryCache cache;
+    prefetcher.want(sandbox.database, {"AAA", "BBB", "MISSING"});
+    prefetcher.wait_idle();
+
+    REQUIRE_EQ(prefetcher.drain(cache, sandbox.database), std::size_t{3});
+    const auto generation = sandbox.database.write_generation();
+    REQUIRE(cache.has_current("AAA", generation));
+    REQUIRE(cache.has_current("BBB", generation));
+
+    const auto bbb = cache.load(sandbox.database, "BBB");
+    REQUIRE(bbb != nullptr);
+    REQUIRE_EQ(bbb->rows.size(), std::size_t{2});
+    REQUIRE_EQ(cache.misses(), std::uint64_t{0});
+    REQUIRE_EQ(cache.hits(), std::uint64_t{1});
+}
+
+TEST_CASE("history prefetcher drops decodes made stale by a write")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+
+    db::HistoryPrefetcher prefetcher;
+    db::HistoryCache cache;
+    prefetcher.want(sandbox.database, {"AAA"});
+    prefetcher.wait_idle();
+
+    sandbox.add_finance("AAA", "2025-Y");
+    REQUIRE_EQ(prefetcher.drain(cache, sandbox.database), std::size_t{0});
+    REQUIRE_EQ(cache.size(), std::size_t{0});
+
+    const auto fresh = cache.load(sandbox.database, "AAA");
+    REQUIRE(fresh != nullptr);
+    REQUIRE_EQ(fresh->rows.size(), std::size_t{2});
+}
+
+TEST_CASE("history prefetcher close releases the file and recovers on want")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+
+    db::HistoryPrefetcher prefetcher;
+    db::HistoryCache cache;
+    prefetcher.want(sandbox.database, {"AAA"});
+    prefetcher.close();
+    prefetcher.drain(cache, sandbox.database);
+
+    prefetcher.want(sandbox.database, {"AAA"});
+    prefetcher.wait_idle();
+    prefetcher.drain(cache, sandbox.database);
+    REQUIRE(cache.has_current("AAA", sandbox.database.write_generation()));
+}
+
+TEST_CASE("key_home selection moves retarget the history prefetch")
+{
+    test::AppSandbox sandbox;
+    for (const char* t : {"AAA", "BBB", "CCC", "DDD"}) {
+        sandbox.add_finance(t, "2024-Y");
+    }
+
+    db::HistoryPrefetcher prefetcher;
+    auto& app = sandbox.app;
+    app.prefetcher = &prefetcher;
+    app.settings.sort_key = db::Database::TickerSortKey::Ticker;
+    app.settings.sort_dir = db::Database::SortDir::Asc;
+
+    std::string err;
+    app.tickers.last_rows = views::fetch_page(app, 0, &err);
+    REQUIRE(err.empty());
+    app.tickers.selected = 1;
+
+    // single column grid in tests: the selection, then below and above
+    REQUIRE_EQ(views::home_history_prefetch_targets(app),
+               (std::vector<std::string>{"BBB", "CCC", "AAA"}));
+
+    views::pump_home_history_prefetch(app);
+    REQUIRE_EQ(app.tickers.history_prefetch.size(), std::size_t{3});
+    prefetcher.wait_idle();
+
+    REQUIRE(views::handle_key_home(app, KEY_DOWN));
+    views::pump_home_history_prefetch(app);
+    REQUIRE_EQ(app.tickers.history_prefetch.front(), std::string("CCC"));
+    prefetcher.wait_idle();
+    views::pump_home_history_prefetch(app);
+
+    const auto generation = app.db->write_generation();
+    for (const char* t : {"AAA", "BBB", "CCC", "DDD"}) {
+        REQUIRE(app.history_cache.has_current(t, generation));
+    }
+
+    REQUIRE(views::handle_key_home(app, '\n'));
+    REQUIRE_EQ(app.current, views::ViewId::Ticker);
+    REQUIRE_EQ(app.ticker_view.ticker, std::string("CCC"));
+    REQUIRE_EQ(app.history_cache.misses(), std::uint64_t{0});
+}
@@ -4,10 +4,13 @@
 #include "views/add/view_add.hpp"
 #include "views/help/view_help.hpp"
 #include "views/home/view_home.hpp"
+#include "views/matrix/view_matrix.hpp"
 #include "views/settings/view_settings.hpp"
+#include "views/sweep/view_sweep.hpp"
 #include "views/ticker/view_ticker.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <string>
 
@@ -46,6 +49,68 @@ TEST_CASE("key_home search flow transitions into ticker view")
     REQUIRE_EQ(sandbox.app.ticker_view.ticker_type, 1);
 }
 
+TEST_CASE("key_home search updates results on every keystroke")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAPL", "2024-Y");
+    sandbox.add_finance("AAL", "2024-Y");
+    sandbox.add_finance("MSFT", "2024-Y");
+
+    REQUIRE(views::handle_key_home(sandbox.app, ' '));
+    REQUIRE(views::handle_key_home(sandbox.app, 'a'));
+    REQUIRE_EQ(sandbox.app.tickers.search_submitted_query, std::string("A"));
+    REQUIRE_EQ(sandbox.app.tickers.search_rows.size(), std::size_t{2});
+
+    REQUIRE(views::handle_key_home(sandbox.app, 'a'));
+    REQUIRE(views::handle_key_home(sandbox.app, 'p'));
+    // AAPL by prefix, then AAL one edit away
+    REQUIRE_EQ(sandbox.app.tickers.search_rows.size(), std::size_t{2});
+    REQUIRE_EQ(sandbox.app.tickers.search_rows[0].ticker, std::string("AAPL"));
+    REQUIRE_EQ(sandbox.app.tickers.search_rows[1].ticker, std::string("AAL"));
+
+    REQUIRE(views::handle_key_home(sandbox.app, 127));
+    REQUIRE_EQ(sandbox.app.tickers.search_submitted_query, std::string("AA"));
+    REQUIRE_EQ(sandbox.app.tickers.search_rows.size(), std::size_t{2});
+
+    // typing after results keeps extending the query
+    REQUIRE(views::handle_key_home(sandbox.app, 'l'));
+    REQUIRE_EQ(sandbox.app.tickers.search_query, std::string("AAL"));
+    REQUIRE_EQ(sandbox.app.tickers.search_rows.front().ticker,
+               std::string("AAL"));
+
+    REQUIRE(views::handle_key_home(sandbox.app, '\n'));
+    REQUIRE_EQ(sandbox.app.current, views::ViewId::Ticker);
+    REQUIRE_EQ(sandbox.app.ticker_view.ticker, std::string("AAL"));
+}
+
+TEST_CASE("key_home search pages through results beyond one grid")
+{
+    test::AppSandbox sandbox;
+    for (int i = 0; i < 40; ++i) {
+        sandbox.add_finance("X" + std::to_string(100 + i), "2024-Y");
+    }
+
+    REQUIRE(views::handle_key_home(sandbox.app, ' '));
+    REQUIRE(views::handle_key_home(sandbox.app, 'x'));
+    REQUIRE_EQ(sandbox.app.tickers.search_results.size(), std::size_t{40});
+    REQUIRE_EQ(sandbox.app.tickers.search_rows.size(),
+               static_cast<std::size_t>(views::kHomeSearchLimit));
+    REQUIRE_EQ(views::home_search_page_count(sandbox.app), 3);
+
+    views::show_home_search_page(sandbox.app, 2);
+    REQUIRE_EQ(sandbox.app.tickers.search_page, 2);
+    REQUIRE_EQ(sandbox.app.tickers.search_rows.size(), std::size_t{10});
+    REQUIRE_EQ(sandbox.app.tickers.search_rows.front().ticker,
+               std::string("X130"));
+
+    // past the last page clamps instead of showing an empty grid
+    views::show_home_search_page(sandbox.app, 9);
+    REQUIRE_EQ(sandbox.app.tickers.search_page, 2);
+
+    REQUIRE(views::handle_key_home(sandbox.app, '1'));
+    REQUIRE_EQ(sandbox.app.tickers.search_page, 0);
+}
+
 TEST_CASE("key_home enforces search length limit and exits search mode")
 {
     test::AppSandbox sandbox;
@@ -111,6 +176,52 @@ TEST_CASE("key_home p toggles selected ticker portfolio membership")
     REQUIRE(none.empty());
 }
 
+TEST_CASE("key_home p patches the in-memory ticker index")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAPL", "2024-Y");
+    sandbox.add_finance("MSFT", "2024-Y");
+
+    std::string err;
+    sandbox.app.tickers.last_rows = views::fetch_page(sandbox.app, 0, &err);
+    REQUIRE(err.empty());
+    REQUIRE(sandbox.app.tickers.index.ready());
+    REQUIRE_EQ(sandbox.app.tickers.index.count(true), std::size_t{0});
+
+    REQUIRE(views::handle_key_home(sandbox.app, 'p'));
+    REQUIRE_EQ(sandbox.app.tickers.index.count(true), std::size_t{1});
+
+    sandbox.app.tickers.portfolio_only = true;
+    const auto rows = views::fetch_page(sandbox.app, 0, &err);
+    REQUIRE(err.empty());
+    REQUIRE_EQ(rows.size(), std::size_t{1});
+    REQUIRE(rows.front().portfolio);
+    REQUIRE_EQ(rows.front().ticker, sandbox.app.tickers.last_rows[0].ticker);
+}
+
+TEST_CASE("key_home enter reopens a ticker from the history cache")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+    auto& app = sandbox.app;
+
+    std::string err;
+    app.tickers.last_rows = views::fetch_page(app, 0, &err);
+    REQUIRE(err.empty());
+
+    REQUIRE(views::handle_key_home(app, '\n'));
+    REQUIRE_EQ(app.current, views::ViewId::Ticker);
+    REQUIRE(app.ticker_view.history != nullptr);
+
+    app.current = views::ViewId::Home;
+    REQUIRE(views::handle_key_home(app, '\n'));
+    REQUIRE_EQ(app.current, views::ViewId::Ticker);
+    REQUIRE_EQ(app.history_cache.hits(), std::uint64_t{1});
+    REQUIRE_EQ(app.history_cache.misses(), std::uint64_t{1});
+    REQUIRE_CONTAINS(views::history_cache_status_line(app.history_cache),
+                     "1 tickers");
+}
+
 TEST_CASE("key_home P toggles portfolio mode and scopes search")
 {
     test::AppSandbox sandbox;
@@ -123,13 +234,14 @@ TEST_CASE("key_home P toggles portfolio mode and scopes search")
 
     sandbox.app.tickers.page = 4;
     sandbox.app.tickers.selected = 3;
-    sandbox.app.tickers.prefetch.valid = true;
+    sandbox.app.tickers.pages.set_key(views::home_page_ring_key(sandbox.app));
+    sandbox.app.tickers.pages.store(4, {});
 
     REQUIRE(views::handle_key_home(sandbox.app, 'P'));
     REQUIRE(sandbox.app.tickers.portfolio_only);
     REQUIRE_EQ(sandbox.app.tickers.page, 0);
     REQUIRE_EQ(sandbox.app.tickers.selected, 0);
-    REQUIRE(!sandbox.app.tickers.prefetch.valid);
+    REQUIRE_EQ(sandbox.app.tickers.pages.size(), std::size_t{0});
 
     const auto rows = views::fetch_page(sandbox.app, 0, &err);
     REQUIRE(err.empty());
@@ -971,12 +1083,108 @@ TEST_CASE("key_ticker minus navigates back home")
     REQUIRE_EQ(sandbox.app.current, views::ViewId::Home);
 }
 
+TEST_CASE("key_ticker m opens the metric matrix and key_matrix scrolls it")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("IBM", "2022-Y");
+    sandbox.add_finance("IBM", "2023-Y");
+    sandbox.add_finance("IBM", "2024-Q1");
+    sandbox.add_finance("IBM", "2024-Y");
+
+    std::string err;
+    auto rows = sandbox.database.get_finances("IBM", &err);
+    REQUIRE(err.empty());
+
+    sandbox.app.ticker_view.reset("IBM", rows);
+    sandbox.app.current = views::ViewId::Ticker;
+
+    REQUIRE(views::handle_key_ticker(sandbox.app, 'm'));
+    REQUIRE_EQ(sandbox.app.current, views::ViewId::Matrix);
+    auto& matrix = sandbox.app.matrix_view;
+    REQUIRE(matrix.matrix != nullptr);
+    REQUIRE_EQ(matrix.matrix->column_count(), std::size_t{4});
+
+    // starts on the newest periods, one column per step or page
+    matrix.visible_columns = 2;
+    REQUIRE(views::handle_key_matrix(sandbox.app, KEY_RIGHT));
+    REQUIRE_EQ(matrix.column, 2);
+    REQUIRE(views::handle_key_matrix(sandbox.app, KEY_LEFT));
+    REQUIRE_EQ(matrix.column, 1);
+    REQUIRE(views::handle_key_matrix(sandbox.app, KEY_PPAGE));
+    REQUIRE_EQ(matrix.column, 0);
+    REQUIRE(views::handle_key_matrix(sandbox.app, KEY_NPAGE));
+    REQUIRE_EQ(matrix.column, 2);
+    REQUIRE(views::handle_key_matrix(sandbox.app, KEY_HOME));
+    REQUIRE_EQ(matrix.column, 0);
+
+    REQUIRE(views::handle_key_matrix(sandbox.app, KEY_DOWN));
+    REQUIRE_EQ(matrix.row, 1);
+    REQUIRE(views::handle_key_matrix(sandbox.app, KEY_UP));
+    REQUIRE(views::handle_key_matrix(sandbox.app, KEY_UP));
+    REQUIRE_EQ(matrix.row, 0);
+
+    // reopening the same history reuses the matrix
+    const auto built = matrix.matrix;
+    REQUIRE(views::handle_key_matrix(sandbox.app, 'm'));
+    REQUIRE_EQ(sandbox.app.current, views::ViewId::Ticker);
+    REQUIRE(views::handle_key_ticker(sandbox.app, 'm'));
+    REQUIRE_EQ(matrix.matrix, built);
+
+    REQUIRE(views::handle_key_matrix(sandbox.app, '-'));
+    REQUIRE_EQ(sandbox.app.current, views::ViewId::Ticker);
+}
+
+TEST_CASE("another session's writes refresh only the tickers they touched")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("IBM", "2023-Y");
+    sandbox.add_finance("IBM", "2024-Y");
+    sandbox.add_finance("AAA", "2024-Y");
+    auto& app = sandbox.app;
+
+    std::string err;
+    auto history = app.history_cache.load(sandbox.database, "IBM", &err);
+    REQUIRE(app.history_cache.load(sandbox.database, "AAA", &err) != nullptr);
+    app.ticker_view.reset(history);
+    app.ticker_view.index = 0; // 2023-Y
+    app.current = views::ViewId::Ticker;
+
+    db::Database other;
+    other.open_or_create();
+    REQUIRE(other.add_finances(
+        "IBM", "2022-Y", test::standard_payload(), &err));
+
+    views::apply_external_changes(app);
+    const auto generation = sandbox.database.write_generation();
+    REQUIRE(app.ticker_view.refresh_pending);
+    REQUIRE(app.history_cache.has_current("AAA", generation));
+    REQUIRE(!app.history_cache.has_current("IBM", generation));
+    REQUIRE_EQ(app.ticker_view.rows.size(), std::size_t{2});
+
+    views::pump_ticker_view_refresh(app);
+    REQUIRE(!app.ticker_view.refresh_pending);
+    REQUIRE_EQ(app.ticker_view.rows.size(), std::size_t{3});
+    REQUIRE_EQ(app.ticker_view.rows[app.ticker_view.index].year, 2023);
+
+    // nothing new: nothing moves
+    views::apply_external_changes(app);
+    REQUIRE_EQ(sandbox.database.write_generation(), generation);
+
+    for (const char* period : {"2022-Y", "2023-Y", "2024-Y"}) {
+        REQUIRE(other.delete_period("IBM", period, &err));
+    }
+    views::apply_external_changes(app);
+    views::pump_ticker_view_refresh(app);
+    REQUIRE_EQ(app.current, views::ViewId::Home);
+}
+
 TEST_CASE("key_settings toggles values persists settings and arms nuke")
 {
     test::AppSandbox sandbox;
 
     sandbox.app.tickers.page = 7;
-    sandbox.app.tickers.prefetch.valid = true;
+    sandbox.app.tickers.pages.set_key(views::home_page_ring_key(sandbox.app));
+    sandbox.app.tickers.pages.store(7, {});
 
     const auto old_sort_key = sandbox.app.settings.sort_key;
     const auto old_sort_dir = sandbox.app.settings.sort_dir;
@@ -987,7 +1195,8 @@ TEST_CASE("key_settings toggles values persists settings and arms nuke")
     REQUIRE(views::handle_key_settings(sandbox.app, 'S'));
     REQUIRE(sandbox.app.settings.sort_key != old_sort_key);
     REQUIRE_EQ(sandbox.app.tickers.page, 0);
-    REQUIRE(!sandbox.app.tickers.prefetch.valid);
+    sandbox.app.tickers.pages.set_key(views::home_page_ring_key(sandbox.app));
+    REQUIRE(sandbox.app.tickers.pages.find(7) == nullptr);
 
     REQUIRE(views::handle_key_settings(sandbox.app, 'O'));
     REQUIRE(sandbox.app.settings.sort_dir != old_sort_dir);
@@ -1064,3 +1273,50 @@ TEST_CASE("key_settings and key_help escape routes back home")
 }
 
 
+
+TEST_CASE("key_ticker g opens the price sweep and key_sweep edits its inputs")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("IBM", "2024-Y");
+
+    std::string err;
+    auto rows = sandbox.database.get_finances("IBM", &err);
+    REQUIRE(err.empty());
+
+    sandbox.app.ticker_view.reset("IBM", rows);
+    sandbox.app.current = views::ViewId::Ticker;
+    sandbox.app.sweep_view.offset = 7;
+
+    REQUIRE(views::handle_key_ticker(sandbox.app, 'g'));
+    REQUIRE_EQ(sandbox.app.current, views::ViewId::Sweep);
+    REQUIRE_EQ(sandbox.app.sweep_view.offset, 0);
+    REQUIRE(!views::ticker_sweep_lines(sandbox.app.ticker_view).empty());
+
+    // typing goes to the ticker view's inputs, so the grid follows it
+    auto& ticker = sandbox.app.ticker_view;
+    REQUIRE(views::handle_key_sweep(sandbox.app, '1'));
+    REQUIRE(views::handle_key_sweep(sandbox.app, '2'));
+    REQUIRE_EQ(ticker.inputs[0], std::string("12"));
+    REQUIRE(views::handle_key_sweep(sandbox.app, KEY_DOWN));
+    REQUIRE(views::handle_key_sweep(sandbox.app, '9'));
+    REQUIRE_EQ(ticker.inputs[1], std::string("9"));
+    REQUIRE(views::handle_key_sweep(sandbox.app, 127));
+    REQUIRE(ticker.inputs[1].empty());
+
+    // the window shifts within the grid and recentres on home
+    auto& sweep = sandbox.app.sweep_view;
+    REQUIRE(views::handle_key_sweep(sandbox.app, KEY_RIGHT));
+    REQUIRE_EQ(sweep.offset, 1);
+    sweep.visible_columns = 200;
+    REQUIRE(views::handle_key_sweep(sandbox.app, KEY_NPAGE));
+    REQUIRE_EQ(sweep.offset, metrics::kSweepHalfSteps);
+    REQUIRE(views::handle_key_sweep(sandbox.app, KEY_HOME));
+    REQUIRE_EQ(sweep.offset, 0);
+    REQUIRE_EQ(views::sweep_first_column(50, 0, 101, 11), 45);
+    REQUIRE_EQ(views::sweep_first_column(50, -50, 101, 11), 0);
+    REQUIRE_EQ(views::sweep_first_column(50, 50, 101, 11), 90);
+
+    REQUIRE(!views::handle_key_sweep(sandbox.app, 'q'));
+    REQUIRE(views::handle_key_sweep(sandbox.app, 27));
+    REQUIRE_EQ(sandbox.app.current, views::ViewId::Ticker);
+}
@@ -0,0 +1,89 @@
+#include "db/history_cache.hpp"
+#include "metrics/finance_metrics.hpp"
+#include "metrics/metric_matrix.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+#include "views/matrix/view_matrix.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace {
+
+const metrics::MetricMatrixRow* find_row(const metrics::MetricMatrix& m,
+                                         const std::string& name)
+{
+    for (std::size_t i = 0; i < m.row_count(); ++i) {
+        if (m.row(i).name == name) return &m.row(i);
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("metric matrix lays out every metric against every period")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y", test::standard_payload(100, 10));
+    sandbox.add_finance("AAA", "2025-Q1", test::standard_payload(40, 2));
+    sandbox.add_finance("AAA", "2025-Y", test::standard_payload(150, 12));
+
+    db::HistoryCache cache;
+    const auto history = cache.load(sandbox.database, "AAA");
+    REQUIRE(history != nullptr);
+    const metrics::MetricMatrix matrix(history->columns, history->yoy);
+
+    REQUIRE_EQ(matrix.column_count(), std::size_t{3});
+    REQUIRE_EQ(matrix.period(0), std::string("2024-Y"));
+    REQUIRE_EQ(matrix.period(2), std::string("2025-Y"));
+    REQUIRE(matrix.bytes() > 0);
+
+    // raw fields come first; empty ones are dropped
+    REQUIRE_EQ(matrix.row(0).name, std::string("current_assets"));
+    REQUIRE(find_row(matrix, "total_deposits") == nullptr);
+
+    const auto* revenue = find_row(matrix, "revenue");
+    REQUIRE(revenue != nullptr);
+    REQUIRE_EQ(revenue->values.at(1), std::optional<double>(40.0));
+    REQUIRE_EQ(revenue->changes.at(2), std::optional<double>(50.0));
+    REQUIRE(!revenue->changes.at(1).has_value());
+
+    const auto* margin = find_row(matrix, "net_margin");
+    REQUIRE(margin != nullptr);
+    REQUIRE_EQ(margin->kind, metrics::MetricKind::Ratio);
+    const auto k = static_cast<std::size_t>(
+        metrics::find_finance_metric("net_margin") -
+        metrics::kFinanceMetricColumns);
+    REQUIRE_EQ(margin->values.at(2), history->yoy.metric_value(k, 2));
+    REQUIRE(find_row(matrix, "eps") != nullptr);
+
+    const metrics::MetricMatrix empty;
+    REQUIRE_EQ(empty.row_count(), std::size_t{0});
+}
+
+TEST_CASE("matrix view windows columns and formats cells by kind")
+{
+    REQUIRE_EQ(views::matrix_visible_columns(10), 1);
+    REQUIRE_EQ(views::matrix_visible_columns(
+                   1 + views::kMatrixLabelWidth + 3 * views::kMatrixCellWidth),
+               3);
+
+    REQUIRE_EQ(views::clamp_matrix_column(-4, 10, 3), 0);
+    REQUIRE_EQ(views::clamp_matrix_column(5, 10, 3), 5);
+    REQUIRE_EQ(views::clamp_matrix_column(10, 10, 3), 7);
+    REQUIRE_EQ(views::clamp_matrix_column(2, 2, 3), 0);
+
+    metrics::MetricMatrixRow row;
+    row.name = "net_margin";
+    row.kind = metrics::MetricKind::Ratio;
+    REQUIRE_EQ(views::format_matrix_value(row, 0.125), std::string("12.50%"));
+    row.name = "leverage";
+    REQUIRE_EQ(views::format_matrix_value(row, 1.5), std::string("1.50"));
+    row.kind = metrics::MetricKind::Amount;
+    REQUIRE_EQ(views::format_matrix_value(row, 2500000.0), std::string("2M"));
+    REQUIRE_EQ(views::format_matrix_value(row, std::nullopt),
+               std::string(views::kNaValue));
+    row.name = "net_income";
+    REQUIRE_EQ(views::matrix_row_label(row), std::string("net income"));
+}
@@ -0,0 +1,202 @@
+#include "db/database.hpp"
+#include "db/metrics_vtab.hpp"
+#include "metrics/finance_metrics.hpp"
+#include "test_harness.hpp"
+#include "test_utils.hpp"
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct MetricRow {
+    std::string ticker;
+    std::string period;
+    std::string metric;
+    double value = 0.0;
+    std::optional<double> yoy;
+};
+
+// Second connection on the app database with only the module registered,
+// the way an external tool would load it.
+class VtabConnection {
+public:
+    explicit VtabConnection(const std::filesystem::path& path)
+    {
+        if (sqlite3_open(path.string().c_str(), &db_) != SQLITE_OK) {
+            throw std::runtime_error("failed to open vtab connection");
+        }
+        db::register_metrics_vtab(db_);
+    }
+
+    ~VtabConnection()
+    {
+        if (db_) sqlite3_close(db_);
+    }
+
+    VtabConnection(const VtabConnection&) = delete;
+    VtabConnection& operator=(const VtabConnection&) = delete;
+
+    std::vector<MetricRow> rows(const std::string& sql)
+    {
+        sqlite3_stmt* st = nullptr;
+        if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &st, nullptr) !=
+            SQLITE_OK) {
+            throw std::runtime_error(sqlite3_errmsg(db_));
+        }
+
+        std::vector<MetricRow> out;
+        int rc = SQLITE_OK;
+        while ((rc = sqlite3_step(st)) == SQLITE_ROW) {
+            const auto text = [&](int col) {
+                return std::string(reinterpret_cast<const char*>(
+                    sqlite3_column_text(st, col)));
+            };
+            MetricRow r;
+            r.ticker = text(0);
+            r.period = text(1);
+            r.metric = text(2);
+            r.value = sqlite3_column_double(st, 3);
+            if (sqlite3_column_type(st, 4) != SQLITE_NULL)
+                r.yoy = sqlite3_column_double(st, 4);
+            out.push_back(std::move(r));
+        }
+        sqlite3_finalize(st);
+        if (rc != SQLITE_DONE) throw std::runtime_error(sqlite3_errmsg(db_));
+        return out;
+    }
+
+    void exec(const char* sql)
+    {
+        if (sqlite3_exec(db_, sql, nullptr, nullptr, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(sqlite3_errmsg(db_));
+        }
+    }
+
+private:
+    sqlite3* db_{nullptr};
+};
+
+db::Database::FinancePayload payload(std::int64_t net_income, double eps)
+{
+    db::Database::FinancePayload p{};
+    p.current_assets = 1000;
+    p.non_current_assets = 5000;
+    p.current_liabilities = 800;
+    p.non_current_liabilities = 2000;
+    p.revenue = 400;
+    p.net_income = net_income;
+    p.eps = eps;
+    return p;
+}
+
+struct MetricsDb {
+    test::TempDir temp;
+    test::ScopedEnvVar xdg_data{"XDG_DATA_HOME", temp.path().string()};
+    test::ScopedEnvVar home{"HOME", (temp.path() / "home").string()};
+    db::Database database;
+
+    MetricsDb()
+    {
+        database.open_or_create();
+        std::string err;
+        if (!database.add_finances("ACME", "2023-Y", payload(40, 2.0), &err) ||
+            !database.add_finances("ACME", "2024-Y", payload(60, 3.0), &err) ||
+            !database.add_finances("BETA", "2024-Y", payload(10, 1.0), &err)) {
+            throw std::runtime_error("seed failed: " + err);
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE("metrics vtab pushes ticker and metric constraints down")
+{
+    MetricsDb fx;
+    VtabConnection conn(fx.database.path());
+
+    const auto rows =
+        conn.rows("SELECT * FROM intrinsic_metrics "
+                  "WHERE ticker = 'ACME' AND metric = 'roe';");
+    REQUIRE_EQ(rows.size(), std::size_t{2});
+    REQUIRE_EQ(rows[0].period, std::string("2023-Y"));
+    REQUIRE_EQ(rows[1].period, std::string("2024-Y"));
+
+    // equity = 6000 - 2800
+    REQUIRE_EQ(rows[0].value, 40.0 / 3200.0);
+    REQUIRE_EQ(rows[1].value, 60.0 / 3200.0);
+    REQUIRE(!rows[0].yoy.has_value());
+    REQUIRE(rows[1].yoy.has_value());
+    REQUIRE(*rows[1].yoy > 49.99 && *rows[1].yoy < 50.01);
+
+    const auto one = conn.rows("SELECT * FROM intrinsic_metrics "
+                               "WHERE ticker = 'ACME' AND period = '2024-Y' "
+                               "AND metric = 'equity';");
+    REQUIRE_EQ(one.size(), std::size_t{1});
+    REQUIRE_EQ(one[0].value, 3200.0);
+    REQUIRE(!one[0].yoy.has_value() || *one[0].yoy == 0.0);
+}
+
+TEST_CASE("metrics vtab streams every non-null metric across tickers")
+{
+    MetricsDb fx;
+    VtabConnection conn(fx.database.path());
+
+    std::string err;
+    std::size_t expected = 0;
+    for (const char* ticker : {"ACME", "BETA"}) {
+        const auto rows = fx.database.get_finances(ticker, &err);
+        for (int i = 0; i < static_cast<int>(rows.size()); ++i) {
+            const auto m = metrics::derive_finance_metrics(rows, i, 1);
+            for (const auto& column : metrics::kFinanceMetricColumns) {
+                if ((m.*column.field).has_value()) expected += 1;
+            }
+        }
+    }
+
+    const auto all = conn.rows("SELECT * FROM intrinsic_metrics;");
+    REQUIRE_EQ(all.size(), expected);
+    REQUIRE_EQ(all.front().ticker, std::string("ACME"));
+    REQUIRE_EQ(all.back().ticker, std::string("BETA"));
+
+    const auto latest = conn.rows("SELECT * FROM intrinsic_metrics "
+                                  "WHERE period = '2024-Y' "
+                                  "AND metric = 'net_margin' "
+                                  "ORDER BY ticker;");
+    REQUIRE_EQ(latest.size(), std::size_t{2});
+    REQUIRE_EQ(latest[0].value, 0.15);
+    REQUIRE_EQ(latest[1].value, 0.025);
+
+    REQUIRE(conn.rows("SELECT * FROM intrinsic_metrics "
+                      "WHERE metric = 'no_such_metric';")
+                .empty());
+    REQUIRE(conn.rows("SELECT * FROM intrinsic_metrics "
+                      "WHERE ticker = 'NOPE';")
+                .empty());
+}
+
+TEST_CASE("metrics vtab can be created as a temp table and sees new writes")
+{
+    MetricsDb fx;
+    VtabConnection conn(fx.database.path());
+    conn.exec("CREATE VIRTUAL TABLE temp.metrics USING intrinsic_metrics;");
+
+    auto rows = conn.rows("SELECT * FROM metrics "
+                          "WHERE ticker = 'BETA' AND metric = 'roe';");
+    REQUIRE_EQ(rows.size(), std::size_t{1});
+
+    std::string err;
+    REQUIRE(fx.database.add_finances(
+        "BETA", "2025-Y", payload(20, 1.0), &err));
+
+    rows = conn.rows("SELECT * FROM metrics "
+                     "WHERE ticker = 'BETA' AND metric = 'roe';");
+    REQUIRE_EQ(rows.size(), std::size_t{2});
+    REQUIRE(rows[1].yoy.has_value());
+    REQUIRE(*rows[1].yoy > 99.99 && *rows[1].yoy < 100.01);
+}
@@ -0,0 +1,172 @@
+#include "metrics/finance_store.hpp"
+#include "metrics/monte_carlo.hpp"
+#include "metrics/work_pool.hpp"
+#include "metrics/yoy_table.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using Row = db::Database::FinanceRow;
+
+bool near(double a, double b, double tolerance = 1e-9)
+{
+    return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+}
+
+} // namespace
+
+TEST_CASE("work pool runs every index once and rethrows task errors")
+{
+    for (const unsigned threads : {1u, 4u}) {
+        metrics::WorkPool pool(threads);
+        REQUIRE_EQ(pool.size(), threads);
+
+        // uneven tasks, so idle workers have to steal
+        std::vector<std::atomic<int>> hits(1000);
+        pool.parallel_for(hits.size(), [&](std::size_t i) {
+            volatile double sink = 0.0;
+            for (std::size_t k = 0; k < (i % 7) * 500; ++k) sink = sink + k;
+            hits[i].fetch_add(1);
+        });
+        for (const auto& h : hits) REQUIRE_EQ(h.load(), 1);
+
+        // reusable, and errors surface after the round
+        std::atomic<int> ran{0};
+        REQUIRE_THROWS(pool.parallel_for(64, [&](std::size_t i) {
+            ran.fetch_add(1);
+            if (i == 3) throw std::runtime_error("boom");
+        }));
+        REQUIRE_EQ(ran.load(), 64);
+        pool.parallel_for(0, [](std::size_t) {});
+    }
+}
+
+TEST_CASE("monte carlo dcf matches the closed form with fixed inputs")
+{
+    metrics::DcfInputs in;
+    in.base = 1000.0;
+    in.shares = 10.0;
+    in.growth = {0.05, 0.0};
+    in.margin = {0.2, 0.0};
+    in.discount = {0.09, 0.0};
+
+    metrics::DcfParams params;
+    params.paths = 5000;
+    params.years = 5;
+
+    // year by year: 200 * 1.05^t / 1.09^t, then a Gordon terminal value
+    double pv = 0.0;
+    double cash = 200.0;
+    for (int t = 1; t <= 5; ++t) {
+        cash *= 1.05;
+        pv += cash / std::pow(1.09, t);
+    }
+    pv += cash * 1.02 / (0.09 - 0.02) / std::pow(1.09, 5);
+    const double expected = pv / 10.0;
+    REQUIRE(near(metrics::dcf_value(in, 0.05, 0.2, 0.09, params), expected));
+
+    metrics::WorkPool pool(2);
+    const auto dist = metrics::simulate_dcf(in, params, pool);
+    REQUIRE_EQ(dist.paths, std::uint64_t{5000});
+    REQUIRE_EQ(dist.quantiles.size(),
+               metrics::DcfDistribution::kQuantileSteps + 1);
+    REQUIRE(near(dist.percentile(0.0), expected));
+    REQUIRE(near(dist.percentile(100.0), expected));
+    REQUIRE(near(dist.mean, expected));
+    REQUIRE_EQ(dist.probability_below(expected - 1.0), 1.0);
+    REQUIRE_EQ(dist.probability_below(expected + 1.0), 0.0);
+}
+
+TEST_CASE("monte carlo dcf is deterministic across thread counts")
+{
+    metrics::DcfInputs in;
+    in.base = 500.0;
+    in.shares = 5.0;
+    in.growth = {0.08, 0.1};
+    in.margin = {0.15, 0.05};
+    in.discount = {0.1, 0.01};
+
+    metrics::DcfParams params;
+    params.paths = 70001; // a ragged last chunk
+
+    metrics::WorkPool one(1);
+    metrics::WorkPool four(4);
+    const auto a = metrics::simulate_dcf(in, params, one);
+    const auto b = metrics::simulate_dcf(in, params, four);
+    REQUIRE_EQ(a.quantiles, b.quantiles);
+    REQUIRE(near(a.mean, b.mean));
+
+    // percentiles rise, and the median splits the paths
+    REQUIRE(a.percentile(10.0) < a.percentile(50.0));
+    REQUIRE(a.percentile(50.0) < a.percentile(90.0));
+    REQUIRE(near(a.probability_below(a.percentile(50.0)), 0.5, 1e-3));
+
+    params.seed += 1;
+    REQUIRE(metrics::simulate_dcf(in, params, one).quantiles != a.quantiles);
+}
+
+TEST_CASE("monte carlo inputs come from yearly history and are cached")
+{
+    const std::vector<Row> rows = {
+        // 10 shares
+        test::finance_row(2021, "Y")
+            .revenue(1000)
+            .cash_flow_from_operations(200)
+            .net_income(100)
+            .eps(10.0),
+        test::finance_row(2022, "Y")
+            .revenue(1100)
+            .cash_flow_from_operations(220)
+            .net_income(110)
+            .eps(11.0),
+        test::finance_row(2023, "Y")
+            .revenue(1210)
+            .cash_flow_from_operations(242)
+            .net_income(121)
+            .eps(12.1),
+        test::finance_row(2024, "Y")
+            .revenue(1331)
+            .cash_flow_from_operations(266)
+            .net_income(133)
+            .eps(13.3),
+    };
+    const metrics::FinanceStore store(rows);
+    const metrics::YoyTable yoy(rows, store, 1);
+
+    const auto in = metrics::dcf_inputs(store, yoy);
+    REQUIRE(in.has_value());
+    REQUIRE_EQ(in->base, 1331.0);
+    REQUIRE(near(in->shares, 10.0));
+    REQUIRE(near(in->growth.mean, 0.1));
+    REQUIRE(in->growth.sd < 1e-9);
+    REQUIRE(near(in->margin.mean, 0.2, 1e-3));
+    REQUIRE(near(in->discount.mean, metrics::kDcfBaseDiscount, 1e-6));
+
+    // two years give one growth observation: not enough
+    const std::vector<Row> short_rows(rows.begin(), rows.begin() + 2);
+    const metrics::FinanceStore short_store(short_rows);
+    REQUIRE(!metrics::dcf_inputs(
+                 short_store, metrics::YoyTable(short_rows, short_store, 1))
+                 .has_value());
+
+    metrics::DcfParams params;
+    params.paths = 2000;
+    metrics::WorkPool pool(1);
+    metrics::DcfCache cache;
+    const auto first = cache.get("ACME", 1, store, yoy, params, pool);
+    REQUIRE(first != nullptr);
+    REQUIRE_EQ(cache.get("ACME", 1, store, yoy, params, pool), first);
+    REQUIRE_EQ(cache.find("ACME", 1, params), first);
+    REQUIRE(cache.find("ACME", 2, params) == nullptr);
+    params.years = 5;
+    REQUIRE(cache.find("ACME", 1, params) == nullptr);
+    REQUIRE_EQ(cache.size(), std::size_t{1});
+}
@@ -0,0 +1,212 @@
+#include "metrics/portfolio.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+#include "views/portfolio/view_portfolio.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+metrics::PortfolioPosition position(const std::string& ticker,
+                                    int type,
+                                    double shares,
+                                    std::optional<double> price,
+                                    std::optional<double> eps)
+{
+    metrics::PortfolioPosition p;
+    p.row.ticker = ticker;
+    p.row.type = type;
+    p.row.shares = shares;
+    p.row.cost_basis = shares * 10.0;
+    p.row.eps = eps;
+    p.price = price;
+    return p;
+}
+
+bool near(std::optional<double> actual, double expected)
+{
+    return actual.has_value() && std::abs(*actual - expected) < 1e-9;
+}
+
+db::Database::FinancePayload bank_payload()
+{
+    db::Database::FinancePayload bank{};
+    bank.total_loans = 3000;
+    bank.goodwill = 100;
+    bank.total_assets = 5000;
+    bank.total_deposits = 4000;
+    bank.total_liabilities = 4500;
+    bank.net_income = 40;
+    bank.eps = 2.0;
+    return bank;
+}
+
+} // namespace
+
+TEST_CASE("portfolio aggregate weighs positions by value")
+{
+    auto bank = position("BANK", 2, 5.0, 40.0, 4.0);
+    bank.row.tbv_per_share = 20.0;
+    auto insurer = position("INSR", 3, 2.0, 50.0, 5.0);
+    insurer.row.combined_ratio = 0.95;
+
+    metrics::PortfolioAggregate aggregate;
+    aggregate.reset({position("STD", 1, 10.0, 20.0, 2.0),
+                     bank,
+                     insurer,
+                     position("NOPX", 1, 1.0, std::nullopt, 1.0),
+                     position("WATCH", 1, 0.0, 9.0, 1.0)});
+
+    const auto& totals = aggregate.totals();
+    REQUIRE_EQ(totals.held, 4);
+    REQUIRE_EQ(totals.unpriced, 1);
+    REQUIRE(near(totals.value, 500.0));
+    // (20 + 20 + 10) earned on 500
+    REQUIRE(near(totals.earnings_yield(), 0.1));
+    REQUIRE(near(totals.price_earnings(), 10.0));
+    REQUIRE(near(totals.bank_price_tbv(), 2.0));
+    REQUIRE(near(totals.insurer_combined_ratio(), 0.95));
+    REQUIRE(near(totals.exposure(1), 0.4));
+    REQUIRE(near(totals.exposure(2), 0.4));
+    REQUIRE(!totals.exposure(4).has_value());
+    REQUIRE_EQ(aggregate.position(0).row.ticker, std::string("BANK"));
+
+    // one re-priced position gives the totals a fresh build would
+    REQUIRE(aggregate.update_price("STD", 30.0));
+    REQUIRE(aggregate.update_price("NOPX", 5.0));
+    REQUIRE(!aggregate.update_price("ZZZ", 1.0));
+    metrics::PortfolioAggregate fresh;
+    fresh.reset({position("STD", 1, 10.0, 30.0, 2.0),
+                 bank,
+                 insurer,
+                 position("NOPX", 1, 1.0, 5.0, 1.0)});
+    REQUIRE(near(totals.value, fresh.totals().value));
+    REQUIRE(near(totals.earnings_yield(), *fresh.totals().earnings_yield()));
+    REQUIRE(near(totals.exposure(3), *fresh.totals().exposure(3)));
+    REQUIRE_EQ(totals.unpriced, 0);
+
+    for (const char* ticker : {"STD", "BANK", "INSR", "NOPX"}) {
+        aggregate.erase(ticker);
+    }
+    REQUIRE_EQ(aggregate.size(), std::size_t{1});
+    REQUIRE_EQ(aggregate.totals().value, 0.0);
+    REQUIRE(!aggregate.totals().earnings_yield().has_value());
+}
+
+TEST_CASE("portfolio rows join holdings and newest period metrics")
+{
+    test::AppSandbox sandbox;
+    auto& database = sandbox.database;
+    sandbox.add_finance("AAA", "2023-Y");
+    sandbox.add_finance("AAA", "2024-Y", test::standard_payload(100, 10, 1.5));
+    sandbox.add_finance("ZZZ", "2024-Y");
+    std::string err;
+    REQUIRE(database.add_finances("BANK", "2024-Y", bank_payload(), &err, 2));
+    REQUIRE(database.toggle_ticker_portfolio("AAA", &err));
+    REQUIRE(database.toggle_ticker_portfolio("BANK", &err));
+
+    REQUIRE(database.set_holding("AAA", 10.0, 150.0, &err));
+    REQUIRE(!database.set_holding("NOPE", 1.0, 1.0, &err));
+    err.clear();
+
+    const auto rows = database.get_portfolio_rows(&err);
+    REQUIRE(err.empty());
+    REQUIRE_EQ(rows.size(), std::size_t{2});
+    REQUIRE_EQ(rows[0].ticker, std::string("AAA"));
+    REQUIRE_EQ(rows[0].shares, 10.0);
+    REQUIRE_EQ(rows[0].cost_basis, 150.0);
+    REQUIRE_EQ(*rows[0].eps, 1.5); // yearly row: its own eps
+    REQUIRE_EQ(rows[1].type, 2);
+    REQUIRE_EQ(rows[1].shares, 0.0);
+    // (5000 - 4500 - 100) over 40 / 2 shares
+    REQUIRE(near(rows[1].tbv_per_share, 20.0));
+
+    REQUIRE(!database.get_portfolio_row("ZZZ", &err).has_value());
+    REQUIRE(database.set_holding("AAA", 0.0, 0.0, &err));
+    REQUIRE_EQ(database.get_portfolio_row("AAA", &err)->shares, 0.0);
+}
+
+TEST_CASE("holdings view edits a holding and follows live quotes")
+{
+    test::AppSandbox sandbox;
+    auto& app = sandbox.app;
+    sandbox.add_finance("AAA", "2024-Y", test::standard_payload(100, 10, 2.0));
+    sandbox.add_finance("BBB", "2024-Y");
+    std::string err;
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("AAA", &err));
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("BBB", &err));
+    REQUIRE(sandbox.database.add_prices("AAA", {{20000, 20.0}}, &err));
+    REQUIRE(sandbox.database.add_prices("BBB", {{20000, 5.0}}, &err));
+
+    REQUIRE(views::handle_key_home(app, 'o'));
+    REQUIRE(app.current == views::ViewId::Portfolio);
+    views::sync_portfolio(app);
+    const auto& aggregate = app.portfolio_view.aggregate;
+    REQUIRE_EQ(aggregate.size(), std::size_t{2});
+    REQUIRE_EQ(aggregate.totals().held, 0);
+
+    // 10 AAA for 150
+    REQUIRE(views::handle_key_portfolio(app, 'e'));
+    for (const int ch : {'1', '0', '\t', '1', '5', '0', '\n'}) {
+        REQUIRE(views::handle_key_portfolio(app, ch));
+    }
+    REQUIRE(!app.portfolio_view.editing);
+    REQUIRE(near(aggregate.totals().value, 200.0));
+    REQUIRE(near(aggregate.totals().earnings_yield(), 0.1));
+    REQUIRE_EQ(sandbox.database.get_portfolio_row("AAA")->cost_basis, 150.0);
+
+    // a quote re-prices its position without reloading the rest
+    const auto misses = app.price_cache.misses();
+    views::apply_price_quotes(app, {{"AAA", 25.0}});
+    views::sync_portfolio(app);
+    REQUIRE(near(aggregate.totals().value, 250.0));
+    REQUIRE_EQ(app.price_cache.misses(), misses);
+
+    // other writes are picked up on the next frame
+    REQUIRE(sandbox.database.add_prices("AAA", {{99999, 30.0}}, &err));
+    views::sync_portfolio(app);
+    REQUIRE(near(aggregate.totals().value, 300.0));
+
+    REQUIRE(views::handle_key_portfolio(app, 27));
+    REQUIRE(app.current == views::ViewId::Home);
+}
+
+TEST_CASE("holdings editor saved unchanged keeps the stored holding exactly")
+{
+    test::AppSandbox sandbox;
+    auto& app = sandbox.app;
+    sandbox.add_finance("AAA", "2024-Y");
+    sandbox.add_finance("BBB", "2024-Y");
+    std::string err;
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("AAA", &err));
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("BBB", &err));
+    // more decimals than the editor shows; a cost too long to show at all
+    REQUIRE(sandbox.database.set_holding("AAA", 1.23456, 123456789012.5, &err));
+    // rounds to "0", which saved as typed would delete the holding
+    REQUIRE(sandbox.database.set_holding("BBB", 0.00004, 1.0, &err));
+
+    REQUIRE(views::handle_key_home(app, 'o'));
+    views::sync_portfolio(app);
+    REQUIRE_EQ(app.portfolio_view.aggregate.size(), std::size_t{2});
+
+    for (int index = 0; index < 2; ++index) {
+        app.portfolio_view.selected = index;
+        REQUIRE(views::handle_key_portfolio(app, 'e'));
+        REQUIRE(app.portfolio_view.editing);
+        REQUIRE(views::handle_key_portfolio(app, '\n'));
+        REQUIRE(!app.portfolio_view.editing);
+    }
+
+    const auto aaa = sandbox.database.get_portfolio_row("AAA", &err);
+    REQUIRE(aaa.has_value());
+    REQUIRE_EQ(aaa->shares, 1.23456);
+    REQUIRE_EQ(aaa->cost_basis, 123456789012.5);
+    const auto bbb = sandbox.database.get_portfolio_row("BBB", &err);
+    REQUIRE(bbb.has_value());
+    REQUIRE_EQ(bbb->shares, 0.00004);
+    REQUIRE_EQ(bbb->cost_basis, 1.0);
+}
@@ -0,0 +1,162 @@
+#include "db/price_cache.hpp"
+#include "db/price_feed.hpp"
+#include "db/price_series.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+#include "views/ticker/view_ticker.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+using Point = db::Database::PricePoint;
+
+// Connects to `path`, writes `text` and hangs up.
+bool feed_text(const std::filesystem::path& path, const std::string& text)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    const bool ok =
+        ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) ==
+            0 &&
+        ::write(fd, text.data(), text.size()) ==
+            static_cast<ssize_t>(text.size());
+    ::close(fd);
+    return ok;
+}
+
+} // namespace
+
+TEST_CASE("price feed parses ticker and price lines")
+{
+    const auto quote = db::PriceFeed::parse_line("  acme\t45.10\r");
+    REQUIRE(quote.has_value());
+    REQUIRE_EQ(quote->ticker, std::string("ACME"));
+    REQUIRE_EQ(quote->price, 45.1);
+
+    REQUIRE(!db::PriceFeed::parse_line("ACME").has_value());
+    REQUIRE(!db::PriceFeed::parse_line("ACME 0").has_value());
+    REQUIRE(!db::PriceFeed::parse_line("ACME -3").has_value());
+    REQUIRE(!db::PriceFeed::parse_line("ACME 4x").has_value());
+    REQUIRE(!db::PriceFeed::parse_line("ACME inf").has_value());
+    REQUIRE(!db::PriceFeed::parse_line("ACME 4 5").has_value());
+}
+
+TEST_CASE("price feed reads quotes from socket feeders")
+{
+    test::TempDir temp;
+    const auto path = temp.path() / "feed.sock";
+
+    db::PriceFeed feed;
+    std::string err;
+    REQUIRE(feed.open(path, &err));
+    // one session serves a socket
+    db::PriceFeed second;
+    REQUIRE(!second.open(path, &err));
+    REQUIRE_CONTAINS(err, "already served");
+
+    int input[2];
+    REQUIRE_EQ(::pipe(input), 0);
+
+    REQUIRE(feed_text(path, "acme 45.1\nnot a quote\n\nBBB 2"));
+    std::vector<db::PriceFeed::Quote> quotes;
+    for (int i = 0; i < 20 && quotes.size() < 2; ++i) {
+        REQUIRE(!feed.wait(input[0], 50));
+        for (auto& quote : feed.take_quotes()) quotes.push_back(quote);
+    }
+    REQUIRE_EQ(quotes.size(), std::size_t{2});
+    REQUIRE_EQ(quotes[0].ticker, std::string("ACME"));
+    REQUIRE_EQ(quotes[1].price, 2.0); // unterminated last line
+    REQUIRE_EQ(feed.accepted(), std::uint64_t{2});
+    REQUIRE_EQ(feed.rejected(), std::uint64_t{1});
+
+    // the terminal still wakes the loop
+    REQUIRE_EQ(::write(input[1], "k", 1), static_cast<ssize_t>(1));
+    REQUIRE(feed.wait(input[0], 1000));
+    ::close(input[0]);
+    ::close(input[1]);
+
+    feed.close();
+    REQUIRE(!std::filesystem::exists(path));
+    // a stale socket file is replaced
+    REQUIRE(second.open(path, &err));
+}
+
+TEST_CASE("price cache applies a quote without reloading other tickers")
+{
+    test::AppSandbox sandbox;
+    std::string err;
+    std::vector<Point> closes;
+    for (std::int32_t day = 0; day < 130; ++day) {
+        closes.push_back({20000 + day, 10.0 + day * 0.5});
+    }
+    REQUIRE(sandbox.database.add_prices("AAA", closes, &err));
+    REQUIRE(sandbox.database.add_prices("BBB", {{20000, 3.0}}, &err));
+
+    db::PriceCache cache;
+    const auto before = cache.load(sandbox.database, "AAA");
+    REQUIRE(cache.load(sandbox.database, "BBB") != nullptr);
+    REQUIRE_EQ(cache.misses(), std::uint64_t{2});
+
+    // replaces the latest day, then opens a new block
+    REQUIRE(cache.apply(sandbox.database, "AAA", {{20129, 99.0}}, &err));
+    REQUIRE(cache.apply(sandbox.database, "AAA", {{20135, 101.25}}, &err));
+
+    const auto after = cache.load(sandbox.database, "AAA");
+    REQUIRE(cache.load(sandbox.database, "BBB") != nullptr);
+    REQUIRE_EQ(cache.misses(), std::uint64_t{2});
+    REQUIRE_EQ(before->size(), std::size_t{130}); // held copies unchanged
+    REQUIRE_EQ(after->size(), std::size_t{131});
+    REQUIRE_EQ(after->at_or_before(20134)->close, 99.0);
+    REQUIRE_EQ(after->latest()->close, 101.25);
+
+    // the patched series matches what sqlite now holds
+    const auto stored = sandbox.database.get_prices("AAA");
+    const auto decoded = after->decode();
+    REQUIRE_EQ(decoded.size(), stored.size());
+    for (std::size_t i = 0; i < stored.size(); ++i) {
+        REQUIRE_EQ(decoded[i].day, stored[i].day);
+        REQUIRE_EQ(decoded[i].close, stored[i].close);
+    }
+
+    // back-filling history drops the entry for a reload
+    REQUIRE(cache.apply(sandbox.database, "AAA", {{19990, 1.0}}, &err));
+    REQUIRE_EQ(cache.load(sandbox.database, "AAA")->size(), std::size_t{132});
+    REQUIRE_EQ(cache.misses(), std::uint64_t{3});
+}
+
+TEST_CASE("live quotes move the open ticker's price unless typed over")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+    std::string err;
+    REQUIRE(sandbox.database.add_prices("AAA", {{20000, 30.0}}, &err));
+
+    auto& app = sandbox.app;
+    app.ticker_view.reset("AAA", sandbox.database.get_finances("AAA"));
+    views::load_ticker_view_prices(app);
+    REQUIRE_EQ(app.ticker_view.inputs[0], std::string("30"));
+
+    views::apply_price_quotes(
+        app, {{"AAA", 31.0}, {"BBB", 4.0}, {"AAA", 32.5}});
+    REQUIRE_EQ(app.ticker_view.inputs[0], std::string("32.5"));
+    REQUIRE_EQ(app.ticker_view.prices->latest()->day, db::local_today());
+    REQUIRE_EQ(sandbox.database.get_prices("BBB")[0].close, 4.0);
+
+    app.ticker_view.inputs[0] = "28";
+    views::apply_price_quotes(app, {{"AAA", 33.0}});
+    REQUIRE_EQ(app.ticker_view.inputs[0], std::string("28"));
+    REQUIRE_EQ(app.ticker_view.prices->latest()->close, 33.0);
+}
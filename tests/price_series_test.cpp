@@ -0,0 +1,193 @@
+#include "cli/cli_import_prices.hpp"
+#include "db/price_cache.hpp"
+#include "db/price_series.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+#include "views/ticker/view_ticker.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Point = db::Database::PricePoint;
+
+// `count` weekday closes from 2000-01-03, drifting up and down
+std::vector<Point> daily_closes(std::size_t count)
+{
+    std::vector<Point> points;
+    std::int32_t day = *db::parse_iso_day("2000-01-03");
+    for (std::size_t i = 0; i < count; ++i) {
+        points.push_back({day, 50.0 + static_cast<double>(i % 37) * 0.25 -
+                                   static_cast<double>(i % 11) * 0.5});
+        day += (i % 5 == 4) ? 3 : 1;
+    }
+    return points;
+}
+
+} // namespace
+
+TEST_CASE("price dates convert both ways and map periods to their end")
+{
+    REQUIRE_EQ(db::days_from_civil(1970, 1, 1), 0);
+    REQUIRE_EQ(*db::parse_iso_day("2000-03-01"),
+               db::days_from_civil(2000, 3, 1));
+    REQUIRE_EQ(db::format_iso_day(*db::parse_iso_day("2024-02-29")),
+               std::string("2024-02-29"));
+    REQUIRE_EQ(db::format_iso_day(-1), std::string("1969-12-31"));
+    REQUIRE(!db::parse_iso_day("2023-02-29").has_value());
+    REQUIRE(!db::parse_iso_day("2023-13-01").has_value());
+    REQUIRE(!db::parse_iso_day("2023/01/01").has_value());
+
+    REQUIRE_EQ(*db::period_end_day(2024, "Y"),
+               *db::parse_iso_day("2024-12-31"));
+    REQUIRE_EQ(*db::period_end_day(2024, "Q1"),
+               *db::parse_iso_day("2024-03-31"));
+    REQUIRE_EQ(*db::period_end_day(2024, "S1"),
+               *db::parse_iso_day("2024-06-30"));
+    REQUIRE_EQ(*db::period_end_day(2024, "Q3"),
+               *db::parse_iso_day("2024-09-30"));
+    REQUIRE(!db::period_end_day(2024, "X").has_value());
+}
+
+TEST_CASE("price series round-trips delta-encoded closes across blocks")
+{
+    const auto points = daily_closes(1000);
+    const auto series = db::PriceSeries::encode(points);
+    REQUIRE_EQ(series.size(), points.size());
+    // small deltas pack into a few bytes a point
+    REQUIRE(series.bytes() < points.size() * 5);
+
+    const auto decoded = series.decode();
+    REQUIRE_EQ(decoded.size(), points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        REQUIRE_EQ(decoded[i].day, points[i].day);
+        REQUIRE_EQ(decoded[i].close, points[i].close);
+    }
+
+    REQUIRE_EQ(series.latest()->day, points.back().day);
+    REQUIRE(!series.at_or_before(points.front().day - 1).has_value());
+    // a weekend resolves to the Friday before it, in any block
+    for (const std::size_t i : {std::size_t{4}, std::size_t{129},
+                                std::size_t{514}}) {
+        REQUIRE_EQ(points[i + 1].day - points[i].day, 3);
+        const auto friday = series.at_or_before(points[i].day + 2);
+        REQUIRE_EQ(friday->day, points[i].day);
+        REQUIRE_EQ(friday->close, points[i].close);
+    }
+
+    const auto window = series.range(points[120].day, points[300].day);
+    REQUIRE_EQ(window.size(), std::size_t{181});
+    REQUIRE_EQ(window.front().day, points[120].day);
+    REQUIRE_EQ(window.back().day, points[300].day);
+    REQUIRE(series.range(points.back().day + 1, points.back().day + 9)
+                .empty());
+    REQUIRE(db::PriceSeries::encode({}).decode().empty());
+}
+
+TEST_CASE("price cache reloads after a prices write")
+{
+    test::AppSandbox sandbox;
+    std::string err;
+    REQUIRE(sandbox.database.add_prices("AAA", daily_closes(10), &err));
+
+    db::PriceCache cache;
+    const auto first = cache.load(sandbox.database, "AAA", &err);
+    REQUIRE(first != nullptr);
+    REQUIRE_EQ(first->size(), std::size_t{10});
+    REQUIRE(cache.load(sandbox.database, "AAA").get() == first.get());
+    REQUIRE_EQ(cache.hits(), std::uint64_t{1});
+    // tickers without prices are cached empty
+    REQUIRE(cache.load(sandbox.database, "BBB")->empty());
+    REQUIRE_EQ(cache.size(), std::size_t{2});
+
+    // upserts replace a day's close
+    const auto generation = sandbox.database.price_generation();
+    const std::int32_t day = daily_closes(1)[0].day;
+    REQUIRE(sandbox.database.add_prices("AAA", {{day, 99.5}}, &err));
+    REQUIRE(sandbox.database.price_generation() > generation);
+    const auto after = cache.load(sandbox.database, "AAA");
+    REQUIRE_EQ(after->size(), std::size_t{10});
+    REQUIRE_EQ(after->decode().front().close, 99.5);
+    REQUIRE_EQ(cache.misses(), std::uint64_t{3});
+
+    cache.set_budget_bytes(0);
+    REQUIRE_EQ(cache.size(), std::size_t{0});
+    REQUIRE(cache.load(sandbox.database, "AAA") != nullptr);
+    REQUIRE_EQ(cache.size(), std::size_t{0});
+}
+
+TEST_CASE("import prices command loads csv closes per ticker")
+{
+    test::AppSandbox sandbox;
+    const auto path = sandbox.temp.path() / "closes.csv";
+    {
+        std::ofstream file(path);
+        file << "ticker,date,close\n# comment\n\n"
+             << "aaa,2024-01-03,11.5\nAAA,2024-01-02,10\n"
+             << "BBB, 2024-01-02 , 7.25\nAAA,2024-01-03,12\n";
+    }
+
+    std::ostringstream log;
+    REQUIRE_EQ(cli::run_import_prices(
+                   sandbox.database, {path.string()}, log),
+               0);
+    REQUIRE_CONTAINS(log.str(), "imported 3 closes for 2 tickers");
+
+    const auto aaa = sandbox.database.get_prices("AAA");
+    REQUIRE_EQ(aaa.size(), std::size_t{2});
+    REQUIRE_EQ(db::format_iso_day(aaa[0].day), std::string("2024-01-02"));
+    REQUIRE_EQ(aaa[1].close, 12.0); // repeated day: last read wins
+    REQUIRE_EQ(sandbox.database.get_prices("BBB")[0].close, 7.25);
+
+    {
+        std::ofstream file(path);
+        file << "AAA,2024-01-04,13\nAAA,2024-02-30,1\n";
+    }
+    std::ostringstream bad_log;
+    REQUIRE_EQ(cli::run_import_prices(
+                   sandbox.database, {path.string()}, bad_log),
+               1);
+    REQUIRE_CONTAINS(bad_log.str(), "line 2");
+    REQUIRE_EQ(sandbox.database.get_prices("AAA").size(), std::size_t{2});
+}
+
+TEST_CASE("ticker view prefills the latest close and prices report dates")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2023-Y");
+    sandbox.add_finance("AAA", "2024-Y");
+    std::string err;
+    REQUIRE(sandbox.database.add_prices(
+        "AAA",
+        {{*db::parse_iso_day("2023-12-29"), 20.0},
+         {*db::parse_iso_day("2025-01-10"), 31.25}},
+        &err));
+
+    auto& app = sandbox.app;
+    app.ticker_view.reset("AAA", sandbox.database.get_finances("AAA"));
+    views::load_ticker_view_prices(app);
+    REQUIRE_EQ(app.ticker_view.inputs[0], std::string("31.25"));
+
+    const auto rows = app.ticker_view.rows;
+    REQUIRE_EQ(*views::ticker_ratio_price(app, rows[0]), 31.25);
+
+    // each period at its own report-date close; none before the series
+    app.settings.report_date_prices = true;
+    REQUIRE_EQ(*views::ticker_ratio_price(app, rows[0]), 20.0);
+    REQUIRE_EQ(*views::ticker_ratio_price(app, rows[1]), 20.0);
+    auto early = rows[0];
+    early.year = 2022;
+    REQUIRE(!views::ticker_ratio_price(app, early).has_value());
+
+    // a typed price is kept, and tickers without prices use it
+    app.ticker_view.reset("BBB", {});
+    app.ticker_view.inputs[0] = "5";
+    views::load_ticker_view_prices(app);
+    REQUIRE_EQ(app.ticker_view.inputs[0], std::string("5"));
+    REQUIRE_EQ(*views::ticker_ratio_price(app, rows[0]), 5.0);
+}
@@ -0,0 +1,119 @@
+#include "metrics/price_sweep.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Row = db::Database::FinanceRow;
+using metrics::SweepMetric;
+
+std::vector<Row> quarters()
+{
+    const auto payload = test::standard_payload();
+    return {test::finance_row(2024, "Q1", payload),
+            test::finance_row(2024, "Q2", payload),
+            test::finance_row(2024, "Q3", payload),
+            test::finance_row(2024, "Q4", payload)};
+}
+
+const metrics::SweepLine*
+find_line(const std::vector<metrics::SweepLine>& lines,
+          SweepMetric metric,
+          bool ttm)
+{
+    for (const auto& line : lines) {
+        if (line.metric == metric && line.ttm == ttm) return &line;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST_CASE("sweep lines reduce valuation ratios to price coefficients")
+{
+    const auto rows = quarters();
+    const auto lines = metrics::sweep_lines(rows, 3, 1);
+    REQUIRE_EQ(lines.size(), std::size_t{10});
+    REQUIRE(lines[0].metric == SweepMetric::PriceEarnings && !lines[0].ttm);
+    REQUIRE(lines[1].metric == SweepMetric::PriceEarnings && lines[1].ttm);
+
+    // P / E on quarterly EPS 1, TTM EPS 4
+    REQUIRE_EQ(find_line(lines, SweepMetric::PriceEarnings, false)->at(20.0),
+               20.0);
+    REQUIRE_EQ(find_line(lines, SweepMetric::PriceEarnings, true)->at(20.0),
+               5.0);
+    // 10 shares, equity 3200; EV = 10 p + 2800 - 300
+    REQUIRE_EQ(find_line(lines, SweepMetric::PriceBook, false)->at(32.0),
+               0.1);
+    REQUIRE_EQ(find_line(lines, SweepMetric::EvNetIncome, false)->at(20.0),
+               270.0);
+    REQUIRE_EQ(find_line(lines, SweepMetric::EvCashFlowOps, true)->at(20.0),
+               2700.0 / 280.0);
+    REQUIRE_EQ(find_line(lines, SweepMetric::EvMarketCap, false)->at(250.0),
+               2.0);
+
+    // where each ratio meets a target multiple
+    const auto pe = find_line(lines, SweepMetric::PriceEarnings, false);
+    REQUIRE_EQ(*pe->price_for(15.0), 15.0);
+    const auto evcap = find_line(lines, SweepMetric::EvMarketCap, false);
+    REQUIRE_EQ(*evcap->price_for(2.0), 250.0);
+    const auto ev_ni = find_line(lines, SweepMetric::EvNetIncome, true);
+    REQUIRE(!ev_ni->price_for(15.0).has_value()); // needs a negative price
+
+    // no TTM for yearly rows, and types keep their own ratios
+    const std::vector<Row> yearly = {
+        test::finance_row(2024, "Y", test::standard_payload())};
+    REQUIRE_EQ(metrics::sweep_lines(yearly, 0, 1).size(), std::size_t{5});
+    const auto bank = metrics::sweep_lines(yearly, 0, 2);
+    REQUIRE_EQ(bank.size(), std::size_t{1}); // no tangible equity reported
+    REQUIRE(bank[0].metric == SweepMetric::PriceEarnings);
+    const auto insurer = metrics::sweep_lines(yearly, 0, 3);
+    REQUIRE_EQ(insurer.size(), std::size_t{1});
+    REQUIRE(metrics::sweep_lines(yearly, 4, 1).empty());
+}
+
+TEST_CASE("price sweep evaluates every line across the grid")
+{
+    const auto rows = quarters();
+    const auto lines = metrics::sweep_lines(rows, 3, 1);
+    const auto sweep = metrics::sweep_prices(lines, 20.0);
+    REQUIRE_EQ(sweep.columns(), std::size_t{101});
+    REQUIRE_EQ(sweep.base_column, std::size_t{50});
+    REQUIRE_EQ(sweep.prices[50], 20.0);
+    REQUIRE(std::abs(sweep.prices.front() - 10.0) < 1e-12);
+    REQUIRE(std::abs(sweep.prices.back() - 30.0) < 1e-12);
+    REQUIRE_EQ(sweep.values.size(), lines.size() * sweep.columns());
+
+    for (std::size_t l = 0; l < lines.size(); ++l) {
+        for (std::size_t c = 0; c < sweep.columns(); ++c) {
+            REQUIRE_EQ(sweep.value(l, c), lines[l].at(sweep.prices[c]));
+        }
+    }
+
+    REQUIRE_EQ(metrics::sweep_prices(lines, 0.0).columns(), std::size_t{0});
+    // steps past -100% are dropped, the base column still marked
+    const auto wide = metrics::sweep_prices(lines, 20.0, 3, 0.5);
+    REQUIRE_EQ(wide.columns(), std::size_t{5});
+    REQUIRE_EQ(wide.prices[wide.base_column], 20.0);
+}
+
+TEST_CASE("price sweep hides negative EV ratios but keeps negative P / E")
+{
+    const std::vector<Row> rows = {
+        test::finance_row(2024, "Y", test::standard_payload(100, -10, -1.0))};
+    const auto lines = metrics::sweep_lines(rows, 0, 1);
+    const auto sweep = metrics::sweep_prices(lines, 20.0);
+
+    const auto pe = find_line(lines, SweepMetric::PriceEarnings, false);
+    REQUIRE_EQ(pe->at(20.0), -20.0);
+    const auto ev_ni = find_line(lines, SweepMetric::EvNetIncome, false);
+    REQUIRE(std::isnan(ev_ni->at(20.0)));
+    const auto index = static_cast<std::size_t>(ev_ni - lines.data());
+    REQUIRE(std::isnan(sweep.value(index, sweep.base_column)));
+}
@@ -0,0 +1,453 @@
+#include "db/database.hpp"
+#include "db/database_sql.hpp"
+#include "test_harness.hpp"
+#include "test_utils.hpp"
+
+#include <sqlite3.h>
+
+#include <filesystem>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Key = db::Database::TickerSortKey;
+using Dir = db::Database::SortDir;
+
+constexpr int kPopulatedTickers = 200;
+constexpr int kPeriodsPerTicker = 6;
+
+// Raw connection on the same file, so plans come from the schema that
+// open_or_create() produced rather than from a hand written copy.
+class PlanConnection {
+public:
+    explicit PlanConnection(const std::filesystem::path& path)
+    {
+        const int rc = sqlite3_open_v2(path.string().c_str(),
+                                       &db_,
+                                       SQLITE_OPEN_READONLY,
+                                       nullptr);
+        if (rc != SQLITE_OK || !db_) {
+            if (db_) sqlite3_close(db_);
+            throw std::runtime_error("failed to open plan connection");
+        }
+    }
+
+    ~PlanConnection()
+    {
+        if (db_) sqlite3_close(db_);
+    }
+
+    PlanConnection(const PlanConnection&) = delete;
+    PlanConnection& operator=(const PlanConnection&) = delete;
+
+    std::vector<std::string> plan(const std::string& sql) const
+    {
+        const std::string explain = "EXPLAIN QUERY PLAN " + sql;
+
+        sqlite3_stmt* st = nullptr;
+        if (sqlite3_prepare_v2(db_, explain.c_str(), -1, &st, nullptr) !=
+            SQLITE_OK) {
+            throw std::runtime_error(std::string("prepare plan failed: ") +
+                                     sqlite3_errmsg(db_));
+        }
+
+        std::vector<std::string> details;
+        while (sqlite3_step(st) == SQLITE_ROW) {
+            const unsigned char* t = sqlite3_column_text(st, 3);
+            details.emplace_back(t ? reinterpret_cast<const char*>(t) : "");
+        }
+        sqlite3_finalize(st);
+        return details;
+    }
+
+    // Root page of the b-tree that enforces `table`'s primary key: its
+    // autoindex, or the table itself when it is WITHOUT ROWID.
+    int primary_key_root(const std::string& table) const
+    {
+        const char* sql = "SELECT rootpage FROM sqlite_schema "
+                          "WHERE name IN (?1, 'sqlite_autoindex_' || ?1 || "
+                          "'_1') ORDER BY type = 'table' LIMIT 1;";
+        sqlite3_stmt* st = nullptr;
+        if (sqlite3_prepare_v2(db_, sql, -1, &st, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(std::string("prepare root failed: ") +
+                                     sqlite3_errmsg(db_));
+        }
+        sqlite3_bind_text(st, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+        const int root =
+            sqlite3_step(st) == SQLITE_ROW ? sqlite3_column_int(st, 0) : 0;
+        sqlite3_finalize(st);
+        return root;
+    }
+
+    // Root pages the upsert's NoConflict probes go through, read off the
+    // OpenWrite that opened each probed cursor.
+    std::vector<int> conflict_roots(const std::string& sql) const
+    {
+        const std::string explain = "EXPLAIN " + sql;
+
+        sqlite3_stmt* st = nullptr;
+        if (sqlite3_prepare_v2(db_, explain.c_str(), -1, &st, nullptr) !=
+            SQLITE_OK) {
+            throw std::runtime_error(std::string("prepare program failed: ") +
+                                     sqlite3_errmsg(db_));
+        }
+
+        std::vector<std::pair<int, int>> opened; // cursor, root page
+        std::vector<int> roots;
+        while (sqlite3_step(st) == SQLITE_ROW) {
+            const unsigned char* t = sqlite3_column_text(st, 1);
+            const std::string opcode =
+                t ? reinterpret_cast<const char*>(t) : "";
+            const int p1 = sqlite3_column_int(st, 2);
+            if (opcode == "OpenWrite") {
+                opened.emplace_back(p1, sqlite3_column_int(st, 3));
+            }
+            else if (opcode == "NoConflict") {
+                for (const auto& [cursor, root] : opened) {
+                    if (cursor == p1) roots.push_back(root);
+                }
+            }
+        }
+        sqlite3_finalize(st);
+        return roots;
+    }
+
+private:
+    sqlite3* db_{nullptr};
+};
+
+void populate(db::Database& database)
+{
+    std::string err;
+    for (int i = 0; i < kPopulatedTickers; ++i) {
+        const std::string ticker = "T" + std::to_string(1000 + i);
+
+        db::Database::FinancePayload payload{};
+        payload.revenue = 100 + i;
+        payload.net_income = 10 + i;
+        payload.eps = 1.0;
+
+        for (int p = 0; p < kPeriodsPerTicker; ++p) {
+            const std::string period =
+                std::to_string(2015 + p) + (p % 2 == 0 ? "-FY" : "-Q2");
+            if (!database.add_finances(ticker, period, payload, &err)) {
+                throw std::runtime_error("populate failed: " + err);
+            }
+        }
+
+        if (i % 3 == 0 && !database.toggle_ticker_portfolio(ticker, &err)) {
+            throw std::runtime_error("populate toggle failed: " + err);
+        }
+    }
+}
+
+std::string join(const std::vector<std::string>& lines)
+{
+    std::string out;
+    for (const auto& line : lines) {
+        if (!out.empty()) out += " | ";
+        out += line;
+    }
+    return out;
+}
+
+bool starts_with(const std::string& s, const std::string& prefix)
+{
+    return s.rfind(prefix, 0) == 0;
+}
+
+// Every SCAN line must match one of `allowed_scans` exactly and no temp
+// B-tree may appear. `required` lines must all be present, so an index that
+// stops being picked fails even if the replacement plan is also a SEARCH.
+void require_plan(const PlanConnection& conn,
+                  const std::string& sql,
+                  std::initializer_list<const char*> required,
+                  std::initializer_list<const char*> allowed_scans = {})
+{
+    const auto details = conn.plan(sql);
+    const std::string rendered = join(details);
+
+    for (const auto& line : details) {
+        if (line.find("TEMP B-TREE") != std::string::npos) {
+            throw test::Failure("temp b-tree in plan: " + rendered +
+                                "\nsql: " + sql);
+        }
+
+        if (starts_with(line, "SCAN ")) {
+            bool ok = false;
+            for (const char* allowed : allowed_scans) {
+                if (line == allowed) ok = true;
+            }
+            if (!ok) {
+                throw test::Failure("unexpected scan in plan: " + rendered +
+                                    "\nsql: " + sql);
+            }
+        }
+    }
+
+    for (const char* want : required) {
+        bool found = false;
+        for (const auto& line : details) {
+            if (line == want) found = true;
+        }
+        if (!found) {
+            throw test::Failure(std::string("missing plan step '") + want +
+                                "': " + rendered + "\nsql: " + sql);
+        }
+    }
+}
+
+struct PopulatedDb {
+    test::TempDir temp;
+    test::ScopedEnvVar xdg_data{"XDG_DATA_HOME", temp.path().string()};
+    test::ScopedEnvVar home{"HOME", (temp.path() / "home").string()};
+    db::Database database;
+
+    PopulatedDb()
+    {
+        database.open_or_create();
+        populate(database);
+    }
+};
+
+// An upsert has no query plan of its own, so check its program instead:
+// no SCAN, and the ON CONFLICT probe goes through `table`'s primary key.
+void require_upsert_on_primary_key(const PlanConnection& conn,
+                                   const std::string& sql,
+                                   const std::string& table)
+{
+    require_plan(conn, sql, {});
+
+    const int root = conn.primary_key_root(table);
+    const auto roots = conn.conflict_roots(sql);
+    bool found = false;
+    for (const int r : roots) {
+        if (r == root) found = true;
+    }
+    if (root == 0 || !found) {
+        throw test::Failure("conflict target is not " + table +
+                            "'s primary key\nsql: " + sql);
+    }
+}
+
+} // namespace
+
+TEST_CASE("query plan get_tickers pages through an index in every sort order")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(conn,
+                 db::sql::tickers_page(Key::LastUpdate, Dir::Desc, false),
+                 {"SCAN tickers USING INDEX idx_tickers_order"},
+                 {"SCAN tickers USING INDEX idx_tickers_order"});
+    require_plan(conn,
+                 db::sql::tickers_page(Key::LastUpdate, Dir::Asc, false),
+                 {"SCAN tickers USING INDEX idx_tickers_order_asc"},
+                 {"SCAN tickers USING INDEX idx_tickers_order_asc"});
+    require_plan(conn,
+                 db::sql::tickers_page(Key::Ticker, Dir::Asc, false),
+                 {"SCAN tickers"},
+                 {"SCAN tickers"});
+    require_plan(conn,
+                 db::sql::tickers_page(Key::Ticker, Dir::Desc, false),
+                 {"SCAN tickers"},
+                 {"SCAN tickers"});
+}
+
+TEST_CASE("query plan get_tickers portfolio pages search the portfolio index")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(
+        conn,
+        db::sql::tickers_page(Key::LastUpdate, Dir::Desc, true),
+        {"SEARCH tickers USING INDEX idx_tickers_portfolio "
+         "(portfolio=?)"});
+    require_plan(
+        conn,
+        db::sql::tickers_page(Key::LastUpdate, Dir::Asc, true),
+        {"SEARCH tickers USING INDEX idx_tickers_portfolio_asc "
+         "(portfolio=?)"});
+    require_plan(
+        conn,
+        db::sql::tickers_page(Key::Ticker, Dir::Asc, true),
+        {"SEARCH tickers USING INDEX idx_tickers_portfolio_ticker "
+         "(portfolio=?)"});
+    require_plan(
+        conn,
+        db::sql::tickers_page(Key::Ticker, Dir::Desc, true),
+        {"SEARCH tickers USING INDEX idx_tickers_portfolio_ticker "
+         "(portfolio=?)"});
+}
+
+TEST_CASE("query plan search_tickers walks ticker order without sorting")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    // A '%x%' pattern cannot use an index; what matters is that the walk is
+    // already in output order, so LIMIT stops it early and nothing is sorted.
+    require_plan(conn,
+                 db::sql::search_tickers(false),
+                 {"SCAN tickers"},
+                 {"SCAN tickers"});
+    require_plan(
+        conn,
+        db::sql::search_tickers(true),
+        {"SEARCH tickers USING INDEX idx_tickers_portfolio_ticker "
+         "(portfolio=?)"});
+}
+
+TEST_CASE("query plan ticker index load walks the primary key in order")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(
+        conn, db::sql::kSelectAllTickers, {"SCAN tickers"}, {"SCAN tickers"});
+}
+
+TEST_CASE("query plan ticker counts stay on an index")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(conn,
+                 db::sql::kCountPortfolioTickers,
+                 {"SEARCH tickers USING COVERING INDEX "
+                  "idx_tickers_portfolio_ticker (portfolio=?)"});
+}
+
+TEST_CASE("query plan ticker point statements use the primary key")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(conn,
+                 db::sql::kSelectTicker,
+                 {"SEARCH tickers USING PRIMARY KEY (ticker=?)"});
+    require_plan(conn,
+                 db::sql::kSelectTickerType,
+                 {"SEARCH tickers USING PRIMARY KEY (ticker=?)"});
+    require_plan(conn,
+                 db::sql::kToggleTickerPortfolio,
+                 {"SEARCH tickers USING PRIMARY KEY (ticker=?)"});
+    require_plan(conn,
+                 db::sql::kDeleteTicker,
+                 {"SEARCH tickers USING PRIMARY KEY (ticker=?)"});
+    require_upsert_on_primary_key(conn, db::sql::kUpsertTicker, "tickers");
+}
+
+TEST_CASE("query plan finances statements use the primary key")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(conn,
+                 db::sql::kSelectFinances,
+                 {"SEARCH finances USING PRIMARY KEY (ticker=?)"});
+    require_plan(conn,
+                 db::sql::kCountFinancesForTicker,
+                 {"SEARCH finances USING PRIMARY KEY (ticker=?)"});
+    require_plan(conn,
+                 db::sql::kDeleteFinancePeriod,
+                 {"SEARCH finances USING PRIMARY KEY (ticker=? AND year=? "
+                  "AND period_type=?)"});
+    require_upsert_on_primary_key(conn, db::sql::kUpsertFinances, "finances");
+}
+
+TEST_CASE("query plan ticker summary statements use the primary key")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(conn,
+                 db::sql::kSelectTickerSummary,
+                 {"SEARCH ticker_summary USING PRIMARY KEY (ticker=?)"});
+    require_plan(conn,
+                 db::sql::kDeleteTickerSummary,
+                 {"SEARCH ticker_summary USING PRIMARY KEY (ticker=?)"});
+    require_upsert_on_primary_key(
+        conn, db::sql::kUpsertTickerSummary, "ticker_summary");
+}
+
+TEST_CASE("query plan finance metric screens range scan their index")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    for (const auto& column : metrics::kFinanceMetricColumns) {
+        if (!column.indexed) continue;
+
+        const std::string name = column.name;
+        const std::string search = "SEARCH m USING COVERING INDEX "
+                                   "idx_finance_metrics_" +
+                                   name + " (" + name + ">? AND " + name +
+                                   "<?)";
+        for (const auto dir : {Dir::Asc, Dir::Desc}) {
+            require_plan(conn,
+                         db::sql::screen_finance_metric(
+                             column.name, dir, false),
+                         {search.c_str()});
+            require_plan(
+                conn,
+                db::sql::screen_finance_metric(column.name, dir, true),
+                {search.c_str(),
+                 "SEARCH s USING PRIMARY KEY (ticker=?)"});
+        }
+    }
+    require_upsert_on_primary_key(
+        conn, db::sql::finance_metrics_upsert(), "finance_metrics");
+}
+
+TEST_CASE("query plan portfolio rows search the portfolio index and keys")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(
+        conn,
+        db::sql::kSelectPortfolioRows,
+        {"SEARCH t USING INDEX idx_tickers_portfolio_ticker (portfolio=?)",
+         "SEARCH h USING PRIMARY KEY (ticker=?) LEFT-JOIN",
+         "SEARCH s USING PRIMARY KEY (ticker=?) LEFT-JOIN",
+         "SEARCH m USING PRIMARY KEY (ticker=? AND year=? AND "
+         "period_type=?) LEFT-JOIN"});
+    require_plan(conn,
+                 db::sql::kDeleteHolding,
+                 {"SEARCH holdings USING PRIMARY KEY (ticker=?)"});
+    require_upsert_on_primary_key(conn, db::sql::kUpsertHolding, "holdings");
+}
+
+TEST_CASE("query plan price statements use the primary key")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(conn,
+                 db::sql::kSelectPrices,
+                 {"SEARCH prices USING PRIMARY KEY (ticker=?)"});
+    require_plan(conn,
+                 db::sql::kSelectLatestPrice,
+                 {"SEARCH prices USING PRIMARY KEY (ticker=?)"});
+    require_upsert_on_primary_key(conn, db::sql::kUpsertPrice, "prices");
+}
+
+TEST_CASE("query plan change log reads and acks range search the rowid")
+{
+    PopulatedDb fx;
+    PlanConnection conn(fx.database.path());
+
+    require_plan(conn,
+                 db::sql::kSelectChangesAfter,
+                 {"SEARCH change_log USING INTEGER PRIMARY KEY (rowid>?)"});
+    require_plan(conn,
+                 db::sql::kDeleteChangesThrough,
+                 {"SEARCH change_log USING INTEGER PRIMARY KEY (rowid<?)"});
+}
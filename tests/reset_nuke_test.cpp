@@ -3,9 +3,14 @@
 #include "test_harness.hpp"
 #include "views/settings/view_settings.hpp"
 
+#include <cstring>
 #include <filesystem>
 #include <string>
 
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
 TEST_CASE("nuke_and_reset_app wipes data and config then reinitializes app")
 {
     test::AppSandbox sandbox;
@@ -46,6 +51,39 @@ TEST_CASE("nuke_and_reset_app wipes data and config then reinitializes app")
     REQUIRE(rows.empty());
 }
 
+TEST_CASE("nuke_and_reset_app keeps the price feed and work pool running")
+{
+    test::AppSandbox sandbox;
+    const auto socket_path =
+        sandbox.database.path().parent_path() / "feed.sock";
+    db::PriceFeed feed;
+    std::string err;
+    REQUIRE(feed.open(socket_path, &err));
+    sandbox.app.price_feed = &feed;
+    metrics::WorkPool pool(2);
+    sandbox.app.work_pool = &pool;
+
+    views::nuke_and_reset_app(sandbox.app);
+
+    REQUIRE_EQ(sandbox.app.current, views::ViewId::Home);
+    REQUIRE_EQ(sandbox.app.price_feed, &feed);
+    REQUIRE_EQ(sandbox.app.work_pool, &pool);
+    REQUIRE(feed.is_open());
+    REQUIRE(std::filesystem::is_socket(socket_path));
+
+    // a feeder reaches the reopened socket
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(
+        addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(fd >= 0);
+    const int rc =
+        ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+    ::close(fd);
+    REQUIRE_EQ(rc, 0);
+}
+
 TEST_CASE("nuke_and_reset_app reports error when database is missing")
 {
     AppState app;
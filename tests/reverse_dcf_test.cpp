@@ -0,0 +1,180 @@
+#include "cli/cli_implied_growth.hpp"
+#include "metrics/monte_carlo.hpp"
+#include "metrics/reverse_dcf.hpp"
+#include "metrics/work_pool.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Row = db::Database::FinanceRow;
+
+double price_at_growth(const metrics::ReverseDcfInputs& in, double growth)
+{
+    const metrics::DcfInputs dcf{in.cash, in.shares, {}, {}, {}};
+    return metrics::dcf_value(
+        dcf, growth, 1.0, metrics::kDcfBaseDiscount, metrics::DcfParams{});
+}
+
+} // namespace
+
+TEST_CASE("brent root finds bracketed roots only")
+{
+    const auto cubic = [](double x) { return x * x * x - 2.0 * x - 5.0; };
+    const auto root = metrics::brent_root(cubic, 2.0, 3.0, 1e-12);
+    REQUIRE(root.has_value());
+    REQUIRE(std::abs(*root - 2.0945514815423265) < 1e-9);
+
+    const auto flat = [](double x) { return x * x + 1.0; };
+    REQUIRE(!metrics::brent_root(flat, -1.0, 1.0, 1e-12).has_value());
+
+    // a root on the bracket edge is returned as is
+    const auto square = [](double x) { return x * x - 4.0; };
+    REQUIRE_EQ(*metrics::brent_root(square, 2.0, 3.0, 1e-12), 2.0);
+}
+
+TEST_CASE("implied growth inverts the dcf value")
+{
+    const metrics::ReverseDcfInputs in{70.0, 10.0};
+    for (const double g : {-0.2, 0.0, 0.05, 0.3}) {
+        const auto solved = metrics::implied_growth(in, price_at_growth(in, g));
+        REQUIRE(solved.has_value());
+        REQUIRE(std::abs(*solved - g) < 1e-5);
+    }
+
+    // prices the bracket cannot reach, and no price at all
+    REQUIRE(!metrics::implied_growth(in, 0.0).has_value());
+    REQUIRE(!metrics::implied_growth(in, 1e-6).has_value());
+    REQUIRE(!metrics::implied_growth(in, 1e12).has_value());
+}
+
+TEST_CASE("reverse dcf inputs use ttm cash flow and fall back to net income")
+{
+    std::vector<Row> rows;
+    for (const char* quarter : {"Q1", "Q2", "Q3", "Q4"}) {
+        rows.push_back(test::finance_row(2024, quarter)
+                           .cash_flow_from_operations(70)
+                           .net_income(10)
+                           .eps(1.0));
+    }
+    rows.push_back(test::finance_row(2024, "Y").net_income(40).eps(4.0));
+
+    const auto ttm = metrics::reverse_dcf_inputs(rows, 3);
+    REQUIRE(ttm.has_value());
+    REQUIRE_EQ(ttm->cash, 280.0);
+    REQUIRE_EQ(ttm->shares, 10.0);
+
+    // incomplete ttm window: nothing to solve from
+    REQUIRE(!metrics::reverse_dcf_inputs(rows, 2).has_value());
+
+    // yearly rows use their own figures; no CFop means NI
+    const auto yearly = metrics::reverse_dcf_inputs(rows, 4);
+    REQUIRE(yearly.has_value());
+    REQUIRE_EQ(yearly->cash, 40.0);
+    REQUIRE_EQ(yearly->shares, 10.0);
+
+    rows[4].net_income = -5;
+    REQUIRE(!metrics::reverse_dcf_inputs(rows, 4).has_value());
+    REQUIRE(!metrics::reverse_dcf_inputs(rows, 9).has_value());
+}
+
+TEST_CASE("implied growth batch matches single solves on any pool")
+{
+    std::vector<metrics::ImpliedGrowthJob> jobs;
+    for (int i = 0; i < 3001; ++i) {
+        const metrics::ReverseDcfInputs in{10.0 + i % 97, 1.0 + i % 13};
+        jobs.push_back({in, price_at_growth(in, -0.3 + (i % 61) * 0.01)});
+    }
+    jobs.push_back({{10.0, 1.0}, 0.0}); // unsolvable
+
+    metrics::WorkPool one(1);
+    metrics::WorkPool four(4);
+    const auto a = metrics::implied_growth_batch(jobs, one);
+    const auto b = metrics::implied_growth_batch(jobs, four);
+    REQUIRE_EQ(a.size(), jobs.size());
+    REQUIRE_EQ(a, b);
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        const auto& job = jobs[i];
+        REQUIRE_EQ(a[i], metrics::implied_growth(job.inputs, job.price));
+    }
+    REQUIRE(!a.back().has_value());
+    REQUIRE(metrics::implied_growth_batch({}, four).empty());
+}
+
+TEST_CASE("implied growth command solves priced portfolio tickers")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+    sandbox.add_finance("BBB", "2024-Y");
+    sandbox.add_finance("CCC", "2024-Y");
+    std::string err;
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("AAA", &err));
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("BBB", &err));
+
+    // standard payload: CFop 70 over 10 shares
+    const double price = price_at_growth({70.0, 10.0}, 0.05);
+    const auto path = sandbox.temp.path() / "prices.csv";
+    {
+        std::ofstream file(path);
+        file << "ticker,price\n# comment\n\naaa, " << price << "\nCCC,5\n";
+    }
+
+    metrics::WorkPool pool(2);
+    std::ostringstream out;
+    std::ostringstream log;
+    REQUIRE_EQ(cli::run_implied_growth(
+                   sandbox.database, path.string(), pool, out, log),
+               0);
+    REQUIRE_EQ(out.str().substr(0, out.str().find('\n')),
+               std::string("ticker,period,price,implied_growth_pct"));
+    REQUIRE_CONTAINS(out.str(), "AAA,2024-Y,");
+    REQUIRE_CONTAINS(out.str(), ",5.00\n");
+    REQUIRE(out.str().find("CCC") == std::string::npos);
+    REQUIRE_CONTAINS(log.str(), "no price for BBB");
+    REQUIRE_CONTAINS(log.str(), "solved 1 of 1");
+
+    // the price column repeats the input price exactly
+    {
+        std::ofstream file(path);
+        file << "AAA,1234.5678\n";
+    }
+    std::ostringstream exact;
+    std::ostringstream exact_log;
+    REQUIRE_EQ(cli::run_implied_growth(
+                   sandbox.database, path.string(), pool, exact, exact_log),
+               0);
+    REQUIRE_CONTAINS(exact.str(), "AAA,2024-Y,1234.5678,");
+
+    {
+        std::ofstream file(path);
+        file << "AAA,1\nBBB,abc\n";
+    }
+    std::ostringstream bad_log;
+    REQUIRE_EQ(cli::run_implied_growth(
+                   sandbox.database, path.string(), pool, out, bad_log),
+               1);
+    REQUIRE_CONTAINS(bad_log.str(), "line 2");
+
+    // like import-prices, a price must be positive
+    for (const char* price_text : {"0", "-3.5"}) {
+        {
+            std::ofstream file(path);
+            file << "AAA,1\nBBB," << price_text << "\n";
+        }
+        std::ostringstream nonpositive_log;
+        REQUIRE_EQ(cli::run_implied_growth(sandbox.database,
+                                           path.string(),
+                                           pool,
+                                           out,
+                                           nonpositive_log),
+                   1);
+        REQUIRE_CONTAINS(nonpositive_log.str(), "line 2");
+    }
+}
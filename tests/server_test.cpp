@@ -0,0 +1,355 @@
+#include "server/api.hpp"
+#include "server/http_server.hpp"
+#include "server/response_cache.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// Sends `text` to 127.0.0.1:`port` and reads until the server hangs up.
+std::string exchange(std::uint16_t port, const std::string& text)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return {};
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    std::string reply;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) ==
+            0 &&
+        ::write(fd, text.data(), text.size()) ==
+            static_cast<ssize_t>(text.size())) {
+        char buf[4096];
+        ssize_t got = 0;
+        while ((got = ::read(fd, buf, sizeof(buf))) > 0) {
+            reply.append(buf, static_cast<std::size_t>(got));
+        }
+    }
+    ::close(fd);
+    return reply;
+}
+
+std::size_t count_of(const std::string& text, const std::string& needle)
+{
+    std::size_t n = 0;
+    for (auto at = text.find(needle); at != std::string::npos;
+         at = text.find(needle, at + needle.size())) {
+        ++n;
+    }
+    return n;
+}
+
+server::HttpRequest get(const std::string& target)
+{
+    const std::string text = "GET " + target + " HTTP/1.1\r\n\r\n";
+    server::HttpRequest request;
+    std::size_t consumed = 0;
+    int status = 0;
+    server::parse_request(text, request, consumed, status);
+    return request;
+}
+
+} // namespace
+
+TEST_CASE("http requests parse with keep-alive, pipelining and limits")
+{
+    const std::string two = "GET /api/search?q=a%2Bb+c&limit=5 HTTP/1.1\r\n"
+                            "Host: x\r\n\r\n"
+                            "HEAD /x HTTP/1.0\r\n\r\n";
+    server::HttpRequest request;
+    std::size_t consumed = 0;
+    int status = 0;
+    REQUIRE(server::parse_request(two, request, consumed, status) ==
+            server::ParseStatus::Done);
+    REQUIRE_EQ(request.path, std::string("/api/search"));
+    REQUIRE_EQ(request.param("q"), std::string("a+b c"));
+    REQUIRE_EQ(request.header("host"), std::string("x"));
+    REQUIRE(request.keep_alive);
+
+    const std::string second = two.substr(consumed);
+    REQUIRE(server::parse_request(second, request, consumed, status) ==
+            server::ParseStatus::Done);
+    REQUIRE_EQ(request.method, std::string("HEAD"));
+    REQUIRE(!request.keep_alive); // HTTP/1.0 without keep-alive
+
+    REQUIRE(server::parse_request(
+                "GET / HTTP/1.1\r\nHost:", request, consumed, status) ==
+            server::ParseStatus::Incomplete);
+    REQUIRE(server::parse_request("POST / HTTP/1.1\r\n\r\n",
+                                  request,
+                                  consumed,
+                                  status) == server::ParseStatus::Error);
+    REQUIRE_EQ(status, 405);
+    const std::string huge(server::HttpServer::kMaxHeadBytes + 1, 'a');
+    REQUIRE(server::parse_request(huge, request, consumed, status) ==
+            server::ParseStatus::Error);
+    REQUIRE_EQ(status, 431);
+}
+
+TEST_CASE("api answers ticker pages, history and metrics as json")
+{
+    test::AppSandbox sandbox;
+    auto& database = sandbox.database;
+    sandbox.add_finance("AAA", "2023-Y");
+    sandbox.add_finance("AAA", "2024-Y", test::standard_payload(100, 10, 2.0));
+    sandbox.add_finance("BBB", "2024-Y");
+    std::string err;
+    REQUIRE(database.add_prices("AAA", {{19000, 10.0}, {20000, 20.0}}, &err));
+
+    auto response = server::handle_api_request(
+        database, get("/api/tickers?size=1&sort=ticker&dir=desc"));
+    REQUIRE_EQ(response.status, 200);
+    REQUIRE(response.body.find("\"total\":2") != std::string::npos);
+    REQUIRE(response.body.find("\"ticker\":\"BBB\"") != std::string::npos);
+    REQUIRE(response.body.find("AAA") == std::string::npos);
+
+    response = server::handle_api_request(database, get("/api/search?q=a"));
+    REQUIRE(response.body.find("\"ticker\":\"AAA\"") != std::string::npos);
+
+    response =
+        server::handle_api_request(database, get("/api/tickers/aaa/history"));
+    REQUIRE_EQ(count_of(response.body, "\"period\":"), std::size_t{2});
+    REQUIRE(response.body.find("\"net_income\":10") != std::string::npos);
+
+    // newest period at the newest close: P / E = 20 / 2
+    response =
+        server::handle_api_request(database, get("/api/tickers/AAA/metrics"));
+    REQUIRE_EQ(response.status, 200);
+    REQUIRE(response.body.find("\"period\":\"2024-Y\"") != std::string::npos);
+    REQUIRE(response.body.find("\"price_date\":\"2024-10-04\"") !=
+            std::string::npos);
+    REQUIRE(response.body.find("\"metric\":\"price_earnings\",\"label\":\"P "
+                               "/ E\",\"ttm\":false,\"value\":10") !=
+            std::string::npos);
+
+    response = server::handle_api_request(
+        database, get("/api/tickers/AAA/metrics?period=2023-Y&price=5"));
+    REQUIRE(response.body.find("\"price\":5,\"price_date\":null") !=
+            std::string::npos);
+
+    REQUIRE_EQ(server::handle_api_request(database,
+                                          get("/api/tickers/ZZZ/history"))
+                   .status,
+               404);
+    REQUIRE_EQ(server::handle_api_request(
+                   database, get("/api/tickers/AAA/metrics?period=1999-Y"))
+                   .status,
+               404);
+    REQUIRE_EQ(
+        server::handle_api_request(database, get("/api/tickers?dir=up")).status,
+        400);
+    REQUIRE_EQ(server::handle_api_request(database, get("/nope")).status, 404);
+}
+
+TEST_CASE("response cache serves current payloads and revalidates etags")
+{
+    server::ResponseCache cache(600);
+    int renders = 0;
+    const auto render = [&] {
+        ++renders;
+        return std::string(100, 'x');
+    };
+    const auto a = cache.get_or_render("a", 1, render);
+    REQUIRE_EQ(cache.get_or_render("a", 1, render), a);
+    REQUIRE_EQ(renders, 1);
+    REQUIRE(cache.get_or_render("a", 2, render) != a);
+    REQUIRE_EQ(renders, 2);
+    // an older generation read late does not replace a newer payload
+    cache.store("a", 1, "old");
+    REQUIRE(cache.find("a", 2) != nullptr);
+
+    // over budget: the least recently used goes first
+    cache.store("b", 1, std::string(100, 'y'));
+    REQUIRE(cache.find("a", 2) != nullptr);
+    cache.store("c", 1, std::string(100, 'z'));
+    REQUIRE(cache.find("b", 1) == nullptr);
+    REQUIRE(cache.find("a", 2) != nullptr);
+    REQUIRE(cache.bytes() <= 600);
+
+    REQUIRE(server::etag_matches("\"x\", W/" + a->etag, a->etag));
+    REQUIRE(server::etag_matches("*", a->etag));
+    REQUIRE(!server::etag_matches("\"x\"", a->etag));
+}
+
+TEST_CASE("api reuses payloads until the ticker's generation moves")
+{
+    test::AppSandbox sandbox;
+    auto& database = sandbox.database;
+    sandbox.add_finance("AAA", "2023-Y");
+    server::ResponseCache cache;
+
+    auto request = get("/api/tickers/AAA/history");
+    const auto first = server::handle_api_request(database, request, &cache);
+    REQUIRE_EQ(first.status, 200);
+    REQUIRE_EQ(first.headers.size(), std::size_t{1});
+    const auto etag = first.headers[0].second;
+
+    const auto again = server::handle_api_request(database, request, &cache);
+    REQUIRE_EQ(again.body, first.body);
+    REQUIRE_EQ(cache.hits(), std::uint64_t{1});
+
+    request.headers["if-none-match"] = etag;
+    const auto unchanged =
+        server::handle_api_request(database, request, &cache);
+    REQUIRE_EQ(unchanged.status, 304);
+    REQUIRE(unchanged.body.empty());
+
+    // another ticker's write leaves it current; its own does not
+    sandbox.add_finance("BBB", "2024-Y");
+    REQUIRE_EQ(server::handle_api_request(database, request, &cache).status,
+               304);
+    std::string err;
+    REQUIRE(database.toggle_ticker_portfolio("AAA", &err));
+    const auto changed = server::handle_api_request(database, request, &cache);
+    REQUIRE_EQ(changed.status, 200);
+    REQUIRE(changed.headers[0].second != etag);
+    REQUIRE(changed.body.find("\"period\":\"2023-Y\"") != std::string::npos);
+
+    // a new close changes the metrics key, not the generation
+    auto metrics = get("/api/tickers/AAA/metrics");
+    const auto unpriced = server::handle_api_request(database, metrics, &cache);
+    REQUIRE(database.add_prices("AAA", {{20000, 20.0}}, &err));
+    const auto priced = server::handle_api_request(database, metrics, &cache);
+    REQUIRE(priced.body != unpriced.body);
+    REQUIRE(priced.body.find("\"price\":20") != std::string::npos);
+}
+
+TEST_CASE("api never serves a deleted ticker's payload for its re-creation")
+{
+    test::AppSandbox sandbox;
+    auto& database = sandbox.database;
+    sandbox.add_finance("AAA", "2023-Y");
+    server::ResponseCache cache;
+
+    const auto request = get("/api/tickers/AAA/history");
+    const auto before = server::handle_api_request(database, request, &cache);
+    REQUIRE_EQ(before.status, 200);
+
+    // last period -> the ticker row goes, then comes back within a second
+    std::string err;
+    REQUIRE(database.delete_period("AAA", "2023-Y", &err));
+    sandbox.add_finance("AAA", "2024-Y");
+
+    const auto after = server::handle_api_request(database, request, &cache);
+    REQUIRE_EQ(after.status, 200);
+    REQUIRE(after.headers[0].second != before.headers[0].second);
+    REQUIRE(after.body.find("\"period\":\"2024-Y\"") != std::string::npos);
+    REQUIRE(after.body.find("2023-Y") == std::string::npos);
+}
+
+TEST_CASE("http server answers pipelined keep-alive requests until stopped")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y");
+
+    server::HttpServer http;
+    std::string err;
+    REQUIRE(http.listen(0, &err));
+    REQUIRE(http.port() != 0);
+
+    bool ran = false;
+    std::thread serving([&] {
+        ran = http.run(
+            sandbox.database.path(),
+            2,
+            [](db::Database& reader, const server::HttpRequest& request) {
+                return server::handle_api_request(reader, request);
+            },
+            &err);
+    });
+
+    const auto reply = exchange(http.port(),
+                                "GET /api/tickers HTTP/1.1\r\n\r\n"
+                                "GET /api/tickers/AAA/history HTTP/1.1\r\n\r\n"
+                                "HEAD /missing HTTP/1.1\r\n"
+                                "Connection: close\r\n\r\n");
+    REQUIRE_EQ(count_of(reply, "HTTP/1.1 200 OK"), std::size_t{2});
+    REQUIRE_EQ(count_of(reply, "Connection: keep-alive"), std::size_t{2});
+    REQUIRE_EQ(count_of(reply, "HTTP/1.1 404 Not Found"), std::size_t{1});
+    // HEAD: headers only, so the reply ends with the 404's blank line
+    REQUIRE(reply.size() >= 4 && reply.substr(reply.size() - 4) == "\r\n\r\n");
+
+    const auto refused = exchange(http.port(), "DELETE / HTTP/1.1\r\n\r\n");
+    REQUIRE(refused.find("HTTP/1.1 405") == 0);
+
+    http.stop();
+    serving.join();
+    REQUIRE(ran);
+    REQUIRE_EQ(http.requests_served(), std::uint64_t{3});
+}
+
+TEST_CASE("http server idles while a half-closed peer leaves replies unread")
+{
+    test::AppSandbox sandbox;
+
+    server::HttpServer http;
+    std::string err;
+    REQUIRE(http.listen(0, &err));
+
+    bool ran = false;
+    std::thread serving([&] {
+        ran = http.run(
+            sandbox.database.path(),
+            1,
+            [](db::Database&, const server::HttpRequest&) {
+                server::HttpResponse response;
+                response.content_type = "text/plain";
+                response.body.assign(std::size_t{4} << 20, 'x');
+                return response;
+            },
+            &err);
+    });
+
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(fd >= 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(http.port());
+    REQUIRE(::connect(
+                fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) ==
+            0);
+    const std::string text = "GET / HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\n\r\n"
+                             "GET / HTTP/1.1\r\n\r\n";
+    REQUIRE(::write(fd, text.data(), text.size()) ==
+            static_cast<ssize_t>(text.size()));
+    REQUIRE(::shutdown(fd, SHUT_WR) == 0);
+
+    // 12 MiB cannot all be sent while unread; the worker must wait for
+    // EPOLLOUT instead of polling the peer's EOF
+    const auto cpu_ms = [] {
+        timespec ts{};
+        ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    };
+    const auto cpu_before = cpu_ms();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    const auto cpu_spent = cpu_ms() - cpu_before;
+
+    std::string reply;
+    char buf[65536];
+    ssize_t got = 0;
+    while ((got = ::read(fd, buf, sizeof(buf))) > 0) {
+        reply.append(buf, static_cast<std::size_t>(got));
+    }
+    ::close(fd);
+
+    http.stop();
+    serving.join();
+    REQUIRE(ran);
+    REQUIRE(cpu_spent < 150);
+    REQUIRE_EQ(count_of(reply, "HTTP/1.1 200 OK"), std::size_t{3});
+}
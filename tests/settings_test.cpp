@@ -74,6 +74,9 @@ TEST_CASE("settings save and load roundtrip preserves values")
     saved.ttm = true;
     saved.show_help = false;
     saved.color_mode = ColorMode::White;
+    saved.history_cache_mb = 3;
+    saved.price_cache_mb = 7;
+    saved.report_date_prices = true;
 
     std::string err;
     REQUIRE(save_settings(saved, &err));
@@ -85,6 +88,7 @@ TEST_CASE("settings save and load roundtrip preserves values")
     loaded.ttm = false;
     loaded.show_help = true;
     loaded.color_mode = ColorMode::Default;
+    loaded.report_date_prices = false;
 
     REQUIRE(load_settings(loaded, &err));
     REQUIRE(err.empty());
@@ -94,6 +98,9 @@ TEST_CASE("settings save and load roundtrip preserves values")
     REQUIRE_EQ(loaded.ttm, saved.ttm);
     REQUIRE_EQ(loaded.show_help, saved.show_help);
     REQUIRE_EQ(loaded.color_mode, saved.color_mode);
+    REQUIRE_EQ(loaded.history_cache_mb, saved.history_cache_mb);
+    REQUIRE_EQ(loaded.price_cache_mb, saved.price_cache_mb);
+    REQUIRE_EQ(loaded.report_date_prices, saved.report_date_prices);
 }
 
 TEST_CASE("settings loader handles aliases comments and malformed lines")
@@ -118,6 +125,14 @@ TEST_CASE("settings loader handles aliases comments and malformed lines")
                           "ttm = yes\n"
                           "help = off\n"
                           "theme = white\n"
+                          "history_cache_mb = 64\n"
+                          "cache_mb = 8\n"
+                          "history_cache_mb = lots\n"
+                          "price_cache_mb = 5000\n"
+                          "price_cache_mb = -1\n"
+                          "price_cache_mb = 1234567\n"
+                          "report_date_prices = on\n"
+                          "report_date_prices = maybe\n"
                           "bad_line_without_equals\n"
                           "sort_key = lastupdate\n");
 
@@ -127,6 +142,7 @@ TEST_CASE("settings loader handles aliases comments and malformed lines")
     loaded.ttm = false;
     loaded.show_help = true;
     loaded.color_mode = ColorMode::Default;
+    loaded.report_date_prices = false;
 
     REQUIRE(load_settings(loaded, &err));
     REQUIRE(err.empty());
@@ -136,6 +152,10 @@ TEST_CASE("settings loader handles aliases comments and malformed lines")
     REQUIRE_EQ(loaded.ttm, true);
     REQUIRE_EQ(loaded.show_help, false);
     REQUIRE_EQ(loaded.color_mode, ColorMode::White);
+    REQUIRE_EQ(loaded.history_cache_mb, std::size_t{64});
+    // capped, then garbage and overlong counts ignored
+    REQUIRE_EQ(loaded.price_cache_mb, kMaxPriceCacheMb);
+    REQUIRE_EQ(loaded.report_date_prices, true);
 }
 
 TEST_CASE("settings load succeeds when config file is missing")
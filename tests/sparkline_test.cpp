@@ -0,0 +1,95 @@
+#include "metrics/finance_store.hpp"
+#include "metrics/sparkline.hpp"
+#include "metrics/yoy_table.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Row = db::Database::FinanceRow;
+
+metrics::F64Column f64_column(const std::vector<std::optional<double>>& v)
+{
+    metrics::F64Column c(v.size());
+    for (std::size_t i = 0; i < v.size(); ++i) c.set(i, v[i]);
+    return c;
+}
+
+} // namespace
+
+TEST_CASE("sparkline min/max buckets keep spikes when downsampling")
+{
+    const auto series =
+        f64_column({1.0, 9.0, std::nullopt, std::nullopt, 5.0, 2.0});
+
+    const auto buckets = metrics::minmax_buckets(series, 3);
+    REQUIRE_EQ(buckets.size(), std::size_t{3});
+    REQUIRE(buckets[0].valid);
+    REQUIRE_EQ(buckets[0].min, 1.0);
+    REQUIRE_EQ(buckets[0].max, 9.0);
+    REQUIRE(!buckets[1].valid);
+    REQUIRE_EQ(buckets[2].min, 2.0);
+    REQUIRE_EQ(buckets[2].max, 5.0);
+
+    // never more buckets than points
+    REQUIRE_EQ(metrics::minmax_buckets(series, 100).size(), std::size_t{6});
+    REQUIRE(metrics::minmax_buckets(series, 0).empty());
+}
+
+TEST_CASE("sparkline glyphs map the range onto braille dots and a ramp")
+{
+    const auto buckets =
+        metrics::minmax_buckets(f64_column({0.0, 3.0, 1.0}), 3);
+
+    // bottom-left and top-right dots, then the left dot one level up
+    const std::string braille = metrics::braille_sparkline(buckets);
+    REQUIRE_EQ(braille, std::string("\xE2\xA1\x88\xE2\xA0\x84"));
+
+    REQUIRE_EQ(metrics::ascii_sparkline(buckets), std::string("_#:"));
+    REQUIRE(metrics::ascii_sparkline({}).empty());
+}
+
+TEST_CASE("sparkline cache keeps series across widths and scrolls")
+{
+    const std::vector<Row> rows = {
+        test::finance_row(2022, "Y", test::standard_payload(100, 10, 1.0)),
+        test::finance_row(2023, "Q1", test::standard_payload(30, 3, 0.3)),
+        test::finance_row(2023, "Y", test::standard_payload(140, 14, 1.4)),
+        test::finance_row(2024, "Y", test::standard_payload(90, 9, 0.9)),
+    };
+    const metrics::FinanceStore store(rows);
+    const metrics::YoyTable yoy(rows, store, 1);
+
+    const auto yearly = metrics::spark_series(
+        metrics::SparkMetric::Revenue, store, yoy, true);
+    REQUIRE_EQ(yearly.size(), std::size_t{3});
+    REQUIRE_EQ(yearly.at(1), std::optional<double>(140.0));
+
+    metrics::SparklineCache cache;
+    const auto strip = [&](metrics::SparkMetric metric, int width) {
+        return cache.strip(
+            "ACME", 1, store, yoy, metric, true, width, false);
+    };
+    REQUIRE_EQ(strip(metrics::SparkMetric::Revenue, 10), std::string(".#_"));
+    REQUIRE_EQ(strip(metrics::SparkMetric::Revenue, 10), std::string(".#_"));
+    REQUIRE_EQ(strip(metrics::SparkMetric::Revenue, 2).size(),
+               std::size_t{2});
+    REQUIRE_EQ(cache.series_count(), std::size_t{1});
+    REQUIRE_EQ(cache.strip_count(), std::size_t{2});
+
+    // p/e is 1 / eps, so it falls where eps rises
+    REQUIRE_EQ(strip(metrics::SparkMetric::PriceEarnings, 10),
+               std::string("+_#"));
+
+    // fewer than two points draw nothing
+    REQUIRE(strip(metrics::SparkMetric::Cet1Ratio, 10).empty());
+    REQUIRE(cache.strip("ACME", 1, store, yoy,
+                        metrics::SparkMetric::Revenue, false, 10, false)
+                .empty());
+}
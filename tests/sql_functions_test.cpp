@@ -0,0 +1,185 @@
+#include "db/sql_functions.hpp"
+#include "metrics/metric_math.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// In-memory connection with the intrinsic_* functions registered.
+class MemoryDb {
+public:
+    MemoryDb()
+    {
+        if (sqlite3_open(":memory:", &db_) != SQLITE_OK) {
+            throw std::runtime_error("failed to open memory db");
+        }
+        db::register_sql_functions(db_);
+    }
+
+    ~MemoryDb()
+    {
+        if (db_) sqlite3_close(db_);
+    }
+
+    MemoryDb(const MemoryDb&) = delete;
+    MemoryDb& operator=(const MemoryDb&) = delete;
+
+    void exec(const std::string& sql)
+    {
+        char* err = nullptr;
+        if (sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &err) !=
+            SQLITE_OK) {
+            std::string msg = err ? err : "exec failed";
+            sqlite3_free(err);
+            throw std::runtime_error(msg);
+        }
+    }
+
+    // First column of every row; NULL becomes nullopt.
+    std::vector<std::optional<double>> column(const std::string& sql)
+    {
+        sqlite3_stmt* st = nullptr;
+        if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &st, nullptr) !=
+            SQLITE_OK) {
+            throw std::runtime_error(sqlite3_errmsg(db_));
+        }
+
+        std::vector<std::optional<double>> out;
+        while (sqlite3_step(st) == SQLITE_ROW) {
+            if (sqlite3_column_type(st, 0) == SQLITE_NULL)
+                out.emplace_back(std::nullopt);
+            else
+                out.emplace_back(sqlite3_column_double(st, 0));
+        }
+        sqlite3_finalize(st);
+        return out;
+    }
+
+    std::optional<double> scalar(const std::string& sql)
+    {
+        const auto values = column(sql);
+        if (values.size() != 1) throw std::runtime_error("expected one row");
+        return values.front();
+    }
+
+private:
+    sqlite3* db_{nullptr};
+};
+
+} // namespace
+
+TEST_CASE("sql functions ratios match the metric helpers")
+{
+    MemoryDb mem;
+
+    REQUIRE_EQ(mem.scalar("SELECT intrinsic_pe(30, 2.5);"),
+               std::optional<double>(12.0));
+    REQUIRE(!mem.scalar("SELECT intrinsic_pe(30, 0);").has_value());
+    REQUIRE(!mem.scalar("SELECT intrinsic_pe(0, 2);").has_value());
+    REQUIRE(!mem.scalar("SELECT intrinsic_pe(NULL, 2);").has_value());
+    REQUIRE(!mem.scalar("SELECT intrinsic_pe('abc', 2);").has_value());
+
+    REQUIRE_EQ(mem.scalar("SELECT intrinsic_div(1, 4);"),
+               std::optional<double>(0.25));
+    REQUIRE_EQ(mem.scalar("SELECT intrinsic_shares(1000, 3);"),
+               std::optional<double>(333.0));
+    REQUIRE_EQ(mem.scalar("SELECT intrinsic_pb(20, 1000, 100);"),
+               std::optional<double>(2.0));
+    REQUIRE_EQ(mem.scalar("SELECT intrinsic_equity(6000, 2800);"),
+               std::optional<double>(3200.0));
+    REQUIRE(!mem.scalar("SELECT intrinsic_equity(6000, NULL);").has_value());
+
+    REQUIRE_EQ(
+        mem.scalar("SELECT intrinsic_underwriting_expenses(900, 600, 50, 1);"),
+        std::optional<double>(250.0));
+    REQUIRE_EQ(
+        mem.scalar(
+            "SELECT intrinsic_underwriting_expenses(NULL, 600, 50, 70);"),
+        std::optional<double>(70.0));
+
+    REQUIRE_EQ(mem.scalar("SELECT intrinsic_combined_ratio(60, 30, 100);"),
+               metrics::combined_ratio(60.0, 30.0, 100.0));
+    REQUIRE(!mem.scalar("SELECT intrinsic_combined_ratio(60, NULL, 100);")
+                 .has_value());
+}
+
+TEST_CASE("sql functions intrinsic_ttm window matches ttm_sum_for_family")
+{
+    MemoryDb mem;
+    mem.exec("CREATE TABLE f (year INTEGER, period_type TEXT, eps REAL);");
+
+    // a yearly row interleaved, a gap in 2024 and a semiannual family
+    const std::vector<db::Database::FinanceRow> rows = {
+        test::finance_row(2022, "Q3").eps(1.0),
+        test::finance_row(2022, "Q4").eps(2.0),
+        test::finance_row(2022, "Y").eps(9.0),
+        test::finance_row(2023, "Q1").eps(3.0),
+        test::finance_row(2023, "Q2").eps(4.0),
+        test::finance_row(2023, "Q3").eps(5.0),
+        test::finance_row(2023, "S1").eps(7.0),
+        test::finance_row(2023, "S2").eps(8.0),
+        test::finance_row(2024, "Q1"),
+        test::finance_row(2024, "Q2").eps(1.0),
+    };
+    for (const auto& r : rows) {
+        const std::string eps = r.eps ? std::to_string(*r.eps) : "NULL";
+        mem.exec("INSERT INTO f VALUES (" + std::to_string(r.year) + ", '" +
+                 r.period_type + "', " + eps + ");");
+    }
+
+    const auto sql_ttm =
+        mem.column("SELECT intrinsic_ttm(eps, period_type) OVER ("
+                   "ORDER BY year, period_type) FROM f "
+                   "ORDER BY year, period_type;");
+    REQUIRE_EQ(sql_ttm.size(), rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        REQUIRE_EQ(sql_ttm[i], metrics::ttm_at(rows, static_cast<int>(i)).eps);
+    }
+
+    REQUIRE_EQ(sql_ttm[5], std::optional<double>(14.0));
+    REQUIRE_EQ(sql_ttm[7], std::optional<double>(15.0));
+    REQUIRE(!sql_ttm[2].has_value());
+    REQUIRE(!sql_ttm[9].has_value());
+
+    // plain aggregate: the window ending at the last row
+    REQUIRE_EQ(mem.scalar("SELECT intrinsic_ttm(eps, period_type) FROM "
+                          "(SELECT * FROM f WHERE year = 2023 "
+                          "AND period_type LIKE 'Q%' "
+                          "ORDER BY year, period_type);"),
+               std::optional<double>());
+    REQUIRE_EQ(mem.scalar("SELECT intrinsic_ttm(eps, period_type) FROM "
+                          "(SELECT * FROM f WHERE period_type LIKE 'S%' "
+                          "ORDER BY year, period_type);"),
+               std::optional<double>(15.0));
+}
+
+TEST_CASE("sql functions intrinsic_ttm handles sliding frames")
+{
+    MemoryDb mem;
+    mem.exec("CREATE TABLE f (year INTEGER, period_type TEXT, eps REAL);");
+    for (int y = 2020; y <= 2022; ++y) {
+        for (int q = 1; q <= 4; ++q) {
+            mem.exec("INSERT INTO f VALUES (" + std::to_string(y) + ", 'Q" +
+                     std::to_string(q) + "', " + std::to_string(q) + ");");
+        }
+    }
+
+    // a four-row frame only ever sees one window, and inverse keeps it exact
+    const auto ttm = mem.column(
+        "SELECT intrinsic_ttm(eps, period_type) OVER ("
+        "ORDER BY year, period_type ROWS BETWEEN 3 PRECEDING AND CURRENT ROW)"
+        " FROM f ORDER BY year, period_type;");
+    REQUIRE_EQ(ttm.size(), std::size_t{12});
+    REQUIRE(!ttm[2].has_value());
+    for (std::size_t i = 3; i < ttm.size(); ++i) {
+        REQUIRE_EQ(ttm[i], std::optional<double>(10.0));
+    }
+}
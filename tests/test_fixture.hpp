@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <optional>
 #include <stdexcept>
 #include <string>
 
@@ -29,6 +30,86 @@ inline db::Database::FinancePayload standard_payload(
     return payload;
 }
 
+// A FinanceRow for ACME holding `payload`'s figures, as get_finances()
+// would return it; setters override single figures:
+//   const std::vector<Row> rows = {test::finance_row(2024, "Y").eps(1.0)};
+class FinanceRowBuilder {
+public:
+    FinanceRowBuilder(int year,
+                      const std::string& period_type,
+                      const db::Database::FinancePayload& payload)
+    {
+        row_.ticker = "ACME";
+        row_.year = year;
+        row_.period_type = period_type;
+        row_.current_assets = payload.current_assets;
+        row_.non_current_assets = payload.non_current_assets;
+        row_.eps = payload.eps;
+        row_.cash_and_equivalents = payload.cash_and_equivalents;
+        row_.cash_flow_from_financing = payload.cash_flow_from_financing;
+        row_.cash_flow_from_investing = payload.cash_flow_from_investing;
+        row_.cash_flow_from_operations = payload.cash_flow_from_operations;
+        row_.revenue = payload.revenue;
+        row_.current_liabilities = payload.current_liabilities;
+        row_.non_current_liabilities = payload.non_current_liabilities;
+        row_.net_income = payload.net_income;
+        row_.total_loans = payload.total_loans;
+        row_.goodwill = payload.goodwill;
+        row_.total_assets = payload.total_assets;
+        row_.total_deposits = payload.total_deposits;
+        row_.total_liabilities = payload.total_liabilities;
+        row_.net_interest_income = payload.net_interest_income;
+        row_.non_interest_income = payload.non_interest_income;
+        row_.loan_loss_provisions = payload.loan_loss_provisions;
+        row_.non_interest_expense = payload.non_interest_expense;
+        row_.risk_weighted_assets = payload.risk_weighted_assets;
+        row_.common_equity_tier1 = payload.common_equity_tier1;
+        row_.net_charge_offs = payload.net_charge_offs;
+        row_.non_performing_loans = payload.non_performing_loans;
+        row_.insurance_reserves = payload.insurance_reserves;
+        row_.earned_premiums = payload.earned_premiums;
+        row_.claims_incurred = payload.claims_incurred;
+        row_.interest_expenses = payload.interest_expenses;
+        row_.total_expenses = payload.total_expenses;
+        row_.underwriting_expenses = payload.underwriting_expenses;
+        row_.total_debt = payload.total_debt;
+    }
+
+    FinanceRowBuilder& eps(std::optional<double> v)
+    {
+        row_.eps = v;
+        return *this;
+    }
+    FinanceRowBuilder& cash_flow_from_operations(std::optional<std::int64_t> v)
+    {
+        row_.cash_flow_from_operations = v;
+        return *this;
+    }
+    FinanceRowBuilder& revenue(std::optional<std::int64_t> v)
+    {
+        row_.revenue = v;
+        return *this;
+    }
+    FinanceRowBuilder& net_income(std::optional<std::int64_t> v)
+    {
+        row_.net_income = v;
+        return *this;
+    }
+
+    operator db::Database::FinanceRow() const { return row_; }
+
+private:
+    db::Database::FinanceRow row_{};
+};
+
+inline FinanceRowBuilder finance_row(
+    int year,
+    const std::string& period_type,
+    const db::Database::FinancePayload& payload = {})
+{
+    return FinanceRowBuilder(year, period_type, payload);
+}
+
 struct AppSandbox {
     TempDir temp;
     ScopedEnvVar xdg_data;
@@ -0,0 +1,309 @@
+#include "db/database.hpp"
+#include "db/ticker_index.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Key = db::Database::TickerSortKey;
+using Dir = db::Database::SortDir;
+
+std::vector<std::string>
+to_tickers(const std::vector<db::Database::TickerRow>& rows)
+{
+    std::vector<std::string> out;
+    out.reserve(rows.size());
+    for (const auto& row : rows) out.push_back(row.ticker);
+    return out;
+}
+
+// Walks every page of every ordering and compares with the SQL path.
+void require_matches_sql(db::Database& database, const db::TickerIndex& index)
+{
+    const Key keys[] = {Key::Ticker, Key::LastUpdate};
+    const Dir dirs[] = {Dir::Asc, Dir::Desc};
+    constexpr int kPageSize = 4;
+
+    for (bool portfolio_only : {false, true}) {
+        for (Key key : keys) {
+            for (Dir dir : dirs) {
+                for (int page = 0; page < 6; ++page) {
+                    std::string err;
+                    const auto sql = database.get_tickers(
+                        page, kPageSize, key, dir, &err, portfolio_only);
+                    REQUIRE(err.empty());
+
+                    const auto mem =
+                        index.page(page, kPageSize, key, dir, portfolio_only);
+                    REQUIRE_EQ(to_tickers(mem), to_tickers(sql));
+                    for (std::size_t i = 0; i < mem.size(); ++i) {
+                        REQUIRE_EQ(mem[i].last_update, sql[i].last_update);
+                        REQUIRE_EQ(mem[i].portfolio, sql[i].portfolio);
+                        REQUIRE_EQ(mem[i].type, sql[i].type);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void set_last_update(test::AppSandbox& sandbox,
+                     const std::string& ticker,
+                     std::int64_t value)
+{
+    const std::string sql = "UPDATE tickers SET last_update = " +
+                            std::to_string(value) + " WHERE ticker = '" +
+                            ticker + "';";
+
+    sqlite3* raw = nullptr;
+    REQUIRE_EQ(sqlite3_open(sandbox.database.path().string().c_str(), &raw),
+               SQLITE_OK);
+    REQUIRE_EQ(sqlite3_exec(raw, sql.c_str(), nullptr, nullptr, nullptr),
+               SQLITE_OK);
+    sqlite3_close(raw);
+}
+
+} // namespace
+
+TEST_CASE("ticker index pages match sql in every order and filter")
+{
+    test::AppSandbox sandbox;
+    const char* tickers[] = {
+        "MSFT", "AAPL", "BRK.B", "NVDA", "AMZN", "GOOG", "META", "TSLA", "V"};
+    std::int64_t stamp = 1000;
+    for (const char* t : tickers) {
+        sandbox.add_finance(t, "2024-FY");
+        // ties on last_update exercise the ticker tiebreak
+        set_last_update(sandbox, t, stamp);
+        stamp += (stamp % 3 == 0) ? 0 : 7;
+    }
+
+    std::string err;
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("NVDA", &err));
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("AAPL", &err));
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("V", &err));
+
+    db::TickerIndex index;
+    REQUIRE(index.ensure_loaded(sandbox.database, &err));
+    REQUIRE(err.empty());
+    REQUIRE_EQ(index.count(false), std::size_t{9});
+    REQUIRE_EQ(index.count(true), std::size_t{3});
+
+    require_matches_sql(sandbox.database, index);
+}
+
+TEST_CASE("ticker index stays consistent with sql across patches")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-FY");
+    sandbox.add_finance("BBB", "2024-FY");
+    sandbox.add_finance("CCC", "2024-FY");
+    set_last_update(sandbox, "AAA", 10);
+    set_last_update(sandbox, "BBB", 20);
+    set_last_update(sandbox, "CCC", 30);
+
+    std::string err;
+    db::TickerIndex index;
+    REQUIRE(index.ensure_loaded(sandbox.database, &err));
+
+    auto sync = [&](const std::string& ticker) {
+        const auto row = sandbox.database.get_ticker(ticker, &err);
+        REQUIRE(err.empty());
+        if (row.has_value())
+            index.upsert(*row);
+        else
+            index.erase(ticker);
+    };
+
+    // new ticker
+    sandbox.add_finance("ABC", "2024-FY");
+    set_last_update(sandbox, "ABC", 15);
+    sync("ABC");
+    REQUIRE(index.contains("ABC"));
+    require_matches_sql(sandbox.database, index);
+
+    // existing ticker moves in the last_update orders
+    set_last_update(sandbox, "AAA", 99);
+    sync("AAA");
+    require_matches_sql(sandbox.database, index);
+
+    // portfolio toggles move rows in and out of the filtered orders
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("CCC", &err));
+    sync("CCC");
+    REQUIRE_EQ(index.count(true), std::size_t{1});
+    require_matches_sql(sandbox.database, index);
+
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("CCC", &err));
+    sync("CCC");
+    REQUIRE_EQ(index.count(true), std::size_t{0});
+
+    // deleting the last period removes the ticker
+    REQUIRE(sandbox.database.delete_period("BBB", "2024-FY", &err));
+    sync("BBB");
+    REQUIRE(!index.contains("BBB"));
+    require_matches_sql(sandbox.database, index);
+
+    // freed slots are reused without disturbing the orderings
+    sandbox.add_finance("ZZZ", "2024-FY");
+    sync("ZZZ");
+    REQUIRE_EQ(index.count(false), std::size_t{4});
+    require_matches_sql(sandbox.database, index);
+}
+
+TEST_CASE("ticker index reset drops rows until reloaded")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-FY");
+
+    std::string err;
+    db::TickerIndex index;
+    REQUIRE(index.ensure_loaded(sandbox.database, &err));
+    REQUIRE(index.ready());
+
+    index.reset();
+    REQUIRE(!index.ready());
+    REQUIRE_EQ(index.count(false), std::size_t{0});
+
+    // patches before a load are ignored instead of building a partial index
+    db::Database::TickerRow row;
+    row.ticker = "BBB";
+    index.upsert(row);
+    REQUIRE(!index.contains("BBB"));
+
+    REQUIRE(index.ensure_loaded(sandbox.database, &err));
+    REQUIRE(index.contains("AAA"));
+}
+
+TEST_CASE(
+    "ticker index search matches sql like as the query grows and shrinks")
+{
+    test::AppSandbox sandbox;
+    const char* tickers[] = {"AAPL",  "AAL",   "aapx",  "BA",    "BAC",
+                             "BRK.B", "BRK.A", "ABNB",  "PLTR",  "PL",
+                             "LPLA",  "APLD",  "NVDA",  "AMD",   "XOM",
+                             "CVX",   "ABBV",  "PLUG",  "SPLK",  "ZZZZ"};
+    for (const char* t : tickers) sandbox.add_finance(t, "2024-FY");
+
+    std::string err;
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("APLD", &err));
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("AAPL", &err));
+
+    db::TickerIndex index;
+    REQUIRE(index.ensure_loaded(sandbox.database, &err));
+
+    // typed forward then erased, so both the narrowing and the rescan
+    // paths run against the same expectations
+    const char* queries[] = {"A",  "AP", "APL", "APLD", "APL", "AP", "A",
+                             "PL", "L",  ".",   ".B",   "Z",   "ZZZZZ"};
+    for (bool portfolio_only : {false, true}) {
+        db::TickerIndex::Search search;
+        for (const char* q : queries) {
+            index.search(q, portfolio_only, search);
+            const auto mem = index.search_rows(search, 100);
+            const auto sql =
+                sandbox.database.search_tickers(q, 100, &err, portfolio_only);
+            REQUIRE(err.empty());
+            REQUIRE_EQ(to_tickers(mem), to_tickers(sql));
+        }
+    }
+}
+
+TEST_CASE("ticker index search never matches across ticker boundaries")
+{
+    test::AppSandbox sandbox;
+    // "AB" + "CD" would contain "BC" if the arena were not separated; the
+    // long list pushes the arena past a few 16 byte blocks
+    for (int i = 0; i < 40; ++i) {
+        sandbox.add_finance("AB" + std::to_string(i), "2024-FY");
+    }
+    sandbox.add_finance("CDXX", "2024-FY");
+
+    std::string err;
+    db::TickerIndex index;
+    REQUIRE(index.ensure_loaded(sandbox.database, &err));
+
+    db::TickerIndex::Search search;
+    index.search("9C", false, search);
+    REQUIRE(index.search_rows(search, 100).empty());
+
+    index.search("XX", false, search);
+    const auto rows = index.search_rows(search, 100);
+    REQUIRE_EQ(rows.size(), std::size_t{1});
+    REQUIRE_EQ(rows.front().ticker, std::string("CDXX"));
+}
+
+TEST_CASE("ticker index search state is dropped after a patch")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAPL", "2024-FY");
+
+    std::string err;
+    db::TickerIndex index;
+    REQUIRE(index.ensure_loaded(sandbox.database, &err));
+
+    db::TickerIndex::Search search;
+    index.search("AA", false, search);
+    REQUIRE_EQ(index.search_rows(search, 10).size(), std::size_t{1});
+
+    sandbox.add_finance("AAL", "2024-FY");
+    const auto row = sandbox.database.get_ticker("AAL", &err);
+    REQUIRE(row.has_value());
+    index.upsert(*row);
+
+    // stale slots are not served, and the next query rescans
+    REQUIRE(index.search_rows(search, 10).empty());
+    index.search("AA", false, search);
+    REQUIRE_EQ(index.search_rows(search, 10).size(), std::size_t{2});
+}
+
+TEST_CASE("ticker index ranks exact prefix substring then typo matches")
+{
+    test::AppSandbox sandbox;
+    const char* tickers[] = {
+        "META", "METAX", "AMETA", "MTEA", "META1", "MXETA", "MSFT", "MEAT"};
+    for (const char* t : tickers) sandbox.add_finance(t, "2024-FY");
+
+    std::string err;
+    db::TickerIndex index;
+    REQUIRE(index.ensure_loaded(sandbox.database, &err));
+
+    db::TickerIndex::Search search;
+    index.search("META", false, search);
+    const auto ranked = index.ranked_rows(search, 10);
+
+    // exact, prefixes (ticker order on ties), substring, then typos:
+    // swaps/one-edit before the wider subsequence
+    const std::vector<std::string> expected = {
+        "META", "META1", "METAX", "AMETA", "MEAT", "MTEA", "MXETA"};
+    REQUIRE_EQ(to_tickers(ranked), expected);
+
+    // the heap keeps only the best k
+    const auto top2 = index.ranked_rows(search, 2);
+    REQUIRE_EQ(to_tickers(top2), (std::vector<std::string>{"META", "META1"}));
+}
+
+TEST_CASE("ticker index ranked search scopes typos to the portfolio")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("MSFT", "2024-FY");
+    sandbox.add_finance("MSFX", "2024-FY");
+
+    std::string err;
+    REQUIRE(sandbox.database.toggle_ticker_portfolio("MSFX", &err));
+
+    db::TickerIndex index;
+    REQUIRE(index.ensure_loaded(sandbox.database, &err));
+
+    db::TickerIndex::Search search;
+    index.search("MSFT", true, search);
+    const auto ranked = index.ranked_rows(search, 10);
+    REQUIRE_EQ(to_tickers(ranked), (std::vector<std::string>{"MSFX"}));
+
+    // a single character never pulls in typo matches
+    index.search("Q", false, search);
+    REQUIRE(index.ranked_rows(search, 10).empty());
+}
@@ -0,0 +1,176 @@
+#include "db/database.hpp"
+#include "db/ticker_page_ring.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+#include "views/home/view_home.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Key = db::Database::TickerSortKey;
+using Dir = db::Database::SortDir;
+
+std::vector<std::string>
+to_tickers(const std::vector<db::Database::TickerRow>& rows)
+{
+    std::vector<std::string> out;
+    out.reserve(rows.size());
+    for (const auto& row : rows) out.push_back(row.ticker);
+    return out;
+}
+
+db::TickerPageRing::Key ring_key(int page_size, Key key, Dir dir)
+{
+    db::TickerPageRing::Key k;
+    k.page_size = page_size;
+    k.sort_key = key;
+    k.sort_dir = dir;
+    return k;
+}
+
+// T00..T<n-1>, so ticker order is also insertion order
+void add_tickers(test::AppSandbox& sandbox, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        const std::string ticker =
+            std::string("T") + (i < 10 ? "0" : "") + std::to_string(i);
+        sandbox.add_finance(ticker, "2024-Y");
+    }
+}
+
+// Forces the SQL fallback the ring exists for.
+void disable_index(AppState& app)
+{
+    app.tickers.index.set_max_rows(0);
+    std::string err;
+    REQUIRE(!app.tickers.index.ensure_loaded(*app.db, &err));
+    REQUIRE(app.tickers.index.disabled());
+}
+
+} // namespace
+
+TEST_CASE("ticker page ring orders missing pages nearest first")
+{
+    db::TickerPageRing ring;
+    ring.set_key(ring_key(5, Key::Ticker, Dir::Asc));
+
+    REQUIRE_EQ(ring.missing_around(0), (std::vector<int>{0, 1, 2}));
+    REQUIRE_EQ(ring.missing_around(4), (std::vector<int>{4, 5, 3, 6, 2}));
+
+    ring.store(5, std::vector<db::Database::TickerRow>(2));
+    REQUIRE_EQ(ring.total(), std::optional<std::size_t>{27});
+    REQUIRE(ring.past_end(6));
+    REQUIRE_EQ(ring.missing_around(4), (std::vector<int>{4, 3, 2}));
+
+    ring.store(0, {});
+    ring.trim(4);
+    REQUIRE(ring.find(0) == nullptr);
+    REQUIRE(ring.find(5) != nullptr);
+
+    const auto epoch = ring.epoch();
+    ring.invalidate();
+    REQUIRE(ring.epoch() > epoch);
+    REQUIRE_EQ(ring.size(), std::size_t{0});
+    REQUIRE(!ring.total().has_value());
+}
+
+TEST_CASE("ticker page ring re-cuts held pages when ticker order flips")
+{
+    test::AppSandbox sandbox;
+    add_tickers(sandbox, 11);
+    constexpr int kPageSize = 4;
+
+    db::TickerPageRing ring;
+    ring.set_key(ring_key(kPageSize, Key::Ticker, Dir::Asc));
+    std::string err;
+    for (int page = 0; page < 3; ++page) {
+        ring.store(page,
+                   sandbox.database.get_tickers(
+                       page, kPageSize, Key::Ticker, Dir::Asc, &err));
+        REQUIRE(err.empty());
+    }
+    REQUIRE_EQ(ring.total(), std::optional<std::size_t>{11});
+
+    ring.set_key(ring_key(kPageSize, Key::Ticker, Dir::Desc));
+    REQUIRE_EQ(ring.size(), std::size_t{3});
+    for (int page = 0; page < 3; ++page) {
+        const auto* held = ring.find(page);
+        REQUIRE(held != nullptr);
+        const auto sql = sandbox.database.get_tickers(
+            page, kPageSize, Key::Ticker, Dir::Desc, &err);
+        REQUIRE_EQ(to_tickers(*held), to_tickers(sql));
+    }
+
+    // last_update ties break on ticker ASC both ways: not a reversal
+    ring.set_key(ring_key(kPageSize, Key::LastUpdate, Dir::Desc));
+    REQUIRE_EQ(ring.size(), std::size_t{0});
+}
+
+TEST_CASE("ticker page loader fills the ring around the current page")
+{
+    test::AppSandbox sandbox;
+    add_tickers(sandbox, 23);
+    auto& app = sandbox.app;
+    app.tickers.page_size = 5;
+    app.settings.sort_key = Key::Ticker;
+    app.settings.sort_dir = Dir::Asc;
+    disable_index(app);
+
+    db::TickerPageLoader loader;
+    app.page_loader = &loader;
+
+    views::pump_home_page_prefetch(app);
+    loader.wait_idle();
+    views::pump_home_page_prefetch(app);
+
+    auto& ring = app.tickers.pages;
+    REQUIRE_EQ(ring.total(), std::optional<std::size_t>{23});
+    for (int page = 0; page <= db::TickerPageRing::kRadius; ++page) {
+        REQUIRE(ring.find(page) != nullptr);
+    }
+
+    // walking to the end never needs a page the ring does not hold
+    for (int step = 0; step < 6; ++step) {
+        const int before = app.tickers.page;
+        REQUIRE(ring.find(before + 1) != nullptr || ring.past_end(before + 1));
+        REQUIRE(views::handle_key_home(app, KEY_NPAGE));
+        loader.wait_idle();
+        views::pump_home_page_prefetch(app);
+    }
+    REQUIRE_EQ(app.tickers.page, 4);
+
+    std::string err;
+    const auto rows = views::fetch_page(app, app.tickers.page, &err);
+    REQUIRE(err.empty());
+    REQUIRE_EQ(to_tickers(rows),
+               (std::vector<std::string>{"T20", "T21", "T22"}));
+
+    REQUIRE(views::handle_key_home(app, KEY_PPAGE));
+    REQUIRE_EQ(app.tickers.page, 3);
+    REQUIRE(ring.find(3) != nullptr);
+}
+
+TEST_CASE("ticker page loader results are dropped after a write")
+{
+    test::AppSandbox sandbox;
+    add_tickers(sandbox, 8);
+    auto& app = sandbox.app;
+    app.tickers.page_size = 5;
+    disable_index(app);
+
+    db::TickerPageLoader loader;
+    app.page_loader = &loader;
+    views::pump_home_page_prefetch(app);
+    loader.wait_idle();
+
+    app.tickers.invalidate_prefetch();
+    views::pump_home_page_prefetch(app);
+    REQUIRE(app.tickers.pages.find(0) == nullptr);
+
+    loader.wait_idle();
+    views::pump_home_page_prefetch(app);
+    REQUIRE(app.tickers.pages.find(0) != nullptr);
+}
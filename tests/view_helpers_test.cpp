@@ -156,6 +156,27 @@ TEST_CASE("view_home index helpers clamp and fallback predictably")
     REQUIRE_EQ(views::home_best_index_in_col(2, 2, 1, 3, 5), -1);
 }
 
+TEST_CASE("view_home summary line shows latest period and ttm eps")
+{
+    db::Database::TickerSummary summary;
+    summary.ticker = "ACME";
+    summary.latest_year = 2024;
+    summary.latest_period_type = "Q4";
+    summary.period_count = 12;
+    summary.yearly_count = 3;
+    REQUIRE_EQ(views::home_summary_line(summary),
+               std::string("latest 2024-Q4  periods 12 (3y)"));
+
+    summary.ttm_year = 2024;
+    summary.ttm_period_type = "Q4";
+    REQUIRE_EQ(views::home_summary_line(summary),
+               std::string("latest 2024-Q4  periods 12 (3y)  ttm eps -"));
+
+    summary.ttm_eps = 6.424;
+    REQUIRE_EQ(views::home_summary_line(summary),
+               std::string("latest 2024-Q4  periods 12 (3y)  ttm eps 6.42"));
+}
+
 TEST_CASE("view layout helpers switch hint rows on narrow terminals")
 {
     const int add_input_x =
@@ -0,0 +1,123 @@
+#include "db/history_cache.hpp"
+#include "metrics/finance_metrics.hpp"
+#include "metrics/yoy_table.hpp"
+#include "test_fixture.hpp"
+#include "test_harness.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Row = db::Database::FinanceRow;
+
+bool same(std::optional<double> a, std::optional<double> b)
+{
+    if (a.has_value() != b.has_value()) return false;
+    return !a.has_value() || *a == *b;
+}
+
+} // namespace
+
+TEST_CASE("yoy table aligns the same period a year earlier by packed key")
+{
+    // a gap in 2023-Q2 and interleaved yearly rows
+    const std::vector<Row> rows = {
+        test::finance_row(2022, "Q1"), test::finance_row(2022, "Q2"),
+        test::finance_row(2022, "Y"),  test::finance_row(2023, "Q1"),
+        test::finance_row(2023, "Y"),  test::finance_row(2024, "Q1"),
+        test::finance_row(2024, "Q2"), test::finance_row(2024, "Y"),
+    };
+    const metrics::FinanceStore store(rows);
+
+    const auto keys = metrics::packed_period_keys(store);
+    REQUIRE(keys[1] < keys[2]);
+    REQUIRE_EQ(keys[3] - keys[0], metrics::kPeriodKeyYearStride);
+
+    const auto previous = metrics::previous_year_indexes(store);
+    const std::vector<int> expected = {-1, -1, -1, 0, 2, 3, -1, 4};
+    REQUIRE_EQ(previous, expected);
+
+    // input order does not matter
+    std::vector<Row> shuffled(rows.rbegin(), rows.rend());
+    const auto reversed =
+        metrics::previous_year_indexes(metrics::FinanceStore(shuffled));
+    REQUIRE_EQ(reversed[0], 3); // 2024-Y -> 2023-Y
+    REQUIRE_EQ(reversed[1], -1); // 2024-Q2, no 2023-Q2
+    REQUIRE_EQ(reversed[2], 4);  // 2024-Q1 -> 2023-Q1
+}
+
+TEST_CASE("yoy table matches the row-wise change helpers")
+{
+    const std::vector<Row> rows = {
+        test::finance_row(2022, "Y", test::standard_payload(400, 40, 4.0)),
+        test::finance_row(2023, "Y", test::standard_payload(0, -20, -2.0))
+            .revenue(std::nullopt),
+        test::finance_row(2024, "Y", test::standard_payload(500, 30, 3.0)),
+        test::finance_row(2025, "Y", test::standard_payload(0, 0, 0.0)),
+    };
+
+    for (const int type : {1, 2, 3}) {
+        const metrics::FinanceStore store(rows);
+        const metrics::YoyTable yoy(rows, store, type);
+        REQUIRE_EQ(yoy.size(), rows.size());
+        REQUIRE_EQ(yoy.ticker_type(), type);
+
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            const Row* prev =
+                metrics::find_previous_year_same_period(rows, rows[i]);
+            REQUIRE_EQ(yoy.previous_index(i),
+                       prev ? static_cast<int>(prev - rows.data()) : -1);
+
+            for (const auto& f : metrics::kFinanceStoreFields) {
+                const auto expected = metrics::percent_change(
+                    metrics::to_f64(rows[i].*f.field),
+                    prev ? metrics::to_f64(prev->*f.field) : std::nullopt);
+                REQUIRE(same(yoy.field_change(f.field, i), expected));
+            }
+            REQUIRE(same(yoy.eps_change(i),
+                         metrics::percent_change(
+                             rows[i].eps,
+                             prev ? prev->eps : std::nullopt)));
+
+            const auto now = metrics::derive_finance_metrics(
+                rows, static_cast<int>(i), type);
+            const auto then =
+                prev ? metrics::derive_finance_metrics(
+                           rows, static_cast<int>(prev - rows.data()), type)
+                     : metrics::FinanceMetrics{};
+            for (std::size_t k = 0;
+                 k < std::size(metrics::kFinanceMetricColumns);
+                 ++k) {
+                const auto& column = metrics::kFinanceMetricColumns[k];
+                REQUIRE(same(yoy.metric_value(k, i), now.*column.field));
+                REQUIRE(same(yoy.metric_change(k, i),
+                             metrics::metric_change(column, now, then)));
+            }
+        }
+    }
+
+    const metrics::YoyTable empty;
+    REQUIRE(!empty.field_change(&Row::revenue, 0).has_value());
+    REQUIRE(!empty.metric_change(0, 0).has_value());
+}
+
+TEST_CASE("history cache carries the ticker type and yoy table")
+{
+    test::AppSandbox sandbox;
+    sandbox.add_finance("AAA", "2024-Y", test::standard_payload(100, 10));
+    sandbox.add_finance("AAA", "2025-Y", test::standard_payload(150, 12));
+
+    db::HistoryCache cache;
+    const auto history = cache.load(sandbox.database, "AAA");
+    REQUIRE(history != nullptr);
+    REQUIRE_EQ(history->ticker_type, 1);
+    REQUIRE_EQ(history->yoy.size(), std::size_t{2});
+    REQUIRE_EQ(history->yoy.previous_index(1), 0);
+    REQUIRE_EQ(history->yoy.field_change(&Row::revenue, 1),
+               std::optional<double>(50.0));
+}